@@ -0,0 +1,81 @@
+
+// Bindless scene resources (set 1), see BindlessDescriptors.h for the host side.
+
+struct GeometryRecord
+{
+    uint VertexBufferIndex;
+    uint IndexBufferIndex;
+    uint MaterialIndex;
+    uint Padding;
+};
+
+struct MaterialRecord
+{
+    float4 BaseColor;
+    uint   BaseColorTextureIndex;
+    uint3  Padding;
+};
+
+[[vk::binding(0, 1)]] StructuredBuffer<GeometryRecord> _GeometryTable;
+[[vk::binding(1, 1)]] StructuredBuffer<MaterialRecord> _MaterialTable;
+[[vk::binding(2, 1)]] SamplerState                     _LinearSampler;
+[[vk::binding(3, 1)]] Texture2D<float4>                _Textures[];
+[[vk::binding(4, 1)]] ByteAddressBuffer                _Buffers[];
+
+static const uint kBindlessInvalidIndex = 0xFFFFFFFFU;
+
+// Matches the Vertex layout on the host (float3 position, float3 normal).
+static const uint kVertexStride       = 24U;
+static const uint kVertexNormalOffset = 12U;
+
+struct SurfaceHit
+{
+    float3 positionOS;
+    float3 normalOS;
+    float3 baseColor;
+};
+
+// Meshes carry no UVs, so textures are projected along the three object space axes.
+float3 SampleTriplanar(uint textureIndex, float3 positionOS, float3 normalOS)
+{
+    float3 weights = abs(normalOS);
+    weights /= max(weights.x + weights.y + weights.z, 1e-5);
+
+    Texture2D<float4> baseColorTexture = _Textures[NonUniformResourceIndex(textureIndex)];
+
+    // Explicit LOD, hit shaders have no derivatives.
+    return baseColorTexture.SampleLevel(_LinearSampler, positionOS.yz, 0.0).rgb * weights.x +
+           baseColorTexture.SampleLevel(_LinearSampler, positionOS.xz, 0.0).rgb * weights.y +
+           baseColorTexture.SampleLevel(_LinearSampler, positionOS.xy, 0.0).rgb * weights.z;
+}
+
+// Interpolated object space attributes and material of a triangle hit, from the geometry record of the instance.
+SurfaceHit LoadSurfaceHit(uint geometryIndex, uint primitiveIndex, float3 barycentricCoords)
+{
+    const GeometryRecord geometry = _GeometryTable[geometryIndex];
+    const MaterialRecord material = _MaterialTable[geometry.MaterialIndex];
+
+    // The buffer indices can diverge across the wave, so the descriptors are selected non-uniformly.
+    ByteAddressBuffer vertexBuffer = _Buffers[NonUniformResourceIndex(geometry.VertexBufferIndex)];
+    ByteAddressBuffer indexBuffer  = _Buffers[NonUniformResourceIndex(geometry.IndexBufferIndex)];
+
+    const uint3 triangleIndices = indexBuffer.Load3(primitiveIndex * 12U);
+    const uint3 vertexOffsets   = triangleIndices * kVertexStride;
+
+    SurfaceHit hit;
+
+    hit.positionOS = asfloat(vertexBuffer.Load3(vertexOffsets.x)) * barycentricCoords.x +
+                     asfloat(vertexBuffer.Load3(vertexOffsets.y)) * barycentricCoords.y +
+                     asfloat(vertexBuffer.Load3(vertexOffsets.z)) * barycentricCoords.z;
+
+    hit.normalOS = asfloat(vertexBuffer.Load3(vertexOffsets.x + kVertexNormalOffset)) * barycentricCoords.x +
+                   asfloat(vertexBuffer.Load3(vertexOffsets.y + kVertexNormalOffset)) * barycentricCoords.y +
+                   asfloat(vertexBuffer.Load3(vertexOffsets.z + kVertexNormalOffset)) * barycentricCoords.z;
+
+    hit.baseColor = material.BaseColor.rgb;
+
+    if (material.BaseColorTextureIndex != kBindlessInvalidIndex)
+        hit.baseColor *= SampleTriplanar(material.BaseColorTextureIndex, hit.positionOS, hit.normalOS);
+
+    return hit;
+}
@@ -15,6 +15,8 @@
  * limitations under the License.
  */
 
+#include "Bindless.hlsli"
+
 struct Attributes
 {
     float2 bary;
@@ -23,11 +25,26 @@ struct Attributes
 struct Payload
 {
     [[vk::location(0)]] float3 hitValue;
+    float3                     normalWS;
+    float                      hitT;
 };
 
 [shader("closesthit")]
 void Main(inout Payload p, in Attributes attribs)
 {
     const float3 barycentricCoords = float3(1.0f - attribs.bary.x - attribs.bary.y, attribs.bary.x, attribs.bary.y);
-    p.hitValue = barycentricCoords;
+
+    // The instance custom index selects the geometry record.
+    const SurfaceHit hit = LoadSurfaceHit(InstanceID(), PrimitiveIndex(), barycentricCoords);
+
+    p.hitValue = barycentricCoords * hit.baseColor;
+
+    float3 normalWS = normalize(mul(ObjectToWorld3x4(), float4(hit.normalOS, 0.0)));
+
+    // Face the normal towards the incoming ray.
+    if (dot(normalWS, WorldRayDirection()) > 0.0)
+        normalWS = -normalWS;
+
+    p.normalWS = normalWS;
+    p.hitT     = RayTCurrent();
 }
@@ -1,2 +1,19 @@
 @echo off
-C:\VulkanSDK\1.3.283.0\Bin\dxc.exe -E Main -T lib_6_3 -spirv -fspv-target-env=vulkan1.3 -Fo Compiled\\%1.spv %1.hlsl
\ No newline at end of file
+rem Usage: Compile.bat [Shader] [Profile], e.g. "Compile.bat RayGen" or "Compile.bat RayQuery cs_6_5".
+rem Without arguments every shader is compiled with its profile (keep in sync with Compile.sh).
+if not exist Compiled mkdir Compiled
+if not "%1"=="" goto single
+
+for %%s in (RayGen ClosestHit Miss OcclusionRayGen OcclusionMiss) do call :compile %%s lib_6_3 || exit /b 1
+for %%s in (RayQuery Tonemap TileTrace DenoiseTemporal DenoiseFilter SparseReconstruct DeformVertices) do call :compile %%s cs_6_5 || exit /b 1
+exit /b 0
+
+:single
+set PROFILE=%2
+if "%PROFILE%"=="" set PROFILE=lib_6_3
+call :compile %1 %PROFILE%
+exit /b %errorlevel%
+
+:compile
+C:\VulkanSDK\1.3.283.0\Bin\dxc.exe -E Main -T %2 -spirv -fspv-target-env=vulkan1.3 -Fo Compiled\\%1.spv %1.hlsl
+exit /b %errorlevel%
@@ -0,0 +1,26 @@
+#!/bin/sh
+# Usage: Compile.sh [Shader] [Profile], e.g. "./Compile.sh RayGen" or "./Compile.sh RayQuery cs_6_5".
+# Without arguments every shader is compiled with its profile (keep in sync with Compile.bat). dxc comes from the
+# path, unless the DXC environment variable points at one.
+set -e
+
+cd "$(dirname "$0")"
+mkdir -p Compiled
+
+compile()
+{
+    "${DXC:-dxc}" -E Main -T "$2" -spirv -fspv-target-env=vulkan1.3 -Fo "Compiled/$1.spv" "$1.hlsl"
+}
+
+if [ $# -gt 0 ]; then
+    compile "$1" "${2:-lib_6_3}"
+    exit 0
+fi
+
+for shader in RayGen ClosestHit Miss OcclusionRayGen OcclusionMiss; do
+    compile "$shader" lib_6_3
+done
+
+for shader in RayQuery Tonemap TileTrace DenoiseTemporal DenoiseFilter SparseReconstruct DeformVertices; do
+    compile "$shader" cs_6_5
+done
@@ -0,0 +1,53 @@
+
+RWByteAddressBuffer _RestVertices     : register(u0);
+RWByteAddressBuffer _DeformedVertices : register(u1);
+RWByteAddressBuffer _Drift            : register(u2); // Largest vertex distance to the build pose (float bits).
+
+struct Constants
+{
+    float4 _BoundsCenterRadius;
+    float  _Time;
+    float  _BuildTime; // Time of the pose the BLAS was last built from.
+    float  _Amplitude; // Relative to the bounding radius.
+    float  _Frequency; // Wave number across the bounding radius.
+    float  _Speed;
+    uint   _VertexCount;
+};
+[[vk::push_constant]] Constants gConstants;
+
+// Matches the Vertex layout on the host (float3 position, float3 normal).
+static const uint kVertexStride       = 24U;
+static const uint kVertexNormalOffset = 12U;
+
+// A wave travelling along the diagonal of the object space, displacing the surface along its normal.
+float3 Deform(float3 positionOS, float3 normalOS, float time)
+{
+    const float3 offset = (positionOS - gConstants._BoundsCenterRadius.xyz) / gConstants._BoundsCenterRadius.w;
+    const float  phase  = dot(offset, float3(0.577, 0.577, 0.577)) * gConstants._Frequency + time * gConstants._Speed;
+
+    return positionOS + normalOS * (sin(phase) * gConstants._Amplitude * gConstants._BoundsCenterRadius.w);
+}
+
+// Deforms the rest pose at the current time, and tracks how far the vertices moved from the pose the BLAS was built for.
+[numthreads(64, 1, 1)]
+void Main(uint3 dispatchThreadID : SV_DispatchThreadID)
+{
+    if (dispatchThreadID.x >= gConstants._VertexCount)
+        return;
+
+    const uint vertexOffset = dispatchThreadID.x * kVertexStride;
+
+    const float3 positionOS = asfloat(_RestVertices.Load3(vertexOffset));
+    const float3 normalOS   = asfloat(_RestVertices.Load3(vertexOffset + kVertexNormalOffset));
+
+    const float3 deformedOS = Deform(positionOS, normalOS, gConstants._Time);
+
+    _DeformedVertices.Store3(vertexOffset, asuint(deformedOS));
+    _DeformedVertices.Store3(vertexOffset + kVertexNormalOffset, asuint(normalOS));
+
+    // Distances are non-negative, so their bits order like the floats.
+    const float drift = length(deformedOS - Deform(positionOS, normalOS, gConstants._BuildTime));
+
+    uint previousDrift;
+    _Drift.InterlockedMax(0U, asuint(drift), previousDrift);
+}
@@ -0,0 +1,121 @@
+
+[[vk::image_format("rgba16f")]] RWTexture2D<float4> _InputImage    : register(u0); // rgb: color, a: variance.
+[[vk::image_format("rgba16f")]] RWTexture2D<float4> _OutputImage   : register(u1);
+[[vk::image_format("rgba32f")]] RWTexture2D<float4> _PositionImage : register(u2); // xyz: hit position, w: hit distance (< 0 on miss).
+[[vk::image_format("rgba16f")]] RWTexture2D<float4> _NormalImage   : register(u3);
+
+struct Constants
+{
+    uint  _StepSize; // Spacing of the kernel taps, doubles every iteration.
+    float _PhiColor;
+    float _PhiNormal;
+    float _PhiDepth;
+    float _PixelFootprint;
+};
+[[vk::push_constant]] Constants gConstants;
+
+// 1D weights of the B3 spline kernel (1/16, 1/4, 3/8, 1/4, 1/16) and of a 3x3 gaussian, by distance to the center.
+static const float kKernelWeights[3]   = { 3.0 / 8.0, 1.0 / 4.0, 1.0 / 16.0 };
+static const float kGaussianWeights[2] = { 1.0 / 2.0, 1.0 / 4.0 };
+
+float Luminance(float3 color)
+{
+    return dot(color, float3(0.2126, 0.7152, 0.0722));
+}
+
+// Variance prefiltered over 3x3 pixels, steadier for the luminance edge-stopping.
+float FilterVariance(int2 pixel, int2 imageSize)
+{
+    float variance  = 0.0;
+    float weightSum = 0.0;
+
+    for (int y = -1; y <= 1; y++)
+    {
+        for (int x = -1; x <= 1; x++)
+        {
+            const int2 tapPixel = pixel + int2(x, y);
+
+            if (any(tapPixel < 0) || any(tapPixel >= imageSize))
+                continue;
+
+            const float weight = kGaussianWeights[abs(x)] * kGaussianWeights[abs(y)];
+
+            variance  += weight * _InputImage[tapPixel].a;
+            weightSum += weight;
+        }
+    }
+
+    return variance / weightSum;
+}
+
+// One a-trous wavelet iteration, edge-aware along the G-buffer. Variance is carried along (squared weights) for the
+// luminance edge-stopping of the next iteration.
+[numthreads(8, 8, 1)]
+void Main(uint3 dispatchThreadID : SV_DispatchThreadID)
+{
+    uint2 dispatchSize;
+    _InputImage.GetDimensions(dispatchSize.x, dispatchSize.y);
+
+    if (any(dispatchThreadID.xy >= dispatchSize))
+        return;
+
+    const int2 pixel     = int2(dispatchThreadID.xy);
+    const int2 imageSize = int2(dispatchSize);
+
+    const float4 center       = _InputImage[pixel];
+    const float4 positionHitT = _PositionImage[pixel];
+    const float3 normal       = _NormalImage[pixel].xyz;
+
+    // Misses are passed through.
+    if (positionHitT.w < 0.0)
+    {
+        _OutputImage[pixel] = center;
+        return;
+    }
+
+    const float centerLuminance = Luminance(center.rgb);
+    const float phiLuminance    = gConstants._PhiColor * sqrt(FilterVariance(pixel, imageSize)) + 1e-4;
+
+    // Plane distances are compared against the footprint of one pixel at the hit.
+    const float phiDepth = gConstants._PhiDepth * gConstants._PixelFootprint * positionHitT.w + 1e-4;
+
+    float3 colorSum    = center.rgb * kKernelWeights[0] * kKernelWeights[0];
+    float  varianceSum = center.a * kKernelWeights[0] * kKernelWeights[0] * kKernelWeights[0] * kKernelWeights[0];
+    float  weightSum   = kKernelWeights[0] * kKernelWeights[0];
+
+    for (int y = -2; y <= 2; y++)
+    {
+        for (int x = -2; x <= 2; x++)
+        {
+            if (x == 0 && y == 0)
+                continue;
+
+            const int2 tapPixel = pixel + int2(x, y) * int(gConstants._StepSize);
+
+            if (any(tapPixel < 0) || any(tapPixel >= imageSize))
+                continue;
+
+            const float4 tapPositionHitT = _PositionImage[tapPixel];
+
+            if (tapPositionHitT.w < 0.0)
+                continue;
+
+            const float4 tap = _InputImage[tapPixel];
+
+            // Distance of the tap to the tangent plane of the center, per pixel of the tap offset.
+            const float planeDistance = abs(dot(normal, tapPositionHitT.xyz - positionHitT.xyz));
+
+            const float weightDepth     = exp(-planeDistance / (phiDepth * length(float2(x, y)) * float(gConstants._StepSize)));
+            const float weightNormal    = pow(saturate(dot(normal, _NormalImage[tapPixel].xyz)), gConstants._PhiNormal);
+            const float weightLuminance = exp(-abs(centerLuminance - Luminance(tap.rgb)) / phiLuminance);
+
+            const float weight = kKernelWeights[abs(x)] * kKernelWeights[abs(y)] * weightDepth * weightNormal * weightLuminance;
+
+            colorSum    += weight * tap.rgb;
+            varianceSum += weight * weight * tap.a;
+            weightSum   += weight;
+        }
+    }
+
+    _OutputImage[pixel] = float4(colorSum / weightSum, varianceSum / (weightSum * weightSum));
+}
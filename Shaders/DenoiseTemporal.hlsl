@@ -0,0 +1,176 @@
+
+[[vk::image_format("rgba16f")]] RWTexture2D<float4> _ColorImage         : register(u0);
+[[vk::image_format("rgba32f")]] RWTexture2D<float4> _PositionImage      : register(u1); // xyz: hit position, w: hit distance (< 0 on miss).
+[[vk::image_format("rgba16f")]] RWTexture2D<float4> _NormalImage        : register(u2);
+[[vk::image_format("rg16f")]]   RWTexture2D<float2> _MotionImage        : register(u3); // Pixel offset into the previous frame.
+[[vk::image_format("rgba16f")]] RWTexture2D<float4> _HistoryColor       : register(u4);
+[[vk::image_format("rgba16f")]] RWTexture2D<float4> _HistoryMoments     : register(u5);
+[[vk::image_format("rgba16f")]] RWTexture2D<float4> _HistoryNormalDepth : register(u6);
+[[vk::image_format("rgba16f")]] RWTexture2D<float4> _OutputColor        : register(u7); // rgb: accumulated color, a: variance.
+[[vk::image_format("rgba16f")]] RWTexture2D<float4> _OutputMoments      : register(u8); // xy: luminance moments, z: history length.
+[[vk::image_format("rgba16f")]] RWTexture2D<float4> _OutputNormalDepth  : register(u9); // xyz: normal, w: hit distance.
+
+struct Constants
+{
+    float4 _PreviousRayOrigin; // Camera position of the previous frame, the history hit distances are relative to it.
+    float  _ColorAlpha;
+    float  _MomentsAlpha;
+    uint   _HistoryValid;
+    uint   _ResolveToColor; // Write the accumulated color back, no filter iterations follow.
+};
+[[vk::push_constant]] Constants gConstants;
+
+// History taps are rejected past these (normal cosine, hit distance relative to the expected one).
+static const float kNormalTolerance = 0.9;
+static const float kDepthTolerance  = 0.1;
+
+// Frames the moments need before their variance is trusted over the spatial estimate.
+static const float kMinMomentsHistory = 4.0;
+static const float kMaxHistoryLength  = 64.0;
+
+float Luminance(float3 color)
+{
+    return dot(color, float3(0.2126, 0.7152, 0.0722));
+}
+
+// Motion vectors of points that were behind the previous camera.
+static const float2 kInvalidMotion = float2(-65504.0, -65504.0);
+
+// Luminance variance of the 3x3 neighbourhood on the same surface, for pixels without enough history.
+float EstimateSpatialVariance(int2 pixel, int2 imageSize, float3 normal)
+{
+    float2 moments   = float2(0.0, 0.0);
+    float  weightSum = 0.0;
+
+    for (int y = -1; y <= 1; y++)
+    {
+        for (int x = -1; x <= 1; x++)
+        {
+            const int2 tapPixel = pixel + int2(x, y);
+
+            if (any(tapPixel < 0) || any(tapPixel >= imageSize))
+                continue;
+
+            if (_PositionImage[tapPixel].w < 0.0 || dot(normal, _NormalImage[tapPixel].xyz) < kNormalTolerance)
+                continue;
+
+            const float luminance = Luminance(_ColorImage[tapPixel].rgb);
+
+            moments   += float2(luminance, luminance * luminance);
+            weightSum += 1.0;
+        }
+    }
+
+    moments /= max(weightSum, 1.0);
+
+    return max(moments.y - moments.x * moments.x, 0.0);
+}
+
+// Blends the traced color of every primary hit with its reprojected history, and tracks the luminance moments.
+[numthreads(8, 8, 1)]
+void Main(uint3 dispatchThreadID : SV_DispatchThreadID)
+{
+    uint2 dispatchSize;
+    _ColorImage.GetDimensions(dispatchSize.x, dispatchSize.y);
+
+    if (any(dispatchThreadID.xy >= dispatchSize))
+        return;
+
+    const int2 pixel     = int2(dispatchThreadID.xy);
+    const int2 imageSize = int2(dispatchSize);
+
+    const float3 color        = _ColorImage[pixel].rgb;
+    const float4 positionHitT = _PositionImage[pixel];
+    const float3 normal       = _NormalImage[pixel].xyz;
+    const float  luminance    = Luminance(color);
+
+    // Misses have no surface to reproject or to filter along.
+    if (positionHitT.w < 0.0)
+    {
+        _OutputColor[pixel]       = float4(color, 0.0);
+        _OutputMoments[pixel]     = float4(luminance, luminance * luminance, 0.0, 0.0);
+        _OutputNormalDepth[pixel] = float4(0.0, 0.0, 0.0, -1.0);
+        return;
+    }
+
+    // Bilinear history lookup, each tap only counts when it saw the same surface.
+    // --------------------------------------------
+
+    float3 historyColor   = float3(0.0, 0.0, 0.0);
+    float2 historyMoments = float2(0.0, 0.0);
+    float  historyLength  = 0.0;
+    float  weightSum      = 0.0;
+
+    const float2 motion = _MotionImage[pixel];
+
+    if (gConstants._HistoryValid != 0U && all(motion != kInvalidMotion))
+    {
+        // Pixel coordinates (centers at + 0.5) of the hit in the previous frame.
+        const float2 previousPixel = float2(pixel) + 0.5 + motion;
+
+        const float previousDistance = length(positionHitT.xyz - gConstants._PreviousRayOrigin.xyz);
+
+        const float2 texel     = previousPixel - 0.5;
+        const int2   basePixel = int2(floor(texel));
+        const float2 f         = texel - floor(texel);
+
+        const int2  tapOffsets[4] = { int2(0, 0), int2(1, 0), int2(0, 1), int2(1, 1) };
+        const float tapWeights[4] = { (1.0 - f.x) * (1.0 - f.y), f.x * (1.0 - f.y), (1.0 - f.x) * f.y, f.x * f.y };
+
+        for (uint tapIndex = 0U; tapIndex < 4U; tapIndex++)
+        {
+            const int2 tapPixel = basePixel + tapOffsets[tapIndex];
+
+            if (any(tapPixel < 0) || any(tapPixel >= imageSize))
+                continue;
+
+            const float4 tapNormalDepth = _HistoryNormalDepth[tapPixel];
+
+            if (tapNormalDepth.w < 0.0 || dot(normal, tapNormalDepth.xyz) < kNormalTolerance)
+                continue;
+
+            if (abs(tapNormalDepth.w - previousDistance) > kDepthTolerance * previousDistance)
+                continue;
+
+            const float3 tapMoments = _HistoryMoments[tapPixel].xyz;
+
+            historyColor   += tapWeights[tapIndex] * _HistoryColor[tapPixel].rgb;
+            historyMoments += tapWeights[tapIndex] * tapMoments.xy;
+            historyLength  += tapWeights[tapIndex] * tapMoments.z;
+            weightSum      += tapWeights[tapIndex];
+        }
+    }
+
+    // Exponential moving average, a plain average while the history is short. Rejected pixels start over.
+    // --------------------------------------------
+
+    float3 accumulatedColor = color;
+    float2 moments          = float2(luminance, luminance * luminance);
+    float  accumulatedCount = 1.0;
+
+    if (weightSum > 1e-3)
+    {
+        historyColor   /= weightSum;
+        historyMoments /= weightSum;
+        historyLength  /= weightSum;
+
+        accumulatedCount = min(historyLength + 1.0, kMaxHistoryLength);
+
+        accumulatedColor = lerp(historyColor, color, max(gConstants._ColorAlpha, 1.0 / accumulatedCount));
+        moments          = lerp(historyMoments, moments, max(gConstants._MomentsAlpha, 1.0 / accumulatedCount));
+    }
+
+    float variance = max(moments.y - moments.x * moments.x, 0.0);
+
+    // Boosted while the spatial estimate stands in, the filter is wider on fresh pixels. Not when resolving, the
+    // neighbours of the color image are being overwritten.
+    if (accumulatedCount < kMinMomentsHistory && gConstants._ResolveToColor == 0U)
+        variance = EstimateSpatialVariance(pixel, imageSize, normal) * (kMinMomentsHistory / accumulatedCount);
+
+    _OutputColor[pixel]       = float4(accumulatedColor, variance);
+    _OutputMoments[pixel]     = float4(moments, accumulatedCount, 0.0);
+    _OutputNormalDepth[pixel] = float4(normal, positionHitT.w);
+
+    if (gConstants._ResolveToColor != 0U)
+        _ColorImage[pixel] = float4(accumulatedColor, 0.0);
+}
@@ -18,10 +18,14 @@
 struct Payload
 {
     [[vk::location(0)]] float3 hitValue;
+    float3                     normalWS;
+    float                      hitT;
 };
 
 [shader("miss")]
 void Main(inout Payload p)
 {
     p.hitValue = float3(0.0, 0.0, 0.2);
-}
\ No newline at end of file
+    p.normalWS = float3(0.0, 0.0, 0.0);
+    p.hitT     = -1.0;
+}
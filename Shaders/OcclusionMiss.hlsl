@@ -0,0 +1,13 @@
+
+
+struct VisibilityPayload
+{
+    [[vk::location(0)]] float visible;
+};
+
+// Visibility rays skip the closest hit shader, so reaching the miss shader means the ray is unoccluded.
+[shader("miss")]
+void Main(inout VisibilityPayload p)
+{
+    p.visible = 1.0;
+}
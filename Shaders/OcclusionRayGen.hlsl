@@ -0,0 +1,152 @@
+
+#include "SparseTrace.hlsli"
+
+RaytracingAccelerationStructure                     _AccelerationStructure : register(t0);
+[[vk::image_format("rgba16f")]] RWTexture2D<float4> _ColorImage            : register(u1);
+[[vk::image_format("rgba32f")]] RWTexture2D<float4> _PositionImage         : register(u2);
+[[vk::image_format("rgba16f")]] RWTexture2D<float4> _NormalImage           : register(u3);
+
+struct VisibilityPayload
+{
+    [[vk::location(0)]] float visible;
+};
+
+struct Constants
+{
+    float4   _LightDirection; // xyz: direction towards the light, w: cone half-angle (radians).
+    uint     _ShadowSampleCount;
+    uint     _AOSampleCount;
+    float    _AORadius;
+    uint     _FrameIndex;
+    uint     _OcclusionPass;
+    uint     _SamplesPerPixel;
+    uint     _SampleOffset;
+    uint     _SparseMode;
+    uint     _SparsePhase;
+};
+[[vk::push_constant]] Constants gConstants;
+
+static const uint  kOcclusionPassShadow = 0U;
+static const uint  kOcclusionPassAO     = 1U;
+static const float kAmbient             = 0.2;
+static const float kPI                  = 3.14159265;
+
+// Visibility-only rays: the first hit ends traversal and no closest hit shader runs.
+static const uint kVisibilityRayFlags =
+    RAY_FLAG_ACCEPT_FIRST_HIT_AND_END_SEARCH | RAY_FLAG_SKIP_CLOSEST_HIT_SHADER | RAY_FLAG_FORCE_OPAQUE;
+
+static const uint kVisibilityMissIndex = 1U;
+
+uint Hash(uint x)
+{
+    // PCG hash.
+    uint state = x * 747796405U + 2891336453U;
+    uint word  = ((state >> ((state >> 28U) + 4U)) ^ state) * 277803737U;
+    return (word >> 22U) ^ word;
+}
+
+float Random(inout uint seed)
+{
+    seed = Hash(seed);
+    return float(seed) / 4294967296.0;
+}
+
+float3x3 BuildBasis(float3 n)
+{
+    const float3 up = abs(n.y) < 0.999 ? float3(0, 1, 0) : float3(1, 0, 0);
+    const float3 t  = normalize(cross(up, n));
+    const float3 b  = cross(n, t);
+    return float3x3(t, b, n);
+}
+
+float TraceVisibility(float3 origin, float3 direction, float tMax)
+{
+    RayDesc ray;
+    {
+        ray.Origin    = origin;
+        ray.Direction = direction;
+        ray.TMin      = 0.001;
+        ray.TMax      = tMax;
+    }
+
+    // Assume occluded, the visibility miss shader reports otherwise.
+    VisibilityPayload payload;
+    payload.visible = 0.0;
+
+    TraceRay(_AccelerationStructure, kVisibilityRayFlags, 0xff, 0, 0, kVisibilityMissIndex, ray, payload);
+
+    return payload.visible;
+}
+
+[shader("raygeneration")]
+void Main()
+{
+    uint2 imageSize;
+    _ColorImage.GetDimensions(imageSize.x, imageSize.y);
+
+    // Only the pixels the primary trace covered this frame, the others are reconstructed later.
+    const uint2 pixel = GetSparseTracePixel(DispatchRaysIndex().xy, gConstants._SparseMode, gConstants._SparsePhase);
+
+    if (any(pixel >= imageSize))
+        return;
+
+    const float4 positionHitT = _PositionImage[pixel];
+
+    // Nothing to occlude for primary misses.
+    if (positionHitT.w <= 0.0)
+        return;
+
+    const float3 normal = normalize(_NormalImage[pixel].xyz);
+    const float3 origin = positionHitT.xyz + normal * 1e-3;
+
+    uint seed = Hash(pixel.x + pixel.y * imageSize.x) ^ Hash(gConstants._FrameIndex * 2U + gConstants._OcclusionPass);
+
+    float factor = 1.0;
+
+    if (gConstants._OcclusionPass == kOcclusionPassShadow)
+    {
+        const float3   lightDirection = normalize(gConstants._LightDirection.xyz);
+        const float3x3 lightBasis     = BuildBasis(lightDirection);
+        const float    cosConeAngle   = cos(gConstants._LightDirection.w);
+
+        float visibility = 0.0;
+
+        for (uint sampleIndex = 0U; sampleIndex < gConstants._ShadowSampleCount; sampleIndex++)
+        {
+            // Uniformly sample the cone around the light direction (soft shadows).
+            const float cosTheta = lerp(1.0, cosConeAngle, Random(seed));
+            const float sinTheta = sqrt(saturate(1.0 - cosTheta * cosTheta));
+            const float phi      = 2.0 * kPI * Random(seed);
+
+            const float3 direction = mul(float3(cos(phi) * sinTheta, sin(phi) * sinTheta, cosTheta), lightBasis);
+
+            visibility += TraceVisibility(origin, direction, 10000.0);
+        }
+
+        visibility /= float(gConstants._ShadowSampleCount);
+
+        factor = kAmbient + (1.0 - kAmbient) * saturate(dot(normal, lightDirection)) * visibility;
+    }
+    else
+    {
+        const float3x3 normalBasis = BuildBasis(normal);
+
+        float visibility = 0.0;
+
+        for (uint sampleIndex = 0U; sampleIndex < gConstants._AOSampleCount; sampleIndex++)
+        {
+            // Cosine-weighted hemisphere sample.
+            const float u   = Random(seed);
+            const float phi = 2.0 * kPI * Random(seed);
+            const float r   = sqrt(u);
+
+            const float3 direction = mul(float3(cos(phi) * r, sin(phi) * r, sqrt(1.0 - u)), normalBasis);
+
+            visibility += TraceVisibility(origin, direction, gConstants._AORadius);
+        }
+
+        factor = visibility / float(gConstants._AOSampleCount);
+    }
+
+    _ColorImage[pixel] = float4(_ColorImage[pixel].rgb * factor, 0.0);
+}
@@ -1,41 +1,172 @@
 
 
-RaytracingAccelerationStructure _AccelerationStructure : register(t0);
-RWTexture2D<float4>             _ColorImage            : register(u1);
+#include "SparseTrace.hlsli"
+
+RaytracingAccelerationStructure                     _AccelerationStructure : register(t0);
+[[vk::image_format("rgba16f")]] RWTexture2D<float4> _ColorImage            : register(u1);
+[[vk::image_format("rgba32f")]] RWTexture2D<float4> _PositionImage         : register(u2);
+[[vk::image_format("rgba16f")]] RWTexture2D<float4> _NormalImage           : register(u3);
+[[vk::image_format("rg16f")]]   RWTexture2D<float2> _MotionImage           : register(u4); // Pixel offset of the primary hit into the previous frame.
 
 struct Payload
 {
     [[vk::location(0)]] float3 hitValue;
+    float3                     normalWS;
+    float                      hitT;
+};
+
+// Camera of the frame, in the uniform buffer slot of the frame in flight.
+struct FrameConstants
+{
+    float4   _RayOrigin; // Primary ray basis, see CameraState.
+    float4   _RayCorner;
+    float4   _RayPixelDeltaX;
+    float4   _RayPixelDeltaY;
+    float4x4 _PreviousMatrixVP; // Projects the primary hits into the previous frame for the motion vectors.
 };
+ConstantBuffer<FrameConstants> gFrame : register(b5);
 
 struct Constants
 {
-    float4x4 _InverseMatrixV;
-    float4x4 _InverseMatrixP;
+    float4   _LightDirection;
+    uint     _ShadowSampleCount;
+    uint     _AOSampleCount;
+    float    _AORadius;
+    uint     _FrameIndex;
+    uint     _OcclusionPass;
+    uint     _SamplesPerPixel; // Ray query path only, the pipeline is specialized on kSamplesPerPixel.
+    uint     _SampleOffset;    // Start of the primary sample sequence, cycles per frame while the denoiser accumulates.
+    uint     _SparseMode;      // Pixels traced per frame, see SparseTrace.h.
+    uint     _SparsePhase;
 };
 [[vk::push_constant]] Constants gConstants;
 
-[shader("raygeneration")]
-void Main()
-{
-    uint3 dispatchRayID = DispatchRaysIndex();
-    uint3 dispatchSize  = DispatchRaysDimensions();
+// Specialization constants of the pipeline variant (ShaderVariant), branches they disable are stripped at pipeline
+// compile time.
+[[vk::constant_id(0)]] const uint kSamplesPerPixel = 1U;
+[[vk::constant_id(1)]] const uint kDebugView       = 0U;
+[[vk::constant_id(2)]] const uint kPrimaryRayFlags = 1U; // RAY_FLAG_FORCE_OPAQUE
+[[vk::constant_id(3)]] const uint kMaxBounceCount  = 0U;
+
+static const uint kDebugViewNone        = 0U;
+static const uint kDebugViewNormals     = 1U;
+static const uint kDebugViewHitDistance = 2U;
+
+// Hit distance mapped to white, about the instance cull distance.
+static const float kDebugHitDistanceScale = 150.0;
 
-    const float2 pixelCenter = float2(dispatchRayID.xy) + float2(0.5, 0.5);
-    const float2 inUV = pixelCenter / float2(dispatchSize.xy);
-    float2 d = inUV * 2.0 - 1.0;
-    float4 target = mul(gConstants._InverseMatrixP, float4(d.x, d.y, 1, 1));
+// Share of the energy carried by each mirror bounce.
+static const float kBounceReflectance = 0.5;
+
+RayDesc GeneratePrimaryRay(float2 pixelPosition)
+{
+    const float3 direction =
+        gFrame._RayCorner.xyz + pixelPosition.x * gFrame._RayPixelDeltaX.xyz + pixelPosition.y * gFrame._RayPixelDeltaY.xyz;
 
     RayDesc ray;
     {
-        ray.Origin    = mul(gConstants._InverseMatrixV, float4(0, 0, 0, 1)).xyz;
-        ray.Direction = mul(gConstants._InverseMatrixV, float4(normalize(target.xyz), 0)).xyz;
+        ray.Origin    = gFrame._RayOrigin.xyz;
+        ray.Direction = normalize(direction);
         ray.TMin      = 0.001;
         ray.TMax      = 10000.0;
     }
+    return ray;
+}
+
+float3 ShadeDebugView(Payload payload)
+{
+    if (payload.hitT <= 0.0)
+        return float3(0.0, 0.0, 0.0);
+
+    if (kDebugView == kDebugViewNormals)
+        return payload.normalWS * 0.5 + 0.5;
+
+    return saturate(payload.hitT / kDebugHitDistanceScale).xxx;
+}
+
+// Motions of points behind the previous camera, the denoiser drops their history.
+static const float2 kInvalidMotion = float2(-65504.0, -65504.0);
+
+// Offset from the sample position to the pixel coordinates of the same point in the previous frame. Hits are points
+// (w = 1), misses directions (w = 0) that only move with the camera rotation.
+float2 ComputeMotionVector(float4 positionWS, float2 samplePosition, float2 imageSize)
+{
+    const float4 previousClip = mul(gFrame._PreviousMatrixVP, positionWS);
+
+    if (previousClip.w <= 0.0)
+        return kInvalidMotion;
+
+    const float2 previousPixel = (previousClip.xy / previousClip.w * 0.5 + 0.5) * imageSize;
+
+    return previousPixel - samplePosition;
+}
+
+// Follows the mirror reflection of a primary hit for up to kMaxBounceCount bounces.
+float3 TraceBounces(RayDesc ray, Payload payload)
+{
+    float3 color      = float3(0.0, 0.0, 0.0);
+    float  throughput = 1.0;
+
+    for (uint bounceIndex = 0U; bounceIndex < kMaxBounceCount && payload.hitT > 0.0; bounceIndex++)
+    {
+        ray.Origin    = ray.Origin + ray.Direction * payload.hitT + payload.normalWS * 1e-3;
+        ray.Direction = reflect(ray.Direction, payload.normalWS);
+        throughput   *= kBounceReflectance;
+
+        TraceRay(_AccelerationStructure, kPrimaryRayFlags, 0xff, 0, 0, 0, ray, payload);
+
+        color += throughput * payload.hitValue;
+    }
+
+    return color;
+}
+
+[shader("raygeneration")]
+void Main()
+{
+    uint2 imageSize;
+    _ColorImage.GetDimensions(imageSize.x, imageSize.y);
+
+    // Sparse dispatches cover a subset of the pixels, rounded up.
+    const uint2 pixel = GetSparseTracePixel(DispatchRaysIndex().xy, gConstants._SparseMode, gConstants._SparsePhase);
+
+    if (any(pixel >= imageSize))
+        return;
 
-    Payload payload;
-    TraceRay(_AccelerationStructure, RAY_FLAG_FORCE_OPAQUE, 0xff, 0, 0, 0, ray, payload);
+    const uint sampleCount = max(kSamplesPerPixel, 1U);
+
+    float3 color = float3(0.0, 0.0, 0.0);
+
+    for (uint sampleIndex = 0U; sampleIndex < sampleCount; sampleIndex++)
+    {
+        // The first sample of the sequence goes through the pixel center, the others follow the R2 sequence over the
+        // pixel. The offset moves the frames of an accumulating history along it.
+        const float2 jitter = frac(0.5 + float(sampleIndex + gConstants._SampleOffset) * float2(0.7548776662, 0.5698402910));
+
+        const float2 samplePosition = float2(pixel) + jitter;
+
+        RayDesc ray = GeneratePrimaryRay(samplePosition);
+
+        Payload payload;
+        TraceRay(_AccelerationStructure, kPrimaryRayFlags, 0xff, 0, 0, 0, ray, payload);
+
+        if (kDebugView != kDebugViewNone)
+            color += ShadeDebugView(payload);
+        else
+            color += payload.hitValue + TraceBounces(ray, payload);
+
+        // Surface attributes for the secondary (visibility) rays, w > 0 marks a hit.
+        if (sampleIndex == 0U)
+        {
+            _PositionImage[pixel] = float4(ray.Origin + ray.Direction * payload.hitT, payload.hitT);
+            _NormalImage[pixel]   = float4(payload.normalWS, 0.0);
+
+            const float4 motionPosition =
+                payload.hitT > 0.0 ? float4(ray.Origin + ray.Direction * payload.hitT, 1.0) : float4(ray.Direction, 0.0);
+
+            _MotionImage[pixel] = ComputeMotionVector(motionPosition, samplePosition, float2(imageSize));
+        }
+    }
 
-    _ColorImage[int2(dispatchRayID.xy)] = float4(payload.hitValue, 0.0);
-}
\ No newline at end of file
+    _ColorImage[pixel] = float4(color / float(sampleCount), 0.0);
+}
@@ -0,0 +1,140 @@
+
+RaytracingAccelerationStructure                     _AccelerationStructure : register(t0);
+[[vk::image_format("rgba16f")]] RWTexture2D<float4> _ColorImage            : register(u1);
+[[vk::image_format("rgba32f")]] RWTexture2D<float4> _PositionImage         : register(u2);
+[[vk::image_format("rgba16f")]] RWTexture2D<float4> _NormalImage           : register(u3);
+[[vk::image_format("rg16f")]]   RWTexture2D<float2> _MotionImage           : register(u4); // Pixel offset of the primary hit into the previous frame.
+
+#include "Bindless.hlsli"
+#include "SparseTrace.hlsli"
+
+// Camera of the frame, in the uniform buffer slot of the frame in flight.
+struct FrameConstants
+{
+    float4   _RayOrigin; // Primary ray basis, see CameraState.
+    float4   _RayCorner;
+    float4   _RayPixelDeltaX;
+    float4   _RayPixelDeltaY;
+    float4x4 _PreviousMatrixVP; // Projects the primary hits into the previous frame for the motion vectors.
+};
+ConstantBuffer<FrameConstants> gFrame : register(b5);
+
+struct Constants
+{
+    float4   _LightDirection;
+    uint     _ShadowSampleCount;
+    uint     _AOSampleCount;
+    float    _AORadius;
+    uint     _FrameIndex;
+    uint     _OcclusionPass;
+    uint     _SamplesPerPixel;
+    uint     _SampleOffset;
+    uint     _SparseMode;
+    uint     _SparsePhase;
+};
+[[vk::push_constant]] Constants gConstants;
+
+RayDesc GeneratePrimaryRay(float2 pixelPosition)
+{
+    const float3 direction =
+        gFrame._RayCorner.xyz + pixelPosition.x * gFrame._RayPixelDeltaX.xyz + pixelPosition.y * gFrame._RayPixelDeltaY.xyz;
+
+    RayDesc ray;
+    {
+        ray.Origin    = gFrame._RayOrigin.xyz;
+        ray.Direction = normalize(direction);
+        ray.TMin      = 0.001;
+        ray.TMax      = 10000.0;
+    }
+    return ray;
+}
+
+// Motions of points behind the previous camera, the denoiser drops their history.
+static const float2 kInvalidMotion = float2(-65504.0, -65504.0);
+
+// Offset from the sample position to the pixel coordinates of the same point in the previous frame. Hits are points
+// (w = 1), misses directions (w = 0) that only move with the camera rotation.
+float2 ComputeMotionVector(float4 positionWS, float2 samplePosition, float2 imageSize)
+{
+    const float4 previousClip = mul(gFrame._PreviousMatrixVP, positionWS);
+
+    if (previousClip.w <= 0.0)
+        return kInvalidMotion;
+
+    const float2 previousPixel = (previousClip.xy / previousClip.w * 0.5 + 0.5) * imageSize;
+
+    return previousPixel - samplePosition;
+}
+
+void TracePrimaryRay(RayDesc ray, out float3 hitValue, out float3 normalWS, out float hitT)
+{
+    // All geometry is opaque, so a single Proceed() resolves the closest hit.
+    RayQuery<RAY_FLAG_FORCE_OPAQUE> query;
+    query.TraceRayInline(_AccelerationStructure, RAY_FLAG_NONE, 0xff, ray);
+    query.Proceed();
+
+    hitValue = float3(0.0, 0.0, 0.2);
+    normalWS = float3(0.0, 0.0, 0.0);
+    hitT     = -1.0;
+
+    if (query.CommittedStatus() == COMMITTED_TRIANGLE_HIT)
+    {
+        const float2 bary = query.CommittedTriangleBarycentrics();
+        const float3 barycentricCoords = float3(1.0f - bary.x - bary.y, bary.x, bary.y);
+
+        const SurfaceHit hit = LoadSurfaceHit(query.CommittedInstanceID(), query.CommittedPrimitiveIndex(), barycentricCoords);
+
+        hitValue = barycentricCoords * hit.baseColor;
+        hitT     = query.CommittedRayT();
+
+        normalWS = normalize(mul(query.CommittedObjectToWorld3x4(), float4(hit.normalOS, 0.0)));
+
+        if (dot(normalWS, ray.Direction) > 0.0)
+            normalWS = -normalWS;
+    }
+}
+
+// Inline ray query equivalent of RayGen.hlsl + ClosestHit.hlsl + Miss.hlsl, without a shader binding table.
+[numthreads(8, 8, 1)]
+void Main(uint3 dispatchThreadID : SV_DispatchThreadID)
+{
+    uint2 imageSize;
+    _ColorImage.GetDimensions(imageSize.x, imageSize.y);
+
+    const uint2 pixel = GetSparseTracePixel(dispatchThreadID.xy, gConstants._SparseMode, gConstants._SparsePhase);
+
+    if (any(pixel >= imageSize))
+        return;
+
+    const uint sampleCount = max(gConstants._SamplesPerPixel, 1U);
+
+    float3 color = float3(0.0, 0.0, 0.0);
+
+    for (uint sampleIndex = 0U; sampleIndex < sampleCount; sampleIndex++)
+    {
+        // Same sample pattern as RayGen.hlsl.
+        const float2 jitter = frac(0.5 + float(sampleIndex + gConstants._SampleOffset) * float2(0.7548776662, 0.5698402910));
+
+        const float2 samplePosition = float2(pixel) + jitter;
+
+        RayDesc ray = GeneratePrimaryRay(samplePosition);
+
+        float3 hitValue, normalWS;
+        float  hitT;
+        TracePrimaryRay(ray, hitValue, normalWS, hitT);
+
+        color += hitValue;
+
+        if (sampleIndex == 0U)
+        {
+            _PositionImage[pixel] = float4(ray.Origin + ray.Direction * hitT, hitT);
+            _NormalImage[pixel]   = float4(normalWS, 0.0);
+
+            const float4 motionPosition = hitT > 0.0 ? float4(ray.Origin + ray.Direction * hitT, 1.0) : float4(ray.Direction, 0.0);
+
+            _MotionImage[pixel] = ComputeMotionVector(motionPosition, samplePosition, float2(imageSize));
+        }
+    }
+
+    _ColorImage[pixel] = float4(color / float(sampleCount), 0.0);
+}
@@ -0,0 +1,128 @@
+
+#include "SparseTrace.hlsli"
+
+[[vk::image_format("rgba16f")]] RWTexture2D<float4> _ColorImage    : register(u0);
+[[vk::image_format("rgba32f")]] RWTexture2D<float4> _PositionImage : register(u1); // xyz: hit position, w: hit distance (< 0 on miss).
+[[vk::image_format("rgba16f")]] RWTexture2D<float4> _NormalImage   : register(u2);
+[[vk::image_format("rg16f")]]   RWTexture2D<float2> _MotionImage   : register(u3); // Pixel offset into the previous frame.
+[[vk::image_format("rgba16f")]] RWTexture2D<float4> _HistoryColor  : register(u4); // Reconstruction of the previous frame.
+[[vk::image_format("rgba16f")]] RWTexture2D<float4> _OutputHistory : register(u5);
+
+struct Constants
+{
+    uint _SparseMode;
+    uint _SparsePhase; // Frame within the cycle of the mode, selects the traced pixels.
+    uint _HistoryValid;
+};
+[[vk::push_constant]] Constants gConstants;
+
+// Motion vectors of points that were behind the previous camera.
+static const float2 kInvalidMotion = float2(-65504.0, -65504.0);
+
+// Bilinear lookup of the previous reconstruction at pixel coordinates (centers at + 0.5), false past its edges.
+bool SampleHistory(float2 previousPixel, int2 imageSize, out float3 historyColor)
+{
+    historyColor = float3(0.0, 0.0, 0.0);
+
+    const float2 texel     = previousPixel - 0.5;
+    const int2   basePixel = int2(floor(texel));
+    const float2 f         = texel - floor(texel);
+
+    if (any(basePixel < 0) || any(basePixel + 1 >= imageSize))
+        return false;
+
+    const float3 top    = lerp(_HistoryColor[basePixel].rgb, _HistoryColor[basePixel + int2(1, 0)].rgb, f.x);
+    const float3 bottom = lerp(_HistoryColor[basePixel + int2(0, 1)].rgb, _HistoryColor[basePixel + int2(1, 1)].rgb, f.x);
+
+    historyColor = lerp(top, bottom, f.y);
+    return true;
+}
+
+// Fills the pixels skipped by the sparse trace this frame. The previous reconstruction is followed along the motion of
+// the nearest traced neighbour and clamped to the colors of the traced neighbours, their average stands in without
+// history. Skipped pixels only read traced ones, so the frame images are completed in place.
+[numthreads(8, 8, 1)]
+void Main(uint3 dispatchThreadID : SV_DispatchThreadID)
+{
+    uint2 dispatchSize;
+    _ColorImage.GetDimensions(dispatchSize.x, dispatchSize.y);
+
+    if (any(dispatchThreadID.xy >= dispatchSize))
+        return;
+
+    const int2 pixel     = int2(dispatchThreadID.xy);
+    const int2 imageSize = int2(dispatchSize);
+
+    if (IsSparseTracePixel(dispatchThreadID.xy, gConstants._SparseMode, gConstants._SparsePhase))
+    {
+        _OutputHistory[pixel] = _ColorImage[pixel];
+        return;
+    }
+
+    // Traced neighbours: the four edge neighbours on the checkerboard, one to four quad pixels when interleaved.
+    // --------------------------------------------
+
+    float3 colorSum = float3(0.0, 0.0, 0.0);
+    float3 colorMin = float3(65504.0, 65504.0, 65504.0);
+    float3 colorMax = float3(0.0, 0.0, 0.0);
+    float  count    = 0.0;
+
+    // Misses count as infinitely far, so the nearest surface hands down its G-buffer.
+    int2  nearestPixel    = pixel;
+    float nearestDistance = 0.0;
+
+    for (int y = -1; y <= 1; y++)
+    {
+        for (int x = -1; x <= 1; x++)
+        {
+            const int2 tapPixel = pixel + int2(x, y);
+
+            if (any(tapPixel < 0) || any(tapPixel >= imageSize))
+                continue;
+
+            if (!IsSparseTracePixel(uint2(tapPixel), gConstants._SparseMode, gConstants._SparsePhase))
+                continue;
+
+            const float3 tapColor = _ColorImage[tapPixel].rgb;
+
+            colorSum += tapColor;
+            colorMin  = min(colorMin, tapColor);
+            colorMax  = max(colorMax, tapColor);
+
+            const float hitT        = _PositionImage[tapPixel].w;
+            const float tapDistance = hitT < 0.0 ? 1e30 : hitT;
+
+            if (count == 0.0 || tapDistance < nearestDistance)
+            {
+                nearestPixel    = tapPixel;
+                nearestDistance = tapDistance;
+            }
+
+            count += 1.0;
+        }
+    }
+
+    // Interleaved images one pixel wide or tall can leave a skipped pixel without traced neighbours.
+    if (count == 0.0)
+    {
+        _OutputHistory[pixel] = _ColorImage[pixel];
+        return;
+    }
+
+    // Reprojected history, clamped to the traced neighbourhood against disocclusions and stale shading.
+    // --------------------------------------------
+
+    const float2 motion = _MotionImage[nearestPixel];
+
+    float3 color = colorSum / count;
+    float3 historyColor;
+
+    if (gConstants._HistoryValid != 0U && all(motion != kInvalidMotion) && SampleHistory(float2(pixel) + 0.5 + motion, imageSize, historyColor))
+        color = clamp(historyColor, colorMin, colorMax);
+
+    _ColorImage[pixel]    = float4(color, 0.0);
+    _PositionImage[pixel] = _PositionImage[nearestPixel];
+    _NormalImage[pixel]   = _NormalImage[nearestPixel];
+    _MotionImage[pixel]   = motion;
+    _OutputHistory[pixel] = float4(color, 0.0);
+}
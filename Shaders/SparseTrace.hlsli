@@ -0,0 +1,31 @@
+// Pixels traced per frame by the sparse modes, see SparseTrace.h for the host side.
+
+static const uint kSparseTraceFull         = 0U;
+static const uint kSparseTraceCheckerboard = 1U;
+static const uint kSparseTraceInterleaved  = 2U;
+
+// Pixel of the 2x2 quad traced in each phase of the interleaved mode, diagonals first.
+static const uint2 kSparseInterleavedOffsets[4] = { uint2(0U, 0U), uint2(1U, 1U), uint2(1U, 0U), uint2(0U, 1U) };
+
+// Pixel traced by a thread of the sparse dispatch, can be past the edge of odd sized images.
+uint2 GetSparseTracePixel(uint2 dispatchIndex, uint mode, uint phase)
+{
+    if (mode == kSparseTraceCheckerboard)
+        return uint2(2U * dispatchIndex.x + ((dispatchIndex.y + phase) & 1U), dispatchIndex.y);
+
+    if (mode == kSparseTraceInterleaved)
+        return 2U * dispatchIndex + kSparseInterleavedOffsets[phase & 3U];
+
+    return dispatchIndex;
+}
+
+bool IsSparseTracePixel(uint2 pixel, uint mode, uint phase)
+{
+    if (mode == kSparseTraceCheckerboard)
+        return ((pixel.x + pixel.y + phase) & 1U) == 0U;
+
+    if (mode == kSparseTraceInterleaved)
+        return all((pixel & 1U) == kSparseInterleavedOffsets[phase & 3U]);
+
+    return true;
+}
@@ -0,0 +1,65 @@
+RaytracingAccelerationStructure _AccelerationStructure : register(t0);
+RWStructuredBuffer<float4>      _TileColors            : register(u1);
+
+// Matches kTileSize in TileRenderer.h.
+static const uint kTileSize = 64U;
+
+struct Constants
+{
+    float4 _RayOrigin; // Primary ray basis, see CameraState.
+    float4 _RayCorner;
+    float4 _RayPixelDeltaX;
+    float4 _RayPixelDeltaY;
+    uint2  _TileOrigin;
+    uint2  _ImageSize;
+    uint   _TileSlot; // Tile of the submission, offsets the output.
+    uint   _SamplesPerPixel;
+};
+[[vk::push_constant]] Constants gConstants;
+
+// Primary visibility of one tile for the multi-device offline renders, the same output as RayQuery.hlsl for the
+// untextured white material (the tile devices carry no bindless set).
+[numthreads(8, 8, 1)]
+void Main(uint3 dispatchThreadID : SV_DispatchThreadID)
+{
+    const uint2 pixel = gConstants._TileOrigin + dispatchThreadID.xy;
+
+    if (any(pixel >= gConstants._ImageSize))
+        return;
+
+    const uint sampleCount = max(gConstants._SamplesPerPixel, 1U);
+
+    float3 color = float3(0.0, 0.0, 0.0);
+
+    for (uint sampleIndex = 0U; sampleIndex < sampleCount; sampleIndex++)
+    {
+        // Same sample pattern as RayGen.hlsl.
+        const float2 jitter = frac(0.5 + float(sampleIndex) * float2(0.7548776662, 0.5698402910));
+        const float2 pixelPosition = float2(pixel) + jitter;
+
+        RayDesc ray;
+        {
+            ray.Origin    = gConstants._RayOrigin.xyz;
+            ray.Direction = normalize(gConstants._RayCorner.xyz + pixelPosition.x * gConstants._RayPixelDeltaX.xyz +
+                                      pixelPosition.y * gConstants._RayPixelDeltaY.xyz);
+            ray.TMin      = 0.001;
+            ray.TMax      = 10000.0;
+        }
+
+        RayQuery<RAY_FLAG_FORCE_OPAQUE> query;
+        query.TraceRayInline(_AccelerationStructure, RAY_FLAG_NONE, 0xff, ray);
+        query.Proceed();
+
+        if (query.CommittedStatus() == COMMITTED_TRIANGLE_HIT)
+        {
+            const float2 bary = query.CommittedTriangleBarycentrics();
+
+            color += float3(1.0f - bary.x - bary.y, bary.x, bary.y);
+        }
+        else
+            color += float3(0.0, 0.0, 0.2);
+    }
+
+    _TileColors[gConstants._TileSlot * kTileSize * kTileSize + dispatchThreadID.y * kTileSize + dispatchThreadID.x] =
+        float4(color / float(sampleCount), 0.0);
+}
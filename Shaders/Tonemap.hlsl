@@ -0,0 +1,53 @@
+
+// Both declare their format, writes without one would need shaderStorageImageWriteWithoutFormat.
+[[vk::image_format("rgba16f")]] RWTexture2D<float4> _ColorImage  : register(u0);
+[[vk::image_format("rgba8")]]   RWTexture2D<float4> _OutputImage : register(u1); // Back buffer (R8G8B8A8_UNORM), unused in place.
+
+struct Constants
+{
+    float _Exposure;
+    uint  _TonemapOperator;
+    uint  _InPlace; // The back buffer isn't storage: the color image is tone mapped in place, then blitted.
+};
+[[vk::push_constant]] Constants gConstants;
+
+static const uint kTonemapOperatorNone = 0U;
+static const uint kTonemapOperatorACES = 1U;
+
+// Narkowicz's fit of the ACES filmic curve.
+float3 TonemapACES(float3 x)
+{
+    return saturate((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14));
+}
+
+// The back buffer is a UNORM format presented as sRGB, so the encoding is applied here.
+float3 LinearToSRGB(float3 x)
+{
+    const float3 lo = 12.92 * x;
+    const float3 hi = 1.055 * pow(x, 1.0 / 2.4) - 0.055;
+
+    return lerp(hi, lo, step(x, 0.0031308));
+}
+
+// Tone maps the linear HDR trace output and writes the display-ready result.
+[numthreads(8, 8, 1)]
+void Main(uint3 dispatchThreadID : SV_DispatchThreadID)
+{
+    uint2 dispatchSize;
+    _ColorImage.GetDimensions(dispatchSize.x, dispatchSize.y);
+
+    if (any(dispatchThreadID.xy >= dispatchSize))
+        return;
+
+    float3 color = _ColorImage[int2(dispatchThreadID.xy)].rgb * gConstants._Exposure;
+
+    if (gConstants._TonemapOperator == kTonemapOperatorACES)
+        color = LinearToSRGB(TonemapACES(color));
+    else
+        color = saturate(color);
+
+    if (gConstants._InPlace != 0U)
+        _ColorImage[int2(dispatchThreadID.xy)] = float4(color, 1.0);
+    else
+        _OutputImage[int2(dispatchThreadID.xy)] = float4(color, 1.0);
+}
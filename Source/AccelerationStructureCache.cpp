@@ -0,0 +1,315 @@
+#include <Common.h>
+#include <Profiler.h>
+#include <RenderContext.h>
+#include <AccelerationStructureCache.h>
+
+// Acceleration Structure Cache Implementation
+// ------------------------------------------------------------
+
+// Serialization source / destination addresses must be aligned to 256 bytes.
+const VkDeviceSize kSerializedAccelerationStructureAlignment = 256U;
+
+static std::filesystem::path GetCacheEntryPath(RenderContext* pRenderContext, const std::filesystem::path& cacheDirectory, uint64_t contentHash)
+{
+    VkPhysicalDeviceIDProperties deviceIDProperties { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES };
+
+    VkPhysicalDeviceProperties2 deviceProperties { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
+    {
+        deviceProperties.pNext = &deviceIDProperties;
+    }
+    vkGetPhysicalDeviceProperties2(pRenderContext->GetDevicePhysical(), &deviceProperties);
+
+    // A driver update lands in new entries instead of overwriting the ones of the previous driver.
+    uint64_t deviceHash = HashBytes(deviceIDProperties.deviceUUID, VK_UUID_SIZE);
+    deviceHash          = HashBytes(deviceIDProperties.driverUUID, VK_UUID_SIZE, deviceHash);
+
+    return cacheDirectory / std::format("{:016x}-{:016x}.blas", deviceHash, contentHash);
+}
+
+static void CreateSerializationBuffer(RenderContext* pRenderContext,
+                                      VkDeviceSize   size,
+                                      VmaMemoryUsage memoryUsage,
+                                      Buffer&        buffer,
+                                      void**         ppMappedData)
+{
+    VkBufferCreateInfo bufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+    bufferInfo.size               = size;
+    bufferInfo.usage              = VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage                   = memoryUsage;
+    allocInfo.flags                   = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    VmaAllocationInfo allocationInfo;
+    Check(vmaCreateBufferWithAlignment(pRenderContext->GetAllocator(),
+                                       &bufferInfo,
+                                       &allocInfo,
+                                       kSerializedAccelerationStructureAlignment,
+                                       &buffer.buffer,
+                                       &buffer.bufferAllocation,
+                                       &allocationInfo),
+          "Failed to create acceleration structure serialization memory.");
+
+    *ppMappedData = allocationInfo.pMappedData;
+}
+
+static uint64_t GetDeviceAddress(RenderContext* pRenderContext, const Buffer& buffer)
+{
+    VkBufferDeviceAddressInfoKHR deviceAddressInfo { VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO };
+    {
+        deviceAddressInfo.buffer = buffer.buffer;
+    }
+    return vkGetBufferDeviceAddressKHR(pRenderContext->GetDevice(), &deviceAddressInfo);
+}
+
+bool DeserializeAccelerationStructure(RenderContext*              pRenderContext,
+                                      VkCommandPool               vkCommandPool,
+                                      const std::vector<uint8_t>& serializedData,
+                                      VkDeviceSize                minimumSize,
+                                      const std::string&          sourceName,
+                                      AccelerationStructure&      accelerationStructure)
+{
+    // Validate the header before handing the blob to the driver.
+    // ------------------------------------------------
+
+    if (serializedData.size() < kSerializedAccelerationStructureHeaderSize)
+    {
+        spdlog::warn("Discarding truncated serialized acceleration structure {}.", sourceName);
+        return false;
+    }
+
+    uint64_t serializedSize   = 0U;
+    uint64_t deserializedSize = 0U;
+    uint64_t handleCount      = 0U;
+
+    std::memcpy(&serializedSize, serializedData.data() + 2U * VK_UUID_SIZE, sizeof(uint64_t));
+    std::memcpy(&deserializedSize, serializedData.data() + 2U * VK_UUID_SIZE + sizeof(uint64_t), sizeof(uint64_t));
+    std::memcpy(&handleCount, serializedData.data() + 2U * VK_UUID_SIZE + 2U * sizeof(uint64_t), sizeof(uint64_t));
+
+    // Only bottom-level structures are supported, a blob referencing other structures would need its handles patched.
+    if (serializedSize != serializedData.size() || handleCount != 0U)
+    {
+        spdlog::warn("Discarding malformed serialized acceleration structure {}.", sourceName);
+        return false;
+    }
+
+    VkAccelerationStructureVersionInfoKHR versionInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_VERSION_INFO_KHR };
+    {
+        versionInfo.pVersionData = serializedData.data();
+    }
+
+    VkAccelerationStructureCompatibilityKHR compatibility = VK_ACCELERATION_STRUCTURE_COMPATIBILITY_INCOMPATIBLE_KHR;
+    vkGetDeviceAccelerationStructureCompatibilityKHR(pRenderContext->GetDevice(), &versionInfo, &compatibility);
+
+    if (compatibility != VK_ACCELERATION_STRUCTURE_COMPATIBILITY_COMPATIBLE_KHR)
+    {
+        spdlog::info("Discarding serialized acceleration structure {} (incompatible with the device).", sourceName);
+        return false;
+    }
+
+    // Upload the blob.
+    // ------------------------------------------------
+
+    Buffer serializedBuffer;
+    void*  pMappedData = nullptr;
+    CreateSerializationBuffer(pRenderContext, serializedSize, VMA_MEMORY_USAGE_CPU_TO_GPU, serializedBuffer, &pMappedData);
+
+    std::memcpy(pMappedData, serializedData.data(), serializedData.size());
+    Check(vmaFlushAllocation(pRenderContext->GetAllocator(), serializedBuffer.bufferAllocation, 0U, VK_WHOLE_SIZE),
+          "Failed to flush acceleration structure serialization memory.");
+
+    // Create the destination acceleration structure.
+    // ------------------------------------------------
+
+    const VkDeviceSize accelerationStructureSize = std::max<VkDeviceSize>(deserializedSize, minimumSize);
+
+    VkBufferCreateInfo bufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+    bufferInfo.size               = accelerationStructureSize;
+    bufferInfo.usage              = VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage                   = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    Check(vmaCreateBuffer(pRenderContext->GetAllocator(),
+                          &bufferInfo,
+                          &allocInfo,
+                          &accelerationStructure.backingMemory.buffer,
+                          &accelerationStructure.backingMemory.bufferAllocation,
+                          nullptr),
+          "Failed to create dedicated buffer memory.");
+
+    VkAccelerationStructureCreateInfoKHR accelerationStructureInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR };
+    {
+        accelerationStructureInfo.buffer = accelerationStructure.backingMemory.buffer;
+        accelerationStructureInfo.size   = accelerationStructureSize;
+        accelerationStructureInfo.type   = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+    }
+    Check(vkCreateAccelerationStructureKHR(pRenderContext->GetDevice(), &accelerationStructureInfo, nullptr, &accelerationStructure.handle),
+          "Failed to create acceleration structure");
+
+    // Deserialize
+    // ------------------------------------------------
+
+    VkCopyMemoryToAccelerationStructureInfoKHR copyInfo { VK_STRUCTURE_TYPE_COPY_MEMORY_TO_ACCELERATION_STRUCTURE_INFO_KHR };
+    {
+        copyInfo.src.deviceAddress = GetDeviceAddress(pRenderContext, serializedBuffer);
+        copyInfo.dst               = accelerationStructure.handle;
+        copyInfo.mode              = VK_COPY_ACCELERATION_STRUCTURE_MODE_DESERIALIZE_KHR;
+    }
+
+    VkCommandBuffer vkCommand = VK_NULL_HANDLE;
+    SingleShotCommandBegin(pRenderContext, vkCommand, vkCommandPool);
+    {
+        vkCmdCopyMemoryToAccelerationStructureKHR(vkCommand, &copyInfo);
+    }
+    SingleShotCommandEnd(pRenderContext, vkCommand);
+
+    vmaDestroyBuffer(pRenderContext->GetAllocator(), serializedBuffer.buffer, serializedBuffer.bufferAllocation);
+
+    VkAccelerationStructureDeviceAddressInfoKHR deviceAddressInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR };
+    {
+        deviceAddressInfo.accelerationStructure = accelerationStructure.handle;
+    }
+    accelerationStructure.deviceAddress = vkGetAccelerationStructureDeviceAddressKHR(pRenderContext->GetDevice(), &deviceAddressInfo);
+
+    return true;
+}
+
+bool LoadCachedAccelerationStructure(RenderContext*               pRenderContext,
+                                     VkCommandPool                vkCommandPool,
+                                     const std::filesystem::path& cacheDirectory,
+                                     uint64_t                     contentHash,
+                                     AccelerationStructure&       accelerationStructure)
+{
+    const auto entryPath = GetCacheEntryPath(pRenderContext, cacheDirectory, contentHash);
+
+    std::ifstream file(entryPath, std::ios::binary | std::ios::ate);
+
+    if (!file.is_open())
+        return false;
+
+    std::vector<uint8_t> serializedData(static_cast<size_t>(file.tellg()));
+
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(serializedData.data()), static_cast<std::streamsize>(serializedData.size()));
+    file.close();
+
+    // Entries that can't be used are removed, the build that follows stores a new one.
+    if (!DeserializeAccelerationStructure(pRenderContext, vkCommandPool, serializedData, 0U, entryPath.string(), accelerationStructure))
+    {
+        std::error_code errorCode;
+        std::filesystem::remove(entryPath, errorCode);
+        return false;
+    }
+
+    return true;
+}
+
+bool StoreCachedAccelerationStructure(RenderContext*               pRenderContext,
+                                      VkCommandPool                vkCommandPool,
+                                      const std::filesystem::path& cacheDirectory,
+                                      uint64_t                     contentHash,
+                                      const AccelerationStructure& accelerationStructure)
+{
+    // Query the serialized size.
+    // ------------------------------------------------
+
+    VkQueryPoolCreateInfo queryPoolInfo { VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+    {
+        queryPoolInfo.queryType  = VK_QUERY_TYPE_ACCELERATION_STRUCTURE_SERIALIZATION_SIZE_KHR;
+        queryPoolInfo.queryCount = 1U;
+    }
+
+    VkQueryPool vkQueryPool = VK_NULL_HANDLE;
+    Check(vkCreateQueryPool(pRenderContext->GetDevice(), &queryPoolInfo, nullptr, &vkQueryPool), "Failed to create serialization size query pool.");
+
+    VkCommandBuffer vkCommand = VK_NULL_HANDLE;
+    SingleShotCommandBegin(pRenderContext, vkCommand, vkCommandPool);
+    {
+        vkCmdResetQueryPool(vkCommand, vkQueryPool, 0U, 1U);
+        vkCmdWriteAccelerationStructuresPropertiesKHR(vkCommand,
+                                                      1U,
+                                                      &accelerationStructure.handle,
+                                                      VK_QUERY_TYPE_ACCELERATION_STRUCTURE_SERIALIZATION_SIZE_KHR,
+                                                      vkQueryPool,
+                                                      0U);
+    }
+    SingleShotCommandEnd(pRenderContext, vkCommand);
+
+    uint64_t serializedSize = 0U;
+    Check(vkGetQueryPoolResults(pRenderContext->GetDevice(),
+                                vkQueryPool,
+                                0U,
+                                1U,
+                                sizeof(uint64_t),
+                                &serializedSize,
+                                sizeof(uint64_t),
+                                VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT),
+          "Failed to read back the serialized acceleration structure size.");
+
+    vkDestroyQueryPool(pRenderContext->GetDevice(), vkQueryPool, nullptr);
+
+    // Serialize into host-visible memory.
+    // ------------------------------------------------
+
+    Buffer serializedBuffer;
+    void*  pMappedData = nullptr;
+    CreateSerializationBuffer(pRenderContext, serializedSize, VMA_MEMORY_USAGE_GPU_TO_CPU, serializedBuffer, &pMappedData);
+
+    VkCopyAccelerationStructureToMemoryInfoKHR copyInfo { VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_TO_MEMORY_INFO_KHR };
+    {
+        copyInfo.src               = accelerationStructure.handle;
+        copyInfo.dst.deviceAddress = GetDeviceAddress(pRenderContext, serializedBuffer);
+        copyInfo.mode              = VK_COPY_ACCELERATION_STRUCTURE_MODE_SERIALIZE_KHR;
+    }
+
+    SingleShotCommandBegin(pRenderContext, vkCommand, vkCommandPool);
+    {
+        vkCmdCopyAccelerationStructureToMemoryKHR(vkCommand, &copyInfo);
+
+        // Make the serialized blob visible to the host.
+        VulkanMemoryBarrier(vkCommand,
+                            VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                            VK_ACCESS_2_HOST_READ_BIT,
+                            VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+                            VK_PIPELINE_STAGE_2_HOST_BIT);
+    }
+    SingleShotCommandEnd(pRenderContext, vkCommand);
+
+    Check(vmaInvalidateAllocation(pRenderContext->GetAllocator(), serializedBuffer.bufferAllocation, 0U, VK_WHOLE_SIZE),
+          "Failed to invalidate acceleration structure serialization memory.");
+
+    // Write the entry (through a temporary file, so an interrupted write never leaves a truncated entry behind).
+    // ------------------------------------------------
+
+    const auto entryPath     = GetCacheEntryPath(pRenderContext, cacheDirectory, contentHash);
+    const auto entryPathTemp = std::filesystem::path(entryPath).concat(".tmp");
+
+    std::error_code errorCode;
+    std::filesystem::create_directories(cacheDirectory, errorCode);
+
+    bool written = false;
+    {
+        std::ofstream file(entryPathTemp, std::ios::binary);
+
+        if (file.is_open())
+        {
+            file.write(static_cast<const char*>(pMappedData), static_cast<std::streamsize>(serializedSize));
+            written = file.good();
+        }
+    }
+
+    vmaDestroyBuffer(pRenderContext->GetAllocator(), serializedBuffer.buffer, serializedBuffer.bufferAllocation);
+
+    if (written)
+        std::filesystem::rename(entryPathTemp, entryPath, errorCode);
+
+    if (!written || errorCode)
+    {
+        spdlog::warn("Failed to write acceleration structure cache entry {}.", entryPath.string());
+        std::filesystem::remove(entryPathTemp, errorCode);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,286 @@
+#include <Common.h>
+#include <BVH.h>
+
+// BVH Implementation
+// ------------------------------------------------------------
+
+AABB TransformAABB(const AABB& bounds, const glm::mat4& transform)
+{
+    AABB transformedBounds;
+
+    for (uint32_t cornerIndex = 0U; cornerIndex < 8U; cornerIndex++)
+    {
+        const glm::vec3 corner((cornerIndex & 1U) ? bounds.max.x : bounds.min.x,
+                               (cornerIndex & 2U) ? bounds.max.y : bounds.min.y,
+                               (cornerIndex & 4U) ? bounds.max.z : bounds.min.z);
+
+        transformedBounds.Grow(glm::vec3(transform * glm::vec4(corner, 1.0F)));
+    }
+
+    return transformedBounds;
+}
+
+void BuildBVH(const std::vector<AABB>& primitiveBounds, BVH& bvh, uint32_t maxLeafSize)
+{
+    const auto primitiveCount = static_cast<uint32_t>(primitiveBounds.size());
+
+    bvh.nodes.clear();
+    bvh.primitiveIndices.resize(primitiveCount);
+
+    if (primitiveCount == 0U)
+        return;
+
+    std::iota(bvh.primitiveIndices.begin(), bvh.primitiveIndices.end(), 0U);
+
+    std::vector<glm::vec3> centroids(primitiveCount);
+
+    for (uint32_t primitiveIndex = 0U; primitiveIndex < primitiveCount; primitiveIndex++)
+        centroids[primitiveIndex] = primitiveBounds[primitiveIndex].Centroid();
+
+    // A binary tree with N leaves has 2N - 1 nodes, reserving keeps indices stable and avoids reallocation.
+    bvh.nodes.reserve(2U * primitiveCount - 1U);
+    bvh.nodes.push_back({ {}, 0U, primitiveCount });
+
+    std::vector<uint32_t> nodeStack = { 0U };
+
+    while (!nodeStack.empty())
+    {
+        const uint32_t nodeIndex = nodeStack.back();
+        nodeStack.pop_back();
+
+        BVHNode& node = bvh.nodes[nodeIndex];
+
+        const uint32_t first = node.leftFirst;
+        const uint32_t count = node.primitiveCount;
+
+        AABB centroidBounds;
+
+        for (uint32_t i = first; i < first + count; i++)
+        {
+            node.bounds.Grow(primitiveBounds[bvh.primitiveIndices[i]]);
+            centroidBounds.Grow(centroids[bvh.primitiveIndices[i]]);
+        }
+
+        if (count <= 1U)
+            continue;
+
+        // Find the cheapest binned split along any axis.
+        // ------------------------------------------------
+
+        struct Bin
+        {
+            AABB     bounds;
+            uint32_t count = 0U;
+        };
+
+        float    bestCost  = FLT_MAX;
+        uint32_t bestAxis  = 0U;
+        uint32_t bestSplit = 0U;
+
+        const glm::vec3 centroidExtent = centroidBounds.max - centroidBounds.min;
+
+        for (uint32_t axis = 0U; axis < 3U; axis++)
+        {
+            if (centroidExtent[axis] <= 0.0F)
+                continue;
+
+            std::array<Bin, kBVHBinCount> bins {};
+
+            const float binScale = static_cast<float>(kBVHBinCount) / centroidExtent[axis];
+
+            for (uint32_t i = first; i < first + count; i++)
+            {
+                const uint32_t primitiveIndex = bvh.primitiveIndices[i];
+                const uint32_t binIndex =
+                    std::min(kBVHBinCount - 1U, static_cast<uint32_t>((centroids[primitiveIndex][axis] - centroidBounds.min[axis]) * binScale));
+
+                bins[binIndex].bounds.Grow(primitiveBounds[primitiveIndex]);
+                bins[binIndex].count++;
+            }
+
+            // Sweep from both sides to get the area and count left / right of every bin plane.
+            std::array<float, kBVHBinCount - 1U>    leftArea, rightArea;
+            std::array<uint32_t, kBVHBinCount - 1U> leftCount, rightCount;
+
+            AABB     leftBounds, rightBounds;
+            uint32_t leftSum = 0U, rightSum = 0U;
+
+            for (uint32_t plane = 0U; plane < kBVHBinCount - 1U; plane++)
+            {
+                leftBounds.Grow(bins[plane].bounds);
+                leftSum += bins[plane].count;
+                leftArea[plane]  = leftBounds.SurfaceArea();
+                leftCount[plane] = leftSum;
+
+                rightBounds.Grow(bins[kBVHBinCount - 1U - plane].bounds);
+                rightSum += bins[kBVHBinCount - 1U - plane].count;
+                rightArea[kBVHBinCount - 2U - plane]  = rightBounds.SurfaceArea();
+                rightCount[kBVHBinCount - 2U - plane] = rightSum;
+            }
+
+            for (uint32_t plane = 0U; plane < kBVHBinCount - 1U; plane++)
+            {
+                if (leftCount[plane] == 0U || rightCount[plane] == 0U)
+                    continue;
+
+                const float cost = static_cast<float>(leftCount[plane]) * leftArea[plane] + static_cast<float>(rightCount[plane]) * rightArea[plane];
+
+                if (cost < bestCost)
+                {
+                    bestCost  = cost;
+                    bestAxis  = axis;
+                    bestSplit = plane + 1U;
+                }
+            }
+        }
+
+        // All centroids coincide, nothing to split.
+        if (bestCost == FLT_MAX)
+            continue;
+
+        const float nodeArea  = node.bounds.SurfaceArea();
+        const float splitCost = kBVHTraversalCost + kBVHIntersectCost * bestCost / std::max(nodeArea, FLT_MIN);
+        const float leafCost  = kBVHIntersectCost * static_cast<float>(count);
+
+        if (count <= maxLeafSize && splitCost >= leafCost)
+            continue;
+
+        // Partition the primitives about the split plane.
+        // ------------------------------------------------
+
+        const float binScale = static_cast<float>(kBVHBinCount) / centroidExtent[bestAxis];
+
+        auto middle = std::partition(bvh.primitiveIndices.begin() + first,
+                                     bvh.primitiveIndices.begin() + first + count,
+                                     [&](uint32_t primitiveIndex)
+                                     {
+                                         const uint32_t binIndex = std::min(
+                                             kBVHBinCount - 1U,
+                                             static_cast<uint32_t>((centroids[primitiveIndex][bestAxis] - centroidBounds.min[bestAxis]) * binScale));
+
+                                         return binIndex < bestSplit;
+                                     });
+
+        const auto leftPrimitiveCount = static_cast<uint32_t>(std::distance(bvh.primitiveIndices.begin() + first, middle));
+
+        if (leftPrimitiveCount == 0U || leftPrimitiveCount == count)
+            continue;
+
+        const auto leftChildIndex = static_cast<uint32_t>(bvh.nodes.size());
+
+        node.leftFirst      = leftChildIndex;
+        node.primitiveCount = 0U;
+
+        // NOTE: Invalidates the node reference if the reservation was exceeded, which can't happen here.
+        bvh.nodes.push_back({ {}, first, leftPrimitiveCount });
+        bvh.nodes.push_back({ {}, first + leftPrimitiveCount, count - leftPrimitiveCount });
+
+        nodeStack.push_back(leftChildIndex);
+        nodeStack.push_back(leftChildIndex + 1U);
+    }
+}
+
+BVHStatistics ComputeBVHStatistics(const BVH& bvh)
+{
+    BVHStatistics statistics;
+
+    if (bvh.nodes.empty())
+        return statistics;
+
+    statistics.nodeCount = static_cast<uint32_t>(bvh.nodes.size());
+
+    const float rootArea = std::max(bvh.nodes[0].bounds.SurfaceArea(), FLT_MIN);
+
+    uint64_t depthSum         = 0U;
+    uint64_t leafPrimitiveSum = 0U;
+    uint32_t innerCount       = 0U;
+
+    std::vector<std::pair<uint32_t, uint32_t>> nodeStack = {
+        { 0U, 0U }
+    };
+
+    while (!nodeStack.empty())
+    {
+        const auto [nodeIndex, depth] = nodeStack.back();
+        nodeStack.pop_back();
+
+        const BVHNode& node     = bvh.nodes[nodeIndex];
+        const float    nodeArea = node.bounds.SurfaceArea();
+
+        statistics.maxDepth = std::max(statistics.maxDepth, depth);
+
+        if (node.IsLeaf())
+        {
+            statistics.leafCount++;
+            statistics.sahCost += kBVHIntersectCost * static_cast<float>(node.primitiveCount) * nodeArea / rootArea;
+
+            depthSum += depth;
+            leafPrimitiveSum += node.primitiveCount;
+
+            if (statistics.depthHistogram.size() <= depth)
+                statistics.depthHistogram.resize(depth + 1U, 0U);
+
+            if (statistics.leafSizeHistogram.size() <= node.primitiveCount)
+                statistics.leafSizeHistogram.resize(node.primitiveCount + 1U, 0U);
+
+            statistics.depthHistogram[depth]++;
+            statistics.leafSizeHistogram[node.primitiveCount]++;
+
+            continue;
+        }
+
+        innerCount++;
+
+        statistics.sahCost += kBVHTraversalCost * nodeArea / rootArea;
+
+        const float overlapArea = IntersectAABB(bvh.nodes[node.leftFirst].bounds, bvh.nodes[node.leftFirst + 1U].bounds).SurfaceArea();
+
+        statistics.siblingOverlap += overlapArea / rootArea;
+        statistics.averageSiblingOverlap += overlapArea / std::max(nodeArea, FLT_MIN);
+
+        nodeStack.push_back({ node.leftFirst, depth + 1U });
+        nodeStack.push_back({ node.leftFirst + 1U, depth + 1U });
+    }
+
+    statistics.averageDepth    = static_cast<float>(depthSum) / static_cast<float>(statistics.leafCount);
+    statistics.averageLeafSize = static_cast<float>(leafPrimitiveSum) / static_cast<float>(statistics.leafCount);
+
+    if (innerCount > 0U)
+        statistics.averageSiblingOverlap /= static_cast<float>(innerCount);
+
+    return statistics;
+}
+
+void QueryBVHOverlaps(const BVH& bvh, const std::vector<AABB>& primitiveBounds, const AABB& queryBounds, std::vector<uint32_t>& overlaps)
+{
+    overlaps.clear();
+
+    if (bvh.nodes.empty())
+        return;
+
+    std::vector<uint32_t> nodeStack = { 0U };
+
+    while (!nodeStack.empty())
+    {
+        const BVHNode& node = bvh.nodes[nodeStack.back()];
+        nodeStack.pop_back();
+
+        if (!IntersectAABB(node.bounds, queryBounds).IsValid())
+            continue;
+
+        if (!node.IsLeaf())
+        {
+            nodeStack.push_back(node.leftFirst);
+            nodeStack.push_back(node.leftFirst + 1U);
+            continue;
+        }
+
+        for (uint32_t i = node.leftFirst; i < node.leftFirst + node.primitiveCount; i++)
+        {
+            const uint32_t primitiveIndex = bvh.primitiveIndices[i];
+
+            if (IntersectAABB(primitiveBounds[primitiveIndex], queryBounds).IsValid())
+                overlaps.push_back(primitiveIndex);
+        }
+    }
+}
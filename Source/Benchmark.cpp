@@ -0,0 +1,331 @@
+#include <Common.h>
+#include <Profiler.h>
+#include <RenderContext.h>
+#include <Benchmark.h>
+
+// Launch Options Implementation
+// ------------------------------------------------------------
+
+bool ParseLaunchOptions(int argc, char** argv, LaunchOptions& options)
+{
+    for (int argIndex = 1; argIndex < argc; argIndex++)
+    {
+        const std::string arg = argv[argIndex];
+
+        if (arg == "--headless")
+        {
+            options.renderContext.headless = true;
+            continue;
+        }
+
+        if (arg == "--host-blas")
+        {
+            options.hostBLASBuilds = true;
+            continue;
+        }
+
+        if (arg == "--no-tonemap")
+        {
+            options.tonemap = false;
+            continue;
+        }
+
+        if (arg == "--denoise")
+        {
+            options.denoise = true;
+            continue;
+        }
+
+        if (arg == "--deform")
+        {
+            options.deform = true;
+            continue;
+        }
+
+        if (arg == "--no-cache")
+        {
+            options.cacheDirectory.clear();
+            continue;
+        }
+
+        if (arg == "--camera-path")
+        {
+            options.cameraPath = true;
+            continue;
+        }
+
+        if (arg == "--hot-reload")
+        {
+            options.shaderHotReload = true;
+            continue;
+        }
+
+        if (arg == "--multi-device")
+        {
+            options.multiDevice                  = true;
+            options.renderContext.headless       = true;
+            options.renderContext.sharedDispatch = true;
+            continue;
+        }
+
+        if (argIndex + 1 >= argc)
+        {
+            spdlog::error("Missing value for argument {}.", arg);
+            return false;
+        }
+
+        const char* value = argv[++argIndex];
+
+        auto ParseUInt = [&](uint32_t& target)
+        {
+            char*               pEnd   = nullptr;
+            const unsigned long parsed = std::strtoul(value, &pEnd, 10);
+
+            if (pEnd == value || *pEnd != '\0')
+                return false;
+
+            target = static_cast<uint32_t>(parsed);
+            return true;
+        };
+
+        bool parsed = true;
+
+        if (arg == "--width")
+            parsed = ParseUInt(options.renderContext.width);
+        else if (arg == "--height")
+            parsed = ParseUInt(options.renderContext.height);
+        else if (arg == "--frames")
+            parsed = ParseUInt(options.renderContext.frameCount);
+        else if (arg == "--warmup")
+            parsed = ParseUInt(options.warmupFrames);
+        else if (arg == "--instances")
+            parsed = ParseUInt(options.instanceCount);
+        else if (arg == "--subdivisions")
+            parsed = ParseUInt(options.meshSubdivisions);
+        else if (arg == "--spp")
+            parsed = ParseUInt(options.samplesPerPixel);
+        else if (arg == "--debug-view")
+            parsed = ParseUInt(options.debugView) && options.debugView <= 2U;
+        else if (arg == "--sparse-trace")
+            parsed = ParseUInt(options.sparseTrace) && options.sparseTrace <= 2U;
+        else if (arg == "--bounces")
+            parsed = ParseUInt(options.maxBounceCount);
+        else if (arg == "--camera-time")
+            options.cameraTime = std::strtof(value, nullptr);
+        else if (arg == "--capture")
+            options.capturePath = value;
+        else if (arg == "--results")
+            options.resultsPath = value;
+        else if (arg == "--trace")
+            options.tracePath = value;
+        else if (arg == "--cache-dir")
+            options.cacheDirectory = value;
+        else if (arg == "--device")
+            options.renderContext.device = value;
+        else
+        {
+            spdlog::error("Unknown argument {}.", arg);
+            return false;
+        }
+
+        if (!parsed)
+        {
+            spdlog::error("Invalid value {} for argument {}.", value, arg);
+            return false;
+        }
+    }
+
+    if (options.renderContext.width == 0U || options.renderContext.height == 0U || options.samplesPerPixel == 0U)
+    {
+        spdlog::error("Resolution and samples per pixel must be non-zero.");
+        return false;
+    }
+
+    // Every capable device takes part, the best scoring one is the primary context.
+    if (options.multiDevice && !options.renderContext.device.empty())
+    {
+        spdlog::warn("--device is ignored for multi-device renders.");
+        options.renderContext.device.clear();
+    }
+
+    // A headless run without a frame count would never return.
+    if (options.renderContext.headless && options.renderContext.frameCount == 0U)
+        options.renderContext.frameCount = options.warmupFrames + 256U;
+
+    return true;
+}
+
+// Benchmark Recorder Implementation
+// ------------------------------------------------------------
+
+void BenchmarkRecorder::RecordTiming(const std::string& name, double milliseconds)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    m_Timings.emplace_back(name, milliseconds);
+}
+
+void BenchmarkRecorder::RecordFrame(double cpuMilliseconds, const std::map<std::string, double>& gpuScopeMilliseconds)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    m_FrameMilliseconds.push_back(cpuMilliseconds);
+
+    for (const auto& [scopeName, scopeMilliseconds] : gpuScopeMilliseconds)
+        m_GPUScopeMilliseconds[scopeName].push_back(scopeMilliseconds);
+}
+
+void BenchmarkRecorder::RecordMemory(uint64_t allocatedBytes, uint64_t reservedBytes)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    m_AllocatedBytes = allocatedBytes;
+    m_ReservedBytes  = reservedBytes;
+}
+
+void BenchmarkRecorder::RecordDevice(const std::string& deviceName)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    m_DeviceName = deviceName;
+}
+
+void BenchmarkRecorder::RecordCounter(const std::string& name, uint64_t value)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    m_Counters.emplace_back(name, value);
+}
+
+// Startup Phase Implementation
+// ------------------------------------------------------------
+
+StartupPhase::StartupPhase(BenchmarkRecorder& recorder, const std::string& phaseName) : m_Recorder(recorder)
+{
+    Next(phaseName);
+}
+
+StartupPhase::~StartupPhase()
+{
+    End();
+}
+
+void StartupPhase::Next(const std::string& phaseName)
+{
+    End();
+
+    m_Name      = phaseName;
+    m_TimeBegin = std::chrono::high_resolution_clock::now();
+    m_Open      = true;
+
+    PROFILE_START(m_Name.c_str());
+}
+
+void StartupPhase::End()
+{
+    if (!m_Open)
+        return;
+
+    PROFILE_END;
+
+    m_Recorder.RecordTiming(m_Name, MillisecondsSince(m_TimeBegin));
+    m_Open = false;
+}
+
+// Summary statistics of a sample set, written as a JSON object.
+std::string FormatDistribution(std::vector<double> samples)
+{
+    if (samples.empty())
+        return "{ \"count\": 0 }";
+
+    std::sort(samples.begin(), samples.end());
+
+    // Nearest-rank percentile.
+    auto Percentile = [&](double percentile)
+    {
+        const auto rank = static_cast<size_t>(std::ceil(percentile / 100.0 * static_cast<double>(samples.size())));
+        return samples[std::clamp<size_t>(rank, 1U, samples.size()) - 1U];
+    };
+
+    const double mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+
+    return std::format("{{ \"count\": {}, \"mean\": {:.4f}, \"min\": {:.4f}, \"p50\": {:.4f}, \"p90\": {:.4f}, \"p99\": {:.4f}, \"max\": {:.4f} }}",
+                       samples.size(),
+                       mean,
+                       samples.front(),
+                       Percentile(50.0),
+                       Percentile(90.0),
+                       Percentile(99.0),
+                       samples.back());
+}
+
+bool BenchmarkRecorder::WriteJSON(const char* filePath, const LaunchOptions& options) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    std::ofstream file(filePath);
+
+    if (!file.is_open())
+    {
+        spdlog::error("Failed to open {} for writing.", filePath);
+        return false;
+    }
+
+    file << "{\n";
+
+    file << "  \"config\": {\n";
+    file << std::format("    \"device\": \"{}\",\n", EscapeJSON(m_DeviceName));
+    file << std::format("    \"width\": {},\n", options.renderContext.width);
+    file << std::format("    \"height\": {},\n", options.renderContext.height);
+    file << std::format("    \"instances\": {},\n", options.instanceCount);
+    file << std::format("    \"subdivisions\": {},\n", options.meshSubdivisions);
+    file << std::format("    \"spp\": {},\n", options.samplesPerPixel);
+    file << std::format("    \"bounces\": {},\n", options.maxBounceCount);
+    file << std::format("    \"denoise\": {},\n", options.denoise);
+    file << std::format("    \"sparseTrace\": {},\n", options.sparseTrace);
+    file << std::format("    \"deform\": {},\n", options.deform);
+    file << std::format("    \"hostBLASBuilds\": {},\n", options.hostBLASBuilds);
+    file << std::format("    \"multiDevice\": {},\n", options.multiDevice);
+    file << std::format("    \"frames\": {},\n", options.renderContext.frameCount);
+    file << std::format("    \"warmupFrames\": {}\n", options.warmupFrames);
+    file << "  },\n";
+
+    file << "  \"timingsMs\": {";
+    for (size_t timingIndex = 0U; timingIndex < m_Timings.size(); timingIndex++)
+    {
+        file << std::format(
+            "{}\n    \"{}\": {:.4f}", timingIndex > 0U ? "," : "", EscapeJSON(m_Timings[timingIndex].first), m_Timings[timingIndex].second);
+    }
+    file << "\n  },\n";
+
+    file << std::format("  \"frameTimeMs\": {},\n", FormatDistribution(m_FrameMilliseconds));
+
+    file << "  \"gpuScopesMs\": {";
+    for (auto scopeIt = m_GPUScopeMilliseconds.begin(); scopeIt != m_GPUScopeMilliseconds.end(); ++scopeIt)
+    {
+        file << std::format("{}\n    \"{}\": {}",
+                            scopeIt != m_GPUScopeMilliseconds.begin() ? "," : "",
+                            EscapeJSON(scopeIt->first),
+                            FormatDistribution(scopeIt->second));
+    }
+    file << "\n  },\n";
+
+    file << "  \"memory\": {\n";
+    file << std::format("    \"allocatedBytes\": {},\n", m_AllocatedBytes);
+    file << std::format("    \"reservedBytes\": {}\n", m_ReservedBytes);
+    file << "  },\n";
+
+    file << "  \"counters\": {";
+    for (size_t counterIndex = 0U; counterIndex < m_Counters.size(); counterIndex++)
+    {
+        file << std::format(
+            "{}\n    \"{}\": {}", counterIndex > 0U ? "," : "", EscapeJSON(m_Counters[counterIndex].first), m_Counters[counterIndex].second);
+    }
+    file << "\n  }\n";
+
+    file << "}\n";
+
+    spdlog::info("Wrote benchmark results to {}.", filePath);
+
+    return true;
+}
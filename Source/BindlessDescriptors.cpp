@@ -0,0 +1,190 @@
+#include <Common.h>
+#include <RenderContext.h>
+#include <BindlessDescriptors.h>
+
+// Bindless Descriptors Implementation
+// ------------------------------------------------------------
+
+const uint32_t kBindingGeometryTable = 0U;
+const uint32_t kBindingMaterialTable = 1U;
+const uint32_t kBindingSampler       = 2U;
+const uint32_t kBindingTextures      = 3U;
+const uint32_t kBindingBuffers       = 4U;
+
+void BindlessDescriptors::Create(RenderContext* pRenderContext)
+{
+    // Indexing features are enabled at device creation whenever they are supported.
+    // ------------------------------------------------
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+
+    VkPhysicalDeviceFeatures2 deviceFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+    {
+        deviceFeatures.pNext = &vulkan12Features;
+    }
+    vkGetPhysicalDeviceFeatures2(pRenderContext->GetDevicePhysical(), &deviceFeatures);
+
+    Check(vulkan12Features.runtimeDescriptorArray == VK_TRUE && vulkan12Features.descriptorBindingPartiallyBound == VK_TRUE &&
+              vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind == VK_TRUE &&
+              vulkan12Features.descriptorBindingSampledImageUpdateAfterBind == VK_TRUE &&
+              vulkan12Features.shaderStorageBufferArrayNonUniformIndexing == VK_TRUE &&
+              vulkan12Features.shaderSampledImageArrayNonUniformIndexing == VK_TRUE,
+          "The device does not support the descriptor indexing features of the bindless set.");
+
+    // Layout, the sampler is immutable so it never needs a write.
+    // ------------------------------------------------
+
+    VkSamplerCreateInfo samplerInfo = { VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO };
+    {
+        samplerInfo.magFilter    = VK_FILTER_LINEAR;
+        samplerInfo.minFilter    = VK_FILTER_LINEAR;
+        samplerInfo.mipmapMode   = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInfo.maxLod       = VK_LOD_CLAMP_NONE;
+    }
+    Check(vkCreateSampler(pRenderContext->GetDevice(), &samplerInfo, nullptr, &m_Sampler), "Failed to create the bindless sampler.");
+
+    const VkShaderStageFlags stageFlags = VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT;
+
+    const VkDescriptorBindingFlags bindlessFlags = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+
+    std::array<VkDescriptorSetLayoutBinding, 5> bindingInfos = {
+        { { kBindingGeometryTable, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1U, stageFlags, nullptr },
+         { kBindingMaterialTable, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1U, stageFlags, nullptr },
+         { kBindingSampler, VK_DESCRIPTOR_TYPE_SAMPLER, 1U, stageFlags, &m_Sampler },
+         { kBindingTextures, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, kMaxBindlessTextures, stageFlags, nullptr },
+         { kBindingBuffers, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, kMaxBindlessBuffers, stageFlags, nullptr } }
+    };
+
+    std::array<VkDescriptorBindingFlags, 5> bindingFlags = { bindlessFlags, bindlessFlags, 0x0, bindlessFlags, bindlessFlags };
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO };
+    {
+        bindingFlagsInfo.bindingCount  = (uint32_t)bindingFlags.size();
+        bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+    }
+
+    VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+    {
+        descriptorSetLayoutInfo.pNext        = &bindingFlagsInfo;
+        descriptorSetLayoutInfo.flags        = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+        descriptorSetLayoutInfo.bindingCount = (uint32_t)bindingInfos.size();
+        descriptorSetLayoutInfo.pBindings    = bindingInfos.data();
+    }
+    Check(vkCreateDescriptorSetLayout(pRenderContext->GetDevice(), &descriptorSetLayoutInfo, nullptr, &m_Layout),
+          "Failed to create the bindless descriptor set layout.");
+
+    // Pool + set.
+    // ------------------------------------------------
+
+    std::array<VkDescriptorPoolSize, 3> descriptorPoolSizes = {
+        { { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2U + kMaxBindlessBuffers },
+         { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, kMaxBindlessTextures },
+         { VK_DESCRIPTOR_TYPE_SAMPLER, 1U } }
+    };
+
+    VkDescriptorPoolCreateInfo descriptorPoolInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+    {
+        descriptorPoolInfo.poolSizeCount = (uint32_t)descriptorPoolSizes.size();
+        descriptorPoolInfo.pPoolSizes    = descriptorPoolSizes.data();
+        descriptorPoolInfo.maxSets       = 1U;
+        descriptorPoolInfo.flags         = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    }
+    Check(vkCreateDescriptorPool(pRenderContext->GetDevice(), &descriptorPoolInfo, nullptr, &m_Pool),
+          "Failed to create the bindless descriptor pool.");
+
+    VkDescriptorSetAllocateInfo descriptorSetAllocInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    {
+        descriptorSetAllocInfo.descriptorPool     = m_Pool;
+        descriptorSetAllocInfo.descriptorSetCount = 1U;
+        descriptorSetAllocInfo.pSetLayouts        = &m_Layout;
+    }
+    Check(vkAllocateDescriptorSets(pRenderContext->GetDevice(), &descriptorSetAllocInfo, &m_Set), "Failed to allocate the bindless descriptor set.");
+
+    NameVulkanObject(pRenderContext->GetDevice(), VK_OBJECT_TYPE_DESCRIPTOR_SET, (uint64_t)m_Set, "Bindless Descriptors");
+}
+
+void BindlessDescriptors::Release(RenderContext* pRenderContext)
+{
+    vkDestroyDescriptorPool(pRenderContext->GetDevice(), m_Pool, nullptr);
+    vkDestroyDescriptorSetLayout(pRenderContext->GetDevice(), m_Layout, nullptr);
+    vkDestroySampler(pRenderContext->GetDevice(), m_Sampler, nullptr);
+
+    m_Pool    = VK_NULL_HANDLE;
+    m_Layout  = VK_NULL_HANDLE;
+    m_Set     = VK_NULL_HANDLE;
+    m_Sampler = VK_NULL_HANDLE;
+
+    m_BufferCount  = 0U;
+    m_TextureCount = 0U;
+}
+
+void BindlessDescriptors::Write(RenderContext* pRenderContext, VkWriteDescriptorSet& vkDescriptorWrite)
+{
+    vkDescriptorWrite.dstSet = m_Set;
+
+    vkUpdateDescriptorSets(pRenderContext->GetDevice(), 1U, &vkDescriptorWrite, 0U, nullptr);
+}
+
+BindlessDescriptors::ResourceIndex BindlessDescriptors::RegisterBuffer(RenderContext* pRenderContext, const Buffer& buffer)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    Check(m_BufferCount < kMaxBindlessBuffers, "Out of bindless buffer slots.");
+
+    VkDescriptorBufferInfo descriptorBufferInfo = { buffer.buffer, 0U, VK_WHOLE_SIZE };
+
+    VkWriteDescriptorSet descriptorWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+    {
+        descriptorWrite.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrite.descriptorCount = 1U;
+        descriptorWrite.dstBinding      = kBindingBuffers;
+        descriptorWrite.dstArrayElement = m_BufferCount;
+        descriptorWrite.pBufferInfo     = &descriptorBufferInfo;
+    }
+    Write(pRenderContext, descriptorWrite);
+
+    return m_BufferCount++;
+}
+
+BindlessDescriptors::ResourceIndex BindlessDescriptors::RegisterTexture(RenderContext* pRenderContext, VkImageView vkImageView)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    Check(m_TextureCount < kMaxBindlessTextures, "Out of bindless texture slots.");
+
+    VkDescriptorImageInfo descriptorImageInfo = { VK_NULL_HANDLE, vkImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+
+    VkWriteDescriptorSet descriptorWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+    {
+        descriptorWrite.descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        descriptorWrite.descriptorCount = 1U;
+        descriptorWrite.dstBinding      = kBindingTextures;
+        descriptorWrite.dstArrayElement = m_TextureCount;
+        descriptorWrite.pImageInfo      = &descriptorImageInfo;
+    }
+    Write(pRenderContext, descriptorWrite);
+
+    return m_TextureCount++;
+}
+
+void BindlessDescriptors::SetTables(RenderContext* pRenderContext, const Buffer& geometryTable, const Buffer& materialTable)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    std::array<VkDescriptorBufferInfo, 2> descriptorBufferInfos = {
+        { { geometryTable.buffer, 0U, VK_WHOLE_SIZE }, { materialTable.buffer, 0U, VK_WHOLE_SIZE } }
+    };
+
+    // The two table bindings are consecutive, so one write fills both.
+    VkWriteDescriptorSet descriptorWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+    {
+        descriptorWrite.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrite.descriptorCount = (uint32_t)descriptorBufferInfos.size();
+        descriptorWrite.dstBinding      = kBindingGeometryTable;
+        descriptorWrite.pBufferInfo     = descriptorBufferInfos.data();
+    }
+    Write(pRenderContext, descriptorWrite);
+}
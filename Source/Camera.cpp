@@ -0,0 +1,155 @@
+#include <Common.h>
+#include <Scene.h>
+#include <Camera.h>
+
+// Camera Implementation
+// ------------------------------------------------------------
+
+// Up vector of the view (as in ComputeOrbitCamera), the trace writes rows top to bottom so world up ends up on top.
+const glm::vec3 kCameraViewUp(0.0F, -1.0F, 0.0F);
+const glm::vec3 kCameraWorldUp(0.0F, 1.0F, 0.0F);
+
+static glm::vec3 ComputeCameraForward(float yaw, float pitch)
+{
+    return { std::cos(pitch) * std::sin(yaw), -std::sin(pitch), std::cos(pitch) * std::cos(yaw) };
+}
+
+void Camera::Initialize(uint32_t renderWidth, uint32_t renderHeight)
+{
+    m_RenderWidth  = renderWidth;
+    m_RenderHeight = renderHeight;
+    m_Mode         = CameraMode::Orbit;
+    m_Time         = 0.0F;
+
+    Update(nullptr, 0.0);
+}
+
+void Camera::SetScriptedPath(float startTime, float timeStep)
+{
+    m_Mode             = CameraMode::Scripted;
+    m_Time             = startTime - timeStep; // The next update lands on the start time.
+    m_ScriptedTimeStep = timeStep;
+
+    Update(nullptr, 0.0);
+}
+
+void Camera::SetMode(CameraMode mode)
+{
+    if (mode == CameraMode::Free && m_Mode != CameraMode::Free)
+    {
+        const CameraState& state   = GetState();
+        const glm::vec3    forward = -glm::vec3(glm::row(state.matrixV, 2));
+
+        m_Position = state.position;
+        m_Yaw      = std::atan2(forward.x, forward.z);
+        m_Pitch    = std::clamp(std::asin(-forward.y), -kCameraMaxPitch, kCameraMaxPitch);
+    }
+
+    m_Mode = mode;
+}
+
+void Camera::UpdateFree(GLFWwindow* pWindow, float deltaTime)
+{
+    if (pWindow == nullptr || ImGui::GetCurrentContext() == nullptr)
+        return;
+
+    const ImGuiIO& io = ImGui::GetIO();
+
+    // Look
+    // ------------------------------------------------
+
+    double cursorX, cursorY;
+    glfwGetCursorPos(pWindow, &cursorX, &cursorY);
+
+    const glm::vec2 cursor(static_cast<float>(cursorX), static_cast<float>(cursorY));
+
+    const bool lookActive = glfwGetMouseButton(pWindow, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS && !io.WantCaptureMouse;
+
+    // Only movement within one press counts, so the view doesn't jump when the button goes down.
+    if (lookActive && m_LookActive)
+    {
+        const glm::vec2 cursorDelta = cursor - m_LastCursor;
+
+        m_Yaw   += cursorDelta.x * kCameraLookSensitivity;
+        m_Pitch  = std::clamp(m_Pitch + cursorDelta.y * kCameraLookSensitivity, -kCameraMaxPitch, kCameraMaxPitch);
+    }
+
+    m_LookActive = lookActive;
+    m_LastCursor = cursor;
+
+    // Move
+    // ------------------------------------------------
+
+    if (io.WantCaptureKeyboard)
+        return;
+
+    auto KeyAxis = [&](int positiveKey, int negativeKey)
+    {
+        return (glfwGetKey(pWindow, positiveKey) == GLFW_PRESS ? 1.0F : 0.0F) - (glfwGetKey(pWindow, negativeKey) == GLFW_PRESS ? 1.0F : 0.0F);
+    };
+
+    const glm::vec3 forward = ComputeCameraForward(m_Yaw, m_Pitch);
+    const glm::vec3 right   = glm::normalize(glm::cross(forward, kCameraViewUp));
+
+    const float speedScale = glfwGetKey(pWindow, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS ? 4.0F : 1.0F;
+
+    const glm::vec3 moveDirection =
+        forward * KeyAxis(GLFW_KEY_W, GLFW_KEY_S) + right * KeyAxis(GLFW_KEY_D, GLFW_KEY_A) + kCameraWorldUp * KeyAxis(GLFW_KEY_E, GLFW_KEY_Q);
+
+    m_Position += moveDirection * (kCameraMoveSpeed * speedScale * deltaTime);
+}
+
+void Camera::Update(GLFWwindow* pWindow, double deltaTime)
+{
+    const float aspectRatio = m_RenderWidth / (float)m_RenderHeight;
+
+    glm::mat4 matrixV, matrixP;
+
+    switch (m_Mode)
+    {
+        case CameraMode::Orbit   : m_Time += static_cast<float>(deltaTime); break;
+        case CameraMode::Scripted: m_Time += m_ScriptedTimeStep; break;
+        case CameraMode::Free    : UpdateFree(pWindow, static_cast<float>(deltaTime)); break;
+    }
+
+    if (m_Mode == CameraMode::Free)
+    {
+        matrixV = glm::lookAt(m_Position, m_Position + ComputeCameraForward(m_Yaw, m_Pitch), kCameraViewUp);
+        matrixP = glm::perspective(glm::radians(kCameraFieldOfView), aspectRatio, kCameraNearPlane, kCameraFarPlane);
+    }
+    else
+        ComputeOrbitCamera(m_Time, aspectRatio, matrixV, matrixP);
+
+    Publish(matrixV, matrixP);
+}
+
+void Camera::Publish(const glm::mat4& matrixV, const glm::mat4& matrixP)
+{
+    const uint32_t backState = 1U - m_FrontState.load(std::memory_order_relaxed);
+
+    CameraState& state = m_States[backState];
+    {
+        state.matrixV  = matrixV;
+        state.matrixP  = matrixP;
+        state.matrixVP = matrixP * matrixV;
+    }
+
+    // The view is rigid, its rotation rows are the camera axes (right, up, backwards) and its inverse is the transpose.
+    const glm::vec3 right(glm::row(matrixV, 0));
+    const glm::vec3 up(glm::row(matrixV, 1));
+    const glm::vec3 forward = -glm::vec3(glm::row(matrixV, 2));
+
+    state.position = -(right * matrixV[3].x + up * matrixV[3].y - forward * matrixV[3].z);
+
+    // Spans the same [-1, 1] NDC range across the image as the inverse projection did.
+    const float tanHalfFieldOfView = std::tan(0.5F * glm::radians(kCameraFieldOfView));
+
+    const glm::vec3 halfWidth  = right * (tanHalfFieldOfView * m_RenderWidth / (float)m_RenderHeight);
+    const glm::vec3 halfHeight = up * tanHalfFieldOfView;
+
+    state.rayCorner      = forward - halfWidth - halfHeight;
+    state.rayPixelDeltaX = 2.0F * halfWidth / (float)m_RenderWidth;
+    state.rayPixelDeltaY = 2.0F * halfHeight / (float)m_RenderHeight;
+
+    m_FrontState.store(backState, std::memory_order_release);
+}
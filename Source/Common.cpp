@@ -1,83 +1,154 @@
 #include <Common.h>
+#include <Profiler.h>
 #include <RenderContext.h>
 
 // Utilities Implementation
 // ------------------------------------------------------------
 
-bool CreateRenderingAttachments(RenderContext* pRenderContext, Image& colorAttachment, Image& depthAttachment)
+static void CreateAttachmentImage(RenderContext*     pRenderContext,
+                                  Image&             attachment,
+                                  VkFormat           imageFormat,
+                                  VkImageUsageFlags  imageUsageFlags,
+                                  VkImageAspectFlags imageAspect)
 {
-    auto CreateAttachment = [&](Image& attachment, VkFormat imageFormat, VkImageUsageFlags imageUsageFlags, VkImageAspectFlags imageAspect)
+    VkImageCreateInfo imageInfo = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
     {
-        VkImageCreateInfo imageInfo = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
-        {
-            imageInfo.imageType     = VK_IMAGE_TYPE_2D;
-            imageInfo.arrayLayers   = 1U;
-            imageInfo.format        = imageFormat;
-            imageInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
-            imageInfo.usage         = imageUsageFlags;
-            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            imageInfo.extent        = { kWindowWidth, kWindowHeight, 1 };
-            imageInfo.mipLevels     = 1U;
-            imageInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
-            imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
-            imageInfo.flags         = 0x0;
-        }
+        imageInfo.imageType     = VK_IMAGE_TYPE_2D;
+        imageInfo.arrayLayers   = 1U;
+        imageInfo.format        = imageFormat;
+        imageInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.usage         = imageUsageFlags;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.extent        = { pRenderContext->GetRenderWidth(), pRenderContext->GetRenderHeight(), 1 };
+        imageInfo.mipLevels     = 1U;
+        imageInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.flags         = 0x0;
+    }
 
-        VmaAllocationCreateInfo imageAllocInfo = {};
-        {
-            imageAllocInfo.usage = VMA_MEMORY_USAGE_AUTO;
-        }
+    VmaAllocationCreateInfo imageAllocInfo = {};
+    {
+        imageAllocInfo.usage = VMA_MEMORY_USAGE_AUTO;
+    }
 
-        Check(vmaCreateImage(pRenderContext->GetAllocator(),
-                             &imageInfo,
-                             &imageAllocInfo,
-                             &attachment.image,
-                             &attachment.imageAllocation,
-                             VK_NULL_HANDLE),
-              "Failed to create attachment allocation.");
+    Check(vmaCreateImage(pRenderContext->GetAllocator(),
+                         &imageInfo,
+                         &imageAllocInfo,
+                         &attachment.image,
+                         &attachment.imageAllocation,
+                         VK_NULL_HANDLE),
+          "Failed to create attachment allocation.");
 
-        VkImageViewCreateInfo imageViewInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
-        {
-            imageViewInfo.image                           = attachment.image;
-            imageViewInfo.viewType                        = VK_IMAGE_VIEW_TYPE_2D;
-            imageViewInfo.format                          = imageFormat;
-            imageViewInfo.subresourceRange.levelCount     = 1U;
-            imageViewInfo.subresourceRange.layerCount     = 1U;
-            imageViewInfo.subresourceRange.baseMipLevel   = 0U;
-            imageViewInfo.subresourceRange.baseArrayLayer = 0U;
-            imageViewInfo.subresourceRange.aspectMask     = imageAspect;
-        }
-        Check(vkCreateImageView(pRenderContext->GetDevice(), &imageViewInfo, nullptr, &attachment.imageView), "Failed to create attachment view.");
-    };
+    VkImageViewCreateInfo imageViewInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+    {
+        imageViewInfo.image                           = attachment.image;
+        imageViewInfo.viewType                        = VK_IMAGE_VIEW_TYPE_2D;
+        imageViewInfo.format                          = imageFormat;
+        imageViewInfo.subresourceRange.levelCount     = 1U;
+        imageViewInfo.subresourceRange.layerCount     = 1U;
+        imageViewInfo.subresourceRange.baseMipLevel   = 0U;
+        imageViewInfo.subresourceRange.baseArrayLayer = 0U;
+        imageViewInfo.subresourceRange.aspectMask     = imageAspect;
+    }
+    Check(vkCreateImageView(pRenderContext->GetDevice(), &imageViewInfo, nullptr, &attachment.imageView), "Failed to create attachment view.");
+}
 
-    CreateAttachment(colorAttachment,
-                     VK_FORMAT_R8G8B8A8_UNORM,
-                     VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT,
-                     VK_IMAGE_ASPECT_COLOR_BIT);
-    CreateAttachment(depthAttachment, VK_FORMAT_D32_SFLOAT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT);
+bool CreateStorageImage(RenderContext* pRenderContext, Image& storageImage, VkFormat imageFormat, const char* labelName, VkCommandPool vkCommandPool)
+{
+    CreateAttachmentImage(pRenderContext, storageImage, imageFormat, VK_IMAGE_USAGE_STORAGE_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
 
-    DebugLabelImageResource(pRenderContext, colorAttachment, "Color Attachment");
-    DebugLabelImageResource(pRenderContext, depthAttachment, "Depth Attachment");
+    DebugLabelImageResource(pRenderContext, storageImage, labelName);
 
-    // Transition the color resource
+    // Storage images stay in the general layout for their whole lifetime.
 
     VkCommandBuffer cmd = VK_NULL_HANDLE;
-    SingleShotCommandBegin(pRenderContext, cmd);
+    SingleShotCommandBegin(pRenderContext, cmd, vkCommandPool);
 
     VulkanColorImageBarrier(cmd,
-                            colorAttachment.image,
+                            storageImage.image,
                             VK_IMAGE_LAYOUT_UNDEFINED,
-                            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                            VK_IMAGE_LAYOUT_GENERAL,
                             VK_ACCESS_2_NONE,
-                            VK_ACCESS_2_TRANSFER_READ_BIT,
+                            VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
                             VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
-                            VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+                            VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
 
     SingleShotCommandEnd(pRenderContext, cmd);
 
     return true;
 }
 
+VkDescriptorSetLayout CreateStorageImageSetLayout(RenderContext* pRenderContext, uint32_t bindingCount)
+{
+    std::vector<VkDescriptorSetLayoutBinding> bindingInfos(bindingCount);
+
+    for (uint32_t bindingIndex = 0U; bindingIndex < bindingCount; bindingIndex++)
+        bindingInfos[bindingIndex] = { bindingIndex, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1U, VK_SHADER_STAGE_COMPUTE_BIT, nullptr };
+
+    VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+    {
+        descriptorSetLayoutInfo.bindingCount = bindingCount;
+        descriptorSetLayoutInfo.pBindings    = bindingInfos.data();
+    }
+
+    VkDescriptorSetLayout vkDescriptorSetLayout = VK_NULL_HANDLE;
+    Check(vkCreateDescriptorSetLayout(pRenderContext->GetDevice(), &descriptorSetLayoutInfo, nullptr, &vkDescriptorSetLayout),
+          "Failed to create a storage image descriptor set layout.");
+
+    return vkDescriptorSetLayout;
+}
+
+VkPipelineLayout CreateComputePipelineLayout(RenderContext* pRenderContext, VkDescriptorSetLayout vkDescriptorSetLayout, uint32_t constantsSize)
+{
+    const VkPushConstantRange pushConstantRange = { VK_SHADER_STAGE_COMPUTE_BIT, 0U, constantsSize };
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+    {
+        pipelineLayoutInfo.setLayoutCount         = 1U;
+        pipelineLayoutInfo.pSetLayouts            = &vkDescriptorSetLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1U;
+        pipelineLayoutInfo.pPushConstantRanges    = &pushConstantRange;
+    }
+
+    VkPipelineLayout vkPipelineLayout = VK_NULL_HANDLE;
+    Check(vkCreatePipelineLayout(pRenderContext->GetDevice(), &pipelineLayoutInfo, nullptr, &vkPipelineLayout),
+          "Failed to create a compute pipeline layout.");
+
+    return vkPipelineLayout;
+}
+
+VkPipeline CreateComputePipeline(RenderContext* pRenderContext, const char* shaderPath, VkPipelineLayout vkPipelineLayout)
+{
+    std::vector<char> byteCode;
+    Check(LoadByteCode(shaderPath, byteCode), "Failed to load the compute shader byte code.");
+
+    VkShaderModuleCreateInfo shaderModuleInfo = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
+    {
+        shaderModuleInfo.pCode    = reinterpret_cast<uint32_t*>(byteCode.data());
+        shaderModuleInfo.codeSize = byteCode.size();
+    }
+
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+    Check(vkCreateShaderModule(pRenderContext->GetDevice(), &shaderModuleInfo, nullptr, &shaderModule), "Failed to create a compute shader.");
+
+    VkComputePipelineCreateInfo computePipelineInfo = { VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+    {
+        computePipelineInfo.stage.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        computePipelineInfo.stage.stage  = VK_SHADER_STAGE_COMPUTE_BIT;
+        computePipelineInfo.stage.module = shaderModule;
+        computePipelineInfo.stage.pName  = "Main";
+        computePipelineInfo.layout       = vkPipelineLayout;
+    }
+
+    VkPipeline vkPipeline = VK_NULL_HANDLE;
+    Check(vkCreateComputePipelines(pRenderContext->GetDevice(), VK_NULL_HANDLE, 1U, &computePipelineInfo, nullptr, &vkPipeline),
+          "Failed to create a compute pipeline.");
+
+    vkDestroyShaderModule(pRenderContext->GetDevice(), shaderModule, nullptr);
+
+    return vkPipeline;
+}
+
 bool CreatePhysicallyBasedMaterialDescriptorLayout(const VkDevice& vkLogicalDevice, VkDescriptorSetLayout& vkDescriptorSetLayout)
 {
     std::array<VkDescriptorSetLayoutBinding, 5U> vkDescriptorSetLayoutBindings = {
@@ -109,7 +180,119 @@ bool CreatePhysicallyBasedMaterialDescriptorLayout(const VkDevice& vkLogicalDevi
     return vkCreateDescriptorSetLayout(vkLogicalDevice, &vkDescriptorSetLayoutInfo, nullptr, &vkDescriptorSetLayout) == VK_SUCCESS;
 }
 
-bool SelectVulkanPhysicalDevice(const VkInstance& vkInstance, const std::vector<const char*>& requiredExtensions, VkPhysicalDevice& vkPhysicalDevice)
+static bool HasVulkanExtension(const std::vector<VkExtensionProperties>& extensions, const char* extensionName)
+{
+    return std::any_of(extensions.begin(),
+                       extensions.end(),
+                       [&](const VkExtensionProperties& extension) { return strcmp(extension.extensionName, extensionName) == 0; }); // NOLINT
+}
+
+static const char* GetPhysicalDeviceTypeName(VkPhysicalDeviceType deviceType)
+{
+    switch (deviceType)
+    {
+        case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU  : return "Discrete";
+        case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: return "Integrated";
+        case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU   : return "Virtual";
+        case VK_PHYSICAL_DEVICE_TYPE_CPU           : return "CPU";
+        default                                    : return "Other";
+    }
+}
+
+// Lowercase hex without separators, the form --device UUIDs are compared in.
+static std::string FormatDeviceUUID(const uint8_t* pUUID)
+{
+    std::string uuid;
+
+    for (uint32_t byteIndex = 0U; byteIndex < VK_UUID_SIZE; byteIndex++)
+        uuid += std::format("{:02x}", pUUID[byteIndex]); // NOLINT
+
+    return uuid;
+}
+
+// Zero rejects the device (with the reason). Otherwise the device type dominates, then the device local memory, then
+// the number of optional extensions, so a discrete GPU beats an integrated one beats a CPU implementation.
+static uint64_t ScoreVulkanPhysicalDevice(const VkInstance&               vkInstance,
+                                          const VkPhysicalDevice&         vkPhysicalDevice,
+                                          const VulkanDeviceRequirements& requirements,
+                                          std::string&                    rejectReason)
+{
+    uint32_t extensionCount = 0U;
+    vkEnumerateDeviceExtensionProperties(vkPhysicalDevice, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(vkPhysicalDevice, nullptr, &extensionCount, extensions.data());
+
+    for (const auto& requiredExtension : requirements.requiredExtensions)
+    {
+        if (!HasVulkanExtension(extensions, requiredExtension))
+        {
+            rejectReason = std::format("missing {}", requiredExtension);
+            return 0U;
+        }
+    }
+
+    uint32_t queueIndex = UINT_MAX;
+    if (!GetVulkanQueueIndices(vkInstance, vkPhysicalDevice, requirements.presentation, queueIndex))
+    {
+        rejectReason = requirements.presentation ? "no graphics + compute queue family that can present" : "no graphics + compute queue family";
+        return 0U;
+    }
+
+    VkPhysicalDeviceRayTracingPipelinePropertiesKHR rayTracingProperties = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_PROPERTIES_KHR };
+
+    VkPhysicalDeviceProperties2 deviceProperties = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
+    {
+        deviceProperties.pNext = &rayTracingProperties;
+    }
+    vkGetPhysicalDeviceProperties2(vkPhysicalDevice, &deviceProperties);
+
+    // Primary and visibility rays are traced from the ray generation shaders only.
+    if (rayTracingProperties.maxRayRecursionDepth < 1U)
+    {
+        rejectReason = "ray recursion depth below 1";
+        return 0U;
+    }
+
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(vkPhysicalDevice, &memoryProperties);
+
+    uint64_t deviceLocalBytes = 0U;
+
+    for (uint32_t heapIndex = 0U; heapIndex < memoryProperties.memoryHeapCount; heapIndex++)
+    {
+        if ((memoryProperties.memoryHeaps[heapIndex].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0U)
+            deviceLocalBytes = std::max(deviceLocalBytes, memoryProperties.memoryHeaps[heapIndex].size);
+    }
+
+    uint64_t typeRank = 1U;
+
+    switch (deviceProperties.properties.deviceType)
+    {
+        case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU  : typeRank = 4U; break;
+        case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: typeRank = 3U; break;
+        case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU   : typeRank = 2U; break;
+        default                                    : break;
+    }
+
+    uint64_t optionalCount = 0U;
+
+    for (const auto& optionalExtension : requirements.optionalExtensions)
+    {
+        if (HasVulkanExtension(extensions, optionalExtension))
+            optionalCount++;
+    }
+
+    // Largest device local heap in MiB, which fits below the type rank for any heap up to 2^40 MiB.
+    return (typeRank << 56U) + ((deviceLocalBytes >> 20U) << 8U) + std::min<uint64_t>(optionalCount, 0xFFU);
+}
+
+bool SelectVulkanPhysicalDevice(const VkInstance&               vkInstance,
+                                const VulkanDeviceRequirements& requirements,
+                                VkPhysicalDevice&               vkPhysicalDevice,
+                                uint32_t&                       selectedDeviceIndex,
+                                std::vector<const char*>&       enabledExtensions,
+                                std::vector<uint32_t>&          capableDeviceIndices)
 {
     uint32_t deviceCount = 0U;
     vkEnumeratePhysicalDevices(vkInstance, &deviceCount, nullptr);
@@ -117,55 +300,106 @@ bool SelectVulkanPhysicalDevice(const VkInstance& vkInstance, const std::vector<
     std::vector<VkPhysicalDevice> vkPhysicalDevices(deviceCount);
     vkEnumeratePhysicalDevices(vkInstance, &deviceCount, vkPhysicalDevices.data());
 
+    // A forced device is either an enumeration index or a (prefix of a) UUID, dashes and case are ignored.
+    std::string forcedDevice;
+
+    for (const char character : requirements.forcedDevice)
+    {
+        if (character != '-')
+            forcedDevice += static_cast<char>(std::tolower(static_cast<unsigned char>(character)));
+    }
+
+    const bool forcedByIndex =
+        !forcedDevice.empty() && std::all_of(forcedDevice.begin(), forcedDevice.end(), [](char character) { return std::isdigit(character) != 0; });
+
     vkPhysicalDevice = VK_NULL_HANDLE;
 
-    for (const auto& physicalDevice : vkPhysicalDevices)
+    uint64_t bestScore = 0U;
+
+    std::vector<std::pair<uint64_t, uint32_t>> capableDevices;
+
+    for (uint32_t deviceIndex = 0U; deviceIndex < deviceCount; deviceIndex++)
     {
-        VkPhysicalDeviceProperties physicalDeviceProperties;
-        vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+        VkPhysicalDeviceIDProperties deviceIDProperties = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES };
 
-        if (physicalDeviceProperties.deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
-            continue;
+        VkPhysicalDeviceProperties2 deviceProperties = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
+        {
+            deviceProperties.pNext = &deviceIDProperties;
+        }
+        vkGetPhysicalDeviceProperties2(vkPhysicalDevices[deviceIndex], &deviceProperties);
 
-        // Found the matching Vulkan Physical Device for the existing DXGI Adapter.
-        vkPhysicalDevice = physicalDevice;
+        const std::string deviceUUID = FormatDeviceUUID(deviceIDProperties.deviceUUID);
 
-        break;
+        std::string    rejectReason;
+        const uint64_t score = ScoreVulkanPhysicalDevice(vkInstance, vkPhysicalDevices[deviceIndex], requirements, rejectReason);
+
+        spdlog::info("Vulkan Physical Device {}: {} ({}, UUID {}) - {}",
+                     deviceIndex,
+                     deviceProperties.properties.deviceName,
+                     GetPhysicalDeviceTypeName(deviceProperties.properties.deviceType),
+                     deviceUUID,
+                     score > 0U ? std::format("score {:#x}", score) : std::format("rejected, {}", rejectReason));
+
+        if (score > 0U)
+            capableDevices.emplace_back(score, deviceIndex);
+
+        if (!forcedDevice.empty())
+        {
+            const bool forced = forcedByIndex ? std::to_string(deviceIndex) == forcedDevice : deviceUUID.starts_with(forcedDevice);
+
+            if (!forced)
+                continue;
+
+            if (score == 0U)
+            {
+                spdlog::error("The forced Vulkan Physical Device {} does not meet the requirements.", deviceProperties.properties.deviceName);
+                return false;
+            }
+        }
+
+        if (score > bestScore)
+        {
+            bestScore           = score;
+            vkPhysicalDevice    = vkPhysicalDevices[deviceIndex];
+            selectedDeviceIndex = deviceIndex;
+        }
     }
 
+    std::stable_sort(capableDevices.begin(), capableDevices.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    capableDeviceIndices.clear();
+
+    for (const auto& [score, deviceIndex] : capableDevices)
+        capableDeviceIndices.push_back(deviceIndex);
+
     if (vkPhysicalDevice == VK_NULL_HANDLE)
+    {
+        if (!forcedDevice.empty())
+            spdlog::error("No Vulkan Physical Device matches {}.", requirements.forcedDevice);
+
         return false;
+    }
 
     VkPhysicalDeviceProperties physicalDeviceProperties;
     vkGetPhysicalDeviceProperties(vkPhysicalDevice, &physicalDeviceProperties);
 
     spdlog::info("Selected Vulkan Physical Device: {}", physicalDeviceProperties.deviceName);
 
-    // Confirm that the selected physical device supports the required extensions.
+    // Negotiate the optional extensions.
     uint32_t supportedDeviceExtensionCount = 0U;
     vkEnumerateDeviceExtensionProperties(vkPhysicalDevice, nullptr, &supportedDeviceExtensionCount, nullptr);
 
     std::vector<VkExtensionProperties> supportedDeviceExtensions(supportedDeviceExtensionCount);
     vkEnumerateDeviceExtensionProperties(vkPhysicalDevice, nullptr, &supportedDeviceExtensionCount, supportedDeviceExtensions.data());
 
-    auto CheckExtension = [&](const char* extensionName)
-    {
-        for (const auto& deviceExtension : supportedDeviceExtensions)
-        {
-            if (strcmp(deviceExtension.extensionName, extensionName) == 0) // NOLINT
-                return true;
-        }
+    enabledExtensions = requirements.requiredExtensions;
 
-        return false;
-    };
-
-    for (const auto& requiredExtension : requiredExtensions)
+    for (const auto& optionalExtension : requirements.optionalExtensions)
     {
-        if (CheckExtension(requiredExtension))
-            continue;
-
-        spdlog::error("The selected Vulkan physical device does not support required Vulkan Extension: {}", requiredExtension);
-        return false;
+        if (HasVulkanExtension(supportedDeviceExtensions, optionalExtension))
+            enabledExtensions.push_back(optionalExtension);
+        else
+            spdlog::info("Optional Vulkan Extension {} is not supported, continuing without it.", optionalExtension);
     }
 
     return true;
@@ -192,10 +426,16 @@ bool CreateVulkanLogicalDevice(const VkPhysicalDevice&         vkPhysicalDevice,
     VkPhysicalDeviceVulkan11Features                 vulkan11Features    = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES };
     VkPhysicalDeviceFeatures2                        vulkan10Features    = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
 
+    // Feature structures of extensions that aren't enabled must stay out of the chain.
+    const bool shaderObjectEnabled =
+        std::any_of(requiredExtensions.begin(),
+                    requiredExtensions.end(),
+                    [](const char* extensionName) { return strcmp(extensionName, VK_EXT_SHADER_OBJECT_EXTENSION_NAME) == 0; }); // NOLINT
+
     rtFeature.pNext           = &rayQueryFeature;
     acFeature.pNext           = &rtFeature;
     shaderObjectFeature.pNext = &acFeature;
-    vulkan13Features.pNext    = &shaderObjectFeature;
+    vulkan13Features.pNext    = shaderObjectEnabled ? static_cast<void*>(&shaderObjectFeature) : static_cast<void*>(&acFeature);
     vulkan12Features.pNext    = &vulkan13Features;
     vulkan11Features.pNext    = &vulkan12Features;
     vulkan10Features.pNext    = &vulkan11Features;
@@ -231,9 +471,14 @@ bool CreateVulkanLogicalDevice(const VkPhysicalDevice&         vkPhysicalDevice,
     return vkCreateDevice(vkPhysicalDevice, &vkLogicalDeviceCreateInfo, nullptr, &vkLogicalDevice) == VK_SUCCESS;
 }
 
+std::filesystem::path GetShaderDirectory()
+{
+    return std::filesystem::path("..") / "Shaders";
+}
+
 bool LoadByteCode(const char* filePath, std::vector<char>& byteCode)
 {
-    std::fstream file(std::format(R"(..\Shaders\Compiled\{})", filePath), std::ios::in | std::ios::binary);
+    std::fstream file(GetShaderDirectory() / "Compiled" / filePath, std::ios::in | std::ios::binary);
 
     if (!file.is_open())
         return false;
@@ -300,7 +545,7 @@ void SetDefaultRenderState(VkCommandBuffer commandBuffer)
     vkCmdSetPrimitiveTopologyEXT(commandBuffer, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
 }
 
-bool GetVulkanQueueIndices(const VkInstance& vkInstance, const VkPhysicalDevice& vkPhysicalDevice, uint32_t& vkQueueIndexGraphics)
+bool GetVulkanQueueIndices(const VkInstance& vkInstance, const VkPhysicalDevice& vkPhysicalDevice, bool presentation, uint32_t& vkQueueIndexGraphics)
 {
     vkQueueIndexGraphics = UINT_MAX;
 
@@ -312,10 +557,14 @@ bool GetVulkanQueueIndices(const VkInstance& vkInstance, const VkPhysicalDevice&
 
     for (uint32_t queueFamilyIndex = 0; queueFamilyIndex < queueFamilyCount; queueFamilyIndex++)
     {
-        if (glfwGetPhysicalDevicePresentationSupport(vkInstance, vkPhysicalDevice, queueFamilyIndex) == 0)
+        // Headless runs never initialize GLFW and have nothing to present to.
+        if (presentation && glfwGetPhysicalDevicePresentationSupport(vkInstance, vkPhysicalDevice, queueFamilyIndex) == 0)
             continue;
 
-        if ((queueFamilyProperties[queueFamilyIndex].queueFlags & VK_QUEUE_GRAPHICS_BIT) == 0U)
+        // The frame records compute dispatches and ray tracing on the same queue.
+        const VkQueueFlags requiredQueueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT;
+
+        if ((queueFamilyProperties[queueFamilyIndex].queueFlags & requiredQueueFlags) != requiredQueueFlags)
             continue;
 
         vkQueueIndexGraphics = queueFamilyIndex;
@@ -429,11 +678,35 @@ void VulkanColorImageBarrier(VkCommandBuffer       vkCommand,
     vkCmdPipelineBarrier2(vkCommand, &vkDependencyInfo);
 }
 
+void VulkanMemoryBarrier(VkCommandBuffer       vkCommand,
+                         VkAccessFlags2        vkAccessSrc,
+                         VkAccessFlags2        vkAccessDst,
+                         VkPipelineStageFlags2 vkStageSrc,
+                         VkPipelineStageFlags2 vkStageDst)
+{
+    VkMemoryBarrier2 vkMemoryBarrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+    {
+        vkMemoryBarrier.srcAccessMask = vkAccessSrc;
+        vkMemoryBarrier.dstAccessMask = vkAccessDst;
+        vkMemoryBarrier.srcStageMask  = vkStageSrc;
+        vkMemoryBarrier.dstStageMask  = vkStageDst;
+    }
+
+    VkDependencyInfo vkDependencyInfo = { VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+    {
+        vkDependencyInfo.memoryBarrierCount = 1U;
+        vkDependencyInfo.pMemoryBarriers    = &vkMemoryBarrier;
+    }
+
+    vkCmdPipelineBarrier2(vkCommand, &vkDependencyInfo);
+}
+
 void DebugLabelImageResource(RenderContext* pRenderContext, const Image& imageResource, const char* labelName)
 {
 #ifdef _DEBUG
-    // Label the allocation.
-    vmaSetAllocationName(pRenderContext->GetAllocator(), imageResource.imageAllocation, std::format("Image Alloc - [{}]", labelName).c_str());
+    // Label the allocation (images placed in a shared allocation have none of their own).
+    if (imageResource.imageAllocation != VK_NULL_HANDLE)
+        vmaSetAllocationName(pRenderContext->GetAllocator(), imageResource.imageAllocation, std::format("Image Alloc - [{}]", labelName).c_str());
 
     // Label the image object.
     NameVulkanObject(pRenderContext->GetDevice(),
@@ -455,8 +728,9 @@ void DebugLabelImageResource(RenderContext* pRenderContext, const Image& imageRe
 void DebugLabelBufferResource(RenderContext* pRenderContext, const Buffer& bufferResource, const char* labelName)
 {
 #ifdef _DEBUG
-    // Label the allocation.
-    vmaSetAllocationName(pRenderContext->GetAllocator(), bufferResource.bufferAllocation, std::format("Buffer Alloc - [{}]", labelName).c_str());
+    // Label the allocation (buffers that don't own their memory have none).
+    if (bufferResource.bufferAllocation != VK_NULL_HANDLE)
+        vmaSetAllocationName(pRenderContext->GetAllocator(), bufferResource.bufferAllocation, std::format("Buffer Alloc - [{}]", labelName).c_str());
 
     // Label the buffer object.
     NameVulkanObject(pRenderContext->GetDevice(),
@@ -475,6 +749,9 @@ void DebugLabelBufferResource(RenderContext* pRenderContext, const Buffer& buffe
 #endif
 }
 
+// Single-shot command buffers are recorded and submitted on the same thread, one at a time.
+thread_local uint32_t t_SingleShotQuerySlot = UINT_MAX;
+
 void SingleShotCommandBegin(RenderContext* pRenderContext, VkCommandBuffer& vkCommandBuffer, VkCommandPool vkCommandPool)
 {
     VkCommandBufferAllocateInfo vkCommandAllocateInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
@@ -491,10 +768,18 @@ void SingleShotCommandBegin(RenderContext* pRenderContext, VkCommandBuffer& vkCo
         vkCommandsBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
     }
     Check(vkBeginCommandBuffer(vkCommandBuffer, &vkCommandsBeginInfo), "Failed to begin recording commands");
+
+    // GPU time of the submission for the startup trace.
+    if (CPUTracer::Get().IsEnabled())
+        t_SingleShotQuerySlot = pRenderContext->GetGPUProfiler().BeginSingleShot(vkCommandBuffer);
 }
 
 void SingleShotCommandEnd(RenderContext* pRenderContext, VkCommandBuffer& vkCommandBuffer)
 {
+    const uint32_t querySlot = std::exchange(t_SingleShotQuerySlot, UINT_MAX);
+
+    pRenderContext->GetGPUProfiler().EndSingleShot(vkCommandBuffer, querySlot);
+
     Check(vkEndCommandBuffer(vkCommandBuffer), "Failed to end recording commands");
 
     VkSubmitInfo vkSubmitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
@@ -503,13 +788,235 @@ void SingleShotCommandEnd(RenderContext* pRenderContext, VkCommandBuffer& vkComm
         vkSubmitInfo.pCommandBuffers    = &vkCommandBuffer;
     }
 
-    std::lock_guard<std::mutex> commandQueueLock(pRenderContext->GetCommandQueueMutex());
+    // Each submission signals its own fence, so only these commands are waited for, not the frames in flight.
+    VkFence vkFence = VK_NULL_HANDLE;
+
+    VkFenceCreateInfo vkFenceInfo = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+    Check(vkCreateFence(pRenderContext->GetDevice(), &vkFenceInfo, nullptr, &vkFence), "Failed to create the single-shot fence.");
+
+    std::chrono::high_resolution_clock::time_point submitTime;
+
+    {
+        std::lock_guard<std::mutex> commandQueueLock(pRenderContext->GetCommandQueueMutex());
+
+        submitTime = std::chrono::high_resolution_clock::now();
 
-    Check(vkQueueSubmit(pRenderContext->GetCommandQueue(), 1U, &vkSubmitInfo, VK_NULL_HANDLE), "Failed to submit commands to the graphics queue.");
+        Check(vkQueueSubmit(pRenderContext->GetCommandQueue(), 1U, &vkSubmitInfo, vkFence), "Failed to submit commands to the graphics queue.");
+    }
 
-    // Wait for the commands to complete.
+    // Wait for the commands to complete, outside the queue lock so other threads keep submitting.
     // -----------------------------------------------------
-    Check(vkDeviceWaitIdle(pRenderContext->GetDevice()), "Failed to wait for commands to finish dispatching.");
+    Check(vkWaitForFences(pRenderContext->GetDevice(), 1U, &vkFence, VK_TRUE, UINT64_MAX), "Failed to wait for commands to finish dispatching.");
+
+    vkDestroyFence(pRenderContext->GetDevice(), vkFence, nullptr);
+
+    if (querySlot != UINT_MAX)
+    {
+        // Named after the CPU event the submission happened in.
+        const char* eventName = CPUTracer::Get().GetCurrentEventName();
+
+        CPUTracer::Get().RecordGPUEvent(eventName != nullptr ? eventName : "Single Shot Commands",
+                                        submitTime,
+                                        pRenderContext->GetGPUProfiler().ResolveSingleShotMilliseconds(querySlot));
+    }
+}
+
+uint64_t HashBytes(const void* pData, size_t size, uint64_t seed)
+{
+    const auto* pBytes = static_cast<const uint8_t*>(pData);
+
+    uint64_t hash = seed;
+
+    for (size_t byteIndex = 0U; byteIndex < size; byteIndex++)
+    {
+        hash ^= pBytes[byteIndex];
+        hash *= 0x100000001B3ULL;
+    }
+
+    return hash;
+}
+
+uint64_t HashBytesWide(const void* pData, size_t size, uint64_t seed)
+{
+    const auto* pBytes = static_cast<const uint8_t*>(pData);
+
+    const uint64_t kPrime = 0x9E3779B97F4A7C15ULL;
+
+    std::array<uint64_t, 4> lanes = { seed, seed ^ 0x243F6A8885A308D3ULL, seed ^ 0x13198A2E03707344ULL, seed ^ 0xA4093822299F31D0ULL };
+
+    size_t offset = 0U;
+
+    for (; offset + sizeof(uint64_t) * lanes.size() <= size; offset += sizeof(uint64_t) * lanes.size())
+    {
+        for (uint32_t laneIndex = 0U; laneIndex < lanes.size(); laneIndex++)
+        {
+            uint64_t word;
+            std::memcpy(&word, pBytes + offset + sizeof(uint64_t) * laneIndex, sizeof(uint64_t));
+
+            lanes[laneIndex] = (lanes[laneIndex] ^ word) * kPrime;
+            lanes[laneIndex] ^= lanes[laneIndex] >> 29U;
+        }
+    }
+
+    // Fold the lanes, then the tail shorter than a block, through FNV-1a. The size keeps prefixes apart.
+    uint64_t hash = HashBytes(&size, sizeof(size), seed);
+    hash          = HashBytes(lanes.data(), sizeof(uint64_t) * lanes.size(), hash);
+
+    return HashBytes(pBytes + offset, size - offset, hash);
+}
+
+std::string EscapeJSON(std::string_view text)
+{
+    std::string escaped;
+    escaped.reserve(text.size());
+
+    for (const char character : text)
+    {
+        switch (character)
+        {
+            case '"' : escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(character) < 0x20U)
+                    escaped += std::format("\\u{:04x}", static_cast<uint32_t>(character));
+                else
+                    escaped += character;
+        }
+    }
+
+    return escaped;
+}
+
+// Helper threads of ParallelFor, started on first use and parked between calls so the render path never creates threads.
+// Calls from several threads queue their jobs side by side, helpers take whichever job still wants one.
+class ParallelForPool
+{
+public:
+
+    static ParallelForPool& Get()
+    {
+        static ParallelForPool s_Pool;
+        return s_Pool;
+    }
+
+    inline uint32_t GetHelperCount() const { return static_cast<uint32_t>(m_Helpers.size()); }
+
+    // Runs workFunc on the calling thread and on up to helperCount helpers, and returns once every copy returned.
+    void Run(uint32_t helperCount, const std::function<void()>& workFunc)
+    {
+        Job job = { &workFunc, helperCount, 0U };
+
+        if (helperCount > 0U)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Jobs.push_back(&job);
+            }
+            m_WorkCondition.notify_all();
+        }
+
+        workFunc();
+
+        std::unique_lock<std::mutex> lock(m_Mutex);
+
+        // Helpers that didn't get to the job are no longer needed, the work is claimed once the caller returns.
+        if (job.helperCount > 0U)
+        {
+            m_Jobs.erase(std::find(m_Jobs.begin(), m_Jobs.end(), &job));
+            job.helperCount = 0U;
+        }
+
+        m_DoneCondition.wait(lock, [&]() { return job.activeCount == 0U; });
+    }
+
+private:
+
+    struct Job
+    {
+        const std::function<void()>* pWorkFunc;
+        uint32_t                     helperCount; // Helpers still wanted.
+        uint32_t                     activeCount; // Helpers running it.
+    };
+
+    ParallelForPool()
+    {
+        const uint32_t helperCount = std::max(1U, std::thread::hardware_concurrency()) - 1U;
+
+        for (uint32_t helperIndex = 0U; helperIndex < helperCount; helperIndex++)
+            m_Helpers.emplace_back([this]() { Helper(); });
+    }
+
+    ~ParallelForPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stop = true;
+        }
+        m_WorkCondition.notify_all();
+
+        // The helpers join on destruction.
+    }
+
+    void Helper()
+    {
+        CPUTracer::Get().SetThreadName("Parallel For");
+
+        std::unique_lock<std::mutex> lock(m_Mutex);
+
+        while (true)
+        {
+            m_WorkCondition.wait(lock, [&]() { return m_Stop || !m_Jobs.empty(); });
+
+            if (m_Stop)
+                return;
+
+            Job* pJob = m_Jobs.front();
+
+            if (--pJob->helperCount == 0U)
+                m_Jobs.pop_front();
+
+            pJob->activeCount++;
+
+            lock.unlock();
+            (*pJob->pWorkFunc)();
+            lock.lock();
+
+            if (--pJob->activeCount == 0U)
+                m_DoneCondition.notify_all();
+        }
+    }
+
+    std::mutex              m_Mutex;
+    std::condition_variable m_WorkCondition;
+    std::condition_variable m_DoneCondition;
+    std::deque<Job*>        m_Jobs;
+    bool                    m_Stop = false;
+
+    std::vector<std::jthread> m_Helpers;
+};
+
+void ParallelFor(uint32_t count, uint32_t chunkSize, const std::function<void(uint32_t chunkIndex, uint32_t begin, uint32_t end)>& chunkFunc)
+{
+    const uint32_t chunkCount = (count + chunkSize - 1U) / chunkSize;
+
+    if (chunkCount == 0U)
+        return;
+
+    auto& pool = ParallelForPool::Get();
+
+    std::atomic<uint32_t> nextChunk = 0U;
+
+    // The calling thread works too.
+    const std::function<void()> workFunc = [&]()
+    {
+        for (uint32_t chunkIndex = nextChunk++; chunkIndex < chunkCount; chunkIndex = nextChunk++)
+            chunkFunc(chunkIndex, chunkIndex * chunkSize, std::min(count, (chunkIndex + 1U) * chunkSize));
+    };
+
+    pool.Run(std::min(chunkCount - 1U, pool.GetHelperCount()), workFunc);
 }
 
 void InitializeUserInterface(RenderContext* pRenderContext)
@@ -562,18 +1069,10 @@ void DrawUserInterface(RenderContext* pRenderContext, uint32_t swapChainImageInd
 
     ImGui::Render();
 
-    VulkanColorImageBarrier(cmd,
-                            pRenderContext->GetSwapchainImage(swapChainImageIndex),
-                            VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-                            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                            VK_ACCESS_2_MEMORY_READ_BIT,
-                            VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
-                            VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-                            VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT);
-
+    // The frame commands leave the back buffer as a color attachment, the interface is drawn over its contents.
     VkRenderingAttachmentInfo colorAttachmentInfo = { VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO };
     {
-        colorAttachmentInfo.loadOp      = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        colorAttachmentInfo.loadOp      = VK_ATTACHMENT_LOAD_OP_LOAD;
         colorAttachmentInfo.storeOp     = VK_ATTACHMENT_STORE_OP_STORE;
         colorAttachmentInfo.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
         colorAttachmentInfo.imageView   = pRenderContext->GetSwapchainImageView(swapChainImageIndex);
@@ -587,8 +1086,8 @@ void DrawUserInterface(RenderContext* pRenderContext, uint32_t swapChainImageInd
         vkRenderingInfo.pStencilAttachment   = VK_NULL_HANDLE;
         vkRenderingInfo.layerCount           = 1U;
         vkRenderingInfo.renderArea           = {
-            {            0,             0 },
-            { kWindowWidth, kWindowHeight }
+            {                               0,                                0 },
+            { pRenderContext->GetRenderWidth(), pRenderContext->GetRenderHeight() }
         };
     }
     vkCmdBeginRendering(cmd, &vkRenderingInfo);
@@ -602,7 +1101,7 @@ void DrawUserInterface(RenderContext* pRenderContext, uint32_t swapChainImageInd
                             VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
                             VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
                             VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
-                            VK_ACCESS_2_MEMORY_READ_BIT,
+                            VK_ACCESS_2_NONE,
                             VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
                             VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT);
 }
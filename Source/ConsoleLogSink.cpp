@@ -0,0 +1,70 @@
+#include <ConsoleLogSink.h>
+
+// Console Log Sink Implementation
+// ------------------------------------------------------------
+
+void ConsoleLogSink::log(const spdlog::details::log_msg& msg)
+{
+    const uint64_t lineIndex = m_LineCount.fetch_add(1U, std::memory_order_relaxed);
+
+    Slot& slot = m_Slots[lineIndex % kConsoleLogLineCount];
+
+    // Claim the slot: a writer one lap behind that is still copying (odd sequence) or one lap ahead that already took
+    // it keeps the slot and this line is dropped, so two writers never interleave in the same slot.
+    uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+
+    do
+    {
+        if ((sequence & 1U) != 0U || sequence > 2U * lineIndex)
+            return;
+    } while (!slot.sequence.compare_exchange_weak(sequence, 2U * lineIndex + 1U, std::memory_order_relaxed));
+
+    // Readers that see the odd sequence (or the old even one after the line changed) discard their copy.
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const auto levelName = spdlog::level::to_string_view(msg.level);
+
+    Line line;
+
+    const auto result = std::format_to_n(line.text.data(),
+                                         kConsoleLogLineLength,
+                                         "[{}] {}",
+                                         std::string_view(levelName.data(), levelName.size()),
+                                         std::string_view(msg.payload.data(), msg.payload.size()));
+
+    line.level  = msg.level;
+    line.length = static_cast<uint32_t>(std::min<std::ptrdiff_t>(result.size, kConsoleLogLineLength));
+
+    std::array<uint64_t, kSlotWordCount> words;
+    std::memcpy(words.data(), &line, sizeof(Line));
+
+    for (uint32_t wordIndex = 0U; wordIndex < kSlotWordCount; wordIndex++)
+        slot.words[wordIndex].store(words[wordIndex], std::memory_order_relaxed);
+
+    slot.sequence.store(2U * lineIndex + 2U, std::memory_order_release);
+}
+
+bool ConsoleLogSink::ReadLine(uint64_t lineIndex, Line& line) const
+{
+    const Slot&    slot     = m_Slots[lineIndex % kConsoleLogLineCount];
+    const uint64_t complete = 2U * lineIndex + 2U;
+
+    if (slot.sequence.load(std::memory_order_acquire) != complete)
+        return false;
+
+    // Word-wise atomic loads, so a copy racing a writer is torn but never a data race.
+    std::array<uint64_t, kSlotWordCount> words;
+
+    for (uint32_t wordIndex = 0U; wordIndex < kSlotWordCount; wordIndex++)
+        words[wordIndex] = slot.words[wordIndex].load(std::memory_order_relaxed);
+
+    // The copy is only valid if no writer claimed the slot in the meantime.
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (slot.sequence.load(std::memory_order_relaxed) != complete)
+        return false;
+
+    std::memcpy(&line, words.data(), sizeof(Line));
+
+    return true;
+}
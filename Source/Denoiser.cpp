@@ -0,0 +1,332 @@
+#include <Common.h>
+#include <Profiler.h>
+#include <RenderContext.h>
+#include <RenderGraph.h>
+#include <Camera.h>
+#include <Denoiser.h>
+
+// Denoiser Implementation
+// ------------------------------------------------------------
+
+// Storage image bindings of the two shaders (see their register declarations).
+const uint32_t kDenoiseTemporalBindingCount = 10U;
+const uint32_t kDenoiseFilterBindingCount   = 4U;
+
+// Two temporal sets, and the history (x2), color and scratch filter routes.
+const uint32_t kDenoiseTemporalSetCount = 2U;
+const uint32_t kDenoiseFilterSetCount   = 6U;
+
+const std::array<const char*, kDenoiseMaxFilterIterations> kDenoiseFilterScopeNames = {
+    "Denoise (A-Trous 1)", "Denoise (A-Trous 2)", "Denoise (A-Trous 3)", "Denoise (A-Trous 4)", "Denoise (A-Trous 5)"
+};
+
+VkDescriptorSet Denoiser::AllocateSet(RenderContext* pRenderContext, VkDescriptorSetLayout vkLayout, const std::vector<VkImageView>& imageViews)
+{
+    VkDescriptorSetAllocateInfo descriptorSetInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    {
+        descriptorSetInfo.descriptorPool     = m_DescriptorPool;
+        descriptorSetInfo.descriptorSetCount = 1U;
+        descriptorSetInfo.pSetLayouts        = &vkLayout;
+    }
+
+    VkDescriptorSet vkDescriptorSet = VK_NULL_HANDLE;
+    Check(vkAllocateDescriptorSets(pRenderContext->GetDevice(), &descriptorSetInfo, &vkDescriptorSet),
+          "Failed to allocate a denoiser descriptor set.");
+
+    // Binding i is the i-th view.
+    std::vector<VkDescriptorImageInfo> imageInfos;
+
+    for (VkImageView imageView : imageViews)
+        imageInfos.push_back({ VK_NULL_HANDLE, imageView, VK_IMAGE_LAYOUT_GENERAL });
+
+    VkWriteDescriptorSet descriptorWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+    {
+        descriptorWrite.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        descriptorWrite.descriptorCount = static_cast<uint32_t>(imageInfos.size());
+        descriptorWrite.dstBinding      = 0U;
+        descriptorWrite.dstSet          = vkDescriptorSet;
+        descriptorWrite.pImageInfo      = imageInfos.data();
+    }
+    vkUpdateDescriptorSets(pRenderContext->GetDevice(), 1U, &descriptorWrite, 0U, nullptr);
+
+    return vkDescriptorSet;
+}
+
+void Denoiser::Create(RenderContext* pRenderContext,
+                      const Image&   color,
+                      const Image&   position,
+                      const Image&   normal,
+                      const Image&   motion,
+                      const Image&   scratch,
+                      VkCommandPool  vkCommandPool)
+{
+    m_Width  = pRenderContext->GetRenderWidth();
+    m_Height = pRenderContext->GetRenderHeight();
+
+    // History images, in the general layout from here on.
+    // ------------------------------------------------
+
+    for (uint32_t historyIndex = 0U; historyIndex < m_History.size(); historyIndex++)
+    {
+        auto& history = m_History[historyIndex];
+
+        Check(CreateStorageImage(pRenderContext,
+                                 history.color,
+                                 VK_FORMAT_R16G16B16A16_SFLOAT,
+                                 std::format("Denoise History Color {}", historyIndex).c_str(),
+                                 vkCommandPool),
+              "Failed to create the denoiser color history.");
+        Check(CreateStorageImage(pRenderContext,
+                                 history.moments,
+                                 VK_FORMAT_R16G16B16A16_SFLOAT,
+                                 std::format("Denoise History Moments {}", historyIndex).c_str(),
+                                 vkCommandPool),
+              "Failed to create the denoiser moments history.");
+        Check(CreateStorageImage(pRenderContext,
+                                 history.normalDepth,
+                                 VK_FORMAT_R16G16B16A16_SFLOAT,
+                                 std::format("Denoise History Normal + Depth {}", historyIndex).c_str(),
+                                 vkCommandPool),
+              "Failed to create the denoiser normal + depth history.");
+    }
+
+    // Pipelines.
+    // ------------------------------------------------
+
+    m_TemporalSetLayout      = CreateStorageImageSetLayout(pRenderContext, kDenoiseTemporalBindingCount);
+    m_TemporalPipelineLayout = CreateComputePipelineLayout(pRenderContext, m_TemporalSetLayout, sizeof(DenoiseTemporalConstants));
+    m_TemporalPipeline       = CreateComputePipeline(pRenderContext, "DenoiseTemporal.spv", m_TemporalPipelineLayout);
+
+    m_FilterSetLayout      = CreateStorageImageSetLayout(pRenderContext, kDenoiseFilterBindingCount);
+    m_FilterPipelineLayout = CreateComputePipelineLayout(pRenderContext, m_FilterSetLayout, sizeof(DenoiseFilterConstants));
+    m_FilterPipeline       = CreateComputePipeline(pRenderContext, "DenoiseFilter.spv", m_FilterPipelineLayout);
+
+    // Descriptors for every route through the images, so nothing is rewritten while frames are in flight.
+    // ------------------------------------------------
+
+    const uint32_t storageImageCount = kDenoiseTemporalSetCount * kDenoiseTemporalBindingCount + kDenoiseFilterSetCount * kDenoiseFilterBindingCount;
+
+    const VkDescriptorPoolSize descriptorPoolSize = { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, storageImageCount };
+
+    VkDescriptorPoolCreateInfo descriptorPoolInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+    {
+        descriptorPoolInfo.maxSets       = kDenoiseTemporalSetCount + kDenoiseFilterSetCount;
+        descriptorPoolInfo.poolSizeCount = 1U;
+        descriptorPoolInfo.pPoolSizes    = &descriptorPoolSize;
+    }
+    Check(vkCreateDescriptorPool(pRenderContext->GetDevice(), &descriptorPoolInfo, nullptr, &m_DescriptorPool),
+          "Failed to create the denoiser descriptor pool.");
+
+    for (uint32_t historyIndex = 0U; historyIndex < m_History.size(); historyIndex++)
+    {
+        const auto& current  = m_History[historyIndex];
+        const auto& previous = m_History[historyIndex ^ 1U];
+
+        m_TemporalSets[historyIndex] = AllocateSet(pRenderContext,
+                                                   m_TemporalSetLayout,
+                                                   { color.imageView,
+                                                     position.imageView,
+                                                     normal.imageView,
+                                                     motion.imageView,
+                                                     previous.color.imageView,
+                                                     previous.moments.imageView,
+                                                     previous.normalDepth.imageView,
+                                                     current.color.imageView,
+                                                     current.moments.imageView,
+                                                     current.normalDepth.imageView });
+
+        m_FilterHistoryToColorSets[historyIndex] = AllocateSet(
+            pRenderContext, m_FilterSetLayout, { current.color.imageView, color.imageView, position.imageView, normal.imageView });
+
+        m_FilterHistoryToScratchSets[historyIndex] = AllocateSet(
+            pRenderContext, m_FilterSetLayout, { current.color.imageView, scratch.imageView, position.imageView, normal.imageView });
+    }
+
+    m_FilterColorToScratchSet =
+        AllocateSet(pRenderContext, m_FilterSetLayout, { color.imageView, scratch.imageView, position.imageView, normal.imageView });
+    m_FilterScratchToColorSet =
+        AllocateSet(pRenderContext, m_FilterSetLayout, { scratch.imageView, color.imageView, position.imageView, normal.imageView });
+
+    spdlog::info("Created Denoiser.");
+}
+
+void Denoiser::Release(RenderContext* pRenderContext)
+{
+    vkDestroyDescriptorPool(pRenderContext->GetDevice(), m_DescriptorPool, nullptr);
+
+    for (auto* pPipeline : { &m_TemporalPipeline, &m_FilterPipeline })
+        vkDestroyPipeline(pRenderContext->GetDevice(), *pPipeline, nullptr);
+
+    for (auto* pPipelineLayout : { &m_TemporalPipelineLayout, &m_FilterPipelineLayout })
+        vkDestroyPipelineLayout(pRenderContext->GetDevice(), *pPipelineLayout, nullptr);
+
+    for (auto* pSetLayout : { &m_TemporalSetLayout, &m_FilterSetLayout })
+        vkDestroyDescriptorSetLayout(pRenderContext->GetDevice(), *pSetLayout, nullptr);
+
+    for (auto& history : m_History)
+    {
+        for (auto* pImage : { &history.color, &history.moments, &history.normalDepth })
+        {
+            vkDestroyImageView(pRenderContext->GetDevice(), pImage->imageView, nullptr);
+            vmaDestroyImage(pRenderContext->GetAllocator(), pImage->image, pImage->imageAllocation);
+        }
+    }
+}
+
+void Denoiser::Import(RenderGraph& renderGraph)
+{
+    // Left in the general layout by CreateStorageImage, and idle since.
+    const RenderGraph::ResourceState created = { VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_2_NONE, VK_PIPELINE_STAGE_2_NONE };
+
+    for (uint32_t historyIndex = 0U; historyIndex < m_History.size(); historyIndex++)
+    {
+        auto& history = m_History[historyIndex];
+
+        history.graphColor       = renderGraph.ImportImage(std::format("Denoise History Color {}", historyIndex), history.color.image, created);
+        history.graphMoments     = renderGraph.ImportImage(std::format("Denoise History Moments {}", historyIndex), history.moments.image, created);
+        history.graphNormalDepth = renderGraph.ImportImage(
+            std::format("Denoise History Normal + Depth {}", historyIndex), history.normalDepth.image, created);
+    }
+}
+
+void Denoiser::AddPasses(RenderGraph&            renderGraph,
+                         const FrameResources&   frameResources,
+                         const CameraState&      camera,
+                         const DenoiserSettings& settings,
+                         GPUProfiler&            profiler)
+{
+    using ResourceState = RenderGraph::ResourceState;
+
+    const ResourceState computeRead  = { VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT };
+    const ResourceState computeWrite = { VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT };
+
+    const uint32_t historyIndex = m_HistoryIndex;
+
+    const History& current  = m_History[historyIndex];
+    const History& previous = m_History[historyIndex ^ 1U];
+
+    const uint32_t groupCountX = (m_Width + 7U) / 8U;
+    const uint32_t groupCountY = (m_Height + 7U) / 8U;
+
+    // Temporal accumulation, into the history written this frame.
+    // --------------------------------------------
+
+    const uint32_t iterationCount = std::min(settings.filterIterations, kDenoiseMaxFilterIterations);
+
+    DenoiseTemporalConstants temporalConstants;
+    {
+        temporalConstants.previousRayOrigin = glm::vec4(m_PreviousRayOrigin, 0.0F);
+        temporalConstants.colorAlpha        = settings.colorAlpha;
+        temporalConstants.momentsAlpha      = settings.momentsAlpha;
+        temporalConstants.historyValid      = m_HistoryValid ? 1U : 0U;
+        temporalConstants.resolveToColor    = iterationCount == 0U ? 1U : 0U;
+    }
+
+    std::vector<RenderGraph::ResourceUsage> temporalUsages = {
+        { frameResources.position, computeRead },
+        { frameResources.normal, computeRead },
+        { frameResources.motion, computeRead },
+        { previous.graphColor, computeRead },
+        { previous.graphMoments, computeRead },
+        { previous.graphNormalDepth, computeRead },
+        { current.graphColor, computeWrite },
+        { current.graphMoments, computeWrite },
+        { current.graphNormalDepth, computeWrite },
+    };
+
+    // Without filter iterations the accumulated color goes straight back into the color image.
+    if (iterationCount == 0U)
+    {
+        temporalUsages.push_back({ frameResources.color,
+                                   { VK_IMAGE_LAYOUT_GENERAL,
+                                     VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                                     VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT } });
+    }
+    else
+        temporalUsages.push_back({ frameResources.color, computeRead });
+
+    renderGraph.AddPass(
+        "Denoise (Temporal)",
+        std::move(temporalUsages),
+        [this, temporalConstants, historyIndex, groupCountX, groupCountY, &profiler](VkCommandBuffer cmd)
+        {
+            profiler.BeginScope(cmd, "Denoise (Temporal)");
+
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_TemporalPipeline);
+
+            vkCmdBindDescriptorSets(
+                cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_TemporalPipelineLayout, 0, 1, &m_TemporalSets[historyIndex], 0, 0);
+
+            vkCmdPushConstants(
+                cmd, m_TemporalPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0U, sizeof(DenoiseTemporalConstants), &temporalConstants);
+
+            vkCmdDispatch(cmd, groupCountX, groupCountY, 1U);
+
+            profiler.EndScope(cmd);
+        });
+
+    // A-trous iterations. The first reads the new color history, the rest alternate between the scratch and color
+    // images so the last one lands in the color image.
+    // --------------------------------------------
+
+    RenderGraph::ResourceHandle source = current.graphColor;
+
+    for (uint32_t iteration = 0U; iteration < iterationCount; iteration++)
+    {
+        const bool toColor = (iterationCount - 1U - iteration) % 2U == 0U;
+
+        const RenderGraph::ResourceHandle destination = toColor ? frameResources.color : frameResources.scratch;
+
+        VkDescriptorSet filterSet = VK_NULL_HANDLE;
+
+        if (iteration == 0U)
+            filterSet = toColor ? m_FilterHistoryToColorSets[historyIndex] : m_FilterHistoryToScratchSets[historyIndex];
+        else
+            filterSet = toColor ? m_FilterScratchToColorSet : m_FilterColorToScratchSet;
+
+        DenoiseFilterConstants filterConstants;
+        {
+            filterConstants.stepSize       = 1U << iteration;
+            filterConstants.phiColor       = settings.phiColor;
+            filterConstants.phiNormal      = settings.phiNormal;
+            filterConstants.phiDepth       = settings.phiDepth;
+            filterConstants.pixelFootprint = glm::length(camera.rayPixelDeltaX);
+        }
+
+        const char* scopeName = kDenoiseFilterScopeNames[iteration];
+
+        renderGraph.AddPass(
+            scopeName,
+            {
+                { source, computeRead },
+                { frameResources.position, computeRead },
+                { frameResources.normal, computeRead },
+                { destination, computeWrite },
+            },
+            [this, filterConstants, filterSet, scopeName, groupCountX, groupCountY, &profiler](VkCommandBuffer cmd)
+            {
+                profiler.BeginScope(cmd, scopeName);
+
+                vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_FilterPipeline);
+
+                vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_FilterPipelineLayout, 0, 1, &filterSet, 0, 0);
+
+                vkCmdPushConstants(
+                    cmd, m_FilterPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0U, sizeof(DenoiseFilterConstants), &filterConstants);
+
+                vkCmdDispatch(cmd, groupCountX, groupCountY, 1U);
+
+                profiler.EndScope(cmd);
+            });
+
+        source = destination;
+    }
+
+    // The history written this frame is read by the next one.
+    // --------------------------------------------
+
+    m_PreviousRayOrigin = camera.position;
+
+    m_HistoryIndex ^= 1U;
+    m_HistoryValid  = true;
+}
@@ -0,0 +1,145 @@
+#include <Common.h>
+#include <Scene.h>
+#include <RenderContext.h>
+#include <BindlessDescriptors.h>
+#include <AccelerationStructureCache.h>
+#include <GeometryRegistry.h>
+
+// Geometry Registry Implementation
+// ------------------------------------------------------------
+
+uint64_t HashMeshContent(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+{
+    uint64_t contentHash = HashBytes(&kAccelerationStructureCacheVersion, sizeof(uint32_t));
+    contentHash          = HashBytes(&kBLASBuildFlags, sizeof(kBLASBuildFlags), contentHash);
+    contentHash          = HashBytes(&kBLASGeometryFlags, sizeof(kBLASGeometryFlags), contentHash);
+    contentHash          = HashBytes(&kBLASVertexFormat, sizeof(kBLASVertexFormat), contentHash);
+    contentHash          = HashBytesWide(vertices.data(), sizeof(Vertex) * vertices.size(), contentHash);
+    contentHash          = HashBytesWide(indices.data(), sizeof(uint32_t) * indices.size(), contentHash);
+
+    return contentHash;
+}
+
+template <typename T>
+static bool SameContent(const std::vector<T>& a, const std::vector<T>& b)
+{
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), sizeof(T) * a.size()) == 0;
+}
+
+bool GeometryRegistry::Acquire(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, GeometryHandle& geometry)
+{
+    const uint64_t contentHash = HashMeshContent(vertices, indices);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    bool hashCollision = false;
+
+    const auto [first, last] = m_HandlesByContent.equal_range(contentHash);
+
+    for (auto it = first; it != last; it++)
+    {
+        auto& entry = m_Geometry.at(it->second);
+
+        // Without the content (released) a match can't be verified, and isn't shared.
+        if (!entry.vertices.empty() && SameContent(entry.vertices, vertices) && SameContent(entry.indices, indices))
+        {
+            geometry = it->second;
+
+            entry.referenceCount++;
+            return false;
+        }
+
+        hashCollision = true;
+    }
+
+    if (hashCollision)
+        spdlog::warn("Mesh content hash {:#018x} matches geometry of different (or released) content, it is not shared.", contentHash);
+
+    geometry = static_cast<GeometryHandle>(m_Geometry.size());
+
+    auto& entry = m_Geometry.emplace_back();
+    {
+        entry.mesh.contentHash   = contentHash;
+        entry.mesh.hashCollision = hashCollision;
+        entry.referenceCount     = 1U;
+        entry.vertices           = vertices;
+        entry.indices            = indices;
+    }
+
+    m_HandlesByContent.emplace(contentHash, geometry);
+    return true;
+}
+
+void GeometryRegistry::ReleaseContent()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    for (auto& entry : m_Geometry)
+    {
+        entry.vertices = {};
+        entry.indices  = {};
+    }
+}
+
+void GeometryRegistry::Release(RenderContext* pRenderContext, GeometryHandle geometry)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    auto& entry = m_Geometry.at(geometry);
+
+    Check(entry.referenceCount > 0U, "Released a geometry without references.");
+
+    if (--entry.referenceCount > 0U)
+        return;
+
+    auto& mesh = entry.mesh;
+
+    vkDestroyAccelerationStructureKHR(pRenderContext->GetDevice(), mesh.blas.handle, nullptr);
+
+    vmaDestroyBuffer(pRenderContext->GetAllocator(), mesh.blas.backingMemory.buffer, mesh.blas.backingMemory.bufferAllocation);
+    vmaDestroyBuffer(pRenderContext->GetAllocator(), mesh.vertexBuffer.buffer, mesh.vertexBuffer.bufferAllocation);
+    vmaDestroyBuffer(pRenderContext->GetAllocator(), mesh.indexBuffer.buffer, mesh.indexBuffer.bufferAllocation);
+
+    // The slot of the handle is not reused, the same content acquires a new one.
+    const auto [first, last] = m_HandlesByContent.equal_range(mesh.contentHash);
+
+    for (auto it = first; it != last; it++)
+    {
+        if (it->second == geometry)
+        {
+            m_HandlesByContent.erase(it);
+            break;
+        }
+    }
+
+    mesh = {};
+
+    entry.vertices = {};
+    entry.indices  = {};
+}
+
+Mesh& GeometryRegistry::GetMesh(GeometryHandle geometry)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    return m_Geometry.at(geometry).mesh;
+}
+
+uint32_t GeometryRegistry::GetGeometryCount()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    return static_cast<uint32_t>(m_HandlesByContent.size());
+}
+
+uint32_t GeometryRegistry::GetReferenceCount()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    uint32_t referenceCount = 0U;
+
+    for (const auto& entry : m_Geometry)
+        referenceCount += entry.referenceCount;
+
+    return referenceCount;
+}
@@ -0,0 +1,74 @@
+#include <Common.h>
+#include <ImageIO.h>
+
+// Image IO Implementation
+// ------------------------------------------------------------
+
+bool WritePPM(const char* filePath, const ImageRGB8& image)
+{
+    std::ofstream file(filePath, std::ios::binary);
+
+    if (!file.is_open())
+    {
+        spdlog::error("Failed to open {} for writing.", filePath);
+        return false;
+    }
+
+    file << "P6\n" << image.width << " " << image.height << "\n255\n";
+    file.write(reinterpret_cast<const char*>(image.pixels.data()), static_cast<std::streamsize>(image.pixels.size()));
+
+    return file.good();
+}
+
+bool ReadPPM(const char* filePath, ImageRGB8& image)
+{
+    std::ifstream file(filePath, std::ios::binary);
+
+    if (!file.is_open())
+    {
+        spdlog::error("Failed to open {}.", filePath);
+        return false;
+    }
+
+    // Reads the next header token, skipping whitespace and comments.
+    auto ReadToken = [&]()
+    {
+        std::string token;
+
+        while (file >> token && token[0] == '#')
+            std::getline(file, token);
+
+        return token;
+    };
+
+    if (ReadToken() != "P6")
+    {
+        spdlog::error("{} is not a binary PPM.", filePath);
+        return false;
+    }
+
+    const std::string width    = ReadToken();
+    const std::string height   = ReadToken();
+    const std::string maxValue = ReadToken();
+
+    if (width.empty() || height.empty() || maxValue != "255")
+    {
+        spdlog::error("{} has an unsupported PPM header.", filePath);
+        return false;
+    }
+
+    // A single whitespace character separates the header from the pixel data.
+    file.get();
+
+    image.Resize(static_cast<uint32_t>(std::stoul(width)), static_cast<uint32_t>(std::stoul(height)));
+
+    file.read(reinterpret_cast<char*>(image.pixels.data()), static_cast<std::streamsize>(image.pixels.size()));
+
+    if (file.gcount() != static_cast<std::streamsize>(image.pixels.size()))
+    {
+        spdlog::error("{} is truncated.", filePath);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,48 @@
+#ifndef ACCELERATION_STRUCTURE_CACHE_H
+#define ACCELERATION_STRUCTURE_CACHE_H
+
+// On-disk cache of serialized bottom-level acceleration structures.
+// ---------------------------------------------------------
+//
+// Entries are keyed by the device + driver UUIDs and a hash of the build inputs (geometry, geometry / build flags and
+// vertex format, see HashMeshContent), the serialized blob itself is validated with
+// vkGetDeviceAccelerationStructureCompatibilityKHR before it is used.
+
+// Build inputs of the static BLASes (device and host builds), hashed into the cache key.
+const VkBuildAccelerationStructureFlagsKHR kBLASBuildFlags    = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
+const VkGeometryFlagsKHR                   kBLASGeometryFlags = VK_GEOMETRY_OPAQUE_BIT_KHR;
+const VkFormat                             kBLASVertexFormat  = VK_FORMAT_R32G32B32_SFLOAT;
+
+// Bump when the build inputs change in a way the content hash doesn't capture (e.g. the layout of Vertex).
+const uint32_t kAccelerationStructureCacheVersion = 2U;
+
+// Size of the serialized blob header: driver UUID, compatibility UUID, serialized size, deserialized size and
+// the count of bottom-level handles that follow it.
+const size_t kSerializedAccelerationStructureHeaderSize = 2U * VK_UUID_SIZE + 3U * sizeof(uint64_t);
+
+class RenderContext;
+
+// Deserializes a serialized bottom-level structure (header included) into a new device acceleration structure of at
+// least minimumSize bytes. Returns false when the blob is malformed or incompatible with the device.
+bool DeserializeAccelerationStructure(RenderContext*              pRenderContext,
+                                      VkCommandPool               vkCommandPool,
+                                      const std::vector<uint8_t>& serializedData,
+                                      VkDeviceSize                minimumSize,
+                                      const std::string&          sourceName,
+                                      AccelerationStructure&      accelerationStructure);
+
+// Deserializes a cached acceleration structure into a new one, returns false on a miss or an incompatible entry.
+bool LoadCachedAccelerationStructure(RenderContext*               pRenderContext,
+                                     VkCommandPool                vkCommandPool,
+                                     const std::filesystem::path& cacheDirectory,
+                                     uint64_t                     contentHash,
+                                     AccelerationStructure&       accelerationStructure);
+
+// Serializes a built acceleration structure to the cache.
+bool StoreCachedAccelerationStructure(RenderContext*               pRenderContext,
+                                      VkCommandPool                vkCommandPool,
+                                      const std::filesystem::path& cacheDirectory,
+                                      uint64_t                     contentHash,
+                                      const AccelerationStructure& accelerationStructure);
+
+#endif
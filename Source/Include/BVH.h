@@ -0,0 +1,116 @@
+#ifndef BVH_H
+#define BVH_H
+
+// Axis-aligned bounding box.
+// ---------------------------------------------------------
+
+struct AABB
+{
+    glm::vec3 min = glm::vec3(FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX);
+
+    inline void Grow(const glm::vec3& point)
+    {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    inline void Grow(const AABB& bounds)
+    {
+        min = glm::min(min, bounds.min);
+        max = glm::max(max, bounds.max);
+    }
+
+    inline bool IsValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+    inline glm::vec3 Centroid() const { return 0.5F * (min + max); }
+
+    inline float SurfaceArea() const
+    {
+        if (!IsValid())
+            return 0.0F;
+
+        const glm::vec3 extent = max - min;
+        return 2.0F * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+    }
+
+    inline float Volume() const
+    {
+        if (!IsValid())
+            return 0.0F;
+
+        const glm::vec3 extent = max - min;
+        return extent.x * extent.y * extent.z;
+    }
+};
+
+inline AABB IntersectAABB(const AABB& a, const AABB& b)
+{
+    AABB intersection;
+    {
+        intersection.min = glm::max(a.min, b.min);
+        intersection.max = glm::min(a.max, b.max);
+    }
+    return intersection;
+}
+
+// Bounds of an AABB after an affine transform (the 8 transformed corners).
+AABB TransformAABB(const AABB& bounds, const glm::mat4& transform);
+
+// Reference binned-SAH bounding volume hierarchy.
+// ---------------------------------------------------------
+
+const uint32_t kBVHBinCount      = 16U;
+const uint32_t kBVHMaxLeafSize   = 4U;
+const float    kBVHTraversalCost = 1.0F;
+const float    kBVHIntersectCost = 1.0F;
+
+struct BVHNode
+{
+    AABB bounds;
+
+    // Index of the left child (the right child follows it) for inner nodes, first primitive for leaves.
+    uint32_t leftFirst;
+    uint32_t primitiveCount;
+
+    inline bool IsLeaf() const { return primitiveCount > 0U; }
+};
+
+struct BVH
+{
+    std::vector<BVHNode> nodes;
+
+    // Leaves reference contiguous ranges of this primitive permutation.
+    std::vector<uint32_t> primitiveIndices;
+};
+
+struct BVHStatistics
+{
+    uint32_t nodeCount       = 0U;
+    uint32_t leafCount       = 0U;
+    uint32_t maxDepth        = 0U;
+    float    averageDepth    = 0.0F;
+    float    averageLeafSize = 0.0F;
+
+    // Expected cost of a random ray that hits the root bounds.
+    float sahCost = 0.0F;
+
+    // Summed surface area of sibling bounds intersections, relative to the root surface area.
+    float siblingOverlap = 0.0F;
+
+    // Mean of (sibling intersection area / parent area) over all inner nodes.
+    float averageSiblingOverlap = 0.0F;
+
+    // Leaf count per depth and per primitive count.
+    std::vector<uint32_t> depthHistogram;
+    std::vector<uint32_t> leafSizeHistogram;
+};
+
+void BuildBVH(const std::vector<AABB>& primitiveBounds, BVH& bvh, uint32_t maxLeafSize = kBVHMaxLeafSize);
+
+BVHStatistics ComputeBVHStatistics(const BVH& bvh);
+
+// Collects the primitives whose bounds overlap the query bounds.
+void QueryBVHOverlaps(const BVH& bvh, const std::vector<AABB>& primitiveBounds, const AABB& queryBounds, std::vector<uint32_t>& overlaps);
+
+#endif
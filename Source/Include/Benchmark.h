@@ -0,0 +1,137 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+// Command-line configuration of the renderer (scene size, resolution, headless runs).
+// ---------------------------------------------------------
+
+struct LaunchOptions
+{
+    RenderContextOptions renderContext;
+
+    // Fixed camera orbit time in seconds, negative animates the camera.
+    float cameraTime = -1.0F;
+
+    // Advance the orbit by a fixed step per frame (from cameraTime), so every run traces the same sequence of views.
+    bool cameraPath = false;
+
+    // Zero keeps the instance count of instance_transforms.obj.
+    uint32_t instanceCount = 0U;
+
+    // Midpoint subdivision levels applied to the mesh before the LODs are generated.
+    uint32_t meshSubdivisions = 0U;
+
+    uint32_t samplesPerPixel = 1U;
+
+    // Initial ray tracing pipeline variant: debug view (0 none, 1 normals, 2 hit distance) and mirror bounces.
+    uint32_t debugView      = 0U;
+    uint32_t maxBounceCount = 0U;
+
+    // Build BLASes on the CPU with deferred host operations (falls back to device builds when unsupported).
+    bool hostBLASBuilds = false;
+
+    // Tone map the output (ACES + sRGB encoding), otherwise the linear trace output is written clamped.
+    bool tonemap = true;
+
+    // Temporal accumulation + a-trous filter of the trace output (see Denoiser.h).
+    bool denoise = false;
+
+    // Primary visibility traced per frame: 0 every pixel, 1 a checkerboard, 2 one pixel per 2x2 quad (see SparseTrace.h).
+    uint32_t sparseTrace = 0U;
+
+    // Animate the full detail mesh with a compute pass and refit its BLAS every frame (see MeshDeformer.h).
+    bool deform = false;
+
+    // Frames excluded from the frame time statistics (pipeline warm-up, clock ramp).
+    uint32_t warmupFrames = 16U;
+
+    // Optional PPM capture of the last frame and JSON benchmark results (headless only).
+    std::string capturePath;
+    std::string resultsPath;
+
+    // Optional Chrome trace of the CPU events and single-shot GPU submissions.
+    std::string tracePath;
+
+    // Recompile the ray tracing shaders when their sources change and swap the pipeline in while running.
+    bool shaderHotReload = false;
+
+    // Offline render split into tiles over every ray tracing capable device (headless, see TileRenderer.h).
+    bool multiDevice = false;
+
+    // Serialized acceleration structures of previous launches, empty disables the cache.
+    std::string cacheDirectory = "Cache";
+};
+
+// Returns false (after logging the reason) on malformed arguments.
+bool ParseLaunchOptions(int argc, char** argv, LaunchOptions& options);
+
+// Collects the timings of a benchmark run and writes them out as JSON.
+// ---------------------------------------------------------
+
+class BenchmarkRecorder
+{
+public:
+
+    // Named one-off CPU timings (startup phases, acceleration structure builds). Thread safe.
+    void RecordTiming(const std::string& name, double milliseconds);
+
+    // CPU frame time plus the raw GPU scope timings of a frame.
+    void RecordFrame(double cpuMilliseconds, const std::map<std::string, double>& gpuScopeMilliseconds);
+
+    void RecordMemory(uint64_t allocatedBytes, uint64_t reservedBytes);
+
+    // Named counts of the run (barriers, passes). Thread safe.
+    void RecordCounter(const std::string& name, uint64_t value);
+
+    // Name of the physical device the run was measured on.
+    void RecordDevice(const std::string& deviceName);
+
+    bool WriteJSON(const char* filePath, const LaunchOptions& options) const;
+
+private:
+
+    mutable std::mutex m_Mutex;
+
+    // Insertion ordered, so the phases read in the order they ran.
+    std::vector<std::pair<std::string, double>> m_Timings;
+
+    std::vector<double>                        m_FrameMilliseconds;
+    std::map<std::string, std::vector<double>> m_GPUScopeMilliseconds;
+
+    uint64_t m_AllocatedBytes = 0U;
+    uint64_t m_ReservedBytes  = 0U;
+
+    std::vector<std::pair<std::string, uint64_t>> m_Counters;
+
+    std::string m_DeviceName;
+};
+
+// Sequential startup phases, traced as CPU events and recorded as benchmark timings. Ends the open phase on
+// destruction, so early returns stay balanced.
+class StartupPhase
+{
+public:
+
+    StartupPhase(BenchmarkRecorder& recorder, const std::string& phaseName);
+    ~StartupPhase();
+
+    StartupPhase(const StartupPhase&)            = delete;
+    StartupPhase& operator=(const StartupPhase&) = delete;
+
+    // Ends the open phase and begins the next one.
+    void Next(const std::string& phaseName);
+    void End();
+
+private:
+
+    BenchmarkRecorder&                             m_Recorder;
+    std::string                                    m_Name;
+    std::chrono::high_resolution_clock::time_point m_TimeBegin;
+    bool                                           m_Open = false;
+};
+
+inline double MillisecondsSince(std::chrono::high_resolution_clock::time_point timeBegin)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - timeBegin).count();
+}
+
+#endif
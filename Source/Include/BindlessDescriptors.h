@@ -0,0 +1,73 @@
+#ifndef BINDLESS_DESCRIPTORS_H
+#define BINDLESS_DESCRIPTORS_H
+
+// Scene resources of every hit, reachable through one update-after-bind descriptor set.
+// ---------------------------------------------------------
+//
+// Geometry buffers and textures are registered once into partially bound arrays and referenced by index from the
+// geometry and material tables, so growing the scene never rewrites a bound set or changes the pipeline layout. Hit
+// shaders look up their geometry record with the instance custom index (layout in Shaders/Bindless.hlsli).
+
+class RenderContext;
+
+const uint32_t kBindlessInvalidIndex = ~0U;
+const uint32_t kMaxBindlessBuffers   = 4096U;
+const uint32_t kMaxBindlessTextures  = 1024U;
+
+// Mirrors the records of Shaders/Bindless.hlsli.
+// ---------------------------------------------------------
+
+struct GeometryRecord
+{
+    uint32_t vertexBufferIndex;
+    uint32_t indexBufferIndex;
+    uint32_t materialIndex;
+    uint32_t padding;
+};
+
+struct MaterialRecord
+{
+    glm::vec4 baseColor;
+    uint32_t  baseColorTextureIndex;
+    uint32_t  padding[3];
+};
+
+class BindlessDescriptors
+{
+public:
+
+    using ResourceIndex = uint32_t;
+
+    // Set layout, pool and the set itself. Requires the descriptor indexing features of Vulkan 1.2.
+    void Create(RenderContext* pRenderContext);
+    void Release(RenderContext* pRenderContext);
+
+    // Both are safe to call from several loader threads, and while the set is bound by in-flight frames.
+    ResourceIndex RegisterBuffer(RenderContext* pRenderContext, const Buffer& buffer);
+    ResourceIndex RegisterTexture(RenderContext* pRenderContext, VkImageView vkImageView);
+
+    // Tables of GeometryRecord and MaterialRecord, indexed by the instance custom index and GeometryRecord::materialIndex.
+    void SetTables(RenderContext* pRenderContext, const Buffer& geometryTable, const Buffer& materialTable);
+
+    inline VkDescriptorSetLayout GetLayout() const { return m_Layout; }
+    inline VkDescriptorSet       GetSet() const { return m_Set; }
+
+    inline uint32_t GetBufferCount() const { return m_BufferCount; }
+    inline uint32_t GetTextureCount() const { return m_TextureCount; }
+
+private:
+
+    void Write(RenderContext* pRenderContext, VkWriteDescriptorSet& vkDescriptorWrite);
+
+    VkDescriptorSetLayout m_Layout  = VK_NULL_HANDLE;
+    VkDescriptorPool      m_Pool    = VK_NULL_HANDLE;
+    VkDescriptorSet       m_Set     = VK_NULL_HANDLE;
+    VkSampler             m_Sampler = VK_NULL_HANDLE;
+
+    // Guards the slot counters and vkUpdateDescriptorSets, which needs the set externally synchronized.
+    std::mutex m_Mutex;
+    uint32_t   m_BufferCount  = 0U;
+    uint32_t   m_TextureCount = 0U;
+};
+
+#endif
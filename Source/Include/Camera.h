@@ -0,0 +1,82 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+// View state of the frame, updated from input after the window events are polled.
+// ---------------------------------------------------------
+//
+// Every update computes the matrices and the primary ray basis once and publishes them into the back half of a double
+// buffer, so command recording only copies the front half and never inverts a matrix.
+
+// Scripted updates advance the orbit by a fixed step instead of the frame time.
+const float kCameraScriptedTimeStep = 1.0F / 60.0F;
+
+const float kCameraMoveSpeed       = 10.0F;  // World units per second, x4 with shift held.
+const float kCameraLookSensitivity = 0.003F; // Radians per cursor pixel.
+const float kCameraMaxPitch        = 1.5F;   // Radians, keeps the view off the poles.
+
+enum class CameraMode : int
+{
+    Orbit    = 0, // Orbit animated by the frame time.
+    Scripted = 1, // Orbit at a start time, advanced by a fixed step per update, so every run sees the same views.
+    Free     = 2  // WASD + QE to move, look around while the right mouse button is held.
+};
+
+struct CameraState
+{
+    glm::mat4 matrixV;
+    glm::mat4 matrixP;
+    glm::mat4 matrixVP;
+    glm::vec3 position;
+
+    // The primary ray through pixel coordinates p (pixel centers at + 0.5) points along
+    // rayCorner + p.x * rayPixelDeltaX + p.y * rayPixelDeltaY, unnormalized.
+    glm::vec3 rayCorner;
+    glm::vec3 rayPixelDeltaX;
+    glm::vec3 rayPixelDeltaY;
+};
+
+class Camera
+{
+public:
+
+    // Publishes the orbit pose at time zero.
+    void Initialize(uint32_t renderWidth, uint32_t renderHeight);
+
+    // Switches to the scripted mode at startTime. A zero time step pins the camera.
+    void SetScriptedPath(float startTime, float timeStep);
+
+    // Entering the free mode starts from the current view.
+    void       SetMode(CameraMode mode);
+    CameraMode GetMode() const { return m_Mode; }
+
+    // Integrates the input (ignored while the user interface captures it, and without a window) over deltaTime, then
+    // publishes the new state. Called once per frame from the thread polling the window events.
+    void Update(GLFWwindow* pWindow, double deltaTime);
+
+    // Latest published state. A reader has until the next Update returns before the half it references is rewritten.
+    inline const CameraState& GetState() const { return m_States[m_FrontState.load(std::memory_order_acquire)]; }
+
+private:
+
+    void UpdateFree(GLFWwindow* pWindow, float deltaTime);
+    void Publish(const glm::mat4& matrixV, const glm::mat4& matrixP);
+
+    CameraMode m_Mode             = CameraMode::Orbit;
+    float      m_Time             = 0.0F;
+    float      m_ScriptedTimeStep = kCameraScriptedTimeStep;
+
+    // Free mode pose.
+    glm::vec3 m_Position   = glm::vec3(0.0F);
+    float     m_Yaw        = 0.0F;
+    float     m_Pitch      = 0.0F;
+    glm::vec2 m_LastCursor = glm::vec2(0.0F);
+    bool      m_LookActive = false;
+
+    uint32_t m_RenderWidth  = 1U;
+    uint32_t m_RenderHeight = 1U;
+
+    std::array<CameraState, 2> m_States {};
+    std::atomic<uint32_t>      m_FrontState = 0U;
+};
+
+#endif
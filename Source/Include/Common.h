@@ -4,6 +4,12 @@
 // Logging + crash utility when an assertion fails.
 // ---------------------------------------------------------
 
+#ifdef _MSC_VER
+#define DEBUG_BREAK() __debugbreak()
+#else
+#define DEBUG_BREAK() std::raise(SIGTRAP)
+#endif
+
 #ifdef _DEBUG
 
 inline void Check(VkResult a, const char* b)
@@ -11,7 +17,7 @@ inline void Check(VkResult a, const char* b)
     if (a != VK_SUCCESS)
     {
         spdlog::critical(std::format("{} - [VkResult: {}]", b, std::to_string(a)));
-        __debugbreak();
+        DEBUG_BREAK();
         exit(a);
     }
 }
@@ -20,7 +26,7 @@ inline void Check(bool a, const char* b)
     if (!a)
     {
         spdlog::critical(b);
-        __debugbreak();
+        DEBUG_BREAK();
         exit(1);
     }
 }
@@ -50,13 +56,25 @@ inline void Check(bool a, const char* b)
 // Profile Macro
 // ---------------------------------------------------------
 
-#ifdef USE_SUPERLUMINAL
-#define PROFILE_START(x) PerformanceAPI_BeginEvent(x, nullptr, PERFORMANCEAPI_MAKE_COLOR(255, 150, 0)) // NOLINT
-#define PROFILE_END      PerformanceAPI_EndEvent()
-#else
-#define PROFILE_START(x)
-#define PROFILE_END
-#endif
+// CPU events recorded by the CPU tracer (see Profiler.h), and forwarded to Superluminal when USE_SUPERLUMINAL is defined.
+void ProfileBeginEvent(const char* eventName);
+void ProfileEndEvent();
+
+struct ProfileScope
+{
+    explicit ProfileScope(const char* eventName) { ProfileBeginEvent(eventName); }
+    ~ProfileScope() { ProfileEndEvent(); }
+
+    ProfileScope(const ProfileScope&)            = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b)       PROFILE_CONCAT_INNER(a, b)
+
+#define PROFILE_START(x) ProfileBeginEvent(x) // NOLINT
+#define PROFILE_END      ProfileEndEvent()
+#define PROFILE_SCOPE(x) const ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(x)
 
 // Common parameters pushed to all shaders.
 // ---------------------------------------------------------
@@ -76,7 +94,9 @@ struct FrameParams
     VkCommandBuffer cmd;
     VkImage         backBuffer;
     VkImageView     backBufferView;
+    uint32_t        backBufferIndex;
     double          deltaTime;
+    uint32_t        frameInFlightIndex;
 };
 
 // Collection of vulkan primitives to hold a buffer.
@@ -99,6 +119,16 @@ struct Image
     VmaAllocation imageAllocation = VK_NULL_HANDLE;
 };
 
+// Acceleration structure handle and the buffer backing it.
+// ---------------------------------------------------------
+
+struct AccelerationStructure
+{
+    VkAccelerationStructureKHR handle        = VK_NULL_HANDLE;
+    Buffer                     backingMemory = {};
+    uint64_t                   deviceAddress = 0U;
+};
+
 // Utility Functions.
 // ---------------------------------------------------------
 
@@ -106,22 +136,58 @@ class RenderContext;
 
 bool CreatePhysicallyBasedMaterialDescriptorLayout(const VkDevice& vkLogicalDevice, VkDescriptorSetLayout& vkDescriptorSetLayout);
 
-bool SelectVulkanPhysicalDevice(const VkInstance& vkInstance, const std::vector<const char*>& requiredExtensions, VkPhysicalDevice& vkPhysicalDevice);
+struct VulkanDeviceRequirements
+{
+    std::vector<const char*> requiredExtensions;
+    std::vector<const char*> optionalExtensions; // Enabled on the selected device when supported.
+
+    // The queue family has to present to GLFW surfaces (off for headless runs).
+    bool presentation = true;
+
+    // Enumeration index or UUID (prefix, hex) of the device to use, empty selects the best scoring one.
+    std::string forcedDevice;
+};
+
+// Scores every device meeting the requirements (CPU implementations included) and selects the best or the forced
+// one. Returns the enumeration index of the selected device, the required extensions plus the supported optional ones
+// to enable, and the enumeration indices of every device that meets the requirements (best first).
+bool SelectVulkanPhysicalDevice(const VkInstance&               vkInstance,
+                                const VulkanDeviceRequirements& requirements,
+                                VkPhysicalDevice&               vkPhysicalDevice,
+                                uint32_t&                       selectedDeviceIndex,
+                                std::vector<const char*>&       enabledExtensions,
+                                std::vector<uint32_t>&          capableDeviceIndices);
 
 bool CreateVulkanLogicalDevice(const VkPhysicalDevice&         vkPhysicalDevice,
                                const std::vector<const char*>& requiredExtensions,
                                uint32_t                        vkGraphicsQueueIndex,
                                VkDevice&                       vkLogicalDevice);
 
+// Shader sources relative to the working directory, compiled modules are in its Compiled folder (shared with hot reload).
+std::filesystem::path GetShaderDirectory();
+
 bool LoadByteCode(const char* filePath, std::vector<char>& byteCode);
 
 void SetDefaultRenderState(VkCommandBuffer commandBuffer);
 
-bool GetVulkanQueueIndices(const VkInstance& vkInstance, const VkPhysicalDevice& vkPhysicalDevice, uint32_t& vkQueueIndexGraphics);
+bool GetVulkanQueueIndices(const VkInstance& vkInstance, const VkPhysicalDevice& vkPhysicalDevice, bool presentation, uint32_t& vkQueueIndexGraphics);
 
 void GetVertexInputLayout(std::vector<VkVertexInputBindingDescription2EXT>& bindings, std::vector<VkVertexInputAttributeDescription2EXT>& attributes);
 
-bool CreateRenderingAttachments(RenderContext* pRenderContext, Image& colorAttachment, Image& depthAttachment);
+// The optional command pool is for callers off the main thread (command pools are externally synchronized).
+bool CreateStorageImage(RenderContext* pRenderContext,
+                        Image&         storageImage,
+                        VkFormat       imageFormat,
+                        const char*    labelName,
+                        VkCommandPool  vkCommandPool = VK_NULL_HANDLE);
+
+// Compute passes binding only storage images (binding i is the i-th image), with a push constant block.
+VkDescriptorSetLayout CreateStorageImageSetLayout(RenderContext* pRenderContext, uint32_t bindingCount);
+
+VkPipelineLayout CreateComputePipelineLayout(RenderContext* pRenderContext, VkDescriptorSetLayout vkDescriptorSetLayout, uint32_t constantsSize);
+
+// Entry point "Main" of the compiled shader.
+VkPipeline CreateComputePipeline(RenderContext* pRenderContext, const char* shaderPath, VkPipelineLayout vkPipelineLayout);
 
 void SingleShotCommandBegin(RenderContext* pRenderContext, VkCommandBuffer& vkCommandBuffer, VkCommandPool vkCommandPool = VK_NULL_HANDLE);
 
@@ -142,7 +208,31 @@ void VulkanColorImageBarrier(VkCommandBuffer       vkCommand,
                              VkPipelineStageFlags2 vkStageSrc,
                              VkPipelineStageFlags2 vkStageDst);
 
+void VulkanMemoryBarrier(VkCommandBuffer       vkCommand,
+                         VkAccessFlags2        vkAccessSrc,
+                         VkAccessFlags2        vkAccessDst,
+                         VkPipelineStageFlags2 vkStageSrc,
+                         VkPipelineStageFlags2 vkStageDst);
+
+// 64-bit FNV-1a of a byte range, chain calls through the seed to hash several ranges.
+const uint64_t kHashSeed = 0xCBF29CE484222325ULL;
+
+uint64_t HashBytes(const void* pData, size_t size, uint64_t seed = kHashSeed);
+
+// Same contract for large ranges (mesh content): four independent multiply-xorshift lanes over 8-byte words, which the
+// compiler pipelines and vectorizes where the byte-serial FNV-1a chain can't. Not interchangeable with HashBytes.
+uint64_t HashBytesWide(const void* pData, size_t size, uint64_t seed = kHashSeed);
+
+// Contents of a JSON string literal for arbitrary text (quotes, backslashes and control characters escaped).
+std::string EscapeJSON(std::string_view text);
+
+// Splits [0, count) into chunks of chunkSize and runs them on all hardware threads, blocks until done. The calling
+// thread is joined by a pool of helper threads that persists between calls.
+void ParallelFor(uint32_t count, uint32_t chunkSize, const std::function<void(uint32_t chunkIndex, uint32_t begin, uint32_t end)>& chunkFunc);
+
 void InitializeUserInterface(RenderContext* pRenderContext);
+
+// Expects the back buffer in the color attachment layout and transitions it for presentation.
 void DrawUserInterface(RenderContext* pRenderContext, uint32_t swapChainImageIndex, VkCommandBuffer cmd, const std::function<void()>& interfaceFunc);
 
 #endif
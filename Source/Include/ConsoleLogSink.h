@@ -0,0 +1,56 @@
+#ifndef CONSOLE_LOG_SINK_H
+#define CONSOLE_LOG_SINK_H
+
+// Keeps the latest log lines for the in-app console in a fixed ring, without locks.
+// ---------------------------------------------------------
+//
+// Every message claims the next line index with one atomic increment and publishes its slot through a sequence number
+// (a per-slot seqlock), so loader threads never wait on each other or on the UI; a writer that finds its slot still
+// claimed by another writer drops its line. Readers address lines by index and skip a line that was overwritten while
+// they copied it. Lines are formatted as "[level] message" (the logger pattern is ignored) and truncated to
+// kConsoleLogLineLength.
+
+const uint32_t kConsoleLogLineCount  = 1024U; // Power of two.
+const uint32_t kConsoleLogLineLength = 256U;
+
+class ConsoleLogSink final : public spdlog::sinks::sink
+{
+public:
+
+    struct Line
+    {
+        spdlog::level::level_enum               level  = spdlog::level::info;
+        uint32_t                                length = 0U;
+        std::array<char, kConsoleLogLineLength> text {};
+    };
+
+    void log(const spdlog::details::log_msg& msg) override;
+    void flush() override {}
+    void set_pattern(const std::string&) override {}
+    void set_formatter(std::unique_ptr<spdlog::formatter>) override {}
+
+    // Lines logged so far, the last kConsoleLogLineCount of them are still in the ring (the latest may be mid-write).
+    inline uint64_t GetLineCount() const { return m_LineCount.load(std::memory_order_acquire); }
+
+    // False when the line is not written yet or was overwritten by a newer one.
+    bool ReadLine(uint64_t lineIndex, Line& line) const;
+
+private:
+
+    // The line is stored as atomic words so readers can copy it while a writer overwrites the slot.
+    static constexpr uint32_t kSlotWordCount = sizeof(Line) / sizeof(uint64_t);
+
+    static_assert(sizeof(Line) % sizeof(uint64_t) == 0U && std::is_trivially_copyable_v<Line>);
+
+    struct Slot
+    {
+        // 2 * index + 1 while line index is written, 2 * index + 2 once it is complete.
+        std::atomic<uint64_t>                              sequence = 0U;
+        std::array<std::atomic<uint64_t>, kSlotWordCount> words    {};
+    };
+
+    std::atomic<uint64_t>                  m_LineCount = 0U;
+    std::array<Slot, kConsoleLogLineCount> m_Slots;
+};
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef DENOISER_H
+#define DENOISER_H
+
+// Spatio-temporal denoiser for the low sample count trace output, after SVGF.
+// ---------------------------------------------------------
+//
+// Shaders/DenoiseTemporal.hlsl follows the motion vectors of the trace into the previous frame and blends every
+// primary hit with the color history wherever the normal and hit distance agree, accumulating the first two luminance
+// moments for a per-pixel variance estimate. Shaders/DenoiseFilter.hlsl then runs a few iterations of an edge-aware
+// a-trous wavelet filter: a 5x5 B3 spline kernel with holes doubling per iteration, stopped at normal and plane
+// distance discontinuities and at luminance differences large compared to the variance. Without filter iterations the
+// accumulated color is written straight back. The history images are persistent and ping-pong between frames, the
+// temporally accumulated color is what feeds back.
+
+class RenderContext;
+class GPUProfiler;
+struct CameraState;
+
+const uint32_t kDenoiseMaxFilterIterations = 5U;
+
+// Frames the primary sample sequence cycles through while the history accumulates.
+const uint32_t kTemporalJitterFrameCount = 16U;
+
+struct DenoiserSettings
+{
+    bool     enabled          = false;
+    uint32_t filterIterations = 4U;     // Zero only accumulates over time.
+    float    colorAlpha       = 0.2F;   // Lowest weight of the current frame in the color history.
+    float    momentsAlpha     = 0.2F;   // Same for the luminance moments.
+    float    phiColor         = 4.0F;   // Luminance edge-stopping, in standard deviations.
+    float    phiNormal        = 128.0F; // Exponent of the normal similarity.
+    float    phiDepth         = 1.0F;   // Plane distance edge-stopping, in pixel footprints at the hit.
+};
+
+// Mirrors the constants of Shaders/DenoiseTemporal.hlsl.
+struct DenoiseTemporalConstants
+{
+    glm::vec4 previousRayOrigin;
+    float     colorAlpha;
+    float     momentsAlpha;
+    uint32_t  historyValid;
+    uint32_t  resolveToColor;
+};
+
+// Mirrors the constants of Shaders/DenoiseFilter.hlsl.
+struct DenoiseFilterConstants
+{
+    uint32_t stepSize;
+    float    phiColor;
+    float    phiNormal;
+    float    phiDepth;
+    float    pixelFootprint; // Pixel size at unit distance along the view direction.
+};
+
+class Denoiser
+{
+public:
+
+    // Graph handles of the frame images the passes read and write.
+    struct FrameResources
+    {
+        RenderGraph::ResourceHandle color;
+        RenderGraph::ResourceHandle position;
+        RenderGraph::ResourceHandle normal;
+        RenderGraph::ResourceHandle motion;
+        RenderGraph::ResourceHandle scratch; // Same format as the color image.
+    };
+
+    // Creates the history images and pipelines, and binds the frame images (render resolution). Called the first time
+    // the denoiser is enabled. The optional command pool is for callers off the main thread, as for CreateStorageImage.
+    void Create(RenderContext* pRenderContext,
+                const Image&   color,
+                const Image&   position,
+                const Image&   normal,
+                const Image&   motion,
+                const Image&   scratch,
+                VkCommandPool  vkCommandPool = VK_NULL_HANDLE);
+    void Release(RenderContext* pRenderContext); // Also when it was never created.
+
+    inline bool IsCreated() const { return m_TemporalPipeline != VK_NULL_HANDLE; }
+
+    // Imports the history images, once after Create.
+    void Import(RenderGraph& renderGraph);
+
+    // Adds the temporal pass and the filter iterations, which leave the denoised color in the color image.
+    void AddPasses(RenderGraph&            renderGraph,
+                   const FrameResources&   frameResources,
+                   const CameraState&      camera,
+                   const DenoiserSettings& settings,
+                   GPUProfiler&            profiler);
+
+    // The next frame starts accumulating from scratch (e.g. after frames were rendered without the denoiser).
+    inline void ResetHistory() { m_HistoryValid = false; }
+
+private:
+
+    // Two sets of history images, written on alternate frames. The graph orders every frame after the one it reads
+    // the history of, so two are enough for any number of frames in flight.
+    struct History
+    {
+        Image color {};   // Accumulated color, variance in alpha.
+        Image moments {}; // Luminance moments, history length in z.
+        Image normalDepth {};
+
+        RenderGraph::ResourceHandle graphColor;
+        RenderGraph::ResourceHandle graphMoments;
+        RenderGraph::ResourceHandle graphNormalDepth;
+    };
+
+    VkDescriptorSet AllocateSet(RenderContext* pRenderContext, VkDescriptorSetLayout vkLayout, const std::vector<VkImageView>& imageViews);
+
+    std::array<History, 2> m_History;
+
+    uint32_t m_HistoryIndex = 0U; // Written by the next frame.
+    bool     m_HistoryValid = false;
+
+    // Camera position of the frame the history was written with, its hit distances are relative to it.
+    glm::vec3 m_PreviousRayOrigin = glm::vec3(0.0F);
+
+    uint32_t m_Width  = 0U;
+    uint32_t m_Height = 0U;
+
+    VkDescriptorSetLayout m_TemporalSetLayout      = VK_NULL_HANDLE;
+    VkPipelineLayout      m_TemporalPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline            m_TemporalPipeline       = VK_NULL_HANDLE;
+
+    VkDescriptorSetLayout m_FilterSetLayout      = VK_NULL_HANDLE;
+    VkPipelineLayout      m_FilterPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline            m_FilterPipeline       = VK_NULL_HANDLE;
+
+    VkDescriptorPool m_DescriptorPool = VK_NULL_HANDLE;
+
+    // Temporal sets by the history index they write.
+    std::array<VkDescriptorSet, 2> m_TemporalSets {};
+
+    // Filter sets by source and destination, the first iteration reads the color history written this frame.
+    std::array<VkDescriptorSet, 2> m_FilterHistoryToColorSets {};
+    std::array<VkDescriptorSet, 2> m_FilterHistoryToScratchSets {};
+    VkDescriptorSet                m_FilterColorToScratchSet = VK_NULL_HANDLE;
+    VkDescriptorSet                m_FilterScratchToColorSet = VK_NULL_HANDLE;
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef GEOMETRY_REGISTRY_H
+#define GEOMETRY_REGISTRY_H
+
+// Meshes keyed by the content of their vertex + index data.
+// ---------------------------------------------------------
+//
+// Identical content (the same mesh behind several files or transforms, a LOD that simplifies to the one above it)
+// maps to one pair of device buffers, one pair of bindless slots and one BLAS, which every TLAS instance of it
+// references by device address. Entries are reference counted: the first reference creates the resources, the last
+// one destroys them. A hash match is only shared after the content compares equal, which is why the registry keeps a
+// copy of it until loading is done. The content hash also keys the acceleration structure cache.
+
+class RenderContext;
+
+struct Mesh
+{
+    Buffer                vertexBuffer;
+    Buffer                indexBuffer;
+    uint32_t              vertexCount;
+    uint32_t              indexCount;
+    BoundingSphere        bounds;
+    AccelerationStructure blas;
+
+    // Slots of the vertex + index buffers in the bindless set.
+    BindlessDescriptors::ResourceIndex vertexBufferIndex;
+    BindlessDescriptors::ResourceIndex indexBufferIndex;
+
+    // Hash of the BLAS build inputs, keys the registry and the acceleration structure cache.
+    uint64_t contentHash;
+
+    // Another mesh has the same content hash, so the acceleration structure cache can't tell them apart.
+    bool hashCollision;
+
+    // CPU copy of the geometry for host builds, released once the BLAS is built.
+    std::vector<Vertex>   hostVertices;
+    std::vector<uint32_t> hostIndices;
+};
+
+// Content hash of a mesh, versioned with the acceleration structure cache.
+uint64_t HashMeshContent(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+
+class GeometryRegistry
+{
+public:
+
+    using GeometryHandle = uint32_t;
+
+    // Adds a reference to the geometry with the content, and returns true when it is the first: the caller then
+    // creates the buffers and the BLAS of the mesh before any other reference reads them (the task graph orders it).
+    // Safe to call from several loader threads.
+    bool Acquire(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, GeometryHandle& geometry);
+
+    // Drops the content copies once nothing more is acquired, later acquisitions never share geometry.
+    void ReleaseContent();
+
+    // Drops a reference, the last one destroys the buffers and the BLAS. Their bindless slots stay allocated.
+    void Release(RenderContext* pRenderContext, GeometryHandle geometry);
+
+    // Stable for the lifetime of the geometry, also while other threads acquire.
+    Mesh& GetMesh(GeometryHandle geometry);
+
+    // Geometry alive, and the references to it.
+    uint32_t GetGeometryCount();
+    uint32_t GetReferenceCount();
+
+private:
+
+    struct Geometry
+    {
+        Mesh     mesh {};
+        uint32_t referenceCount = 0U;
+
+        // Compared on hash matches.
+        std::vector<Vertex>   vertices;
+        std::vector<uint32_t> indices;
+    };
+
+    // Deque, so references to the meshes survive the insertions. Colliding hashes have several entries.
+    std::mutex                                        m_Mutex;
+    std::deque<Geometry>                              m_Geometry;
+    std::unordered_multimap<uint64_t, GeometryHandle> m_HandlesByContent;
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef IMAGE_IO_H
+#define IMAGE_IO_H
+
+// Tightly packed 8-bit RGB host image, used to exchange frames between the renderer and the offline tools.
+// ---------------------------------------------------------
+
+struct ImageRGB8
+{
+    uint32_t             width  = 0U;
+    uint32_t             height = 0U;
+    std::vector<uint8_t> pixels;
+
+    inline void Resize(uint32_t imageWidth, uint32_t imageHeight)
+    {
+        width  = imageWidth;
+        height = imageHeight;
+        pixels.assign(3U * static_cast<size_t>(width) * height, 0U);
+    }
+
+    inline uint8_t* GetPixel(uint32_t x, uint32_t y) { return pixels.data() + 3U * (static_cast<size_t>(y) * width + x); }
+    inline const uint8_t* GetPixel(uint32_t x, uint32_t y) const { return pixels.data() + 3U * (static_cast<size_t>(y) * width + x); }
+};
+
+// Converts a linear [0, 1] color the same way a UNORM attachment stores it.
+inline uint8_t QuantizeUNORM8(float value)
+{
+    return static_cast<uint8_t>(std::clamp(value, 0.0F, 1.0F) * 255.0F + 0.5F);
+}
+
+// Binary (P6) portable pixmaps.
+// ---------------------------------------------------------
+
+bool WritePPM(const char* filePath, const ImageRGB8& image);
+
+bool ReadPPM(const char* filePath, ImageRGB8& image);
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef MESH_DEFORMER_H
+#define MESH_DEFORMER_H
+
+// Animated copy of a mesh: deformed by a compute pass every frame, its BLAS refit from the one of the previous frame.
+// ---------------------------------------------------------
+//
+// Shaders/DeformVertices.hlsl displaces the rest pose along its normals with a wave travelling across the mesh (normals
+// are carried over from the rest pose, the displacement is a few percent of the bounds), and writes the result into the
+// deformed vertex buffer that the BLAS and the hit shaders read. Every frame in flight has its own vertex buffer, BLAS
+// and scratch, so a frame deforms and refits while the previous one is still traced. The BLAS allows updates: most
+// frames refit the BLAS of the previous frame into their own (VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR), which
+// keeps the tree of the last full build and only grows its boxes, so its quality drops as the vertices drift from the
+// pose it was built for. The deform pass measures that drift
+// (the largest vertex distance to the build pose, relative to the bounding radius) and reads it back a few frames later,
+// a full rebuild follows once it passes the threshold or after a maximum number of refits in a row. Every instance of
+// the mesh shares the deformed BLAS; the instance bounds used for culling stay those of the rest pose.
+
+class RenderContext;
+class GPUProfiler;
+
+struct DeformationSettings
+{
+    bool     enabled      = false;
+    float    amplitude    = 0.05F; // Displacement along the normal, relative to the bounding radius.
+    float    frequency    = 6.0F;  // Wave number across the bounding radius.
+    float    speed        = 3.0F;  // Radians per second.
+    float    rebuildDrift = 0.04F; // Largest vertex drift from the build pose, relative to the bounding radius.
+    uint32_t maxRefits    = 120U;  // Refits in a row before a rebuild regardless of the drift.
+};
+
+// Mirrors the constants of Shaders/DeformVertices.hlsl.
+struct DeformVerticesConstants
+{
+    glm::vec4 boundsCenterRadius;
+    float     time;
+    float     buildTime; // Time of the pose the BLAS was last built from.
+    float     amplitude;
+    float     frequency;
+    float     speed;
+    uint32_t  vertexCount;
+};
+
+class MeshDeformer
+{
+public:
+
+    // Creates the deformed vertex buffers (registered in the bindless set) and the BLAS objects of every frame in
+    // flight. Called the first time deformation is enabled, nothing is built until the first frame that deforms.
+    void Create(RenderContext* pRenderContext, const Mesh& restMesh, BindlessDescriptors& bindlessDescriptors);
+    void Release(RenderContext* pRenderContext); // Also when it was never created.
+
+    inline bool IsCreated() const { return m_Pipeline != VK_NULL_HANDLE; }
+
+    // Imports the deformed vertex buffers and the BLAS, once after Create.
+    void Import(RenderGraph& renderGraph);
+
+    // Adds the deform pass and the BLAS refit (or rebuild) at the given animation time. The frame slot selects the
+    // drift read back, whose fence was waited on.
+    void AddPasses(RenderGraph& renderGraph, const DeformationSettings& settings, float time, uint32_t frameInFlightIndex, GPUProfiler& profiler);
+
+    // Graph handles of a frame slot, for the TLAS build (reads the BLAS) and the trace (reads the vertices).
+    inline RenderGraph::ResourceHandle GetGraphBLAS(uint32_t frameInFlightIndex) const { return m_GraphBLAS.at(frameInFlightIndex); }
+    inline RenderGraph::ResourceHandle GetGraphVertices(uint32_t frameInFlightIndex) const { return m_GraphVertices.at(frameInFlightIndex); }
+
+    inline uint64_t GetBLASDeviceAddress(uint32_t frameInFlightIndex) const { return m_BLAS.at(frameInFlightIndex).deviceAddress; }
+    inline BindlessDescriptors::ResourceIndex GetVertexBufferIndex(uint32_t frameInFlightIndex) const
+    {
+        return m_VertexBufferIndices.at(frameInFlightIndex);
+    }
+
+    // Last drift read back, and the refits / rebuilds recorded so far.
+    inline float    GetDrift() const { return m_Drift; }
+    inline uint32_t GetRefitCount() const { return m_TotalRefitCount; }
+    inline uint32_t GetRebuildCount() const { return m_TotalRebuildCount; }
+
+    // The next frame that deforms rebuilds (e.g. after frames were rendered without deformation).
+    inline void ResetBLAS() { m_Built = false; }
+
+private:
+
+    void RecordBuild(VkCommandBuffer vkCommand, uint32_t frameInFlightIndex, uint32_t sourceFrameIndex, bool update);
+
+    RenderContext* m_pRenderContext = nullptr;
+
+    // Owned by the geometry registry, which outlives the deformer.
+    const Mesh* m_pRestMesh = nullptr;
+
+    // By frame slot.
+    std::array<Buffer, kMaxFramesInFlight>                             m_Vertices {};
+    std::array<BindlessDescriptors::ResourceIndex, kMaxFramesInFlight> m_VertexBufferIndices {};
+
+    std::array<AccelerationStructure, kMaxFramesInFlight> m_BLAS {};
+    std::array<Buffer, kMaxFramesInFlight>                m_Scratch {}; // Sized for both builds and updates.
+
+    uint32_t m_SourceFrameIndex = 0U; // Slot of the BLAS the next refit starts from.
+
+    // Host visible, one per frame in flight: the drift measured by that frame (float bits) and the build it refers to.
+    std::array<Buffer, kMaxFramesInFlight>    m_DriftBuffers {};
+    std::array<uint32_t*, kMaxFramesInFlight> m_DriftMappings {};
+    std::array<uint32_t, kMaxFramesInFlight>  m_DriftBuildIndices {};
+
+    bool     m_Built        = false;
+    uint32_t m_BuildIndex   = 0U; // Counts the full builds.
+    float    m_BuildTime    = 0.0F;
+    uint32_t m_RefitsInARow = 0U;
+    float    m_Drift        = 0.0F;
+
+    uint32_t m_TotalRefitCount   = 0U;
+    uint32_t m_TotalRebuildCount = 0U;
+
+    std::array<RenderGraph::ResourceHandle, kMaxFramesInFlight> m_GraphVertices {};
+    std::array<RenderGraph::ResourceHandle, kMaxFramesInFlight> m_GraphBLAS {};
+
+    VkDescriptorSetLayout m_SetLayout      = VK_NULL_HANDLE;
+    VkPipelineLayout      m_PipelineLayout = VK_NULL_HANDLE;
+    VkPipeline            m_Pipeline       = VK_NULL_HANDLE;
+
+    VkDescriptorPool m_DescriptorPool = VK_NULL_HANDLE;
+
+    // Sets by the frame slot, which selects the drift buffer.
+    std::array<VkDescriptorSet, kMaxFramesInFlight> m_Sets {};
+};
+
+#endif
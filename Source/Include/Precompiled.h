@@ -23,9 +23,28 @@
 #include <spdlog/sinks/ostream_sink.h> // For imgui.
 #include <spdlog/spdlog.h>
 
+#include <bit>
+#include <condition_variable>
+#include <csignal>
+#include <deque>
 #include <filesystem>
+#include <format>
 #include <fstream>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <set>
+#include <unordered_map>
+
+#ifdef _MSC_VER
 #include <intrin.h>
+#endif
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
 
 // Imgui Includes
 // ---------------------------------------------------------
@@ -38,6 +57,7 @@
 // GLM Includes
 // ---------------------------------------------------------
 
+#include <glm/gtc/matrix_access.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/mat4x4.hpp>
@@ -0,0 +1,127 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// GPU timestamp profiler for named scopes recorded into the frame command buffers.
+// ---------------------------------------------------------
+
+const uint32_t kMaxGPUProfilerScopes = 32U;
+
+// Timestamp pairs available to single-shot submissions in flight at once.
+const uint32_t kMaxSingleShotQueries = 64U;
+
+class RenderContext;
+
+class GPUProfiler
+{
+public:
+
+    void Create(RenderContext* pRenderContext, uint32_t frameCount);
+    void Release(RenderContext* pRenderContext);
+
+    // Collects the timings of the last submission that used this frame-in-flight slot and resets its queries.
+    // Must be called after the frame fence for the slot was waited on.
+    void BeginFrame(VkCommandBuffer cmd, uint32_t frameInFlightIndex);
+
+    void BeginScope(VkCommandBuffer cmd, const char* scopeName);
+    void EndScope(VkCommandBuffer cmd);
+
+    // Smoothed GPU duration of a named scope in milliseconds (zero if the scope was never recorded).
+    double GetScopeMilliseconds(const std::string& scopeName) const;
+
+    inline const std::map<std::string, double>& GetScopes() const { return m_ScopeMilliseconds; }
+
+    // Unsmoothed GPU durations of the most recently resolved frame (for benchmarking).
+    inline const std::map<std::string, double>& GetLastFrameScopes() const { return m_LastFrameScopeMilliseconds; }
+
+    // Timestamps around a single-shot command buffer (uploads, acceleration structure builds), independent of the
+    // frame scopes so it can be used from the loader thread. Returns the query slot to resolve.
+    uint32_t BeginSingleShot(VkCommandBuffer cmd);
+    void     EndSingleShot(VkCommandBuffer cmd, uint32_t querySlot);
+
+    // Must be called after the single-shot submission completed (zero if the results are unavailable).
+    double ResolveSingleShotMilliseconds(uint32_t querySlot);
+
+private:
+
+    struct Scope
+    {
+        std::string name;
+        uint32_t    queryBegin;
+        uint32_t    queryEnd;
+    };
+
+    VkDevice    m_VKDevice          = VK_NULL_HANDLE;
+    VkQueryPool m_VKQueryPool       = VK_NULL_HANDLE;
+    double      m_TimestampPeriodNs = 1.0;
+
+    VkQueryPool           m_VKSingleShotQueryPool = VK_NULL_HANDLE;
+    std::atomic<uint32_t> m_NextSingleShotSlot    = 0U;
+
+    uint32_t m_FrameInFlightIndex = 0U;
+    uint32_t m_FrameQueryCount    = 0U;
+
+    std::vector<std::vector<Scope>> m_FrameScopes;
+    std::vector<uint32_t>           m_OpenScopes;
+
+    std::map<std::string, double> m_ScopeMilliseconds;
+    std::map<std::string, double> m_LastFrameScopeMilliseconds;
+};
+
+// CPU scope tracer, written out in the Chrome trace event format (chrome://tracing, ui.perfetto.dev).
+// ---------------------------------------------------------
+
+// Caps the memory of long interactive sessions, later events are dropped.
+const uint32_t kMaxCPUTraceEvents = 1U << 20U;
+
+// Thread id of the GPU track in the trace.
+const uint32_t kCPUTracerGPUThreadId = 0U;
+
+class CPUTracer
+{
+public:
+
+    static CPUTracer& Get();
+
+    // Nothing is recorded until enabled, scopes only cost a flag check until then.
+    inline void Enable() { m_Enabled.store(true); }
+    inline bool IsEnabled() const { return m_Enabled.load(std::memory_order_relaxed); }
+
+    // Labels the track of the calling thread.
+    void SetThreadName(const char* threadName);
+
+    void BeginEvent(const char* eventName);
+    void EndEvent();
+
+    // Name of the innermost open event on the calling thread (nullptr outside of any event).
+    const char* GetCurrentEventName() const;
+
+    // GPU work goes on its own track. Without calibrated timestamps it is placed at its CPU submission time.
+    void RecordGPUEvent(const char* eventName, std::chrono::high_resolution_clock::time_point submitTime, double gpuMilliseconds);
+
+    bool WriteChromeTrace(const char* filePath) const;
+
+private:
+
+    struct Event
+    {
+        std::string name;
+        double      beginUs;
+        double      durationUs;
+        uint32_t    threadId;
+    };
+
+    uint32_t GetThreadId();
+    double   MicrosecondsSinceEpoch(std::chrono::high_resolution_clock::time_point timePoint) const;
+    void     PushEvent(Event&& event);
+
+    std::atomic<bool>     m_Enabled      = false;
+    std::atomic<uint32_t> m_NextThreadId = 1U;
+
+    const std::chrono::high_resolution_clock::time_point m_Epoch = std::chrono::high_resolution_clock::now();
+
+    mutable std::mutex              m_Mutex;
+    std::vector<Event>              m_Events;
+    std::map<uint32_t, std::string> m_ThreadNames;
+};
+
+#endif
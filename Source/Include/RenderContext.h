@@ -9,18 +9,44 @@ const uint32_t kWindowHeight      = 1080U; // NOLINT
 const uint32_t kMaxFramesInFlight = 3U;
 
 struct FrameParams;
+struct ImageRGB8;
 class Scene;
 
+struct RenderContextOptions
+{
+    uint32_t width  = kWindowWidth;
+    uint32_t height = kWindowHeight;
+
+    // Render into offscreen back buffers instead of an OS window + swapchain (no GLFW, no UI).
+    bool headless = false;
+
+    // Number of frames to dispatch before returning, zero runs until the window is closed.
+    uint32_t frameCount = 0U;
+
+    // Enumeration index or UUID of the physical device, empty picks the best scoring one.
+    std::string device;
+
+    // Load the device functions through the loader instead of for this device, required when several contexts are alive
+    // at once (multi-device renders). Contexts have to be created one at a time either way.
+    bool sharedDispatch = false;
+};
+
 class RenderContext
 {
 public:
 
-    RenderContext(uint32_t windowWidth, uint32_t windowHeight);
+    explicit RenderContext(const RenderContextOptions& options);
     ~RenderContext();
 
-    // Dispatch a render loop into the OS window, invoking a provided command recording callback
-    // each frame.
-    void Dispatch(const std::function<void(FrameParams)>& commandsFunc, const std::function<void()>& interfaceFunc);
+    // Dispatch a render loop into the OS window (or the offscreen back buffers), invoking a provided command
+    // recording callback each frame. The input callback runs at the end of every frame, after the window events are
+    // polled, with the duration of that frame.
+    void Dispatch(const std::function<void(FrameParams)>& commandsFunc,
+                  const std::function<void()>&            interfaceFunc,
+                  const std::function<void(double)>&      inputFunc);
+
+    // Reads back the back buffer of the last dispatched frame (headless only).
+    bool CaptureLastFrame(ImageRGB8& image);
 
     inline VkInstance&       GetInstance() { return m_VKInstance; }
     inline VkDevice&         GetDevice() { return m_VKDeviceLogical; }
@@ -32,18 +58,47 @@ public:
     inline VkCommandPool&    GetCommandPool() { return m_VKCommandPool; }
     inline VkDescriptorPool& GetDescriptorPool() { return m_VKDescriptorPool; }
     inline GLFWwindow*       GetWindow() { return m_Window; }
+    inline GPUProfiler&      GetGPUProfiler() { return m_GPUProfiler; }
+    inline bool              IsHeadless() const { return m_Options.headless; }
+    inline uint32_t          GetRenderWidth() const { return m_Options.width; }
+    inline uint32_t          GetRenderHeight() const { return m_Options.height; }
+
+    inline const std::string& GetDeviceName() const { return m_DeviceName; }
+
+    // Enumeration index of the selected physical device, which is the best capable one unless another was forced.
+    inline uint32_t GetDeviceIndex() const { return m_DeviceIndex; }
+
+    // Enumeration indices of every physical device meeting the requirements, best first.
+    inline const std::vector<uint32_t>& GetCapableDeviceIndices() const { return m_CapableDeviceIndices; }
+
+    // Optional device extensions are only enabled when the selected device supports them.
+    bool IsDeviceExtensionEnabled(const char* pExtensionName) const;
+
+    // Back buffers that can be written directly as storage images (otherwise the output has to be blitted).
+    inline bool     IsBackBufferStorage() const { return m_BackBufferStorage; }
+    inline uint32_t GetSwapchainImageCount() const { return static_cast<uint32_t>(m_VKSwapchainImages.size()); }
 
     inline const VkImage&     GetSwapchainImage(uint32_t swapChainImageIndex) { return m_VKSwapchainImages.at(swapChainImageIndex); }
     inline const VkImageView& GetSwapchainImageView(uint32_t swapChainImageIndex) { return m_VKSwapchainImageViews.at(swapChainImageIndex); }
 
 private:
 
+    void CreateSwapchain();
+    void CreateHeadlessBackBuffers();
+
+    RenderContextOptions m_Options;
+
     VkInstance       m_VKInstance        = VK_NULL_HANDLE;
     VkPhysicalDevice m_VKDevicePhysical  = VK_NULL_HANDLE;
     VkDevice         m_VKDeviceLogical   = VK_NULL_HANDLE;
     VkDescriptorPool m_VKDescriptorPool  = VK_NULL_HANDLE;
     VmaAllocator     m_VKMemoryAllocator = VK_NULL_HANDLE;
-    GLFWwindow*      m_Window;
+    GLFWwindow*      m_Window            = nullptr;
+
+    std::vector<const char*> m_EnabledDeviceExtensions;
+    uint32_t                 m_DeviceIndex = 0U;
+    std::vector<uint32_t>    m_CapableDeviceIndices;
+    std::string              m_DeviceName;
 
     // Command Primitives
     VkCommandPool m_VKCommandPool       = VK_NULL_HANDLE;
@@ -53,11 +108,19 @@ private:
     // For multi-threaded queue submissions
     std::mutex m_VKCommandQueueMutex;
 
+    // GPU timestamps for the frame command buffers.
+    GPUProfiler m_GPUProfiler;
+
     // Swapchain Primitives
     VkSwapchainKHR           m_VKSwapchain = VK_NULL_HANDLE;
     VkSurfaceKHR             m_VKSurface   = VK_NULL_HANDLE;
     std::vector<VkImage>     m_VKSwapchainImages;
     std::vector<VkImageView> m_VKSwapchainImageViews;
+    bool                     m_BackBufferStorage = false;
+
+    // Offscreen back buffers standing in for the swapchain images in headless mode.
+    std::vector<VmaAllocation> m_HeadlessImageAllocations;
+    uint32_t                   m_LastBackBufferIndex = 0U;
 
     // Frame Primitives
     std::array<VkCommandBuffer, kMaxFramesInFlight> m_VKCommandBuffers {};
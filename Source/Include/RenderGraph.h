@@ -0,0 +1,116 @@
+#ifndef RENDER_GRAPH_H
+#define RENDER_GRAPH_H
+
+// Passes declare how they use each resource, the graph derives the barriers between them.
+// ---------------------------------------------------------
+//
+// Resources are imported once and their state is tracked across frames, so a pass only waits on whatever touched the
+// resource last (the previous frame included). The barriers needed before a pass are batched into one
+// vkCmdPipelineBarrier2: layout transitions as image barriers, every other dependency folded into a single memory barrier.
+
+class TransientImageAllocator;
+
+class RenderGraph
+{
+public:
+
+    using ResourceHandle = uint32_t;
+
+    struct ResourceState
+    {
+        VkImageLayout         layout = VK_IMAGE_LAYOUT_UNDEFINED; // Ignored for buffers.
+        VkAccessFlags2        access = VK_ACCESS_2_NONE;
+        VkPipelineStageFlags2 stage  = VK_PIPELINE_STAGE_2_NONE;
+    };
+
+    struct ResourceUsage
+    {
+        ResourceHandle resource;
+        ResourceState  state;
+    };
+
+    // Counters of the last executed frame.
+    struct Statistics
+    {
+        uint32_t passCount          = 0U;
+        uint32_t culledPassCount    = 0U;
+        uint32_t barrierBatchCount  = 0U;
+        uint32_t imageBarrierCount  = 0U;
+        uint32_t memoryBarrierCount = 0U;
+    };
+
+    ResourceHandle ImportImage(const std::string&   resourceName,
+                               VkImage              vkImage,
+                               const ResourceState& state,
+                               VkImageAspectFlags   vkAspectMask = VK_IMAGE_ASPECT_COLOR_BIT);
+
+    // Buffers and acceleration structures, which only need execution and memory dependencies.
+    ResourceHandle ImportBuffer(const std::string& resourceName, const ResourceState& state = {});
+
+    // Imports every image of the allocator, in its handle order. Transient images are discarded at their first use in
+    // a frame, which also waits on the last use of the images aliasing their memory.
+    std::vector<ResourceHandle> ImportTransientImages(const TransientImageAllocator& transientImages);
+
+    // Rebinds an imported image and overrides its tracked state (e.g. the swapchain image acquired this frame).
+    void ResetImage(ResourceHandle resource, VkImage vkImage, const ResourceState& state);
+
+    // Usages with write access make the pass a producer of the resource, the rest are reads.
+    void AddPass(const std::string& passName, std::vector<ResourceUsage> usages, std::function<void(VkCommandBuffer)> recordFunc);
+
+    // Leaves the resource in the given state at the end of the frame, its producers are never culled.
+    void Export(ResourceHandle resource, const ResourceState& state);
+
+    // Culls the passes whose output is never consumed, records the rest behind their barriers and clears the frame.
+    void Execute(VkCommandBuffer vkCommand);
+
+    inline const Statistics& GetStatistics() const { return m_Statistics; }
+
+private:
+
+    struct Resource
+    {
+        std::string        name;
+        VkImage            image      = VK_NULL_HANDLE;
+        VkImageAspectFlags aspectMask = 0x0;
+
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        // Last write, and the stages + accesses it was already made visible to.
+        VkPipelineStageFlags2 writeStage    = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2        writeAccess   = VK_ACCESS_2_NONE;
+        VkPipelineStageFlags2 visibleStages = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2        visibleAccess = VK_ACCESS_2_NONE;
+
+        // Reads since the last write, which the next write has to wait on.
+        VkPipelineStageFlags2 readStages = VK_PIPELINE_STAGE_2_NONE;
+
+        bool                        transient = false;
+        std::vector<ResourceHandle> aliases;
+    };
+
+    struct Pass
+    {
+        std::string                          name;
+        std::vector<ResourceUsage>           usages;
+        std::function<void(VkCommandBuffer)> recordFunc;
+    };
+
+    struct BarrierBatch
+    {
+        VkMemoryBarrier2                   memoryBarrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+        std::vector<VkImageMemoryBarrier2> imageBarriers;
+    };
+
+    void SetState(Resource& resource, const ResourceState& state);
+    void Discard(Resource& resource);
+    void Transition(Resource& resource, const ResourceState& state, BarrierBatch& batch);
+    void Flush(VkCommandBuffer vkCommand, BarrierBatch& batch);
+
+    std::vector<Resource>                                 m_Resources;
+    std::vector<Pass>                                     m_Passes;
+    std::vector<std::pair<ResourceHandle, ResourceState>> m_Exports;
+
+    Statistics m_Statistics;
+};
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+// Layout of the standard Vertex for this application.
+// ---------------------------------------------------------
+
+struct Vertex
+{
+    glm::vec3 positionOS;
+    glm::vec3 normalOS;
+};
+
+// Mesh levels of detail, LOD 0 is the source mesh.
+// ---------------------------------------------------------
+
+const uint32_t kMeshLODCount = 3U;
+
+// Vertex clustering grid resolution (cells along the longest axis) per simplified LOD.
+const std::array<uint32_t, kMeshLODCount> kMeshLODGridResolution = { 0U, 24U, 12U };
+
+struct BoundingSphere
+{
+    glm::vec3 center;
+    float     radius;
+};
+
+// Instance culling + LOD selection.
+// ---------------------------------------------------------
+
+const uint32_t kInstanceCulled = UINT_MAX;
+
+struct InstanceCullingParams
+{
+    // Left, right, bottom, top and near planes (xyz: inward normal, w: distance).
+    std::array<glm::vec4, 5> frustumPlanes;
+
+    glm::vec3 cameraPosition;
+
+    // Instances further than this from the camera are culled.
+    float maxDistance;
+
+    // World-space slack added to the bounding radius for the frustum test, so instances just outside the
+    // view that still cast visible shadows / occlusion are kept.
+    float frustumMargin;
+
+    // Converts (radius / distance) to a projected radius in pixels: 0.5 * viewportHeight / tan(0.5 * fovY).
+    float projectionScale;
+
+    // Minimum projected radius in pixels to keep LOD n (index n - 1), below that the next LOD is used.
+    std::array<float, kMeshLODCount - 1> lodPixelThresholds;
+};
+
+// Demo camera, orbiting the instance cloud.
+// ---------------------------------------------------------
+
+const float kCameraOrbitRadius = 50.0F;
+const float kCameraOrbitSpeed  = 0.2F;
+const float kCameraFieldOfView = 30.0F; // Vertical, in degrees.
+const float kCameraNearPlane   = 0.001F;
+const float kCameraFarPlane    = 100.0F;
+
+// Utility Functions.
+// ---------------------------------------------------------
+
+bool LoadMesh(const char* filePath, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+bool LoadPoints(const char* filePath, std::vector<Vertex>& vertices);
+
+// Grows (or shrinks) the instance point cloud to instanceCount points. Points past the source count are copies of
+// the source points with a deterministic positional jitter, so the cloud gets denser rather than larger.
+void ResizeInstancePoints(std::vector<Vertex>& points, uint32_t instanceCount);
+
+// Splits every triangle into four through its edge midpoints, levels times (keeps the non-indexed layout of LoadMesh).
+void SubdivideMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t levels);
+
+// Orients an instance along the normal of a point and places it at the point position.
+glm::mat4 ComputeInstanceTransform(const Vertex& point);
+
+// View and projection of the orbit camera after time seconds.
+void ComputeOrbitCamera(float time, float aspectRatio, glm::mat4& matrixV, glm::mat4& matrixP);
+
+BoundingSphere ComputeBoundingSphere(const std::vector<Vertex>& vertices);
+
+// Simplifies a mesh by merging all vertices that fall into the same cell of a uniform grid with cellCount
+// cells along the longest axis of the bounds. Collapsed triangles are removed.
+void SimplifyMesh(const std::vector<Vertex>&   vertices,
+                  const std::vector<uint32_t>& indices,
+                  uint32_t                     cellCount,
+                  std::vector<Vertex>&         simplifiedVertices,
+                  std::vector<uint32_t>&       simplifiedIndices);
+
+void ComputeFrustumPlanes(const glm::mat4& matrixVP, std::array<glm::vec4, 5>& frustumPlanes);
+
+// Returns the LOD index to render an instance with, or kInstanceCulled.
+uint32_t SelectInstanceLOD(const InstanceCullingParams& params, const BoundingSphere& worldBounds);
+
+#endif
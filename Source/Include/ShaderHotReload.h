@@ -0,0 +1,91 @@
+#ifndef SHADER_HOT_RELOAD_H
+#define SHADER_HOT_RELOAD_H
+
+// Recompiles shaders on a worker thread whenever their HLSL sources change.
+// ---------------------------------------------------------
+//
+// The worker waits on the shader folder (inotify on Linux, modification times elsewhere), compiles the changed
+// sources with dxc the same way Compile.bat does and hands the names of the compiled shaders to a rebuild callback,
+// still on the worker. A changed .hlsli recompiles every watched shader, since any of them may include it. A batch
+// with a source that fails to compile skips the rebuild, the shaders in use stay untouched.
+
+// Changes closer together than this are compiled as one batch (editors write a file in several steps).
+const std::chrono::milliseconds kShaderHotReloadSettleTime(100);
+
+// Wait between modification time scans where inotify is not available.
+const std::chrono::milliseconds kShaderHotReloadPollInterval(250);
+
+// dxc from the path, unless the DXC environment variable points at one.
+const char* const kShaderCompilerDefault = "dxc";
+
+class ShaderHotReload
+{
+public:
+
+    struct Shader
+    {
+        std::string name;    // Source Shaders/<name>.hlsl, output Shaders/Compiled/<name>.spv.
+        std::string profile; // e.g. lib_6_3 or cs_6_5.
+    };
+
+    // Returns false when the objects could not be rebuilt from the new SPIR-V.
+    using RebuildFunc = std::function<bool(const std::vector<std::string>& shaderNames)>;
+
+    ~ShaderHotReload() { Stop(); }
+
+    void Start(const std::filesystem::path& shaderDirectory, const std::vector<Shader>& shaders, RebuildFunc rebuildFunc);
+    void Stop();
+
+    // Outcome of the last batch, for the user interface.
+    std::string GetStatus() const;
+
+private:
+
+    void Run(const std::stop_token& stopToken);
+
+    // Blocks until a source changed (true) or a stop was requested (false), and returns the changed file names.
+    bool WaitForChanges(const std::stop_token& stopToken, std::set<std::string>& changedFiles);
+
+    bool Compile(const Shader& shader) const;
+
+    void SetStatus(const std::string& status);
+
+    std::filesystem::path m_ShaderDirectory;
+    std::vector<Shader>   m_Shaders;
+    RebuildFunc           m_RebuildFunc;
+
+    // inotify instance (Linux), otherwise the modification times of the last scan are compared.
+    int                                                     m_NotifyHandle = -1;
+    std::map<std::string, std::filesystem::file_time_type> m_WriteTimes;
+
+    mutable std::mutex m_StatusMutex;
+    std::string        m_Status = "Watching";
+
+    std::jthread m_Thread;
+};
+
+// Holds GPU objects that were replaced while the render loop runs until no frame in flight can still reference them.
+// ---------------------------------------------------------
+//
+// Objects handed over while recording frame N are released when frame N + kMaxFramesInFlight is recorded, after its
+// fence wait, so replacing them never waits on the device. Used from the render loop thread only.
+
+class DeferredReleaseQueue
+{
+public:
+
+    void Push(std::function<void()> releaseFunc);
+
+    // Advances the frame counter and releases what expired, once per recorded frame.
+    void Collect();
+
+    // Releases everything regardless of the frame, once the device is idle.
+    void Flush();
+
+private:
+
+    std::deque<std::pair<uint64_t, std::function<void()>>> m_Releases;
+    uint64_t                                                m_FrameIndex = 0U;
+};
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef SHADER_VARIANTS_H
+#define SHADER_VARIANTS_H
+
+// Ray tracing pipelines specialized per combination of the constants in Shaders/RayGen.hlsl.
+// ---------------------------------------------------------
+//
+// The sample count, debug view, primary ray flags and bounce count are specialization constants, so the driver folds
+// them into the ray generation shader and strips the branches they disable. Every combination is built once (pipeline
+// + shader binding tables) and cached, switching back to a variant later costs a lookup.
+
+// Mirrors the RAY_FLAG_* values of the primary rays.
+const uint32_t kRayFlagForceOpaque             = 0x01U;
+const uint32_t kRayFlagCullBackFacingTriangles = 0x10U;
+
+enum class DebugView : uint32_t
+{
+    None        = 0U,
+    Normals     = 1U,
+    HitDistance = 2U
+};
+
+// Specialization constant values, in constant_id order (the struct is the specialization data as is).
+struct ShaderVariant
+{
+    uint32_t  samplesPerPixel = 1U;
+    DebugView debugView       = DebugView::None;
+    uint32_t  rayFlags        = kRayFlagForceOpaque;
+    uint32_t  maxBounceCount  = 0U;
+
+    bool operator==(const ShaderVariant& other) const = default;
+};
+
+const uint32_t kShaderVariantConstantCount = 4U;
+
+// Map entries + info pointing at a variant, which has to outlive the pipeline creation.
+struct ShaderVariantSpecialization
+{
+    explicit ShaderVariantSpecialization(const ShaderVariant& variant);
+
+    std::array<VkSpecializationMapEntry, kShaderVariantConstantCount> mapEntries;
+    VkSpecializationInfo                                              info;
+};
+
+// Ray tracing pipeline and the shader binding tables of its groups.
+struct RaytracingPipeline
+{
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    Buffer     shaderBindingsRayGen {};
+    Buffer     shaderBindingsOcclusionRayGen {};
+    Buffer     shaderBindingsMiss {};
+    Buffer     shaderBindingsClosestHit {};
+};
+
+class ShaderVariantCache
+{
+public:
+
+    using BuildFunc   = std::function<bool(const ShaderVariant& variant, RaytracingPipeline& raytracingPipeline)>;
+    using ReleaseFunc = std::function<void(RaytracingPipeline& raytracingPipeline)>;
+
+    void Initialize(BuildFunc buildFunc);
+
+    // Pipeline of the variant, built on the calling thread the first time it is requested. Null if the build failed.
+    const RaytracingPipeline* Get(const ShaderVariant& variant);
+
+    // Adds (or replaces, without releasing) the pipeline of a variant built elsewhere.
+    void Insert(const ShaderVariant& variant, const RaytracingPipeline& raytracingPipeline);
+
+    // Hands every cached pipeline to releaseFunc and empties the cache.
+    void Clear(const ReleaseFunc& releaseFunc);
+
+    // Cached variants, safe to call from other threads (e.g. to rebuild them after a shader reload).
+    std::vector<ShaderVariant> GetVariants() const;
+
+    inline uint32_t GetBuildCount() const { return m_BuildCount; }
+    inline double   GetLastBuildMilliseconds() const { return m_LastBuildMilliseconds; }
+
+private:
+
+    struct Entry
+    {
+        ShaderVariant      variant;
+        RaytracingPipeline raytracingPipeline;
+    };
+
+    BuildFunc m_BuildFunc;
+
+    mutable std::mutex                  m_Mutex;
+    std::unordered_map<uint64_t, Entry> m_Entries;
+
+    uint32_t m_BuildCount            = 0U;
+    double   m_LastBuildMilliseconds = 0.0;
+};
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef SPARSE_TRACE_H
+#define SPARSE_TRACE_H
+
+// Sparse primary visibility: a subset of the pixels is traced every frame, the rest is reconstructed.
+// ---------------------------------------------------------
+//
+// The checkerboard mode traces every other pixel of a row, alternating between frames, and the interleaved mode one
+// pixel of every 2x2 quad, cycling through the quad over four frames. The ray generation shaders map the (smaller)
+// dispatch onto the traced pixels with Shaders/SparseTrace.hlsli, and the shadow / AO rays follow the same pixels.
+// Shaders/SparseReconstruct.hlsl then fills in the skipped pixels: it follows the motion of the nearest traced
+// neighbour into the previous reconstruction and clamps the result to the colors of the traced neighbours, falling back
+// to their average where there is no history. The skipped pixels take the G-buffer of that neighbour, so the denoiser
+// sees a complete frame.
+
+class RenderContext;
+class GPUProfiler;
+
+enum class SparseTraceMode : uint32_t
+{
+    Full         = 0, // Every pixel, every frame.
+    Checkerboard = 1, // 1/2 of the pixels per frame.
+    Interleaved  = 2  // 1/4 of the pixels per frame.
+};
+
+const std::array<const char*, 3> kSparseTraceModeNames = { "full", "checkerboard", "interleaved" };
+
+// Frames until every pixel was traced once.
+uint32_t GetSparseTracePhaseCount(SparseTraceMode mode);
+
+// Dispatch extent covering the pixels traced per frame of a width x height image.
+VkExtent2D GetSparseTraceDispatchSize(SparseTraceMode mode, uint32_t width, uint32_t height);
+
+// Mirrors the constants of Shaders/SparseReconstruct.hlsl.
+struct SparseReconstructConstants
+{
+    uint32_t sparseMode;
+    uint32_t sparsePhase;
+    uint32_t historyValid;
+};
+
+class SparseReconstruction
+{
+public:
+
+    // Graph handles of the frame images, all of them are completed in place.
+    struct FrameResources
+    {
+        RenderGraph::ResourceHandle color;
+        RenderGraph::ResourceHandle position;
+        RenderGraph::ResourceHandle normal;
+        RenderGraph::ResourceHandle motion;
+    };
+
+    // Creates the history images and the pipeline, and binds the frame images (render resolution). Called the first
+    // time a sparse mode is selected. The optional command pool is for callers off the main thread, as for
+    // CreateStorageImage.
+    void Create(RenderContext* pRenderContext,
+                const Image&   color,
+                const Image&   position,
+                const Image&   normal,
+                const Image&   motion,
+                VkCommandPool  vkCommandPool = VK_NULL_HANDLE);
+    void Release(RenderContext* pRenderContext); // Also when it was never created.
+
+    inline bool IsCreated() const { return m_Pipeline != VK_NULL_HANDLE; }
+
+    // Imports the history images, once after Create.
+    void Import(RenderGraph& renderGraph);
+
+    // Adds the reconstruction of the pixels the sparse mode skipped in this phase.
+    void AddPass(RenderGraph& renderGraph, const FrameResources& frameResources, SparseTraceMode mode, uint32_t phase, GPUProfiler& profiler);
+
+    // The next frame reconstructs without history (e.g. after frames were traced at full rate).
+    inline void ResetHistory() { m_HistoryValid = false; }
+
+private:
+
+    // Reconstructed color of alternate frames, the next frame reprojects the skipped pixels from it.
+    struct History
+    {
+        Image                       color {};
+        RenderGraph::ResourceHandle graphColor;
+    };
+
+    std::array<History, 2> m_History;
+
+    uint32_t m_HistoryIndex = 0U; // Written by the next frame.
+    bool     m_HistoryValid = false;
+
+    uint32_t m_Width  = 0U;
+    uint32_t m_Height = 0U;
+
+    VkDescriptorSetLayout m_SetLayout      = VK_NULL_HANDLE;
+    VkPipelineLayout      m_PipelineLayout = VK_NULL_HANDLE;
+    VkPipeline            m_Pipeline       = VK_NULL_HANDLE;
+
+    VkDescriptorPool m_DescriptorPool = VK_NULL_HANDLE;
+
+    // Sets by the history index they write.
+    std::array<VkDescriptorSet, 2> m_Sets {};
+};
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+// Dependency-driven task graph, executed on a work-stealing pool of worker threads.
+// ---------------------------------------------------------
+
+class TaskGraph
+{
+public:
+
+    using TaskHandle = uint32_t;
+
+    // Dependencies must be handles of previously added tasks, which keeps the graph acyclic.
+    TaskHandle AddTask(const std::string& taskName, std::function<void()> taskFunc, const std::vector<TaskHandle>& dependencies = {});
+
+    // Runs every task on workerCount threads (the calling thread included) and returns once all of them completed.
+    void Execute(uint32_t workerCount);
+
+    // Index of the worker running on the calling thread, in [0, workerCount) while inside a task.
+    static uint32_t GetWorkerIndex();
+
+    // Wall-clock duration of every task in completion order.
+    inline const std::vector<std::pair<std::string, double>>& GetTaskTimings() const { return m_TaskTimings; }
+
+private:
+
+    struct Task
+    {
+        std::string             name;
+        std::function<void()>   func;
+        std::vector<TaskHandle> dependents;
+        uint32_t                dependencyCount = 0U;
+    };
+
+    std::vector<Task> m_Tasks;
+
+    std::mutex                                  m_TimingsMutex;
+    std::vector<std::pair<std::string, double>> m_TaskTimings;
+};
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef TILE_RENDERER_H
+#define TILE_RENDERER_H
+
+// Offline renders split into tiles across every ray tracing capable physical device.
+// ---------------------------------------------------------
+//
+// Each device gets its own headless render context and its own copy of the scene (geometry, BLAS, TLAS), and traces
+// tiles with Shaders/TileTrace.hlsl into a host visible buffer. Tiles are dealt out in proportion to the throughput
+// every device measured on the previous frame, and a device that runs out steals from the back of the longest queue,
+// so the image is finished at about the same time everywhere. The tiles are composed into one image on the host.
+
+class RenderContext;
+struct ImageRGB8;
+
+const uint32_t kTileSize = 64U;
+
+// Tiles recorded into one submission per device (bounds the host visible output buffer of a device).
+const uint32_t kTileBatchSize = 16U;
+
+// Weight of the newest frame in the smoothed per-device throughput.
+const double kTileThroughputSmoothing = 0.5;
+
+// Host copy of the scene each device builds its acceleration structures from (LOD 0, every instance).
+struct TileScene
+{
+    std::vector<Vertex>               vertices;
+    std::vector<uint32_t>             indices;
+    std::vector<VkTransformMatrixKHR> instanceTransforms;
+};
+
+// Mirrors the constants of Shaders/TileTrace.hlsl.
+struct TileTraceConstants
+{
+    glm::vec4  rayOrigin;
+    glm::vec4  rayCorner;
+    glm::vec4  rayPixelDeltaX;
+    glm::vec4  rayPixelDeltaY;
+    glm::uvec2 tileOrigin;
+    glm::uvec2 imageSize;
+    uint32_t   tileSlot;
+    uint32_t   samplesPerPixel;
+};
+
+// Per-device tile queues, seeded with contiguous runs of tiles sized by weight. Owners take from the front (scanline
+// order), thieves take from the back of the longest queue.
+class TileScheduler
+{
+public:
+
+    void Reset(uint32_t tileCount, const std::vector<double>& deviceWeights);
+
+    // Up to maxTileCount tiles for the device, empty once every queue is drained.
+    void Pop(uint32_t deviceIndex, uint32_t maxTileCount, std::vector<uint32_t>& tileIndices);
+
+    inline uint32_t GetStolenCount() const { return m_StolenCount.load(); }
+
+private:
+
+    struct DeviceQueue
+    {
+        std::mutex           mutex;
+        std::deque<uint32_t> tiles;
+    };
+
+    std::vector<std::unique_ptr<DeviceQueue>> m_Queues;
+    std::atomic<uint32_t>                     m_StolenCount = 0U;
+};
+
+class TileRenderer
+{
+public:
+
+    struct DeviceStatistics
+    {
+        std::string name;
+        uint32_t    tileCount        = 0U; // Of the last frame.
+        double      busyMilliseconds = 0.0;
+        double      tilesPerSecond   = 0.0; // Smoothed, weighs the next frame.
+    };
+
+    // One render context per device, which have to load the device functions through the loader dispatch (see
+    // RenderContextOptions::sharedDispatch) and outlive the renderer. Replicates the scene on every device, in parallel.
+    void Initialize(const std::vector<RenderContext*>& renderContexts, const TileScene& scene);
+
+    // Destroys the per-device objects, the contexts are left to the caller.
+    void Release();
+
+    // Traces one image of width x height pixels with the ray basis of the camera state and composes it into the
+    // linear HDR image (RGBA, row major).
+    void Render(const CameraState& camera, uint32_t width, uint32_t height, uint32_t samplesPerPixel, std::vector<glm::vec4>& image);
+
+    inline const std::vector<DeviceStatistics>& GetStatistics() const { return m_Statistics; }
+    inline uint32_t                             GetStolenCount() const { return m_Scheduler.GetStolenCount(); }
+
+    // Tone maps the composed image on the host, the same way Shaders/Tonemap.hlsl writes the back buffer.
+    static void Resolve(const std::vector<glm::vec4>& image, uint32_t width, uint32_t height, bool tonemap, ImageRGB8& output);
+
+private:
+
+    struct Device
+    {
+        RenderContext* pRenderContext = nullptr;
+
+        Buffer                vertexBuffer {};
+        Buffer                indexBuffer {};
+        Buffer                instanceBuffer {};
+        AccelerationStructure blas {};
+        AccelerationStructure tlas {};
+
+        VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+        VkPipelineLayout      pipelineLayout      = VK_NULL_HANDLE;
+        VkPipeline            pipeline            = VK_NULL_HANDLE;
+        VkDescriptorPool      descriptorPool      = VK_NULL_HANDLE;
+        VkDescriptorSet       descriptorSet       = VK_NULL_HANDLE;
+
+        // kTileBatchSize tiles of kTileSize x kTileSize float4, persistently mapped.
+        Buffer     outputBuffer {};
+        glm::vec4* pOutput = nullptr;
+
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence         fence         = VK_NULL_HANDLE;
+    };
+
+    void InitializeDevice(Device& device, const TileScene& scene);
+    void ReleaseDevice(Device& device);
+
+    // Drains the scheduler on the device, returns the number of tiles traced.
+    uint32_t RenderDevice(uint32_t deviceIndex, const TileTraceConstants& frameConstants, std::vector<glm::vec4>& image);
+
+    std::vector<Device>           m_Devices;
+    std::vector<DeviceStatistics> m_Statistics;
+    TileScheduler                 m_Scheduler;
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef TRANSIENT_IMAGE_ALLOCATOR_H
+#define TRANSIENT_IMAGE_ALLOCATOR_H
+
+// Places the per-frame attachments in one allocation, aliasing images whose lifetimes in the frame don't overlap.
+// ---------------------------------------------------------
+//
+// Lifetimes are inclusive ranges of pass indices, in the order a frame records its passes. Aliased images lose their
+// contents to each other, so every first use in a frame discards (see RenderGraph::ImportTransientImages).
+
+class RenderContext;
+
+class TransientImageAllocator
+{
+public:
+
+    using ImageHandle = uint32_t;
+
+    // Render resolution 2D color image, created and placed by Allocate.
+    ImageHandle AddImage(const std::string& imageName, VkFormat imageFormat, VkImageUsageFlags imageUsage, uint32_t firstPass, uint32_t lastPass);
+
+    void Allocate(RenderContext* pRenderContext);
+    void Release(RenderContext* pRenderContext);
+
+    inline uint32_t GetImageCount() const { return static_cast<uint32_t>(m_Images.size()); }
+
+    inline const Image&       GetImage(ImageHandle image) const { return m_Images.at(image).image; }
+    inline const std::string& GetImageName(ImageHandle image) const { return m_Images.at(image).name; }
+
+    // Images sharing memory with the given one.
+    inline const std::vector<ImageHandle>& GetAliases(ImageHandle image) const { return m_Images.at(image).aliases; }
+
+    // Size of the shared allocation, and the sum of the images as separate allocations.
+    inline VkDeviceSize GetAllocationSize() const { return m_AllocationSize; }
+    inline VkDeviceSize GetUnaliasedSize() const { return m_UnaliasedSize; }
+
+private:
+
+    struct TransientImage
+    {
+        std::string              name;
+        VkFormat                 format;
+        VkImageUsageFlags        usage;
+        uint32_t                 firstPass;
+        uint32_t                 lastPass;
+        Image                    image              = {};
+        VkMemoryRequirements     memoryRequirements = {};
+        VkDeviceSize             offset             = 0U;
+        std::vector<ImageHandle> aliases;
+    };
+
+    std::vector<TransientImage> m_Images;
+
+    VmaAllocation m_Allocation     = VK_NULL_HANDLE;
+    VkDeviceSize  m_AllocationSize = 0U;
+    VkDeviceSize  m_UnaliasedSize  = 0U;
+};
+
+#endif
@@ -1,90 +1,351 @@
 #include <Common.h>
+#include <Profiler.h>
 #include <RenderContext.h>
+#include <Scene.h>
+#include <ImageIO.h>
+#include <Benchmark.h>
+#include <TaskGraph.h>
+#include <AccelerationStructureCache.h>
+#include <TransientImageAllocator.h>
+#include <RenderGraph.h>
+#include <BindlessDescriptors.h>
+#include <Camera.h>
+#include <ConsoleLogSink.h>
+#include <ShaderHotReload.h>
+#include <ShaderVariants.h>
+#include <TileRenderer.h>
+#include <Denoiser.h>
+#include <SparseTrace.h>
+#include <GeometryRegistry.h>
+#include <MeshDeformer.h>
+
+// Camera of the frame, in a uniform buffer slot per frame in flight (set 0, binding 5, dynamic offset).
+struct FrameConstants
+{
+    // Primary ray basis of the camera (see CameraState), w unused.
+    glm::vec4 RayOrigin;
+    glm::vec4 RayCorner;
+    glm::vec4 RayPixelDeltaX;
+    glm::vec4 RayPixelDeltaY;
+
+    // View-projection of the previous frame, the primary hits are projected with it into motion vectors.
+    glm::mat4 PreviousMatrixVP;
+};
+
+struct RaytracingPushConstants
+{
+    glm::vec4 LightDirection;
+    uint32_t  ShadowSampleCount;
+    uint32_t  AOSampleCount;
+    float     AORadius;
+    uint32_t  FrameIndex;
+    uint32_t  OcclusionPass;
+    uint32_t  SamplesPerPixel;
+    uint32_t  SampleOffset; // Start of the primary sample sequence, cycled per frame while the denoiser accumulates.
+    uint32_t  SparseMode;   // Pixels traced per frame (SparseTraceMode), and the frame within the cycle of the mode.
+    uint32_t  SparsePhase;
+};
 
-// Layout of the standard Vertex for this application.
+// Every device supports push constants up to this size, the frame constants hold the rest.
+static_assert(sizeof(RaytracingPushConstants) <= 128U, "The trace push constants exceed the guaranteed maxPushConstantsSize.");
+
+// Visibility-only ray configuration (zero samples disables a pass).
 // ---------------------------------------------------------
 
-struct Vertex
+const uint32_t kOcclusionPassShadow = 0U;
+const uint32_t kOcclusionPassAO     = 1U;
+const uint32_t kMissShaderCount     = 2U;
+
+// Ray generation, hit group, the two miss shaders and the occlusion ray generation.
+const uint32_t kShaderGroupCount = 5U;
+
+// Stages of the pipeline, in the order the shader groups reference them.
+const std::array<ShaderHotReload::Shader, 5> kRaytracingShaders = {
+    { { "RayGen", "lib_6_3" },
+     { "ClosestHit", "lib_6_3" },
+     { "Miss", "lib_6_3" },
+     { "OcclusionMiss", "lib_6_3" },
+     { "OcclusionRayGen", "lib_6_3" } }
+};
+
+struct OcclusionSettings
 {
-    glm::vec3 positionOS;
-    glm::vec3 normalOS;
+    int       shadowSampleCount = 0;
+    int       aoSampleCount     = 0;
+    float     aoRadius          = 2.0F;
+    float     lightConeAngle    = 0.02F;
+    glm::vec3 lightDirection    = { 0.4F, -1.0F, 0.3F };
 };
 
-struct RaytracingPushConstants
+// Selectable implementations of the primary visibility trace.
+// ---------------------------------------------------------
+
+enum class RenderPath : int
+{
+    RaytracingPipeline = 0,
+    RayQueryCompute    = 1
+};
+
+const std::array<const char*, 2> kRenderPathNames = { "Trace (Ray Tracing Pipeline)", "Trace (Ray Query Compute)" };
+
+// Tone mapping of the HDR trace output into the back buffer.
+// ---------------------------------------------------------
+
+enum class TonemapOperator : int
+{
+    None = 0, // Clamped linear output, comparable with the reference tracer.
+    ACES = 1
+};
+
+struct OutputPushConstants
 {
-    glm::mat4 InverseMatrixV;
-    glm::mat4 InverseMatrixP;
+    float    Exposure;
+    uint32_t TonemapOperator;
+    uint32_t InPlace; // Writes the color attachment instead of the back buffer.
 };
 
+struct OutputSettings
+{
+    TonemapOperator tonemapOperator = TonemapOperator::ACES;
+    float           exposure        = 1.0F;
+};
+
+// Order of the passes in a frame, the lifetimes of the transient attachments are expressed in it.
+// ---------------------------------------------------------
+
+const uint32_t kFramePassDeform      = 0U;
+const uint32_t kFramePassBLASRefit   = 1U;
+const uint32_t kFramePassTLASBuild   = 2U;
+const uint32_t kFramePassTrace       = 3U;
+const uint32_t kFramePassOcclusion   = 4U;
+const uint32_t kFramePassReconstruct = 5U;
+const uint32_t kFramePassDenoise     = 6U;
+const uint32_t kFramePassOutput      = 7U;
+
+// Per-frame instance culling + LOD selection ahead of the TLAS rebuild.
+// ---------------------------------------------------------
+
+const uint32_t kInstanceCullingChunkSize = 256U;
+
+struct InstanceCullingSettings
+{
+    bool                                  enabled            = false;
+    float                                 maxDistance        = 150.0F;
+    float                                 frustumMargin      = 2.0F;
+    std::array<float, kMeshLODCount - 1U> lodPixelThresholds = { 24.0F, 8.0F };
+};
+
+// Upper bound of the resource loader task graph workers (startup is mostly bound by the queue past that).
+const uint32_t kMaxResourceLoaderWorkers = 8U;
+
 // Forwards
 // --------------------------------------
 
 void     InitializeResources(RenderContext* pRenderContext);
 void     FreeResources(RenderContext* pRenderContext);
 uint64_t GetBufferDeviceAddress(RenderContext* pRenderContext, const Buffer& buffer);
-bool     LoadMesh(const char* filePath, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
-bool     LoadPoints(const char* filePath, std::vector<Vertex>& vertices);
+void     UpdateTLAS(RenderContext*               pRenderContext,
+                    VkCommandBuffer              vkCommand,
+                    uint32_t                     frameInFlightIndex,
+                    const InstanceCullingParams& cullingParams,
+                    bool                         deformed);
+bool     CreateRaytracingPipeline(RenderContext* pRenderContext, const ShaderVariant& variant, RaytracingPipeline& raytracingPipeline);
+void     CreateShaderBindingTables(RenderContext* pRenderContext, RaytracingPipeline& raytracingPipeline);
+void     ReleaseRaytracingPipeline(RenderContext* pRenderContext, RaytracingPipeline& raytracingPipeline);
+void     RenderTiles(RenderContext* pRenderContext);
+void     CreateOptionalPasses(RenderContext* pRenderContext, bool createDenoiser, bool createSparseReconstruction, bool createMeshDeformer);
 
 // Resources
 // --------------------------------------
 
+// Views of the transient images, which share one allocation.
+TransientImageAllocator              g_TransientImages;
+TransientImageAllocator::ImageHandle g_TransientColor;
+TransientImageAllocator::ImageHandle g_TransientGBufferPosition;
+TransientImageAllocator::ImageHandle g_TransientGBufferNormal;
+TransientImageAllocator::ImageHandle g_TransientGBufferMotion;
+TransientImageAllocator::ImageHandle g_TransientDenoiseScratch;
+
 Image g_ColorAttachment {};
-Image g_DepthAttachment {};
+Image g_GBufferPosition {};
+Image g_GBufferNormal {};
+Image g_GBufferMotion {};
+Image g_DenoiseScratch {};
+
+// Every mesh goes through the registry, LODs with identical content share one.
+GeometryRegistry                                            g_GeometryRegistry;
+std::array<GeometryRegistry::GeometryHandle, kMeshLODCount> g_MeshLODs {};
+
+// Scene geometry + materials for the hit shaders, the geometry table has one record per LOD (in LOD order) followed by
+// the deformed copies of LOD 0, one per frame in flight (LOD 0 until the mesh deformer is created).
+BindlessDescriptors g_BindlessDescriptors;
+Buffer              g_GeometryTable {};
+Buffer              g_MaterialTable {};
+
+const uint32_t kDeformedGeometryRecord = kMeshLODCount;
+
+// Animated LOD 0, shared by every instance at full detail while enabled. Coarser LODs stay rigid.
+DeformationSettings g_DeformationSettings;
+MeshDeformer        g_MeshDeformer;
+
+// Ray tracing pipeline variants, the selected one is built on first use when the selection changes.
+ShaderVariantCache g_RaytracingVariants;
+ShaderVariant      g_RaytracingVariant;
+ShaderVariant      g_ActiveRaytracingVariant;
 
-Buffer g_MeshVertexBuffer {};
-Buffer g_MeshIndexBuffer {};
+// Every cached variant rebuilt by the shader hot reload worker, swapped in before the next frame is recorded.
+std::mutex                                                g_PendingRaytracingVariantsMutex;
+std::vector<std::pair<ShaderVariant, RaytracingPipeline>> g_PendingRaytracingVariants;
 
-Buffer g_ShaderBindingsRayGen {};
-Buffer g_ShaderBindingsMiss {};
-Buffer g_ShaderBindingsClosestHit {};
+ShaderHotReload      g_ShaderHotReload;
+DeferredReleaseQueue g_DeferredReleases;
 
-Buffer g_BLASBackingMemory {};
-Buffer g_TLASBackingMemory {};
+AccelerationStructure g_TLAS {};
+Buffer                g_TLASScratchBuffer {};
 
-uint64_t g_BLASDeviceAddress;
-uint64_t g_TLASDeviceAddress;
+std::array<Buffer, kMaxFramesInFlight>                              g_InstanceBuffers {};
+std::array<VkAccelerationStructureInstanceKHR*, kMaxFramesInFlight> g_InstanceBufferMappings {};
 
-VkAccelerationStructureKHR g_BLAS;
-VkAccelerationStructureKHR g_TLAS;
+std::vector<VkTransformMatrixKHR> g_InstanceTransforms;
+std::vector<BoundingSphere>       g_InstanceBounds;
 
-VkPipeline            g_RaytracingPipeline;
+VkPipeline            g_RayQueryPipeline;
 VkDescriptorSetLayout g_DescriptorSetLayout;
 VkPipelineLayout      g_PipelineLayout;
 VkDescriptorPool      g_DescriptorPool;
 VkDescriptorSet       g_DescriptorSet;
+Buffer                g_FrameConstantsBuffer {}; // kMaxFramesInFlight slots, persistently mapped.
+uint8_t*              g_pFrameConstants      = nullptr;
+uint32_t              g_FrameConstantsStride = 0U;
 VkImageView           g_ColorImageStorageView;
 
+VkPipeline                   g_OutputPipeline;
+VkDescriptorSetLayout        g_OutputDescriptorSetLayout;
+VkPipelineLayout             g_OutputPipelineLayout;
+std::vector<VkDescriptorSet> g_OutputDescriptorSets; // One per back buffer.
+
 VkPhysicalDeviceRayTracingPipelinePropertiesKHR g_RayTracingProperties;
 
-RaytracingPushConstants g_PushConstants;
+// BLASes are built on the CPU (deferred host operations) when requested and supported by the driver.
+bool g_HostBLASBuilds = false;
+
+Camera g_Camera;
+
+RaytracingPushConstants g_PushConstants {};
+OcclusionSettings       g_OcclusionSettings;
+OutputSettings          g_OutputSettings;
+DenoiserSettings        g_DenoiserSettings;
+
+Denoiser g_Denoiser;
+
+// Sparse primary visibility, the skipped pixels are reconstructed from the traced ones and the previous frame.
+SparseTraceMode      g_SparseTraceMode = SparseTraceMode::Full;
+SparseReconstruction g_SparseReconstruction;
+
+// Optional passes (denoiser, sparse reconstruction, mesh deformer) are created on a loader thread the first time they
+// are enabled, so their single-shot uploads never wait inside the frame loop. Swapped in before the next frame is
+// recorded, the frames until then render without them.
+std::jthread                        g_OptionalPassLoader;
+std::atomic<bool>                   g_OptionalPassLoaderBusy;
+std::mutex                          g_PendingOptionalPassesMutex;
+std::optional<Denoiser>             g_PendingDenoiser;
+std::optional<SparseReconstruction> g_PendingSparseReconstruction;
+std::optional<MeshDeformer>         g_PendingMeshDeformer;
 
 std::atomic<bool> g_ResourcesReadyFence;
 
+RenderPath g_RenderPath = RenderPath::RaytracingPipeline;
+
+// Alternate the render path each frame to compare both under identical conditions.
+bool g_AlternateRenderPaths = false;
+
+InstanceCullingSettings g_CullingSettings;
+
+// Set when culling gets disabled so the full instance set is restored once.
+bool g_TLASRequiresRebuild = false;
+
+uint32_t                            g_VisibleInstanceCount = 0U;
+std::array<uint32_t, kMeshLODCount> g_InstanceLODCounts {};
+
+// Per-frame passes and the resources they use, the barriers between them are derived by the graph.
+RenderGraph                 g_RenderGraph;
+RenderGraph::ResourceHandle g_GraphBackBuffer;
+RenderGraph::ResourceHandle g_GraphColor;
+RenderGraph::ResourceHandle g_GraphGBufferPosition;
+RenderGraph::ResourceHandle g_GraphGBufferNormal;
+RenderGraph::ResourceHandle g_GraphGBufferMotion;
+RenderGraph::ResourceHandle g_GraphDenoiseScratch;
+RenderGraph::ResourceHandle g_GraphTLAS;
+
+LaunchOptions     g_LaunchOptions;
+BenchmarkRecorder g_BenchmarkRecorder;
+
 // Entry-point
 // --------------------------------------
 
-int main()
+int main(int argc, char** argv)
 {
+    if (!ParseLaunchOptions(argc, argv, g_LaunchOptions))
+        return 1;
+
     // Configure logging.
     // --------------------------------------
 
-    auto loggerMemory = std::make_shared<std::stringstream>();
-    auto loggerSink   = std::make_shared<spdlog::sinks::ostream_sink_mt>(*loggerMemory);
-    auto logger       = std::make_shared<spdlog::logger>("", loggerSink);
+    // Headless runs have no UI to show the log in.
+    auto consoleSink = std::make_shared<ConsoleLogSink>();
+
+    spdlog::sink_ptr loggerSink = consoleSink;
+
+    if (g_LaunchOptions.renderContext.headless)
+        loggerSink = std::make_shared<spdlog::sinks::ostream_sink_mt>(std::cout);
+
+    auto logger = std::make_shared<spdlog::logger>("", loggerSink);
 
     spdlog::set_default_logger(logger);
     spdlog::set_pattern("%^[%l] %v%$");
 
+    if (!g_LaunchOptions.tracePath.empty())
+        CPUTracer::Get().Enable();
+
+    if (!g_LaunchOptions.tonemap)
+        g_OutputSettings.tonemapOperator = TonemapOperator::None;
+
+    g_DenoiserSettings.enabled = g_LaunchOptions.denoise;
+
+    g_SparseTraceMode = static_cast<SparseTraceMode>(g_LaunchOptions.sparseTrace);
+
+    g_DeformationSettings.enabled = g_LaunchOptions.deform;
+
+    CPUTracer::Get().SetThreadName("Main");
+
     // Launch Vulkan + OS Window
     // --------------------------------------
 
-    std::unique_ptr<RenderContext> pRenderContext = std::make_unique<RenderContext>(kWindowWidth, kWindowHeight);
+    std::unique_ptr<RenderContext> pRenderContext;
+    {
+        StartupPhase phase(g_BenchmarkRecorder, "Create Render Context");
+
+        pRenderContext = std::make_unique<RenderContext>(g_LaunchOptions.renderContext);
+
+        g_BenchmarkRecorder.RecordDevice(pRenderContext->GetDeviceName());
+    }
+
+    // Offline renders split over every capable device replace the render loop.
+    if (g_LaunchOptions.multiDevice)
+    {
+        RenderTiles(pRenderContext.get());
+        return 0;
+    }
 
     // Initialize
     // ------------------------------------------------
 
     std::jthread loadResourcesAsync(InitializeResources, pRenderContext.get());
 
+    // Every headless frame should be a measurable one.
+    if (pRenderContext->IsHeadless())
+        loadResourcesAsync.join();
+
     // UI
     // ------------------------------------------------
 
@@ -97,7 +358,26 @@ int main()
         {
             if (ImGui::BeginChild("LogSubWindow", ImVec2(600, 100), 1, ImGuiWindowFlags_HorizontalScrollbar))
             {
-                ImGui::TextUnformatted(loggerMemory->str().c_str());
+                // Only the visible lines are read from the ring.
+                const uint64_t lineCount = consoleSink->GetLineCount();
+                const uint64_t firstLine = lineCount > kConsoleLogLineCount ? lineCount - kConsoleLogLineCount : 0U;
+
+                ConsoleLogSink::Line line;
+
+                ImGuiListClipper clipper;
+                clipper.Begin(static_cast<int>(lineCount - firstLine));
+
+                while (clipper.Step())
+                {
+                    for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+                    {
+                        // Lines still being written (or already overwritten) keep their row empty.
+                        if (!consoleSink->ReadLine(firstLine + row, line))
+                            line.length = 0U;
+
+                        ImGui::TextUnformatted(line.text.data(), line.text.data() + line.length);
+                    }
+                }
 
                 if (ImGui::GetScrollY() >= ImGui::GetScrollMaxY())
                     ImGui::SetScrollHereY(1.0F);
@@ -107,6 +387,92 @@ int main()
             // Display the FPS in the window
             ImGui::Text("FPS: %.1f (%.2f ms)", ImGui::GetIO().Framerate, ImGui::GetIO().DeltaTime * 1000.0F);
 
+            // Same names as the GPU scopes and the results.
+            ImGui::Combo("Render Path", reinterpret_cast<int*>(&g_RenderPath), kRenderPathNames.data(), static_cast<int>(kRenderPathNames.size()));
+
+            if (g_LaunchOptions.shaderHotReload)
+                ImGui::Text("Shader Hot Reload: %s", g_ShaderHotReload.GetStatus().c_str());
+
+            // Specialization constants of the ray tracing pipeline (the ray query path only follows the sample count).
+            ImGui::SliderInt("Samples Per Pixel", reinterpret_cast<int*>(&g_RaytracingVariant.samplesPerPixel), 1, 16);
+            ImGui::Combo("Debug View", reinterpret_cast<int*>(&g_RaytracingVariant.debugView), "None\0Normals\0Hit Distance\0");
+            ImGui::SliderInt("Bounces", reinterpret_cast<int*>(&g_RaytracingVariant.maxBounceCount), 0, 4);
+            ImGui::CheckboxFlags("Cull Back Faces", &g_RaytracingVariant.rayFlags, kRayFlagCullBackFacingTriangles);
+            ImGui::Text("Pipeline Variants: %u built (last %.2f ms)",
+                        g_RaytracingVariants.GetBuildCount(),
+                        g_RaytracingVariants.GetLastBuildMilliseconds());
+
+            int cameraMode = static_cast<int>(g_Camera.GetMode());
+
+            if (ImGui::Combo("Camera", &cameraMode, "Orbit\0Scripted\0Free (WASD + QE, Right Mouse)\0"))
+                g_Camera.SetMode(static_cast<CameraMode>(cameraMode));
+            ImGui::Checkbox("Alternate Render Paths", &g_AlternateRenderPaths);
+
+            // Frames traced at full rate don't write the history the reconstruction reads.
+            if (ImGui::Combo("Sparse Trace", reinterpret_cast<int*>(&g_SparseTraceMode), "Full\0Checkerboard (1/2)\0Interleaved 2x2 (1/4)\0"))
+                g_SparseReconstruction.ResetHistory();
+
+            const VkExtent2D sparseTraceExtent =
+                GetSparseTraceDispatchSize(g_SparseTraceMode, pRenderContext->GetRenderWidth(), pRenderContext->GetRenderHeight());
+
+            ImGui::Text("Primary Rays: %u / frame", sparseTraceExtent.width * sparseTraceExtent.height * g_RaytracingVariant.samplesPerPixel);
+
+            ImGui::SliderInt("Shadow Samples", &g_OcclusionSettings.shadowSampleCount, 0, 16);
+            ImGui::SliderInt("AO Samples", &g_OcclusionSettings.aoSampleCount, 0, 32);
+            ImGui::SliderFloat("AO Radius", &g_OcclusionSettings.aoRadius, 0.1F, 10.0F);
+            ImGui::SliderFloat("Light Cone Angle", &g_OcclusionSettings.lightConeAngle, 0.0F, 0.5F);
+            ImGui::SliderFloat3("Light Direction", &g_OcclusionSettings.lightDirection.x, -1.0F, 1.0F);
+
+            // Frames rendered without the denoiser leave its history stale.
+            if (ImGui::Checkbox("Denoise", &g_DenoiserSettings.enabled))
+                g_Denoiser.ResetHistory();
+            ImGui::SliderInt(
+                "Denoise Iterations", reinterpret_cast<int*>(&g_DenoiserSettings.filterIterations), 0, static_cast<int>(kDenoiseMaxFilterIterations));
+            ImGui::SliderFloat("Denoise History Alpha", &g_DenoiserSettings.colorAlpha, 0.01F, 1.0F);
+            ImGui::SliderFloat("Denoise Phi Color", &g_DenoiserSettings.phiColor, 0.1F, 16.0F);
+            ImGui::SliderFloat("Denoise Phi Normal", &g_DenoiserSettings.phiNormal, 1.0F, 256.0F);
+            ImGui::SliderFloat("Denoise Phi Depth", &g_DenoiserSettings.phiDepth, 0.1F, 8.0F);
+
+            ImGui::Combo("Tonemap", reinterpret_cast<int*>(&g_OutputSettings.tonemapOperator), "None\0ACES\0");
+            ImGui::SliderFloat("Exposure", &g_OutputSettings.exposure, 0.1F, 8.0F);
+
+            ImGui::Checkbox("Instance Culling + LOD", &g_CullingSettings.enabled);
+            ImGui::SliderFloat("Cull Distance", &g_CullingSettings.maxDistance, 10.0F, 200.0F);
+            ImGui::SliderFloat("Frustum Margin", &g_CullingSettings.frustumMargin, 0.0F, 20.0F);
+            ImGui::SliderFloat2("LOD Thresholds (px)", g_CullingSettings.lodPixelThresholds.data(), 1.0F, 64.0F);
+            ImGui::Text("Instances: %u / %u (LOD0: %u, LOD1: %u, LOD2: %u)",
+                        g_VisibleInstanceCount,
+                        static_cast<uint32_t>(g_InstanceTransforms.size()),
+                        g_InstanceLODCounts[0],
+                        g_InstanceLODCounts[1],
+                        g_InstanceLODCounts[2]);
+
+            // Frames rendered without deformation leave the deformed BLAS at an old pose.
+            if (ImGui::Checkbox("Deform Mesh", &g_DeformationSettings.enabled))
+                g_MeshDeformer.ResetBLAS();
+            ImGui::SliderFloat("Deform Amplitude", &g_DeformationSettings.amplitude, 0.0F, 0.2F);
+            ImGui::SliderFloat("Deform Frequency", &g_DeformationSettings.frequency, 0.5F, 16.0F);
+            ImGui::SliderFloat("Deform Speed", &g_DeformationSettings.speed, 0.0F, 10.0F);
+            ImGui::SliderFloat("BLAS Rebuild Drift", &g_DeformationSettings.rebuildDrift, 0.0F, 0.4F);
+            ImGui::SliderInt("BLAS Max Refits", reinterpret_cast<int*>(&g_DeformationSettings.maxRefits), 0, 600);
+            ImGui::Text("Deformed BLAS: %u refits, %u rebuilds (drift %.3f)",
+                        g_MeshDeformer.GetRefitCount(),
+                        g_MeshDeformer.GetRebuildCount(),
+                        g_MeshDeformer.GetDrift());
+
+            // GPU timings of every pass (both trace paths are listed once used, for a head-to-head comparison).
+            for (const auto& [scopeName, scopeMilliseconds] : pRenderContext->GetGPUProfiler().GetScopes())
+                ImGui::Text("%s: %.3f ms", scopeName.c_str(), scopeMilliseconds);
+
+            const RenderGraph::Statistics& graphStatistics = g_RenderGraph.GetStatistics();
+
+            ImGui::Text("Passes: %u (%u culled), Barriers: %u (%u image, %u memory)",
+                        graphStatistics.passCount,
+                        graphStatistics.culledPassCount,
+                        graphStatistics.barrierBatchCount,
+                        graphStatistics.imageBarrierCount,
+                        graphStatistics.memoryBarrierCount);
+
             ImGui::End();
         }
     };
@@ -114,191 +480,684 @@ int main()
     // Command Recording
     // ------------------------------------------------
 
+    // Rebound to the acquired swapchain image every frame.
+    g_GraphBackBuffer = g_RenderGraph.ImportImage("Back Buffer", VK_NULL_HANDLE, {});
+
     auto RecordCommands = [&](FrameParams frameParams)
     {
+        // Resource states of the frame.
+        // --------------------------------------------
+
+        using ResourceState = RenderGraph::ResourceState;
+
+        // The acquire semaphore is waited on at the color attachment output stage, and the back buffer is written from
+        // scratch every frame.
+        const ResourceState backBufferAcquired = { VK_IMAGE_LAYOUT_UNDEFINED, VK_ACCESS_2_NONE, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT };
+
+        // The user interface is drawn on top of the back buffer after these passes, headless frames go straight to present.
+        const ResourceState backBufferFinal =
+            pRenderContext->IsHeadless()
+                ? ResourceState { VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_ACCESS_2_NONE, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT }
+                : ResourceState { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                                  VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                                  VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT };
+
+        g_RenderGraph.ResetImage(g_GraphBackBuffer, frameParams.backBuffer, backBufferAcquired);
+        g_RenderGraph.Export(g_GraphBackBuffer, backBufferFinal);
+
+        // The fence of this frame slot was waited on, objects replaced kMaxFramesInFlight frames ago are unused now.
+        g_DeferredReleases.Collect();
+
         if (!g_ResourcesReadyFence.load())
         {
-            VulkanColorImageBarrier(frameParams.cmd,
-                                    frameParams.backBuffer,
-                                    VK_IMAGE_LAYOUT_UNDEFINED,
-                                    VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-                                    VK_ACCESS_2_MEMORY_READ_BIT,
-                                    VK_ACCESS_2_MEMORY_READ_BIT,
-                                    VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-                                    VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT);
-
+            g_RenderGraph.Execute(frameParams.cmd);
             return;
         }
 
-        // Configure Attachments
+        // Swap in reloaded ray tracing pipelines, earlier frames in flight keep the ones they were recorded with.
         // --------------------------------------------
 
-        VkRenderingAttachmentInfo colorAttachmentInfo = { VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO };
         {
-            colorAttachmentInfo.loadOp           = VK_ATTACHMENT_LOAD_OP_CLEAR;
-            colorAttachmentInfo.storeOp          = VK_ATTACHMENT_STORE_OP_STORE;
-            colorAttachmentInfo.imageLayout      = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-            colorAttachmentInfo.imageView        = g_ColorAttachment.imageView;
-            colorAttachmentInfo.clearValue.color = {
-                { 1.0, 0.0, 0.0, 1.0 }
-            };
+            std::lock_guard<std::mutex> lock(g_PendingRaytracingVariantsMutex);
+
+            if (!g_PendingRaytracingVariants.empty())
+            {
+                g_RaytracingVariants.Clear(
+                    [&](RaytracingPipeline& raytracingPipeline)
+                    {
+                        g_DeferredReleases.Push([pRenderContext = pRenderContext.get(), raytracingPipeline]() mutable
+                                                { ReleaseRaytracingPipeline(pRenderContext, raytracingPipeline); });
+                    });
+
+                for (const auto& [variant, raytracingPipeline] : g_PendingRaytracingVariants)
+                    g_RaytracingVariants.Insert(variant, raytracingPipeline);
+
+                g_PendingRaytracingVariants.clear();
+            }
+        }
+
+        // A variant that fails to build keeps the previous selection.
+        const RaytracingPipeline* pRaytracingPipeline = g_RaytracingVariants.Get(g_RaytracingVariant);
+
+        if (pRaytracingPipeline == nullptr)
+        {
+            g_RaytracingVariant = g_ActiveRaytracingVariant;
+            pRaytracingPipeline = g_RaytracingVariants.Get(g_RaytracingVariant);
         }
 
-        VkRenderingAttachmentInfo depthAttachmentInfo = { VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO };
+        g_ActiveRaytracingVariant = g_RaytracingVariant;
+
+        // Created by the loader tasks, so imported on the first frame they are ready.
+        static bool s_GraphResourcesImported = false;
+
+        if (!s_GraphResourcesImported)
         {
-            depthAttachmentInfo.loadOp                  = VK_ATTACHMENT_LOAD_OP_CLEAR;
-            depthAttachmentInfo.storeOp                 = VK_ATTACHMENT_STORE_OP_STORE;
-            depthAttachmentInfo.imageLayout             = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
-            depthAttachmentInfo.imageView               = g_DepthAttachment.imageView;
-            depthAttachmentInfo.clearValue.depthStencil = { 1.0, 0x0 };
+            const auto transientResources = g_RenderGraph.ImportTransientImages(g_TransientImages);
+
+            g_GraphColor           = transientResources.at(g_TransientColor);
+            g_GraphGBufferPosition = transientResources.at(g_TransientGBufferPosition);
+            g_GraphGBufferNormal   = transientResources.at(g_TransientGBufferNormal);
+            g_GraphGBufferMotion   = transientResources.at(g_TransientGBufferMotion);
+            g_GraphDenoiseScratch  = transientResources.at(g_TransientDenoiseScratch);
+            g_GraphTLAS            = g_RenderGraph.ImportBuffer("TLAS");
+
+            s_GraphResourcesImported = true;
         }
 
-        // Record
+        // Request the optional passes enabled for the first time, and swap in the ones the loader finished. They are
+        // kept from then on.
         // --------------------------------------------
 
-        VulkanColorImageBarrier(frameParams.cmd,
-                                g_ColorAttachment.image,
-                                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                                VK_ACCESS_2_MEMORY_READ_BIT,
-                                VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
-                                VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-                                VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT);
+        static bool s_DenoiserRequested             = false;
+        static bool s_SparseReconstructionRequested = false;
+        static bool s_MeshDeformerRequested         = false;
+
+        const bool requestDenoiser             = g_DenoiserSettings.enabled && !s_DenoiserRequested;
+        const bool requestSparseReconstruction = g_SparseTraceMode != SparseTraceMode::Full && !s_SparseReconstructionRequested;
+        const bool requestMeshDeformer         = g_DeformationSettings.enabled && !s_MeshDeformerRequested;
 
-        VkRenderingInfo vkRenderingInfo = { VK_STRUCTURE_TYPE_RENDERING_INFO };
+        // One load at a time, passes enabled meanwhile are requested once it is done.
+        if ((requestDenoiser || requestSparseReconstruction || requestMeshDeformer) && !g_OptionalPassLoaderBusy.load())
         {
-            vkRenderingInfo.colorAttachmentCount = 1U;
-            vkRenderingInfo.pColorAttachments    = &colorAttachmentInfo;
-            vkRenderingInfo.pDepthAttachment     = &depthAttachmentInfo;
-            vkRenderingInfo.pStencilAttachment   = VK_NULL_HANDLE;
-            vkRenderingInfo.layerCount           = 1U;
-            vkRenderingInfo.renderArea           = {
-                {            0,             0 },
-                { kWindowWidth, kWindowHeight }
-            };
+            s_DenoiserRequested             |= requestDenoiser;
+            s_SparseReconstructionRequested |= requestSparseReconstruction;
+            s_MeshDeformerRequested         |= requestMeshDeformer;
+
+            g_OptionalPassLoaderBusy.store(true);
+
+            // Joins the previous load, which already published its passes.
+            g_OptionalPassLoader =
+                std::jthread(CreateOptionalPasses, pRenderContext.get(), requestDenoiser, requestSparseReconstruction, requestMeshDeformer);
+
+            // Every headless frame should be a measurable one.
+            if (pRenderContext->IsHeadless())
+                g_OptionalPassLoader.join();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(g_PendingOptionalPassesMutex);
+
+            if (g_PendingDenoiser.has_value())
+            {
+                g_Denoiser = *g_PendingDenoiser;
+                g_Denoiser.Import(g_RenderGraph);
+                g_PendingDenoiser.reset();
+            }
+
+            if (g_PendingSparseReconstruction.has_value())
+            {
+                g_SparseReconstruction = *g_PendingSparseReconstruction;
+                g_SparseReconstruction.Import(g_RenderGraph);
+                g_PendingSparseReconstruction.reset();
+            }
+
+            if (g_PendingMeshDeformer.has_value())
+            {
+                g_MeshDeformer = *g_PendingMeshDeformer;
+                g_MeshDeformer.Import(g_RenderGraph);
+                g_PendingMeshDeformer.reset();
+            }
+        }
+
+        // Enabled passes still being created sit out the frame.
+        const bool denoise = g_DenoiserSettings.enabled && g_Denoiser.IsCreated();
+
+        // Camera, published by the input update at the end of the previous frame.
+        // --------------------------------------------
+
+        const CameraState camera = g_Camera.GetState();
+
+        // The first frame has no previous one, its motion is zero.
+        static glm::mat4 s_PreviousMatrixVP = camera.matrixVP;
+
+        // The slot of this frame in flight, whose fence was waited on.
+        const uint32_t frameConstantsOffset = frameParams.frameInFlightIndex * g_FrameConstantsStride;
+
+        FrameConstants frameConstants;
+        {
+            frameConstants.RayOrigin        = glm::vec4(camera.position, 0.0F);
+            frameConstants.RayCorner        = glm::vec4(camera.rayCorner, 0.0F);
+            frameConstants.RayPixelDeltaX   = glm::vec4(camera.rayPixelDeltaX, 0.0F);
+            frameConstants.RayPixelDeltaY   = glm::vec4(camera.rayPixelDeltaY, 0.0F);
+            frameConstants.PreviousMatrixVP = s_PreviousMatrixVP;
+        }
+        std::memcpy(g_pFrameConstants + frameConstantsOffset, &frameConstants, sizeof(FrameConstants));
+
+        vmaFlushAllocation(pRenderContext->GetAllocator(), g_FrameConstantsBuffer.bufferAllocation, frameConstantsOffset, sizeof(FrameConstants));
+
+        s_PreviousMatrixVP = camera.matrixVP;
+
+        g_PushConstants.LightDirection    = glm::vec4(glm::normalize(g_OcclusionSettings.lightDirection), g_OcclusionSettings.lightConeAngle);
+        g_PushConstants.ShadowSampleCount = static_cast<uint32_t>(g_OcclusionSettings.shadowSampleCount);
+        g_PushConstants.AOSampleCount     = static_cast<uint32_t>(g_OcclusionSettings.aoSampleCount);
+        g_PushConstants.AORadius          = g_OcclusionSettings.aoRadius;
+        g_PushConstants.SamplesPerPixel   = g_RaytracingVariant.samplesPerPixel;
+        g_PushConstants.FrameIndex++;
+
+        // Jittering the primary samples over the frames lets the accumulated history converge to a multi-sample result.
+        g_PushConstants.SampleOffset = denoise ? (g_PushConstants.FrameIndex % kTemporalJitterFrameCount) * g_PushConstants.SamplesPerPixel : 0U;
+
+        // Sparse modes trace their subset of the pixels, every pixel once per cycle of the mode.
+        const SparseTraceMode sparseTraceMode = g_SparseReconstruction.IsCreated() ? g_SparseTraceMode : SparseTraceMode::Full;
+
+        g_PushConstants.SparseMode  = static_cast<uint32_t>(sparseTraceMode);
+        g_PushConstants.SparsePhase = g_PushConstants.FrameIndex % GetSparseTracePhaseCount(sparseTraceMode);
+
+        const VkExtent2D traceExtent =
+            GetSparseTraceDispatchSize(sparseTraceMode, pRenderContext->GetRenderWidth(), pRenderContext->GetRenderHeight());
+
+        // Cull instances + select LODs for this view, and rebuild the TLAS from the survivors.
+        // --------------------------------------------
+
+        InstanceCullingParams cullingParams;
+        {
+            ComputeFrustumPlanes(camera.matrixVP, cullingParams.frustumPlanes);
+
+            cullingParams.cameraPosition     = camera.position;
+            cullingParams.maxDistance        = g_CullingSettings.maxDistance;
+            cullingParams.frustumMargin      = g_CullingSettings.frustumMargin;
+            cullingParams.projectionScale    = 0.5F * pRenderContext->GetRenderHeight() / std::tan(0.5F * glm::radians(kCameraFieldOfView));
+            cullingParams.lodPixelThresholds = g_CullingSettings.lodPixelThresholds;
         }
-        vkCmdBeginRendering(frameParams.cmd, &vkRenderingInfo);
 
-        // NO-OP
+        // Deform the animated mesh and refit its BLAS, ahead of the TLAS build referencing it.
+        // --------------------------------------------
+
+        static float s_DeformationTime = 0.0F;
+
+        const bool deformMesh = g_DeformationSettings.enabled && g_MeshDeformer.IsCreated();
+
+        if (deformMesh)
+        {
+            // Scripted cameras step the animation by a fixed time as well, so benchmark runs see the same poses.
+            s_DeformationTime += g_LaunchOptions.cameraPath ? kCameraScriptedTimeStep : static_cast<float>(frameParams.deltaTime);
+
+            g_MeshDeformer.AddPasses(
+                g_RenderGraph, g_DeformationSettings, s_DeformationTime, frameParams.frameInFlightIndex, pRenderContext->GetGPUProfiler());
+        }
+
+        // Traversals read the deformed BLAS, and the hit shaders its vertices.
+        auto AddDeformedMeshReads = [&](std::vector<RenderGraph::ResourceUsage>& usages, VkPipelineStageFlags2 stage, bool readVertices)
+        {
+            if (!deformMesh)
+                return;
 
-        vkCmdEndRendering(frameParams.cmd);
+            const uint32_t frameInFlightIndex = frameParams.frameInFlightIndex;
+
+            usages.push_back({ g_MeshDeformer.GetGraphBLAS(frameInFlightIndex),
+                               { VK_IMAGE_LAYOUT_UNDEFINED, VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR, stage } });
+
+            if (readVertices)
+            {
+                usages.push_back({ g_MeshDeformer.GetGraphVertices(frameInFlightIndex),
+                                   { VK_IMAGE_LAYOUT_UNDEFINED, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, stage } });
+            }
+        };
 
-        // Temp camera
+        // Nothing changes without culling or deformation, the initial build stays valid.
+        if (g_CullingSettings.enabled || g_TLASRequiresRebuild || deformMesh)
         {
-            static float s_Time = 0.0F;
+            const ResourceState tlasBuild = { VK_IMAGE_LAYOUT_UNDEFINED,
+                                              VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,
+                                              VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR };
+
+            std::vector<RenderGraph::ResourceUsage> tlasUsages = { { g_GraphTLAS, tlasBuild } };
+
+            AddDeformedMeshReads(tlasUsages, VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, false);
+
+            g_RenderGraph.AddPass(
+                "TLAS Build",
+                std::move(tlasUsages),
+                [&, deformMesh](VkCommandBuffer cmd)
+                { UpdateTLAS(pRenderContext.get(), cmd, frameParams.frameInFlightIndex, cullingParams, deformMesh); });
+        }
+
+        // Select the trace implementation for this frame.
+        // --------------------------------------------
+
+        // Alternating switches path every frame, the selection in the UI stays what the user picked.
+        RenderPath renderPath = g_RenderPath;
+
+        if (g_AlternateRenderPaths)
+            renderPath = (g_PushConstants.FrameIndex & 1U) != 0U ? RenderPath::RayQueryCompute : RenderPath::RaytracingPipeline;
+
+        const VkPipelineStageFlags2 traceStage =
+            renderPath == RenderPath::RaytracingPipeline ? VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR : VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+
+        // Shader binding table regions.
+        // --------------------------------------------
+
+        auto handleSize        = g_RayTracingProperties.shaderGroupHandleSize;
+        auto handleAlignment   = g_RayTracingProperties.shaderGroupHandleAlignment;
+        auto handleSizeAligned = (handleSize + handleAlignment - 1) & ~(handleAlignment - 1);
+
+        VkStridedDeviceAddressRegionKHR shaderBindingAddressRayGen {};
+        shaderBindingAddressRayGen.deviceAddress = GetBufferDeviceAddress(pRenderContext.get(), pRaytracingPipeline->shaderBindingsRayGen);
+        shaderBindingAddressRayGen.stride        = handleSizeAligned;
+        shaderBindingAddressRayGen.size          = handleSizeAligned;
+
+        VkStridedDeviceAddressRegionKHR shaderBindingAddressOcclusionRayGen {};
+        shaderBindingAddressOcclusionRayGen.deviceAddress =
+            GetBufferDeviceAddress(pRenderContext.get(), pRaytracingPipeline->shaderBindingsOcclusionRayGen);
+        shaderBindingAddressOcclusionRayGen.stride        = handleSizeAligned;
+        shaderBindingAddressOcclusionRayGen.size          = handleSizeAligned;
+
+        VkStridedDeviceAddressRegionKHR shaderBindingAddressHit {};
+        shaderBindingAddressHit.deviceAddress = GetBufferDeviceAddress(pRenderContext.get(), pRaytracingPipeline->shaderBindingsClosestHit);
+        shaderBindingAddressHit.stride        = handleSizeAligned;
+        shaderBindingAddressHit.size          = handleSizeAligned;
+
+        // Primary miss followed by the visibility miss.
+        VkStridedDeviceAddressRegionKHR shaderBindingAddressMiss {};
+        shaderBindingAddressMiss.deviceAddress = GetBufferDeviceAddress(pRenderContext.get(), pRaytracingPipeline->shaderBindingsMiss);
+        shaderBindingAddressMiss.stride        = handleSizeAligned;
+        shaderBindingAddressMiss.size          = handleSizeAligned * kMissShaderCount;
+
+        VkStridedDeviceAddressRegionKHR shaderBindingAddressCallable {};
+
+        // Primary visibility (color + G-buffer).
+        // --------------------------------------------
+
+        // Frame resources + the bindless scene resources, shared by both render paths and the visibility rays.
+        const std::array<VkDescriptorSet, 2> traceDescriptorSets = { g_DescriptorSet, g_BindlessDescriptors.GetSet() };
+
+        // Tracks the pipeline bound by the passes as they are recorded.
+        bool raytracingPipelineBound = false;
+
+        std::vector<RenderGraph::ResourceUsage> traceUsages = {
+            { g_GraphTLAS, { VK_IMAGE_LAYOUT_UNDEFINED, VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR, traceStage } },
+            { g_GraphColor, { VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, traceStage } },
+            { g_GraphGBufferPosition, { VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, traceStage } },
+            { g_GraphGBufferNormal, { VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, traceStage } },
+            { g_GraphGBufferMotion, { VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, traceStage } },
+        };
+
+        AddDeformedMeshReads(traceUsages, traceStage, true);
+
+        g_RenderGraph.AddPass(
+            kRenderPathNames.at(static_cast<int>(renderPath)),
+            std::move(traceUsages),
+            [&](VkCommandBuffer cmd)
+            {
+                vkCmdPushConstants(cmd,
+                                   g_PipelineLayout,
+                                   VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT,
+                                   0U,
+                                   sizeof(RaytracingPushConstants),
+                                   &g_PushConstants);
+
+                pRenderContext->GetGPUProfiler().BeginScope(cmd, kRenderPathNames.at(static_cast<int>(renderPath)));
+
+                // Dispatch rays.
+                if (renderPath == RenderPath::RaytracingPipeline)
+                {
+                    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, pRaytracingPipeline->pipeline);
+
+                    vkCmdBindDescriptorSets(
+                        cmd, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, g_PipelineLayout, 0, 2, traceDescriptorSets.data(), 1, &frameConstantsOffset);
+
+                    vkCmdTraceRaysKHR(cmd,
+                                      &shaderBindingAddressRayGen,
+                                      &shaderBindingAddressMiss,
+                                      &shaderBindingAddressHit,
+                                      &shaderBindingAddressCallable,
+                                      traceExtent.width,
+                                      traceExtent.height,
+                                      1U);
+
+                    raytracingPipelineBound = true;
+                }
+                // Dispatch inline ray queries.
+                else
+                {
+                    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, g_RayQueryPipeline);
+
+                    vkCmdBindDescriptorSets(
+                        cmd, VK_PIPELINE_BIND_POINT_COMPUTE, g_PipelineLayout, 0, 2, traceDescriptorSets.data(), 1, &frameConstantsOffset);
+
+                    vkCmdDispatch(cmd, (traceExtent.width + 7U) / 8U, (traceExtent.height + 7U) / 8U, 1U);
+                }
+
+                pRenderContext->GetGPUProfiler().EndScope(cmd);
+            });
+
+        // Visibility rays (shadows + ambient occlusion), modulating the color attachment in place.
+        // --------------------------------------------
+
+        auto AddOcclusionPass = [&](uint32_t occlusionPass, const char* scopeName)
+        {
+            const VkPipelineStageFlags2 occlusionStage = VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR;
+
+            std::vector<RenderGraph::ResourceUsage> occlusionUsages = {
+                { g_GraphTLAS, { VK_IMAGE_LAYOUT_UNDEFINED, VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR, occlusionStage } },
+                { g_GraphColor,
+                  { VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, occlusionStage } },
+                { g_GraphGBufferPosition, { VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, occlusionStage } },
+                { g_GraphGBufferNormal, { VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, occlusionStage } },
+            };
+
+            // Visibility rays skip the closest hit shader, they never read the vertices.
+            AddDeformedMeshReads(occlusionUsages, occlusionStage, false);
+
+            g_RenderGraph.AddPass(
+                scopeName,
+                std::move(occlusionUsages),
+                [&, occlusionPass, scopeName](VkCommandBuffer cmd)
+                {
+                    if (!raytracingPipelineBound)
+                    {
+                        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, pRaytracingPipeline->pipeline);
+
+                        vkCmdBindDescriptorSets(cmd,
+                                                VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR,
+                                                g_PipelineLayout,
+                                                0,
+                                                2,
+                                                traceDescriptorSets.data(),
+                                                1,
+                                                &frameConstantsOffset);
+
+                        raytracingPipelineBound = true;
+                    }
+
+                    g_PushConstants.OcclusionPass = occlusionPass;
+
+                    vkCmdPushConstants(cmd,
+                                       g_PipelineLayout,
+                                       VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT,
+                                       0U,
+                                       sizeof(RaytracingPushConstants),
+                                       &g_PushConstants);
+
+                    pRenderContext->GetGPUProfiler().BeginScope(cmd, scopeName);
+
+                    vkCmdTraceRaysKHR(cmd,
+                                      &shaderBindingAddressOcclusionRayGen,
+                                      &shaderBindingAddressMiss,
+                                      &shaderBindingAddressHit,
+                                      &shaderBindingAddressCallable,
+                                      traceExtent.width,
+                                      traceExtent.height,
+                                      1U);
+
+                    pRenderContext->GetGPUProfiler().EndScope(cmd);
+                });
+        };
+
+        if (g_PushConstants.ShadowSampleCount > 0U)
+            AddOcclusionPass(kOcclusionPassShadow, "Shadow Rays");
+
+        if (g_PushConstants.AOSampleCount > 0U)
+            AddOcclusionPass(kOcclusionPassAO, "Ambient Occlusion Rays");
+
+        // Fill in the pixels the sparse trace skipped (color + G-buffer), the passes after this one see a full frame.
+        // --------------------------------------------
+
+        if (sparseTraceMode != SparseTraceMode::Full)
+        {
+            const SparseReconstruction::FrameResources reconstructResources = {
+                g_GraphColor, g_GraphGBufferPosition, g_GraphGBufferNormal, g_GraphGBufferMotion
+            };
 
-            auto matrixV =
-                glm::lookAt(glm::vec3(50 * std::sin(0.2 * s_Time), 0, 50 * std::cos(0.2 * s_Time)), glm::vec3(0, 1, 0), glm::vec3(0, -1, 0));
-            auto matrixP = glm::perspective(glm::radians(30.0F), kWindowWidth / (float)kWindowHeight, 0.001F, 100.0F);
+            g_SparseReconstruction.AddPass(
+                g_RenderGraph, reconstructResources, sparseTraceMode, g_PushConstants.SparsePhase, pRenderContext->GetGPUProfiler());
+        }
 
-            s_Time += (float)frameParams.deltaTime;
+        // Temporal accumulation + a-trous filter of the color attachment, guided by the G-buffer.
+        // --------------------------------------------
 
-            g_PushConstants.InverseMatrixV = glm::inverse(matrixV);
-            g_PushConstants.InverseMatrixP = glm::inverse(matrixP);
+        if (denoise)
+        {
+            const Denoiser::FrameResources denoiseResources = {
+                g_GraphColor, g_GraphGBufferPosition, g_GraphGBufferNormal, g_GraphGBufferMotion, g_GraphDenoiseScratch
+            };
 
-            vkCmdPushConstants(frameParams.cmd,
-                               g_PipelineLayout,
-                               VK_SHADER_STAGE_RAYGEN_BIT_KHR,
-                               0U,
-                               sizeof(RaytracingPushConstants),
-                               &g_PushConstants);
+            g_Denoiser.AddPasses(g_RenderGraph, denoiseResources, camera, g_DenoiserSettings, pRenderContext->GetGPUProfiler());
         }
 
-        // Dispatch rays.
+        // Tone map the HDR output into the back buffer.
+        // --------------------------------------------
+
+        // Storage-capable back buffers are written directly, otherwise the color attachment is tone mapped in place
+        // and blitted (with format conversion).
+        const bool outputInPlace = !pRenderContext->IsBackBufferStorage();
+
+        std::vector<RenderGraph::ResourceUsage> outputUsages;
+
+        if (outputInPlace)
+        {
+            outputUsages.push_back({ g_GraphColor,
+                                     { VK_IMAGE_LAYOUT_GENERAL,
+                                       VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                                       VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT } });
+        }
+        else
         {
-            VulkanColorImageBarrier(frameParams.cmd,
-                                    g_ColorAttachment.image,
-                                    VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                                    VK_IMAGE_LAYOUT_GENERAL,
-                                    VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
-                                    VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
-                                    VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-                                    VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR);
-
-            vkCmdBindPipeline(frameParams.cmd, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, g_RaytracingPipeline);
-
-            vkCmdBindDescriptorSets(frameParams.cmd, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, g_PipelineLayout, 0, 1, &g_DescriptorSet, 0, 0);
-
-            auto handleSize        = g_RayTracingProperties.shaderGroupHandleSize;
-            auto handleAlignment   = g_RayTracingProperties.shaderGroupHandleAlignment;
-            auto handleSizeAligned = (handleSize + handleAlignment - 1) & ~(handleAlignment - 1);
-
-            VkStridedDeviceAddressRegionKHR shaderBindingAddressRayGen {};
-            shaderBindingAddressRayGen.deviceAddress = GetBufferDeviceAddress(pRenderContext.get(), g_ShaderBindingsRayGen);
-            shaderBindingAddressRayGen.stride        = handleSizeAligned;
-            shaderBindingAddressRayGen.size          = handleSizeAligned;
-
-            VkStridedDeviceAddressRegionKHR shaderBindingAddressHit {};
-            shaderBindingAddressHit.deviceAddress = GetBufferDeviceAddress(pRenderContext.get(), g_ShaderBindingsClosestHit);
-            shaderBindingAddressHit.stride        = handleSizeAligned;
-            shaderBindingAddressHit.size          = handleSizeAligned;
-
-            VkStridedDeviceAddressRegionKHR shaderBindingAddressMiss {};
-            shaderBindingAddressMiss.deviceAddress = GetBufferDeviceAddress(pRenderContext.get(), g_ShaderBindingsMiss);
-            shaderBindingAddressMiss.stride        = handleSizeAligned;
-            shaderBindingAddressMiss.size          = handleSizeAligned;
-
-            VkStridedDeviceAddressRegionKHR shaderBindingAddressCallable {};
-
-            vkCmdTraceRaysKHR(frameParams.cmd,
-                              &shaderBindingAddressRayGen,
-                              &shaderBindingAddressMiss,
-                              &shaderBindingAddressHit,
-                              &shaderBindingAddressCallable,
-                              kWindowWidth,
-                              kWindowHeight,
-                              1U);
+            outputUsages.push_back(
+                { g_GraphColor, { VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT } });
+            outputUsages.push_back(
+                { g_GraphBackBuffer, { VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT } });
         }
 
-        // Copy the internal color attachment to back buffer.
-
-        VulkanColorImageBarrier(frameParams.cmd,
-                                g_ColorAttachment.image,
-                                VK_IMAGE_LAYOUT_GENERAL,
-                                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                                VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
-                                VK_ACCESS_2_TRANSFER_READ_BIT,
-                                VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR,
-                                VK_PIPELINE_STAGE_2_TRANSFER_BIT);
-
-        VulkanColorImageBarrier(frameParams.cmd,
-                                frameParams.backBuffer,
-                                VK_IMAGE_LAYOUT_UNDEFINED,
-                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                VK_ACCESS_2_MEMORY_READ_BIT,
-                                VK_ACCESS_2_MEMORY_WRITE_BIT,
-                                VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-                                VK_PIPELINE_STAGE_2_TRANSFER_BIT);
-
-        VkImageCopy backBufferCopy = {};
+        g_RenderGraph.AddPass(
+            "Tonemap",
+            std::move(outputUsages),
+            [&](VkCommandBuffer cmd)
+            {
+                OutputPushConstants outputPushConstants;
+                {
+                    outputPushConstants.Exposure        = g_OutputSettings.exposure;
+                    outputPushConstants.TonemapOperator = static_cast<uint32_t>(g_OutputSettings.tonemapOperator);
+                    outputPushConstants.InPlace         = outputInPlace ? 1U : 0U;
+                }
+
+                pRenderContext->GetGPUProfiler().BeginScope(cmd, "Tonemap");
+
+                vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, g_OutputPipeline);
+
+                vkCmdBindDescriptorSets(cmd,
+                                        VK_PIPELINE_BIND_POINT_COMPUTE,
+                                        g_OutputPipelineLayout,
+                                        0,
+                                        1,
+                                        &g_OutputDescriptorSets.at(frameParams.backBufferIndex),
+                                        0,
+                                        0);
+
+                vkCmdPushConstants(cmd, g_OutputPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0U, sizeof(OutputPushConstants), &outputPushConstants);
+
+                vkCmdDispatch(cmd, (pRenderContext->GetRenderWidth() + 7U) / 8U, (pRenderContext->GetRenderHeight() + 7U) / 8U, 1U);
+
+                pRenderContext->GetGPUProfiler().EndScope(cmd);
+            });
+
+        if (outputInPlace)
         {
-            backBufferCopy.extent         = { kWindowWidth, kWindowHeight, 1U };
-            backBufferCopy.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0U, 0U, 1U };
-            backBufferCopy.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0U, 0U, 1U };
+            g_RenderGraph.AddPass(
+                "Back Buffer Blit",
+                {
+                    { g_GraphColor, { VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_2_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT } },
+                    { g_GraphBackBuffer, { VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT } },
+                },
+                [&](VkCommandBuffer cmd)
+                {
+                    const VkOffset3D blitExtent = { static_cast<int32_t>(pRenderContext->GetRenderWidth()),
+                                                    static_cast<int32_t>(pRenderContext->GetRenderHeight()),
+                                                    1 };
+
+                    VkImageBlit backBufferBlit = {};
+                    {
+                        backBufferBlit.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0U, 0U, 1U };
+                        backBufferBlit.srcOffsets[1]  = blitExtent;
+                        backBufferBlit.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0U, 0U, 1U };
+                        backBufferBlit.dstOffsets[1]  = blitExtent;
+                    }
+
+                    vkCmdBlitImage(cmd,
+                                   g_ColorAttachment.image,
+                                   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                   frameParams.backBuffer,
+                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                   1U,
+                                   &backBufferBlit,
+                                   VK_FILTER_NEAREST);
+                });
         }
 
-        vkCmdCopyImage(frameParams.cmd,
-                       g_ColorAttachment.image,
-                       VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                       frameParams.backBuffer,
-                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                       1U,
-                       &backBufferCopy);
-
-        VulkanColorImageBarrier(frameParams.cmd,
-                                frameParams.backBuffer,
-                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-                                VK_ACCESS_2_MEMORY_WRITE_BIT,
-                                VK_ACCESS_2_MEMORY_READ_BIT,
-                                VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-                                VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT);
+        // Record
+        // --------------------------------------------
+
+        g_RenderGraph.Execute(frameParams.cmd);
+    };
+
+    // Frame timings for the benchmark results (the GPU timings resolved this frame belong to an earlier one).
+    // ------------------------------------------------
+
+    auto RecordCommandsAndTimings = [&](FrameParams frameParams)
+    {
+        static uint32_t s_FrameIndex = 0U;
+
+        if (g_ResourcesReadyFence.load() && s_FrameIndex++ >= g_LaunchOptions.warmupFrames)
+            g_BenchmarkRecorder.RecordFrame(1000.0 * frameParams.deltaTime, pRenderContext->GetGPUProfiler().GetLastFrameScopes());
+
+        RecordCommands(frameParams);
     };
 
     // Kick off render-loop.
     // ------------------------------------------------
 
-    pRenderContext->Dispatch(RecordCommands, RecordInterface);
+    g_Camera.Initialize(pRenderContext->GetRenderWidth(), pRenderContext->GetRenderHeight());
+
+    // A pinned or scripted camera keeps benchmark runs comparable.
+    if (g_LaunchOptions.cameraTime >= 0.0F || g_LaunchOptions.cameraPath)
+        g_Camera.SetScriptedPath(std::max(g_LaunchOptions.cameraTime, 0.0F), g_LaunchOptions.cameraPath ? kCameraScriptedTimeStep : 0.0F);
+
+    auto UpdateInput = [&](double deltaTime) { g_Camera.Update(pRenderContext->GetWindow(), deltaTime); };
+
+    // Shader hot reload, the pipeline + shader binding tables are rebuilt on the watcher thread.
+    // ------------------------------------------------
+
+    auto RebuildRaytracingPipeline = [&](const std::vector<std::string>& shaderNames)
+    {
+        if (!g_ResourcesReadyFence.load())
+        {
+            spdlog::warn("Shaders changed before the resources were loaded, keeping the startup pipeline.");
+            return false;
+        }
+
+        // Every cached variant is rebuilt, so switching between them never compiles stale SPIR-V.
+        std::vector<std::pair<ShaderVariant, RaytracingPipeline>> raytracingVariants;
+
+        for (const auto& variant : g_RaytracingVariants.GetVariants())
+        {
+            RaytracingPipeline raytracingPipeline;
+
+            if (!CreateRaytracingPipeline(pRenderContext.get(), variant, raytracingPipeline))
+            {
+                for (auto& [builtVariant, builtPipeline] : raytracingVariants)
+                    ReleaseRaytracingPipeline(pRenderContext.get(), builtPipeline);
+
+                return false;
+            }
+
+            CreateShaderBindingTables(pRenderContext.get(), raytracingPipeline);
+
+            raytracingVariants.emplace_back(variant, raytracingPipeline);
+        }
+
+        std::lock_guard<std::mutex> lock(g_PendingRaytracingVariantsMutex);
+
+        // Replaced before a frame picked them up, so never referenced by the GPU.
+        for (auto& [pendingVariant, pendingPipeline] : g_PendingRaytracingVariants)
+            ReleaseRaytracingPipeline(pRenderContext.get(), pendingPipeline);
+
+        g_PendingRaytracingVariants = std::move(raytracingVariants);
+
+        spdlog::info("Rebuilt {} ray tracing pipeline variant(s) ({} shader(s) changed).", g_PendingRaytracingVariants.size(), shaderNames.size());
+
+        return true;
+    };
+
+    if (g_LaunchOptions.shaderHotReload && !pRenderContext->IsHeadless())
+    {
+        g_ShaderHotReload.Start(GetShaderDirectory(),
+                                std::vector<ShaderHotReload::Shader>(kRaytracingShaders.begin(), kRaytracingShaders.end()),
+                                RebuildRaytracingPipeline);
+    }
+
+    pRenderContext->Dispatch(RecordCommandsAndTimings, RecordInterface, UpdateInput);
+
+    // Joins a rebuild in progress, its pipelines are released with the pending ones.
+    g_ShaderHotReload.Stop();
+
+    // Joins a load in progress, its passes are released with the pending ones.
+    if (g_OptionalPassLoader.joinable())
+        g_OptionalPassLoader.join();
+
+    // Benchmark results.
+    // ------------------------------------------------
+
+    vkDeviceWaitIdle(pRenderContext->GetDevice());
+
+    VmaTotalStatistics memoryStatistics;
+    vmaCalculateStatistics(pRenderContext->GetAllocator(), &memoryStatistics);
+
+    g_BenchmarkRecorder.RecordMemory(memoryStatistics.total.statistics.allocationBytes, memoryStatistics.total.statistics.blockBytes);
+
+    // Barrier cost of the last frame (the render graph resolves the same barriers every steady-state frame).
+    const RenderGraph::Statistics& graphStatistics = g_RenderGraph.GetStatistics();
+
+    g_BenchmarkRecorder.RecordCounter("renderGraphPasses", graphStatistics.passCount - graphStatistics.culledPassCount);
+    g_BenchmarkRecorder.RecordCounter("pipelineBarrierCalls", graphStatistics.barrierBatchCount);
+    g_BenchmarkRecorder.RecordCounter("imageBarriers", graphStatistics.imageBarrierCount);
+    g_BenchmarkRecorder.RecordCounter("memoryBarriers", graphStatistics.memoryBarrierCount);
+
+    // Primary rays of a frame, to weigh the sparse trace modes against their image error.
+    const VkExtent2D traceExtent = GetSparseTraceDispatchSize(g_SparseTraceMode, pRenderContext->GetRenderWidth(), pRenderContext->GetRenderHeight());
+
+    g_BenchmarkRecorder.RecordCounter("primaryRaysPerFrame",
+                                      static_cast<uint64_t>(traceExtent.width) * traceExtent.height * g_ActiveRaytracingVariant.samplesPerPixel);
+
+    // How often the deformed BLAS was refit or rebuilt, their GPU cost per frame is in the scope timings.
+    if (g_DeformationSettings.enabled)
+    {
+        g_BenchmarkRecorder.RecordCounter("blasRefits", g_MeshDeformer.GetRefitCount());
+        g_BenchmarkRecorder.RecordCounter("blasRebuilds", g_MeshDeformer.GetRebuildCount());
+    }
+
+    if (pRenderContext->IsHeadless() && !g_LaunchOptions.capturePath.empty())
+    {
+        ImageRGB8 capture;
+
+        if (pRenderContext->CaptureLastFrame(capture))
+            WritePPM(g_LaunchOptions.capturePath.c_str(), capture);
+    }
+
+    if (!g_LaunchOptions.resultsPath.empty())
+        g_BenchmarkRecorder.WriteJSON(g_LaunchOptions.resultsPath.c_str(), g_LaunchOptions);
+
+    if (!g_LaunchOptions.tracePath.empty())
+        CPUTracer::Get().WriteChromeTrace(g_LaunchOptions.tracePath.c_str());
 
     // Shutdown
     // ------------------------------------------------
@@ -319,40 +1178,198 @@ uint64_t GetBufferDeviceAddress(RenderContext* pRenderContext, const Buffer& buf
     return vkGetBufferDeviceAddressKHR(pRenderContext->GetDevice(), &deviceAddressInfo);
 }
 
-void BuildBLAS(RenderContext* pRenderContext, VkCommandPool vkCommandPool, uint32_t vertexCount, uint32_t indexCount)
+void BuildBLAS(RenderContext* pRenderContext, VkCommandPool vkCommandPool, Mesh& mesh)
+{
+    VkAccelerationStructureGeometryKHR blasGeometryInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR };
+    {
+        blasGeometryInfo.geometryType                                = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
+        blasGeometryInfo.flags                                       = kBLASGeometryFlags;
+        blasGeometryInfo.geometry.triangles.sType                    = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
+        blasGeometryInfo.geometry.triangles.vertexFormat             = kBLASVertexFormat;
+        blasGeometryInfo.geometry.triangles.vertexData.deviceAddress = GetBufferDeviceAddress(pRenderContext, mesh.vertexBuffer);
+        blasGeometryInfo.geometry.triangles.maxVertex                = mesh.vertexCount;
+        blasGeometryInfo.geometry.triangles.vertexStride             = sizeof(Vertex);
+        blasGeometryInfo.geometry.triangles.indexType                = VK_INDEX_TYPE_UINT32;
+        blasGeometryInfo.geometry.triangles.indexData.deviceAddress  = GetBufferDeviceAddress(pRenderContext, mesh.indexBuffer);
+    }
+
+    VkAccelerationStructureBuildGeometryInfoKHR blasBuildGeometryInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR };
+    {
+        blasBuildGeometryInfo.type          = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+        blasBuildGeometryInfo.flags         = kBLASBuildFlags;
+        blasBuildGeometryInfo.geometryCount = 1;
+        blasBuildGeometryInfo.pGeometries   = &blasGeometryInfo;
+    }
+
+    VkAccelerationStructureBuildSizesInfoKHR blasBuildSizesInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR };
+
+    const uint32_t primitiveCount = mesh.indexCount / 3U;
+
+    vkGetAccelerationStructureBuildSizesKHR(pRenderContext->GetDevice(),
+                                            VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
+                                            &blasBuildGeometryInfo,
+                                            &primitiveCount,
+                                            &blasBuildSizesInfo);
+
+    // Create backing memory for the BLAS
+    // ------------------------------------------------
+
+    VkBufferCreateInfo bufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+    bufferInfo.size               = blasBuildSizesInfo.accelerationStructureSize;
+    bufferInfo.usage              = VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage                   = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    Check(vmaCreateBuffer(pRenderContext->GetAllocator(),
+                          &bufferInfo,
+                          &allocInfo,
+                          &mesh.blas.backingMemory.buffer,
+                          &mesh.blas.backingMemory.bufferAllocation,
+                          nullptr),
+          "Failed to create dedicated buffer memory.");
+
+    // Create intermediate scratch memory
+    // ------------------------------------------------
+
+    bufferInfo.size  = blasBuildSizesInfo.buildScratchSize;
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+    allocInfo.usage  = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    Buffer scratchBuffer;
+    Check(vmaCreateBuffer(pRenderContext->GetAllocator(), &bufferInfo, &allocInfo, &scratchBuffer.buffer, &scratchBuffer.bufferAllocation, nullptr),
+          "Failed to create dedicated buffer memory.");
+
+    // Create BLAS Primitive
+    // ------------------------------------------------
+
+    VkAccelerationStructureCreateInfoKHR acceleration_structure_create_info { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR };
+    {
+        acceleration_structure_create_info.buffer = mesh.blas.backingMemory.buffer;
+        acceleration_structure_create_info.size   = blasBuildSizesInfo.accelerationStructureSize;
+        acceleration_structure_create_info.type   = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+    }
+    Check(vkCreateAccelerationStructureKHR(pRenderContext->GetDevice(), &acceleration_structure_create_info, nullptr, &mesh.blas.handle),
+          "Failed to create acceleration structure");
+
+    // Build
+    // ------------------------------------------------
+
+    {
+        // Rest is defined above.
+        blasBuildGeometryInfo.scratchData.deviceAddress = GetBufferDeviceAddress(pRenderContext, scratchBuffer);
+        blasBuildGeometryInfo.dstAccelerationStructure  = mesh.blas.handle;
+    }
+
+    VkAccelerationStructureBuildRangeInfoKHR blasBuildRangeInfo;
+    {
+        blasBuildRangeInfo.primitiveCount  = primitiveCount;
+        blasBuildRangeInfo.primitiveOffset = 0;
+        blasBuildRangeInfo.firstVertex     = 0;
+        blasBuildRangeInfo.transformOffset = 0;
+    }
+    std::vector<VkAccelerationStructureBuildRangeInfoKHR*> blasBuildRangeInfos = { &blasBuildRangeInfo };
+
+    auto buildTimeBegin = std::chrono::high_resolution_clock::now();
+
+    VkCommandBuffer vkCommand = VK_NULL_HANDLE;
+    SingleShotCommandBegin(pRenderContext, vkCommand, vkCommandPool);
+    {
+        vkCmdBuildAccelerationStructuresKHR(vkCommand, 1U, &blasBuildGeometryInfo, blasBuildRangeInfos.data());
+    }
+    SingleShotCommandEnd(pRenderContext, vkCommand);
+
+    // Submit to completion, so it includes the wait on the queue.
+    g_BenchmarkRecorder.RecordTiming(std::format("BLAS Build Device ({} triangles)", primitiveCount), MillisecondsSince(buildTimeBegin));
+
+    VkAccelerationStructureDeviceAddressInfoKHR blasDeviceAddressInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR };
+    {
+        blasDeviceAddressInfo.accelerationStructure = mesh.blas.handle;
+    }
+    mesh.blas.deviceAddress = vkGetAccelerationStructureDeviceAddressKHR(pRenderContext->GetDevice(), &blasDeviceAddressInfo);
+
+    // Release scratch memory
+    // ------------------------------------------------
+
+    vmaDestroyBuffer(pRenderContext->GetAllocator(), scratchBuffer.buffer, scratchBuffer.bufferAllocation);
+
+    NameVulkanObject(pRenderContext->GetDevice(), VK_OBJECT_TYPE_ACCELERATION_STRUCTURE_KHR, (uint64_t)mesh.blas.handle, "BLAS");
+
+    spdlog::info("Built bottom-level acceleration structure ({} triangles).", primitiveCount);
+}
+
+// Completes a host command started with a deferred operation on the helper threads of ParallelFor, returns its result
+// and the number of threads that joined it.
+VkResult JoinDeferredOperation(RenderContext*         pRenderContext,
+                               VkDeferredOperationKHR vkDeferredOperation,
+                               VkResult               result,
+                               uint32_t&              joinThreadCount)
+{
+    joinThreadCount = 1U;
+
+    if (result == VK_OPERATION_NOT_DEFERRED_KHR)
+        return VK_SUCCESS;
+
+    if (result != VK_OPERATION_DEFERRED_KHR)
+        return result;
+
+    joinThreadCount = std::clamp(vkGetDeferredOperationMaxConcurrencyKHR(pRenderContext->GetDevice(), vkDeferredOperation),
+                                 1U,
+                                 std::max(1U, std::thread::hardware_concurrency()));
+
+    ParallelFor(joinThreadCount,
+                1U,
+                [&](uint32_t, uint32_t, uint32_t)
+                {
+                    // Idle means no work for this thread right now, but more may come until the operation is done.
+                    VkResult joinResult = vkDeferredOperationJoinKHR(pRenderContext->GetDevice(), vkDeferredOperation);
+
+                    while (joinResult == VK_THREAD_IDLE_KHR)
+                    {
+                        std::this_thread::yield();
+                        joinResult = vkDeferredOperationJoinKHR(pRenderContext->GetDevice(), vkDeferredOperation);
+                    }
+                });
+
+    return vkGetDeferredOperationResultKHR(pRenderContext->GetDevice(), vkDeferredOperation);
+}
+
+// Host and device acceleration structures don't share a layout, so the host build is serialized and deserialized into
+// device memory. Returns false when the driver can't deserialize the host result, the caller then builds on the device.
+bool BuildBLASOnHost(RenderContext* pRenderContext, VkCommandPool vkCommandPool, Mesh& mesh)
 {
     VkAccelerationStructureGeometryKHR blasGeometryInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR };
     {
-        blasGeometryInfo.geometryType                                = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
-        blasGeometryInfo.flags                                       = VK_GEOMETRY_OPAQUE_BIT_KHR;
-        blasGeometryInfo.geometry.triangles.sType                    = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
-        blasGeometryInfo.geometry.triangles.vertexFormat             = VK_FORMAT_R32G32B32_SFLOAT;
-        blasGeometryInfo.geometry.triangles.vertexData.deviceAddress = GetBufferDeviceAddress(pRenderContext, g_MeshVertexBuffer);
-        blasGeometryInfo.geometry.triangles.maxVertex                = vertexCount;
-        blasGeometryInfo.geometry.triangles.vertexStride             = sizeof(Vertex);
-        blasGeometryInfo.geometry.triangles.indexType                = VK_INDEX_TYPE_UINT32;
-        blasGeometryInfo.geometry.triangles.indexData.deviceAddress  = GetBufferDeviceAddress(pRenderContext, g_MeshIndexBuffer);
+        blasGeometryInfo.geometryType                              = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
+        blasGeometryInfo.flags                                     = kBLASGeometryFlags;
+        blasGeometryInfo.geometry.triangles.sType                  = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
+        blasGeometryInfo.geometry.triangles.vertexFormat           = kBLASVertexFormat;
+        blasGeometryInfo.geometry.triangles.vertexData.hostAddress = mesh.hostVertices.data();
+        blasGeometryInfo.geometry.triangles.maxVertex              = mesh.vertexCount;
+        blasGeometryInfo.geometry.triangles.vertexStride           = sizeof(Vertex);
+        blasGeometryInfo.geometry.triangles.indexType              = VK_INDEX_TYPE_UINT32;
+        blasGeometryInfo.geometry.triangles.indexData.hostAddress  = mesh.hostIndices.data();
     }
 
     VkAccelerationStructureBuildGeometryInfoKHR blasBuildGeometryInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR };
     {
         blasBuildGeometryInfo.type          = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
-        blasBuildGeometryInfo.flags         = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
+        blasBuildGeometryInfo.flags         = kBLASBuildFlags;
         blasBuildGeometryInfo.geometryCount = 1;
         blasBuildGeometryInfo.pGeometries   = &blasGeometryInfo;
     }
 
     VkAccelerationStructureBuildSizesInfoKHR blasBuildSizesInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR };
 
-    const uint32_t primitiveCount = indexCount / 3U;
+    const uint32_t primitiveCount = mesh.indexCount / 3U;
 
     vkGetAccelerationStructureBuildSizesKHR(pRenderContext->GetDevice(),
-                                            VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
+                                            VK_ACCELERATION_STRUCTURE_BUILD_TYPE_HOST_KHR,
                                             &blasBuildGeometryInfo,
                                             &primitiveCount,
                                             &blasBuildSizesInfo);
 
-    // Create backing memory for the BLAS
+    // Host builds write into host-visible memory.
     // ------------------------------------------------
 
     VkBufferCreateInfo bufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
@@ -360,46 +1377,35 @@ void BuildBLAS(RenderContext* pRenderContext, VkCommandPool vkCommandPool, uint3
     bufferInfo.usage              = VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
 
     VmaAllocationCreateInfo allocInfo = {};
-    allocInfo.usage                   = VMA_MEMORY_USAGE_GPU_ONLY;
+    allocInfo.usage                   = VMA_MEMORY_USAGE_CPU_ONLY;
 
+    AccelerationStructure hostBLAS;
     Check(vmaCreateBuffer(pRenderContext->GetAllocator(),
                           &bufferInfo,
                           &allocInfo,
-                          &g_BLASBackingMemory.buffer,
-                          &g_BLASBackingMemory.bufferAllocation,
+                          &hostBLAS.backingMemory.buffer,
+                          &hostBLAS.backingMemory.bufferAllocation,
                           nullptr),
-          "Failed to create dedicated buffer memory.");
-
-    // Create intermediate scratch memory
-    // ------------------------------------------------
-
-    bufferInfo.size  = blasBuildSizesInfo.buildScratchSize;
-    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
-    allocInfo.usage  = VMA_MEMORY_USAGE_GPU_ONLY;
-
-    Buffer scratchBuffer;
-    Check(vmaCreateBuffer(pRenderContext->GetAllocator(), &bufferInfo, &allocInfo, &scratchBuffer.buffer, &scratchBuffer.bufferAllocation, nullptr),
-          "Failed to create dedicated buffer memory.");
-
-    // Create BLAS Primitive
-    // ------------------------------------------------
+          "Failed to create host buffer memory.");
 
     VkAccelerationStructureCreateInfoKHR acceleration_structure_create_info { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR };
     {
-        acceleration_structure_create_info.buffer = g_BLASBackingMemory.buffer;
+        acceleration_structure_create_info.buffer = hostBLAS.backingMemory.buffer;
         acceleration_structure_create_info.size   = blasBuildSizesInfo.accelerationStructureSize;
         acceleration_structure_create_info.type   = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
     }
-    Check(vkCreateAccelerationStructureKHR(pRenderContext->GetDevice(), &acceleration_structure_create_info, nullptr, &g_BLAS),
+    Check(vkCreateAccelerationStructureKHR(pRenderContext->GetDevice(), &acceleration_structure_create_info, nullptr, &hostBLAS.handle),
           "Failed to create acceleration structure");
 
-    // Build
+    // Build as a deferred operation joined by a pool of worker threads, the GPU keeps rendering meanwhile.
     // ------------------------------------------------
 
+    std::vector<uint8_t> scratchMemory(blasBuildSizesInfo.buildScratchSize);
+
     {
         // Rest is defined above.
-        blasBuildGeometryInfo.scratchData.deviceAddress = GetBufferDeviceAddress(pRenderContext, scratchBuffer);
-        blasBuildGeometryInfo.dstAccelerationStructure  = g_BLAS;
+        blasBuildGeometryInfo.scratchData.hostAddress  = scratchMemory.data();
+        blasBuildGeometryInfo.dstAccelerationStructure = hostBLAS.handle;
     }
 
     VkAccelerationStructureBuildRangeInfoKHR blasBuildRangeInfo;
@@ -411,47 +1417,323 @@ void BuildBLAS(RenderContext* pRenderContext, VkCommandPool vkCommandPool, uint3
     }
     std::vector<VkAccelerationStructureBuildRangeInfoKHR*> blasBuildRangeInfos = { &blasBuildRangeInfo };
 
-    VkCommandBuffer vkCommand = VK_NULL_HANDLE;
-    SingleShotCommandBegin(pRenderContext, vkCommand, vkCommandPool);
+    auto buildTimeBegin = std::chrono::high_resolution_clock::now();
+
+    VkDeferredOperationKHR vkDeferredOperation = VK_NULL_HANDLE;
+    Check(vkCreateDeferredOperationKHR(pRenderContext->GetDevice(), nullptr, &vkDeferredOperation), "Failed to create a deferred operation.");
+
+    uint32_t joinThreadCount = 1U;
+
+    VkResult buildResult =
+        vkBuildAccelerationStructuresKHR(pRenderContext->GetDevice(), vkDeferredOperation, 1U, &blasBuildGeometryInfo, blasBuildRangeInfos.data());
+
+    Check(JoinDeferredOperation(pRenderContext, vkDeferredOperation, buildResult, joinThreadCount),
+          "Failed to build the acceleration structure on the host.");
+
+    vkDestroyDeferredOperationKHR(pRenderContext->GetDevice(), vkDeferredOperation, nullptr);
+
+    g_BenchmarkRecorder.RecordTiming(std::format("BLAS Build Host ({} triangles)", primitiveCount), MillisecondsSince(buildTimeBegin));
+
+    // Serialize on the host, also as a deferred operation.
+    // ------------------------------------------------
+
+    VkDeviceSize serializedSize = 0U;
+    Check(vkWriteAccelerationStructuresPropertiesKHR(pRenderContext->GetDevice(),
+                                                     1U,
+                                                     &hostBLAS.handle,
+                                                     VK_QUERY_TYPE_ACCELERATION_STRUCTURE_SERIALIZATION_SIZE_KHR,
+                                                     sizeof(VkDeviceSize),
+                                                     &serializedSize,
+                                                     sizeof(VkDeviceSize)),
+          "Failed to query the serialized size of the host acceleration structure.");
+
+    std::vector<uint8_t> serializedData(serializedSize);
+
+    VkCopyAccelerationStructureToMemoryInfoKHR serializeInfo { VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_TO_MEMORY_INFO_KHR };
     {
-        vkCmdBuildAccelerationStructuresKHR(vkCommand, 1U, &blasBuildGeometryInfo, blasBuildRangeInfos.data());
+        serializeInfo.src             = hostBLAS.handle;
+        serializeInfo.dst.hostAddress = serializedData.data();
+        serializeInfo.mode            = VK_COPY_ACCELERATION_STRUCTURE_MODE_SERIALIZE_KHR;
     }
-    SingleShotCommandEnd(pRenderContext, vkCommand);
 
-    VkAccelerationStructureDeviceAddressInfoKHR blasDeviceAddressInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR };
+    Check(vkCreateDeferredOperationKHR(pRenderContext->GetDevice(), nullptr, &vkDeferredOperation), "Failed to create a deferred operation.");
+
+    uint32_t serializeThreadCount = 1U;
+
+    const VkResult serializeResult = vkCopyAccelerationStructureToMemoryKHR(pRenderContext->GetDevice(), vkDeferredOperation, &serializeInfo);
+
+    Check(JoinDeferredOperation(pRenderContext, vkDeferredOperation, serializeResult, serializeThreadCount),
+          "Failed to serialize the host acceleration structure.");
+
+    vkDestroyDeferredOperationKHR(pRenderContext->GetDevice(), vkDeferredOperation, nullptr);
+
+    vkDestroyAccelerationStructureKHR(pRenderContext->GetDevice(), hostBLAS.handle, nullptr);
+    vmaDestroyBuffer(pRenderContext->GetAllocator(), hostBLAS.backingMemory.buffer, hostBLAS.backingMemory.bufferAllocation);
+
+    // Deserialize into device memory for traversal, sized for a device build of the same geometry.
+    // ------------------------------------------------
+
+    VkAccelerationStructureBuildSizesInfoKHR deviceBuildSizesInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR };
+
+    vkGetAccelerationStructureBuildSizesKHR(pRenderContext->GetDevice(),
+                                            VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
+                                            &blasBuildGeometryInfo,
+                                            &primitiveCount,
+                                            &deviceBuildSizesInfo);
+
+    if (!DeserializeAccelerationStructure(pRenderContext,
+                                          vkCommandPool,
+                                          serializedData,
+                                          deviceBuildSizesInfo.accelerationStructureSize,
+                                          "(host build)",
+                                          mesh.blas))
     {
-        blasDeviceAddressInfo.accelerationStructure = g_BLAS;
+        return false;
     }
-    g_BLASDeviceAddress = vkGetAccelerationStructureDeviceAddressKHR(pRenderContext->GetDevice(), &blasDeviceAddressInfo);
 
-    // Release scratch memory
-    // ------------------------------------------------
+    NameVulkanObject(pRenderContext->GetDevice(), VK_OBJECT_TYPE_ACCELERATION_STRUCTURE_KHR, (uint64_t)mesh.blas.handle, "BLAS");
 
-    vmaDestroyBuffer(pRenderContext->GetAllocator(), scratchBuffer.buffer, scratchBuffer.bufferAllocation);
+    spdlog::info("Built bottom-level acceleration structure on the host ({} triangles, {} threads).", primitiveCount, joinThreadCount);
+
+    return true;
+}
+
+void LoadOrBuildBLAS(RenderContext* pRenderContext, VkCommandPool vkCommandPool, Mesh& mesh)
+{
+    // The cache is keyed on the content hash alone.
+    const std::filesystem::path cacheDirectory = mesh.hashCollision ? std::filesystem::path() : g_LaunchOptions.cacheDirectory;
+
+    if (!cacheDirectory.empty() && LoadCachedAccelerationStructure(pRenderContext, vkCommandPool, cacheDirectory, mesh.contentHash, mesh.blas))
+    {
+        NameVulkanObject(pRenderContext->GetDevice(), VK_OBJECT_TYPE_ACCELERATION_STRUCTURE_KHR, (uint64_t)mesh.blas.handle, "BLAS");
 
-    NameVulkanObject(pRenderContext->GetDevice(), VK_OBJECT_TYPE_ACCELERATION_STRUCTURE_KHR, (uint64_t)g_BLAS, "BLAS");
+        spdlog::info("Loaded bottom-level acceleration structure from the cache ({} triangles).", mesh.indexCount / 3U);
+    }
+    else
+    {
+        // Host results the device can't deserialize are built again on the device.
+        if (!g_HostBLASBuilds || !BuildBLASOnHost(pRenderContext, vkCommandPool, mesh))
+            BuildBLAS(pRenderContext, vkCommandPool, mesh);
+
+        // Serialized for the next launch.
+        if (!cacheDirectory.empty())
+            StoreCachedAccelerationStructure(pRenderContext, vkCommandPool, cacheDirectory, mesh.contentHash, mesh.blas);
+    }
+
+    // The CPU copy of the geometry is only read by host builds.
+    mesh.hostVertices = {};
+    mesh.hostIndices  = {};
+}
+
+// Runs on the optional pass loader, its single-shot uploads use a command pool of their own. The deformer points the
+// deformed geometry records at the vertex buffers of the frame slots; frames only read them once they deform.
+void CreateOptionalPasses(RenderContext* pRenderContext, bool createDenoiser, bool createSparseReconstruction, bool createMeshDeformer)
+{
+    CPUTracer::Get().SetThreadName("Optional Pass Loader");
+
+    PROFILE_SCOPE("Create Optional Passes");
+
+    VkCommandPool vkCommandPool = VK_NULL_HANDLE;
+
+    VkCommandPoolCreateInfo vkCommandPoolInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+    {
+        vkCommandPoolInfo.queueFamilyIndex = pRenderContext->GetCommandQueueIndex();
+    }
+    Check(vkCreateCommandPool(pRenderContext->GetDevice(), &vkCommandPoolInfo, nullptr, &vkCommandPool), "Failed to create a Vulkan Command Pool");
+
+    std::optional<Denoiser>             denoiser;
+    std::optional<SparseReconstruction> sparseReconstruction;
+    std::optional<MeshDeformer>         meshDeformer;
+
+    if (createDenoiser)
+    {
+        denoiser.emplace();
+        denoiser->Create(pRenderContext, g_ColorAttachment, g_GBufferPosition, g_GBufferNormal, g_GBufferMotion, g_DenoiseScratch, vkCommandPool);
+    }
+
+    if (createSparseReconstruction)
+    {
+        sparseReconstruction.emplace();
+        sparseReconstruction->Create(pRenderContext, g_ColorAttachment, g_GBufferPosition, g_GBufferNormal, g_GBufferMotion, vkCommandPool);
+    }
+
+    if (createMeshDeformer)
+    {
+        const Mesh& restMesh = g_GeometryRegistry.GetMesh(g_MeshLODs.at(0));
+
+        meshDeformer.emplace();
+        meshDeformer->Create(pRenderContext, restMesh, g_BindlessDescriptors);
+
+        std::array<GeometryRecord, kMaxFramesInFlight> deformedRecords {};
+
+        for (uint32_t frameIndex = 0U; frameIndex < kMaxFramesInFlight; frameIndex++)
+            deformedRecords.at(frameIndex) = { meshDeformer->GetVertexBufferIndex(frameIndex), restMesh.indexBufferIndex, 0U, 0U };
+
+        VkCommandBuffer vkCommand = VK_NULL_HANDLE;
+        SingleShotCommandBegin(pRenderContext, vkCommand, vkCommandPool);
+        {
+            vkCmdUpdateBuffer(vkCommand,
+                              g_GeometryTable.buffer,
+                              sizeof(GeometryRecord) * kDeformedGeometryRecord,
+                              sizeof(deformedRecords),
+                              deformedRecords.data());
+        }
+        SingleShotCommandEnd(pRenderContext, vkCommand);
+    }
+
+    // The single-shot submissions were waited for.
+    vkDestroyCommandPool(pRenderContext->GetDevice(), vkCommandPool, nullptr);
+
+    {
+        std::lock_guard<std::mutex> lock(g_PendingOptionalPassesMutex);
+
+        if (denoiser.has_value())
+            g_PendingDenoiser = denoiser;
+
+        if (sparseReconstruction.has_value())
+            g_PendingSparseReconstruction = sparseReconstruction;
+
+        if (meshDeformer.has_value())
+            g_PendingMeshDeformer = meshDeformer;
+    }
+
+    g_OptionalPassLoaderBusy.store(false);
+}
+
+// Compacts the instances that survive culling into the instance buffer, returns the instance count. Deformed frames
+// point the full detail instances at the deformed BLAS of their frame slot.
+uint32_t WriteInstances(VkAccelerationStructureInstanceKHR* pInstances,
+                        const InstanceCullingParams*        pCullingParams,
+                        uint32_t                            frameInFlightIndex,
+                        bool                                deformed)
+{
+    const auto instanceCount = static_cast<uint32_t>(g_InstanceTransforms.size());
+    const auto chunkCount    = (instanceCount + kInstanceCullingChunkSize - 1U) / kInstanceCullingChunkSize;
+
+    std::vector<uint32_t> instanceLODs(instanceCount, 0U);
+    std::vector<uint32_t> chunkSurvivorCounts(chunkCount, 0U);
+
+    // Classify (cull + select LOD) each instance.
+    ParallelFor(instanceCount,
+                kInstanceCullingChunkSize,
+                [&](uint32_t chunkIndex, uint32_t instanceBegin, uint32_t instanceEnd)
+                {
+                    for (uint32_t instanceIndex = instanceBegin; instanceIndex < instanceEnd; instanceIndex++)
+                    {
+                        if (pCullingParams != nullptr)
+                            instanceLODs[instanceIndex] = SelectInstanceLOD(*pCullingParams, g_InstanceBounds[instanceIndex]);
+
+                        if (instanceLODs[instanceIndex] != kInstanceCulled)
+                            chunkSurvivorCounts[chunkIndex]++;
+                    }
+                });
+
+    // Exclusive prefix sum over the chunks gives each chunk its output range.
+    std::vector<uint32_t> chunkOffsets(chunkCount, 0U);
+
+    uint32_t survivorCount = 0U;
+
+    for (uint32_t chunkIndex = 0U; chunkIndex < chunkCount; chunkIndex++)
+    {
+        chunkOffsets[chunkIndex] = survivorCount;
+        survivorCount += chunkSurvivorCounts[chunkIndex];
+    }
+
+    // LODs with identical content share a BLAS, resolved once here rather than per instance.
+    std::array<uint64_t, kMeshLODCount> lodBLASAddresses {};
+    std::array<uint32_t, kMeshLODCount> lodGeometryRecords {};
+
+    for (uint32_t lod = 0U; lod < kMeshLODCount; lod++)
+    {
+        lodBLASAddresses[lod]   = g_GeometryRegistry.GetMesh(g_MeshLODs[lod]).blas.deviceAddress;
+        lodGeometryRecords[lod] = lod;
+    }
+
+    if (deformed)
+    {
+        lodBLASAddresses[0]   = g_MeshDeformer.GetBLASDeviceAddress(frameInFlightIndex);
+        lodGeometryRecords[0] = kDeformedGeometryRecord + frameInFlightIndex;
+    }
+
+    // Write the surviving instances.
+    ParallelFor(instanceCount,
+                kInstanceCullingChunkSize,
+                [&](uint32_t chunkIndex, uint32_t instanceBegin, uint32_t instanceEnd)
+                {
+                    uint32_t writeIndex = chunkOffsets[chunkIndex];
+
+                    for (uint32_t instanceIndex = instanceBegin; instanceIndex < instanceEnd; instanceIndex++)
+                    {
+                        const uint32_t lod = instanceLODs[instanceIndex];
+
+                        if (lod == kInstanceCulled)
+                            continue;
+
+                        VkAccelerationStructureInstanceKHR instance {};
+                        {
+                            // The hit shaders use the custom index to select the geometry record of the LOD.
+                            instance.transform                              = g_InstanceTransforms[instanceIndex];
+                            instance.instanceCustomIndex                    = lodGeometryRecords[lod];
+                            instance.mask                                   = 0xFF;
+                            instance.instanceShaderBindingTableRecordOffset = 0;
+                            instance.flags                                  = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
+                            instance.accelerationStructureReference         = lodBLASAddresses[lod];
+                        }
+                        pInstances[writeIndex++] = instance;
+                    }
+                });
+
+    g_InstanceLODCounts.fill(0U);
+
+    for (const auto lod : instanceLODs)
+    {
+        if (lod != kInstanceCulled)
+            g_InstanceLODCounts.at(lod)++;
+    }
 
-    spdlog::info("Built bottom-level acceleration structure.");
+    return survivorCount;
 }
 
-void BuildTLAS(RenderContext* pRenderContext, VkCommandPool vkCommandPool, uint32_t indexCount, const std::vector<Vertex>& instanceTransforms)
+void RecordTLASBuild(RenderContext* pRenderContext, VkCommandBuffer vkCommand, const Buffer& instanceBuffer, uint32_t instanceCount)
 {
-    auto ComputeTransformForPoint = [&](Vertex point) -> VkTransformMatrixKHR
+    VkAccelerationStructureGeometryKHR tlasGeometryInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR };
+    tlasGeometryInfo.geometryType                          = VK_GEOMETRY_TYPE_INSTANCES_KHR;
+    tlasGeometryInfo.flags                                 = VK_GEOMETRY_OPAQUE_BIT_KHR;
+    tlasGeometryInfo.geometry.instances.sType              = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
+    tlasGeometryInfo.geometry.instances.arrayOfPointers    = VK_FALSE;
+    tlasGeometryInfo.geometry.instances.data.deviceAddress = GetBufferDeviceAddress(pRenderContext, instanceBuffer);
+
+    VkAccelerationStructureBuildGeometryInfoKHR tlasGeometryBuildInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR };
+    tlasGeometryBuildInfo.type                      = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
+    tlasGeometryBuildInfo.flags                     = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
+    tlasGeometryBuildInfo.mode                      = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+    tlasGeometryBuildInfo.geometryCount             = 1U;
+    tlasGeometryBuildInfo.pGeometries               = &tlasGeometryInfo;
+    tlasGeometryBuildInfo.dstAccelerationStructure  = g_TLAS.handle;
+    tlasGeometryBuildInfo.scratchData.deviceAddress = GetBufferDeviceAddress(pRenderContext, g_TLASScratchBuffer);
+
+    VkAccelerationStructureBuildRangeInfoKHR tlasBuildRangeInfo;
     {
-        glm::vec3 U = glm::normalize(point.normalOS);
-        glm::vec3 F = glm::normalize(glm::vec3(0.0f, 0.0f, -1.0f));
-        glm::vec3 R = glm::normalize(glm::cross(F, U));
+        tlasBuildRangeInfo.primitiveCount  = instanceCount;
+        tlasBuildRangeInfo.primitiveOffset = 0U;
+        tlasBuildRangeInfo.firstVertex     = 0U;
+        tlasBuildRangeInfo.transformOffset = 0U;
+    }
+    std::vector<VkAccelerationStructureBuildRangeInfoKHR*> tlasBuildRangeInfos = { &tlasBuildRangeInfo };
 
-        F = glm::normalize(glm::cross(U, R));
+    vkCmdBuildAccelerationStructuresKHR(vkCommand, 1U, &tlasGeometryBuildInfo, tlasBuildRangeInfos.data());
+}
 
-        glm::mat4 rotation = glm::mat4(1.0f);
-        rotation[0]        = glm::vec4(R, 0.0f);
-        rotation[1]        = glm::vec4(U, 0.0f);
-        rotation[2]        = glm::vec4(F, 0.0f);
+void BuildTLAS(RenderContext* pRenderContext, VkCommandPool vkCommandPool, const std::vector<Vertex>& instancePoints)
+{
+    // Static per-instance data for the culling pre-pass.
+    // ------------------------------------------------
 
-        glm::mat4 translation = glm::translate(glm::mat4(1.0f), point.positionOS);
+    const BoundingSphere meshBounds = g_GeometryRegistry.GetMesh(g_MeshLODs[0]).bounds;
 
-        glm::mat4 transform = translation * rotation;
+    for (const auto& point : instancePoints)
+    {
+        const glm::mat4 transform = ComputeInstanceTransform(point);
 
         VkTransformMatrixKHR vkTransform;
 
@@ -463,58 +1745,53 @@ void BuildTLAS(RenderContext* pRenderContext, VkCommandPool vkCommandPool, uint3
             }
         }
 
-        return vkTransform;
-    };
+        // Instances are rigid, so the sphere only moves.
+        BoundingSphere worldBounds;
+        {
+            worldBounds.center = glm::vec3(transform * glm::vec4(meshBounds.center, 1.0F));
+            worldBounds.radius = meshBounds.radius;
+        }
 
-    VkAccelerationStructureInstanceKHR instance {};
-    {
-        instance.instanceCustomIndex                    = 0;
-        instance.mask                                   = 0xFF;
-        instance.instanceShaderBindingTableRecordOffset = 0;
-        instance.flags                                  = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
-        instance.accelerationStructureReference         = g_BLASDeviceAddress;
+        g_InstanceTransforms.push_back(vkTransform);
+        g_InstanceBounds.push_back(worldBounds);
     }
 
-    std::vector<VkAccelerationStructureInstanceKHR> tlasInstances;
+    const auto maxInstanceCount = static_cast<uint32_t>(g_InstanceTransforms.size());
 
-    for (const auto& transform : instanceTransforms)
-    {
-        instance.transform = ComputeTransformForPoint(transform);
-        tlasInstances.push_back(instance);
-    }
-
-    // Create Instances Buffer.
+    // Create Instances Buffers (one per frame in flight, persistently mapped).
     // ------------------------------------------------
 
     VkBufferCreateInfo bufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
     bufferInfo.usage              = VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
-    bufferInfo.size               = sizeof(VkAccelerationStructureInstanceKHR) * tlasInstances.size();
+    bufferInfo.size               = sizeof(VkAccelerationStructureInstanceKHR) * maxInstanceCount;
 
     VmaAllocationCreateInfo allocInfo = {};
     allocInfo.usage                   = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    allocInfo.flags                   = VMA_ALLOCATION_CREATE_MAPPED_BIT;
 
-    Buffer instanceBuffer;
-    Check(vmaCreateBuffer(pRenderContext->GetAllocator(), &bufferInfo, &allocInfo, &instanceBuffer.buffer, &instanceBuffer.bufferAllocation, nullptr),
-          "Failed to create staging buffer memory.");
-
-    // Copy Instances Host -> Staging Memory.
-    // -----------------------------------------------------
-
-    void* pMappedData = nullptr;
-    Check(vmaMapMemory(pRenderContext->GetAllocator(), instanceBuffer.bufferAllocation, &pMappedData), "Failed to map a pointer to staging memory.");
+    for (uint32_t frameIndex = 0U; frameIndex < kMaxFramesInFlight; frameIndex++)
     {
-        // Copy from Host -> Staging memory.
-        memcpy(pMappedData, tlasInstances.data(), sizeof(VkAccelerationStructureInstanceKHR) * tlasInstances.size());
+        auto& instanceBuffer = g_InstanceBuffers.at(frameIndex);
 
-        vmaUnmapMemory(pRenderContext->GetAllocator(), instanceBuffer.bufferAllocation);
+        VmaAllocationInfo instanceAllocationInfo;
+        Check(vmaCreateBuffer(pRenderContext->GetAllocator(),
+                              &bufferInfo,
+                              &allocInfo,
+                              &instanceBuffer.buffer,
+                              &instanceBuffer.bufferAllocation,
+                              &instanceAllocationInfo),
+              "Failed to create instance buffer memory.");
+
+        g_InstanceBufferMappings.at(frameIndex) = static_cast<VkAccelerationStructureInstanceKHR*>(instanceAllocationInfo.pMappedData);
     }
 
+    // Size the TLAS for the worst case (no instance culled).
+    // ------------------------------------------------
+
     VkAccelerationStructureGeometryKHR tlasGeometryInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR };
-    tlasGeometryInfo.geometryType                          = VK_GEOMETRY_TYPE_INSTANCES_KHR;
-    tlasGeometryInfo.flags                                 = VK_GEOMETRY_OPAQUE_BIT_KHR;
-    tlasGeometryInfo.geometry.instances.sType              = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
-    tlasGeometryInfo.geometry.instances.arrayOfPointers    = VK_FALSE;
-    tlasGeometryInfo.geometry.instances.data.deviceAddress = GetBufferDeviceAddress(pRenderContext, instanceBuffer);
+    tlasGeometryInfo.geometryType       = VK_GEOMETRY_TYPE_INSTANCES_KHR;
+    tlasGeometryInfo.flags              = VK_GEOMETRY_OPAQUE_BIT_KHR;
+    tlasGeometryInfo.geometry.instances = { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR };
 
     VkAccelerationStructureBuildGeometryInfoKHR tlasGeometryBuildInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR };
     tlasGeometryBuildInfo.type          = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
@@ -522,39 +1799,42 @@ void BuildTLAS(RenderContext* pRenderContext, VkCommandPool vkCommandPool, uint3
     tlasGeometryBuildInfo.geometryCount = 1U;
     tlasGeometryBuildInfo.pGeometries   = &tlasGeometryInfo;
 
-    const uint32_t primitiveCount = (uint32_t)tlasInstances.size() * (indexCount / 3U);
-
     VkAccelerationStructureBuildSizesInfoKHR tlasBuildSizeInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR };
     vkGetAccelerationStructureBuildSizesKHR(pRenderContext->GetDevice(),
                                             VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
                                             &tlasGeometryBuildInfo,
-                                            &primitiveCount,
+                                            &maxInstanceCount,
                                             &tlasBuildSizeInfo);
 
-    // Create Instances Buffer.
+    // Create TLAS backing memory.
     // ------------------------------------------------
 
     bufferInfo.usage = VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
     bufferInfo.size  = tlasBuildSizeInfo.accelerationStructureSize;
     allocInfo.usage  = VMA_MEMORY_USAGE_GPU_ONLY;
+    allocInfo.flags  = 0x0;
 
     Check(vmaCreateBuffer(pRenderContext->GetAllocator(),
                           &bufferInfo,
                           &allocInfo,
-                          &g_TLASBackingMemory.buffer,
-                          &g_TLASBackingMemory.bufferAllocation,
+                          &g_TLAS.backingMemory.buffer,
+                          &g_TLAS.backingMemory.bufferAllocation,
                           nullptr),
           "Failed to create backing memory for TLAS.");
 
-    // Create intermediate scratch memory
+    // Create scratch memory, kept alive for the per-frame rebuilds.
     // ------------------------------------------------
 
     bufferInfo.size  = tlasBuildSizeInfo.buildScratchSize;
     bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
     allocInfo.usage  = VMA_MEMORY_USAGE_GPU_ONLY;
 
-    Buffer scratchBuffer;
-    Check(vmaCreateBuffer(pRenderContext->GetAllocator(), &bufferInfo, &allocInfo, &scratchBuffer.buffer, &scratchBuffer.bufferAllocation, nullptr),
+    Check(vmaCreateBuffer(pRenderContext->GetAllocator(),
+                          &bufferInfo,
+                          &allocInfo,
+                          &g_TLASScratchBuffer.buffer,
+                          &g_TLASScratchBuffer.bufferAllocation,
+                          nullptr),
           "Failed to create scratch buffer memory.");
 
     // Create TLAS
@@ -563,79 +1843,111 @@ void BuildTLAS(RenderContext* pRenderContext, VkCommandPool vkCommandPool, uint3
     VkAccelerationStructureCreateInfoKHR tlasCreateInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR };
     {
         tlasCreateInfo.sType  = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
-        tlasCreateInfo.buffer = g_TLASBackingMemory.buffer;
+        tlasCreateInfo.buffer = g_TLAS.backingMemory.buffer;
         tlasCreateInfo.size   = tlasBuildSizeInfo.accelerationStructureSize;
         tlasCreateInfo.type   = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
     }
-    vkCreateAccelerationStructureKHR(pRenderContext->GetDevice(), &tlasCreateInfo, nullptr, &g_TLAS);
+    Check(vkCreateAccelerationStructureKHR(pRenderContext->GetDevice(), &tlasCreateInfo, nullptr, &g_TLAS.handle), "Failed to create TLAS.");
 
-    {
-        tlasGeometryBuildInfo.dstAccelerationStructure  = g_TLAS;
-        tlasGeometryBuildInfo.scratchData.deviceAddress = GetBufferDeviceAddress(pRenderContext, scratchBuffer);
-    }
+    // Initial build with every instance at full detail.
+    // ------------------------------------------------
 
-    VkAccelerationStructureBuildRangeInfoKHR tlasBuildRangeInfo;
-    {
-        tlasBuildRangeInfo.primitiveCount  = (uint32_t)tlasInstances.size();
-        tlasBuildRangeInfo.primitiveOffset = 0U;
-        tlasBuildRangeInfo.firstVertex     = 0U;
-        tlasBuildRangeInfo.transformOffset = 0U;
-    }
-    std::vector<VkAccelerationStructureBuildRangeInfoKHR*> tlasBuildRangeInfos = { &tlasBuildRangeInfo };
+    const uint32_t instanceCount = WriteInstances(g_InstanceBufferMappings[0], nullptr, 0U, false);
+
+    g_VisibleInstanceCount = instanceCount;
 
     VkCommandBuffer vkCommand = VK_NULL_HANDLE;
     SingleShotCommandBegin(pRenderContext, vkCommand, vkCommandPool);
     {
-        vkCmdBuildAccelerationStructuresKHR(vkCommand, 1U, &tlasGeometryBuildInfo, tlasBuildRangeInfos.data());
+        RecordTLASBuild(pRenderContext, vkCommand, g_InstanceBuffers[0], instanceCount);
     }
     SingleShotCommandEnd(pRenderContext, vkCommand);
 
     VkAccelerationStructureDeviceAddressInfoKHR tlasDeviceAddressInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR };
     {
-        tlasDeviceAddressInfo.accelerationStructure = g_TLAS;
+        tlasDeviceAddressInfo.accelerationStructure = g_TLAS.handle;
     }
-    g_TLASDeviceAddress = vkGetAccelerationStructureDeviceAddressKHR(pRenderContext->GetDevice(), &tlasDeviceAddressInfo);
+    g_TLAS.deviceAddress = vkGetAccelerationStructureDeviceAddressKHR(pRenderContext->GetDevice(), &tlasDeviceAddressInfo);
 
-    // Release scratch memory
-    // ------------------------------------------------
+    NameVulkanObject(pRenderContext->GetDevice(), VK_OBJECT_TYPE_ACCELERATION_STRUCTURE_KHR, (uint64_t)g_TLAS.handle, "TLAS");
 
-    vmaDestroyBuffer(pRenderContext->GetAllocator(), scratchBuffer.buffer, scratchBuffer.bufferAllocation);
-    vmaDestroyBuffer(pRenderContext->GetAllocator(), instanceBuffer.buffer, instanceBuffer.bufferAllocation);
+    spdlog::info("Built top-level acceleration structure ({} instances).", instanceCount);
+}
+
+void UpdateTLAS(RenderContext*               pRenderContext,
+                VkCommandBuffer              vkCommand,
+                uint32_t                     frameInFlightIndex,
+                const InstanceCullingParams& cullingParams,
+                bool                         deformed)
+{
+    // Either one going off restores the static instance set once.
+    g_TLASRequiresRebuild = g_CullingSettings.enabled || deformed;
+
+    // The fence of this frame slot was waited on, so its instance buffer is no longer read by the GPU.
+    const uint32_t instanceCount = WriteInstances(
+        g_InstanceBufferMappings.at(frameInFlightIndex), g_CullingSettings.enabled ? &cullingParams : nullptr, frameInFlightIndex, deformed);
+
+    g_VisibleInstanceCount = instanceCount;
+
+    // The render graph orders the in-place rebuild after the traversals of the previous frame, and the traversals of
+    // this frame after it.
+    pRenderContext->GetGPUProfiler().BeginScope(vkCommand, "TLAS Build");
 
-    NameVulkanObject(pRenderContext->GetDevice(), VK_OBJECT_TYPE_ACCELERATION_STRUCTURE_KHR, (uint64_t)g_TLAS, "TLAS");
+    RecordTLASBuild(pRenderContext, vkCommand, g_InstanceBuffers.at(frameInFlightIndex), instanceCount);
 
-    spdlog::info("Built top-level acceleration structure.");
+    pRenderContext->GetGPUProfiler().EndScope(vkCommand);
 }
 
-void CreateRaytracingPipeline(RenderContext* pRenderContext)
+bool CreateRaytracingPipeline(RenderContext* pRenderContext, const ShaderVariant& variant, RaytracingPipeline& raytracingPipeline)
 {
+    // Stages without the constants ignore them, so every stage shares the specialization.
+    const ShaderVariantSpecialization specialization(variant);
+
     std::vector<VkPipelineShaderStageCreateInfo> stageInfos;
 
-    auto PushRaytracingShaderStage = [&](const char* shaderFilePath, VkShaderStageFlagBits stageFlags)
+    // Runs again on the hot reload worker, so failures are reported instead of terminating.
+    auto PushRaytracingShaderStage = [&](const ShaderHotReload::Shader& shader, VkShaderStageFlagBits stageFlags)
     {
         VkPipelineShaderStageCreateInfo stageInfo { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
         {
-            stageInfo.pName = "Main";
-            stageInfo.stage = stageFlags;
+            stageInfo.pName               = "Main";
+            stageInfo.stage               = stageFlags;
+            stageInfo.pSpecializationInfo = &specialization.info;
+        }
 
-            std::vector<char> byteCode;
-            LoadByteCode(shaderFilePath, byteCode);
+        std::vector<char> byteCode;
+        if (!LoadByteCode(std::format("{}.spv", shader.name).c_str(), byteCode))
+        {
+            spdlog::error("Failed to load the {} shader byte code.", shader.name);
+            return false;
+        }
 
-            VkShaderModuleCreateInfo shaderModuleInfo = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
-            {
-                shaderModuleInfo.pCode    = reinterpret_cast<uint32_t*>(byteCode.data());
-                shaderModuleInfo.codeSize = byteCode.size();
-            }
-            Check(vkCreateShaderModule(pRenderContext->GetDevice(), &shaderModuleInfo, nullptr, &stageInfo.module),
-                  "Failed to create ray tracing shader.");
+        VkShaderModuleCreateInfo shaderModuleInfo = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
+        {
+            shaderModuleInfo.pCode    = reinterpret_cast<uint32_t*>(byteCode.data());
+            shaderModuleInfo.codeSize = byteCode.size();
+        }
+        if (vkCreateShaderModule(pRenderContext->GetDevice(), &shaderModuleInfo, nullptr, &stageInfo.module) != VK_SUCCESS)
+        {
+            spdlog::error("Failed to create the {} ray tracing shader.", shader.name);
+            return false;
         }
 
         stageInfos.push_back(stageInfo);
+
+        return true;
     };
 
-    PushRaytracingShaderStage("RayGen.spv", VK_SHADER_STAGE_RAYGEN_BIT_KHR);
-    PushRaytracingShaderStage("ClosestHit.spv", VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR);
-    PushRaytracingShaderStage("Miss.spv", VK_SHADER_STAGE_MISS_BIT_KHR);
+    const std::array<VkShaderStageFlagBits, 5> stageFlags = { VK_SHADER_STAGE_RAYGEN_BIT_KHR,
+                                                              VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR,
+                                                              VK_SHADER_STAGE_MISS_BIT_KHR,
+                                                              VK_SHADER_STAGE_MISS_BIT_KHR,
+                                                              VK_SHADER_STAGE_RAYGEN_BIT_KHR };
+
+    bool stagesCreated = true;
+
+    for (uint32_t shaderIndex = 0U; shaderIndex < kRaytracingShaders.size() && stagesCreated; shaderIndex++)
+        stagesCreated = PushRaytracingShaderStage(kRaytracingShaders[shaderIndex], stageFlags[shaderIndex]);
 
     std::vector<VkRayTracingShaderGroupCreateInfoKHR> groupInfos;
 
@@ -669,8 +1981,19 @@ void CreateRaytracingPipeline(RenderContext* pRenderContext)
             missGroupInfo.intersectionShader = VK_SHADER_UNUSED_KHR;
         }
         groupInfos.push_back(missGroupInfo);
+
+        // Visibility rays report unoccluded from their own miss shader.
+        missGroupInfo.generalShader = 3U;
+        groupInfos.push_back(missGroupInfo);
+
+        rayGenGroupInfo.generalShader = 4U;
+        groupInfos.push_back(rayGenGroupInfo);
     }
 
+    Check(groupInfos.size() == kShaderGroupCount, "Shader group count mismatch with the shader binding tables.");
+
+    VkResult result = VK_ERROR_UNKNOWN;
+
     VkRayTracingPipelineCreateInfoKHR rayTracingPipelineInfo { VK_STRUCTURE_TYPE_RAY_TRACING_PIPELINE_CREATE_INFO_KHR };
     {
         rayTracingPipelineInfo.stageCount                   = static_cast<uint32_t>(stageInfos.size());
@@ -680,21 +2003,34 @@ void CreateRaytracingPipeline(RenderContext* pRenderContext)
         rayTracingPipelineInfo.maxPipelineRayRecursionDepth = 1;
         rayTracingPipelineInfo.layout                       = g_PipelineLayout;
     }
-    Check(vkCreateRayTracingPipelinesKHR(pRenderContext->GetDevice(),
-                                         VK_NULL_HANDLE,
-                                         VK_NULL_HANDLE,
-                                         1,
-                                         &rayTracingPipelineInfo,
-                                         nullptr,
-                                         &g_RaytracingPipeline),
-          "Failed to create ray tracing pipeline.");
+
+    if (stagesCreated)
+    {
+        result = vkCreateRayTracingPipelinesKHR(pRenderContext->GetDevice(),
+                                                VK_NULL_HANDLE,
+                                                VK_NULL_HANDLE,
+                                                1,
+                                                &rayTracingPipelineInfo,
+                                                nullptr,
+                                                &raytracingPipeline.pipeline);
+    }
 
     for (auto& stageInfo : stageInfos)
         vkDestroyShaderModule(pRenderContext->GetDevice(), stageInfo.module, nullptr);
 
-    // Create shader binding tables.
-    // ------------------------------------------------
+    if (result != VK_SUCCESS)
+    {
+        spdlog::error("Failed to create ray tracing pipeline - [VkResult: {}]", std::to_string(result));
+        return false;
+    }
+
+    spdlog::info("Created Ray Tracing Pipeline.");
+
+    return true;
+}
 
+void CreateShaderBindingTables(RenderContext* pRenderContext, RaytracingPipeline& raytracingPipeline)
+{
     auto CreateShaderBindingBuffer = [&](Buffer& shaderBindingBuffer, uint32_t shaderBindingBufferSize)
     {
         VkBufferCreateInfo bufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
@@ -717,197 +2053,211 @@ void CreateRaytracingPipeline(RenderContext* pRenderContext)
     auto handleSize        = g_RayTracingProperties.shaderGroupHandleSize;
     auto handleAlignment   = g_RayTracingProperties.shaderGroupHandleAlignment;
     auto handleSizeAligned = (handleSize + handleAlignment - 1) & ~(handleAlignment - 1);
-    auto bindingTableSize  = rayTracingPipelineInfo.groupCount * handleSizeAligned;
+    auto bindingTableSize  = kShaderGroupCount * handleSizeAligned;
 
-    CreateShaderBindingBuffer(g_ShaderBindingsRayGen, g_RayTracingProperties.shaderGroupHandleSize);
-    CreateShaderBindingBuffer(g_ShaderBindingsClosestHit, g_RayTracingProperties.shaderGroupHandleSize);
-    CreateShaderBindingBuffer(g_ShaderBindingsMiss, g_RayTracingProperties.shaderGroupHandleSize);
+    CreateShaderBindingBuffer(raytracingPipeline.shaderBindingsRayGen, g_RayTracingProperties.shaderGroupHandleSize);
+    CreateShaderBindingBuffer(raytracingPipeline.shaderBindingsOcclusionRayGen, g_RayTracingProperties.shaderGroupHandleSize);
+    CreateShaderBindingBuffer(raytracingPipeline.shaderBindingsClosestHit, g_RayTracingProperties.shaderGroupHandleSize);
+    CreateShaderBindingBuffer(raytracingPipeline.shaderBindingsMiss, handleSizeAligned * kMissShaderCount);
 
     std::vector<uint8_t> shaderHandles(bindingTableSize);
     Check(vkGetRayTracingShaderGroupHandlesKHR(pRenderContext->GetDevice(),
-                                               g_RaytracingPipeline,
+                                               raytracingPipeline.pipeline,
                                                0U,
-                                               rayTracingPipelineInfo.groupCount,
+                                               kShaderGroupCount,
                                                bindingTableSize,
                                                shaderHandles.data()),
           "Failed to query shader group handles.");
 
-    auto UploadShaderHandles = [&](Buffer& shaderBindingBuffer, void* pData, uint32_t dataSize)
+    // NOTE: Handles are returned tightly packed, records in the tables are placed at the aligned stride.
+    auto UploadShaderHandles = [&](Buffer& shaderBindingBuffer, uint32_t firstGroup, uint32_t groupCount)
     {
         void* pMappedData = nullptr;
         Check(vmaMapMemory(pRenderContext->GetAllocator(), shaderBindingBuffer.bufferAllocation, &pMappedData),
               "Failed to map a pointer to shader binding buffer memory.");
         {
-            memcpy(pMappedData, pData, dataSize);
+            for (uint32_t groupIndex = 0U; groupIndex < groupCount; groupIndex++)
+            {
+                memcpy(static_cast<uint8_t*>(pMappedData) + groupIndex * handleSizeAligned,
+                       shaderHandles.data() + (firstGroup + groupIndex) * handleSize,
+                       handleSize);
+            }
 
             vmaUnmapMemory(pRenderContext->GetAllocator(), shaderBindingBuffer.bufferAllocation);
         }
     };
 
-    UploadShaderHandles(g_ShaderBindingsRayGen, shaderHandles.data(), g_RayTracingProperties.shaderGroupHandleSize);
-    UploadShaderHandles(g_ShaderBindingsClosestHit, shaderHandles.data() + handleSizeAligned, g_RayTracingProperties.shaderGroupHandleSize);
-    UploadShaderHandles(g_ShaderBindingsMiss, shaderHandles.data() + handleSizeAligned * 2U, g_RayTracingProperties.shaderGroupHandleSize);
+    UploadShaderHandles(raytracingPipeline.shaderBindingsRayGen, 0U, 1U);
+    UploadShaderHandles(raytracingPipeline.shaderBindingsClosestHit, 1U, 1U);
+    UploadShaderHandles(raytracingPipeline.shaderBindingsMiss, 2U, kMissShaderCount);
+    UploadShaderHandles(raytracingPipeline.shaderBindingsOcclusionRayGen, 4U, 1U);
 
-    spdlog::info("Created Ray Tracing Pipeline and Shader Binding Tables.");
+    spdlog::info("Created Shader Binding Tables.");
 }
 
-void InitializeResources(RenderContext* pRenderContext)
+void ReleaseRaytracingPipeline(RenderContext* pRenderContext, RaytracingPipeline& raytracingPipeline)
 {
-    // Query raytracing properties.
-    // ------------------------------------------------
-
-    VkPhysicalDeviceProperties2 deviceProperties { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
-    {
-        g_RayTracingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_PROPERTIES_KHR;
-
-        deviceProperties.pNext = &g_RayTracingProperties;
-    }
-    vkGetPhysicalDeviceProperties2(pRenderContext->GetDevicePhysical(), &deviceProperties);
-
-    // Create Rendering Attachments
-    // ------------------------------------------------
-
-    Check(CreateRenderingAttachments(pRenderContext, g_ColorAttachment, g_DepthAttachment), "Failed to create the rendering attachments.");
-
-    // Create command pool for this thread.
-    // ------------------------------------------------
-
-    VkCommandPoolCreateInfo vkCommandPoolInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
-    {
-        vkCommandPoolInfo.queueFamilyIndex = pRenderContext->GetCommandQueueIndex();
-    }
-
-    VkCommandPool vkCommandPool;
-    Check(vkCreateCommandPool(pRenderContext->GetDevice(), &vkCommandPoolInfo, nullptr, &vkCommandPool), "Failed to create a Vulkan Command Pool");
-
-    // Create staging memory.
-    // ------------------------------------------------
+    vkDestroyPipeline(pRenderContext->GetDevice(), raytracingPipeline.pipeline, nullptr);
 
-    Buffer stagingBuffer {};
-    {
-        VkBufferCreateInfo bufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
-        bufferInfo.usage              = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    for (auto* pShaderBindings : { &raytracingPipeline.shaderBindingsRayGen,
+                                   &raytracingPipeline.shaderBindingsOcclusionRayGen,
+                                   &raytracingPipeline.shaderBindingsClosestHit,
+                                   &raytracingPipeline.shaderBindingsMiss })
+        vmaDestroyBuffer(pRenderContext->GetAllocator(), pShaderBindings->buffer, pShaderBindings->bufferAllocation);
 
-        // Staging memory is 256mb. Hope it's enough!
-        bufferInfo.size = static_cast<VkDeviceSize>(256U * 1024U * 1024U);
+    raytracingPipeline = {};
+}
 
-        VmaAllocationCreateInfo allocInfo = {};
-        allocInfo.usage                   = VMA_MEMORY_USAGE_AUTO;
-        allocInfo.flags                   = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+void CreateRayQueryPipeline(RenderContext* pRenderContext)
+{
+    std::vector<char> byteCode;
+    Check(LoadByteCode("RayQuery.spv", byteCode), "Failed to load the ray query shader byte code.");
 
-        Check(
-            vmaCreateBuffer(pRenderContext->GetAllocator(), &bufferInfo, &allocInfo, &stagingBuffer.buffer, &stagingBuffer.bufferAllocation, nullptr),
-            "Failed to create staging buffer memory.");
+    VkShaderModuleCreateInfo shaderModuleInfo = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
+    {
+        shaderModuleInfo.pCode    = reinterpret_cast<uint32_t*>(byteCode.data());
+        shaderModuleInfo.codeSize = byteCode.size();
     }
 
-    // Mesh resource loading utility.
-    // ------------------------------------------------
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+    Check(vkCreateShaderModule(pRenderContext->GetDevice(), &shaderModuleInfo, nullptr, &shaderModule), "Failed to create ray query shader.");
 
-    auto CreateMeshBuffer = [&](void* pData, uint32_t dataSize, VkBufferUsageFlags usage, Buffer* pBuffer)
+    VkComputePipelineCreateInfo computePipelineInfo = { VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
     {
-        // Create dedicate device memory for the mesh buffer.
-        // -----------------------------------------------------
+        computePipelineInfo.stage.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        computePipelineInfo.stage.stage  = VK_SHADER_STAGE_COMPUTE_BIT;
+        computePipelineInfo.stage.module = shaderModule;
+        computePipelineInfo.stage.pName  = "Main";
+        computePipelineInfo.layout       = g_PipelineLayout;
+    }
+    Check(vkCreateComputePipelines(pRenderContext->GetDevice(), VK_NULL_HANDLE, 1U, &computePipelineInfo, nullptr, &g_RayQueryPipeline),
+          "Failed to create ray query pipeline.");
 
-        VkBufferCreateInfo bufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
-        bufferInfo.size               = dataSize;
-        bufferInfo.usage              = usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    vkDestroyShaderModule(pRenderContext->GetDevice(), shaderModule, nullptr);
 
-        VmaAllocationCreateInfo allocInfo = {};
-        allocInfo.usage                   = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+    spdlog::info("Created Ray Query Pipeline.");
+}
 
-        Check(vmaCreateBuffer(pRenderContext->GetAllocator(), &bufferInfo, &allocInfo, &pBuffer->buffer, &pBuffer->bufferAllocation, nullptr),
-              "Failed to create dedicated buffer memory.");
+void CreateOutputPipeline(RenderContext* pRenderContext)
+{
+    std::vector<char> byteCode;
+    Check(LoadByteCode("Tonemap.spv", byteCode), "Failed to load the tonemap shader byte code.");
 
-        // Copy Host -> Staging Memory.
-        // -----------------------------------------------------
+    VkShaderModuleCreateInfo shaderModuleInfo = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
+    {
+        shaderModuleInfo.pCode    = reinterpret_cast<uint32_t*>(byteCode.data());
+        shaderModuleInfo.codeSize = byteCode.size();
+    }
 
-        void* pMappedData = nullptr;
-        Check(vmaMapMemory(pRenderContext->GetAllocator(), stagingBuffer.bufferAllocation, &pMappedData),
-              "Failed to map a pointer to staging memory.");
-        {
-            // Copy from Host -> Staging memory.
-            memcpy(pMappedData, pData, dataSize);
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+    Check(vkCreateShaderModule(pRenderContext->GetDevice(), &shaderModuleInfo, nullptr, &shaderModule), "Failed to create tonemap shader.");
 
-            vmaUnmapMemory(pRenderContext->GetAllocator(), stagingBuffer.bufferAllocation);
-        }
+    VkComputePipelineCreateInfo computePipelineInfo = { VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+    {
+        computePipelineInfo.stage.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        computePipelineInfo.stage.stage  = VK_SHADER_STAGE_COMPUTE_BIT;
+        computePipelineInfo.stage.module = shaderModule;
+        computePipelineInfo.stage.pName  = "Main";
+        computePipelineInfo.layout       = g_OutputPipelineLayout;
+    }
+    Check(vkCreateComputePipelines(pRenderContext->GetDevice(), VK_NULL_HANDLE, 1U, &computePipelineInfo, nullptr, &g_OutputPipeline),
+          "Failed to create tonemap pipeline.");
 
-        // Copy Staging -> Device Memory.
-        // -----------------------------------------------------
+    vkDestroyShaderModule(pRenderContext->GetDevice(), shaderModule, nullptr);
 
-        VkCommandBuffer vkCommand = VK_NULL_HANDLE;
-        SingleShotCommandBegin(pRenderContext, vkCommand, vkCommandPool);
-        {
-            VmaAllocationInfo allocationInfo;
-            vmaGetAllocationInfo(pRenderContext->GetAllocator(), pBuffer->bufferAllocation, &allocationInfo);
+    spdlog::info("Created Output Pipeline.");
+}
 
-            VkBufferCopy copyInfo;
-            {
-                copyInfo.srcOffset = 0U;
-                copyInfo.dstOffset = 0U;
-                copyInfo.size      = dataSize;
-            }
-            vkCmdCopyBuffer(vkCommand, stagingBuffer.buffer, pBuffer->buffer, 1U, &copyInfo);
-        }
-        SingleShotCommandEnd(pRenderContext, vkCommand);
+void CreateMeshBuffer(RenderContext*     pRenderContext,
+                      VkCommandPool      vkCommandPool,
+                      const void*        pData,
+                      uint32_t           dataSize,
+                      VkBufferUsageFlags usage,
+                      Buffer*            pBuffer)
+{
+    // Create dedicate device memory for the mesh buffer.
+    // -----------------------------------------------------
 
-        NameVulkanObject(pRenderContext->GetDevice(), VK_OBJECT_TYPE_BUFFER, (uint64_t)pBuffer->buffer, "Mesh Buffer");
-    };
+    VkBufferCreateInfo bufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+    bufferInfo.size               = dataSize;
+    bufferInfo.usage              = usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
 
-    // Load instance transforms.
-    // ------------------------------------------------
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage                   = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
 
-    std::vector<Vertex> instanceTransforms;
-    if (!LoadPoints("..\\Assets\\instance_transforms.obj", instanceTransforms))
-        return;
+    Check(vmaCreateBuffer(pRenderContext->GetAllocator(), &bufferInfo, &allocInfo, &pBuffer->buffer, &pBuffer->bufferAllocation, nullptr),
+          "Failed to create dedicated buffer memory.");
 
-    // Create device mesh.
-    // ------------------------------------------------
+    // Create staging memory (per upload, so uploads can run on several threads at once).
+    // -----------------------------------------------------
 
-    std::vector<Vertex>   meshVertices;
-    std::vector<uint32_t> meshIndices;
-    if (!LoadMesh("..\\Assets\\bunny_low.obj", meshVertices, meshIndices))
-        return;
+    Buffer stagingBuffer {};
+    {
+        bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
 
-    // Create dedicate device memory for the mesh buffer.
+        allocInfo.usage = VMA_MEMORY_USAGE_AUTO;
+        allocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+
+        Check(
+            vmaCreateBuffer(pRenderContext->GetAllocator(), &bufferInfo, &allocInfo, &stagingBuffer.buffer, &stagingBuffer.bufferAllocation, nullptr),
+            "Failed to create staging buffer memory.");
+    }
+
+    // Copy Host -> Staging Memory.
     // -----------------------------------------------------
 
-    CreateMeshBuffer(meshVertices.data(),
-                     sizeof(Vertex) * (uint32_t)meshVertices.size(),
-                     VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
-                         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                     &g_MeshVertexBuffer);
+    void* pMappedData = nullptr;
+    Check(vmaMapMemory(pRenderContext->GetAllocator(), stagingBuffer.bufferAllocation, &pMappedData), "Failed to map a pointer to staging memory.");
+    {
+        // Copy from Host -> Staging memory.
+        memcpy(pMappedData, pData, dataSize);
 
-    CreateMeshBuffer(meshIndices.data(),
-                     sizeof(uint32_t) * (uint32_t)meshIndices.size(),
-                     VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
-                         VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-                     &g_MeshIndexBuffer);
+        vmaUnmapMemory(pRenderContext->GetAllocator(), stagingBuffer.bufferAllocation);
+    }
 
-    // Create acceleration structure.
+    // Copy Staging -> Device Memory.
     // -----------------------------------------------------
 
-    BuildBLAS(pRenderContext, vkCommandPool, (uint32_t)meshVertices.size(), (uint32_t)meshIndices.size());
-    BuildTLAS(pRenderContext, vkCommandPool, (uint32_t)meshIndices.size(), instanceTransforms);
+    VkCommandBuffer vkCommand = VK_NULL_HANDLE;
+    SingleShotCommandBegin(pRenderContext, vkCommand, vkCommandPool);
+    {
+        VkBufferCopy copyInfo;
+        {
+            copyInfo.srcOffset = 0U;
+            copyInfo.dstOffset = 0U;
+            copyInfo.size      = dataSize;
+        }
+        vkCmdCopyBuffer(vkCommand, stagingBuffer.buffer, pBuffer->buffer, 1U, &copyInfo);
+    }
+    SingleShotCommandEnd(pRenderContext, vkCommand);
+
+    vmaDestroyBuffer(pRenderContext->GetAllocator(), stagingBuffer.buffer, stagingBuffer.bufferAllocation);
 
-    // Configure Descriptor Set Layout
-    // --------------------------------------
+    NameVulkanObject(pRenderContext->GetDevice(), VK_OBJECT_TYPE_BUFFER, (uint64_t)pBuffer->buffer, "Mesh Buffer");
+}
 
+void CreatePipelineLayout(RenderContext* pRenderContext)
+{
     std::vector<VkDescriptorSetLayoutBinding> descriptorSetBindingInfos;
 
-    auto PushDescriptorBinding = [&](VkDescriptorType descriptorType)
+    auto PushDescriptorBinding = [&](VkDescriptorType descriptorType, uint32_t descriptorCount = 1U)
     {
         VkDescriptorSetLayoutBinding bindingInfo {};
         {
             bindingInfo.binding         = (uint32_t)descriptorSetBindingInfos.size();
             bindingInfo.descriptorType  = descriptorType;
-            bindingInfo.descriptorCount = 1U;
-            bindingInfo.stageFlags      = VK_SHADER_STAGE_RAYGEN_BIT_KHR;
+            bindingInfo.descriptorCount = descriptorCount;
+            bindingInfo.stageFlags      = VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT;
         }
         descriptorSetBindingInfos.push_back(bindingInfo);
     };
 
     PushDescriptorBinding(VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR);
     PushDescriptorBinding(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
+    PushDescriptorBinding(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
+    PushDescriptorBinding(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
+    PushDescriptorBinding(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
+    PushDescriptorBinding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC);
 
     VkDescriptorSetLayoutCreateInfo descriptorSetLayout = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
     {
@@ -921,7 +2271,7 @@ void InitializeResources(RenderContext* pRenderContext)
 
     VkPushConstantRange vkPushConstants;
     {
-        vkPushConstants.stageFlags = VK_SHADER_STAGE_RAYGEN_BIT_KHR;
+        vkPushConstants.stageFlags = VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT;
         vkPushConstants.offset     = 0U;
         vkPushConstants.size       = sizeof(RaytracingPushConstants);
     }
@@ -929,33 +2279,66 @@ void InitializeResources(RenderContext* pRenderContext)
     // Configure Pipeline Layouts
     // --------------------------------------
 
+    // Set 0: frame resources, set 1: bindless scene resources.
+    std::array<VkDescriptorSetLayout, 2> traceSetLayouts = { g_DescriptorSetLayout, g_BindlessDescriptors.GetLayout() };
+
     VkPipelineLayoutCreateInfo pipelineLayoutInfo = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
     {
-        pipelineLayoutInfo.setLayoutCount         = 1U;
-        pipelineLayoutInfo.pSetLayouts            = &g_DescriptorSetLayout;
+        pipelineLayoutInfo.setLayoutCount         = (uint32_t)traceSetLayouts.size();
+        pipelineLayoutInfo.pSetLayouts            = traceSetLayouts.data();
         pipelineLayoutInfo.pushConstantRangeCount = 1U;
         pipelineLayoutInfo.pPushConstantRanges    = &vkPushConstants;
     }
     Check(vkCreatePipelineLayout(pRenderContext->GetDevice(), &pipelineLayoutInfo, nullptr, &g_PipelineLayout),
           "Failed to create the default Vulkan Pipeline Layout");
 
-    // Create ray tracing pipeline.
-    // -----------------------------------------------------
+    // Output pass: HDR color input + back buffer output.
+    // --------------------------------------
 
-    CreateRaytracingPipeline(pRenderContext);
+    std::array<VkDescriptorSetLayoutBinding, 2> outputBindingInfos {};
 
-    // Create descriptor pool.
-    // -----------------------------------------------------
+    for (uint32_t bindingIndex = 0U; bindingIndex < outputBindingInfos.size(); bindingIndex++)
+    {
+        outputBindingInfos.at(bindingIndex).binding         = bindingIndex;
+        outputBindingInfos.at(bindingIndex).descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        outputBindingInfos.at(bindingIndex).descriptorCount = 1U;
+        outputBindingInfos.at(bindingIndex).stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    {
+        descriptorSetLayout.bindingCount = (uint32_t)outputBindingInfos.size();
+        descriptorSetLayout.pBindings    = outputBindingInfos.data();
+    }
+    Check(vkCreateDescriptorSetLayout(pRenderContext->GetDevice(), &descriptorSetLayout, nullptr, &g_OutputDescriptorSetLayout),
+          "Failed to create the output descriptor set layout.");
+
+    {
+        vkPushConstants.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        vkPushConstants.size       = sizeof(OutputPushConstants);
 
-    std::array<VkDescriptorPoolSize, 2> descriptorPoolSizes = {
-        { { VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, 1 }, { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1U } }
+        pipelineLayoutInfo.setLayoutCount = 1U;
+        pipelineLayoutInfo.pSetLayouts    = &g_OutputDescriptorSetLayout;
+    }
+    Check(vkCreatePipelineLayout(pRenderContext->GetDevice(), &pipelineLayoutInfo, nullptr, &g_OutputPipelineLayout),
+          "Failed to create the output pipeline layout.");
+}
+
+void CreateDescriptors(RenderContext* pRenderContext)
+{
+    // Output sets for every back buffer on top of the trace set.
+    const uint32_t backBufferCount = pRenderContext->GetSwapchainImageCount();
+
+    std::array<VkDescriptorPoolSize, 3> descriptorPoolSizes = {
+        { { VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, 1 },
+         { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 4U + 2U * backBufferCount },
+         { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 } }
     };
 
     VkDescriptorPoolCreateInfo descriptorPoolInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
     {
         descriptorPoolInfo.poolSizeCount = (uint32_t)descriptorPoolSizes.size();
         descriptorPoolInfo.pPoolSizes    = descriptorPoolSizes.data();
-        descriptorPoolInfo.maxSets       = 1U;
+        descriptorPoolInfo.maxSets       = 1U + backBufferCount;
         descriptorPoolInfo.flags         = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
     }
     Check(vkCreateDescriptorPool(pRenderContext->GetDevice(), &descriptorPoolInfo, VK_NULL_HANDLE, &g_DescriptorPool),
@@ -973,6 +2356,35 @@ void InitializeResources(RenderContext* pRenderContext)
     Check(vkAllocateDescriptorSets(pRenderContext->GetDevice(), &descriptorSetAllocInfo, &g_DescriptorSet),
           "Failed to allocate raytracing descriptors.");
 
+    // Frame constants, one slot per frame in flight (persistently mapped).
+    // -----------------------------------------------------
+
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(pRenderContext->GetDevicePhysical(), &deviceProperties);
+
+    const auto uniformAlignment = static_cast<uint32_t>(deviceProperties.limits.minUniformBufferOffsetAlignment);
+
+    g_FrameConstantsStride = (static_cast<uint32_t>(sizeof(FrameConstants)) + uniformAlignment - 1U) / uniformAlignment * uniformAlignment;
+
+    VkBufferCreateInfo frameConstantsBufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+    frameConstantsBufferInfo.usage              = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    frameConstantsBufferInfo.size               = static_cast<VkDeviceSize>(g_FrameConstantsStride) * kMaxFramesInFlight;
+
+    VmaAllocationCreateInfo frameConstantsAllocInfo = {};
+    frameConstantsAllocInfo.usage                   = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    frameConstantsAllocInfo.flags                   = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    VmaAllocationInfo frameConstantsAllocationInfo;
+    Check(vmaCreateBuffer(pRenderContext->GetAllocator(),
+                          &frameConstantsBufferInfo,
+                          &frameConstantsAllocInfo,
+                          &g_FrameConstantsBuffer.buffer,
+                          &g_FrameConstantsBuffer.bufferAllocation,
+                          &frameConstantsAllocationInfo),
+          "Failed to create the frame constants buffer.");
+
+    g_pFrameConstants = static_cast<uint8_t*>(frameConstantsAllocationInfo.pMappedData);
+
     std::vector<VkWriteDescriptorSet> descriptorWrites;
 
     // Descriptor #0
@@ -980,7 +2392,7 @@ void InitializeResources(RenderContext* pRenderContext)
     VkWriteDescriptorSetAccelerationStructureKHR descriptorWriteTLASInfo { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR };
     {
         descriptorWriteTLASInfo.accelerationStructureCount = 1U;
-        descriptorWriteTLASInfo.pAccelerationStructures    = &g_TLAS;
+        descriptorWriteTLASInfo.pAccelerationStructures    = &g_TLAS.handle;
     }
 
     VkWriteDescriptorSet descriptorWriteInfo0 = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
@@ -1005,27 +2417,413 @@ void InitializeResources(RenderContext* pRenderContext)
         descriptorWriteInfo1.pImageInfo      = &descriptorWriteColorInfo;
     }
 
+    // Descriptor #2, #3
+
+    VkDescriptorImageInfo descriptorWritePositionInfo(VK_NULL_HANDLE, g_GBufferPosition.imageView, VK_IMAGE_LAYOUT_GENERAL);
+    VkDescriptorImageInfo descriptorWriteNormalInfo(VK_NULL_HANDLE, g_GBufferNormal.imageView, VK_IMAGE_LAYOUT_GENERAL);
+
+    VkWriteDescriptorSet descriptorWriteInfo2 = descriptorWriteInfo1;
+    {
+        descriptorWriteInfo2.dstBinding = 2U;
+        descriptorWriteInfo2.pImageInfo = &descriptorWritePositionInfo;
+    }
+
+    VkWriteDescriptorSet descriptorWriteInfo3 = descriptorWriteInfo1;
+    {
+        descriptorWriteInfo3.dstBinding = 3U;
+        descriptorWriteInfo3.pImageInfo = &descriptorWriteNormalInfo;
+    }
+
+    // Descriptor #4
+
+    VkDescriptorImageInfo descriptorWriteMotionInfo(VK_NULL_HANDLE, g_GBufferMotion.imageView, VK_IMAGE_LAYOUT_GENERAL);
+
+    VkWriteDescriptorSet descriptorWriteInfo4 = descriptorWriteInfo1;
+    {
+        descriptorWriteInfo4.dstBinding = 4U;
+        descriptorWriteInfo4.pImageInfo = &descriptorWriteMotionInfo;
+    }
+
+    // Descriptor #5, bound at the offset of the frame in flight.
+
+    VkDescriptorBufferInfo descriptorWriteFrameConstantsInfo(g_FrameConstantsBuffer.buffer, 0U, sizeof(FrameConstants));
+
+    VkWriteDescriptorSet descriptorWriteInfo5 = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+    {
+        descriptorWriteInfo5.descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        descriptorWriteInfo5.descriptorCount = 1U;
+        descriptorWriteInfo5.dstBinding      = 5U;
+        descriptorWriteInfo5.dstSet          = g_DescriptorSet;
+        descriptorWriteInfo5.pBufferInfo     = &descriptorWriteFrameConstantsInfo;
+    }
+
     descriptorWrites.push_back(descriptorWriteInfo0);
     descriptorWrites.push_back(descriptorWriteInfo1);
+    descriptorWrites.push_back(descriptorWriteInfo2);
+    descriptorWrites.push_back(descriptorWriteInfo3);
+    descriptorWrites.push_back(descriptorWriteInfo4);
+    descriptorWrites.push_back(descriptorWriteInfo5);
 
     vkUpdateDescriptorSets(pRenderContext->GetDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0U, nullptr);
 
-    // Release staging memory.
-    // ------------------------------------------------
+    // Output descriptors.
+    // -----------------------------------------------------
 
-    vmaDestroyBuffer(pRenderContext->GetAllocator(), stagingBuffer.buffer, stagingBuffer.bufferAllocation);
+    g_OutputDescriptorSets.resize(backBufferCount);
+
+    std::vector<VkDescriptorSetLayout> outputDescriptorSetLayouts(backBufferCount, g_OutputDescriptorSetLayout);
+    {
+        descriptorSetAllocInfo.descriptorSetCount = backBufferCount;
+        descriptorSetAllocInfo.pSetLayouts        = outputDescriptorSetLayouts.data();
+    }
+    Check(vkAllocateDescriptorSets(pRenderContext->GetDevice(), &descriptorSetAllocInfo, g_OutputDescriptorSets.data()),
+          "Failed to allocate output descriptors.");
+
+    for (uint32_t backBufferIndex = 0U; backBufferIndex < backBufferCount; backBufferIndex++)
+    {
+        // Without storage back buffers the color attachment is tone mapped in place, then blitted. The output binding
+        // then holds the color attachment too, the shader writes it through the input binding (its declared format).
+        const VkImageView outputView =
+            pRenderContext->IsBackBufferStorage() ? pRenderContext->GetSwapchainImageView(backBufferIndex) : g_ColorAttachment.imageView;
+
+        std::array<VkDescriptorImageInfo, 2> outputImageInfos = {
+            { { VK_NULL_HANDLE, g_ColorAttachment.imageView, VK_IMAGE_LAYOUT_GENERAL }, { VK_NULL_HANDLE, outputView, VK_IMAGE_LAYOUT_GENERAL } }
+        };
+
+        VkWriteDescriptorSet outputDescriptorWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+        {
+            outputDescriptorWrite.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            outputDescriptorWrite.descriptorCount = (uint32_t)outputImageInfos.size();
+            outputDescriptorWrite.dstBinding      = 0U;
+            outputDescriptorWrite.dstSet          = g_OutputDescriptorSets.at(backBufferIndex);
+            outputDescriptorWrite.pImageInfo      = outputImageInfos.data();
+        }
+        vkUpdateDescriptorSets(pRenderContext->GetDevice(), 1U, &outputDescriptorWrite, 0U, nullptr);
+    }
+}
+
+void InitializeResources(RenderContext* pRenderContext)
+{
+    CPUTracer::Get().SetThreadName("Resource Loader");
+
+    PROFILE_SCOPE("Initialize Resources");
+
+    auto initializeTimeBegin = std::chrono::high_resolution_clock::now();
 
-    // Release thread's command pool.
+    // The loader thread is worker zero, the rest of the pool is spawned by the graph.
+    const uint32_t workerCount = std::clamp(std::thread::hardware_concurrency(), 1U, kMaxResourceLoaderWorkers);
+
+    // Command pool per worker (command pools are externally synchronized).
     // ------------------------------------------------
 
-    vkDestroyCommandPool(pRenderContext->GetDevice(), vkCommandPool, nullptr);
+    std::vector<VkCommandPool> vkCommandPools(workerCount, VK_NULL_HANDLE);
+
+    VkCommandPoolCreateInfo vkCommandPoolInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+    {
+        vkCommandPoolInfo.queueFamilyIndex = pRenderContext->GetCommandQueueIndex();
+    }
+
+    for (auto& vkCommandPool : vkCommandPools)
+        Check(vkCreateCommandPool(pRenderContext->GetDevice(), &vkCommandPoolInfo, nullptr, &vkCommandPool),
+              "Failed to create a Vulkan Command Pool");
 
-    // Done.
+    auto GetCommandPool = [&]() { return vkCommandPools.at(TaskGraph::GetWorkerIndex()); };
+
+    // Startup work as a dependency graph, independent branches (asset parsing, attachments, pipelines) overlap.
     // ------------------------------------------------
 
-    spdlog::info("Initialized Resources.");
+    TaskGraph taskGraph;
+
+    std::vector<Vertex>   instanceTransforms;
+    std::vector<Vertex>   meshVertices;
+    std::vector<uint32_t> meshIndices;
+
+    auto queryProperties = taskGraph.AddTask(
+        "Query Properties",
+        [&]()
+        {
+            VkPhysicalDeviceProperties2 deviceProperties { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
+            {
+                g_RayTracingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_PROPERTIES_KHR;
+
+                deviceProperties.pNext = &g_RayTracingProperties;
+            }
+            vkGetPhysicalDeviceProperties2(pRenderContext->GetDevicePhysical(), &deviceProperties);
+
+            VkPhysicalDeviceAccelerationStructureFeaturesKHR accelerationStructureFeatures {
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR
+            };
+
+            VkPhysicalDeviceFeatures2 deviceFeatures { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+            {
+                deviceFeatures.pNext = &accelerationStructureFeatures;
+            }
+            vkGetPhysicalDeviceFeatures2(pRenderContext->GetDevicePhysical(), &deviceFeatures);
+
+            // Supported features are all enabled at device creation.
+            g_HostBLASBuilds = g_LaunchOptions.hostBLASBuilds && accelerationStructureFeatures.accelerationStructureHostCommands == VK_TRUE;
+
+            if (g_LaunchOptions.hostBLASBuilds && !g_HostBLASBuilds)
+                spdlog::warn("Host acceleration structure commands are not supported, falling back to device BLAS builds.");
+        });
+
+    auto createAttachments = taskGraph.AddTask(
+        "Create Attachments",
+        [&]()
+        {
+            // Linear HDR radiance, tone mapped by the output pass (transfer source for the blit fallback).
+            g_TransientColor = g_TransientImages.AddImage("Color Attachment",
+                                                          VK_FORMAT_R16G16B16A16_SFLOAT,
+                                                          VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                                                          kFramePassTrace,
+                                                          kFramePassOutput);
+
+            // Primary hit attributes consumed by the visibility rays, and guiding the denoiser.
+            g_TransientGBufferPosition = g_TransientImages.AddImage("G-Buffer Position",
+                                                                    VK_FORMAT_R32G32B32A32_SFLOAT,
+                                                                    VK_IMAGE_USAGE_STORAGE_BIT,
+                                                                    kFramePassTrace,
+                                                                    kFramePassDenoise);
+            g_TransientGBufferNormal   = g_TransientImages.AddImage("G-Buffer Normal",
+                                                                    VK_FORMAT_R16G16B16A16_SFLOAT,
+                                                                    VK_IMAGE_USAGE_STORAGE_BIT,
+                                                                    kFramePassTrace,
+                                                                    kFramePassDenoise);
+
+            // Offset to where the primary hit of each pixel was in the previous frame.
+            g_TransientGBufferMotion = g_TransientImages.AddImage(
+                "G-Buffer Motion", VK_FORMAT_R16G16_SFLOAT, VK_IMAGE_USAGE_STORAGE_BIT, kFramePassTrace, kFramePassDenoise);
+
+            // Ping-pong target of the a-trous iterations.
+            g_TransientDenoiseScratch = g_TransientImages.AddImage(
+                "Denoise Scratch", VK_FORMAT_R16G16B16A16_SFLOAT, VK_IMAGE_USAGE_STORAGE_BIT, kFramePassDenoise, kFramePassDenoise);
+
+            g_TransientImages.Allocate(pRenderContext);
+
+            g_ColorAttachment = g_TransientImages.GetImage(g_TransientColor);
+            g_GBufferPosition = g_TransientImages.GetImage(g_TransientGBufferPosition);
+            g_GBufferNormal   = g_TransientImages.GetImage(g_TransientGBufferNormal);
+            g_GBufferMotion   = g_TransientImages.GetImage(g_TransientGBufferMotion);
+            g_DenoiseScratch  = g_TransientImages.GetImage(g_TransientDenoiseScratch);
+
+            g_BenchmarkRecorder.RecordCounter("transientImageBytes", g_TransientImages.GetAllocationSize());
+            g_BenchmarkRecorder.RecordCounter("transientImageBytesUnaliased", g_TransientImages.GetUnaliasedSize());
+        });
+
+    auto loadPoints = taskGraph.AddTask(
+        "Load Instance Points",
+        [&]()
+        {
+            Check(LoadPoints("..\\Assets\\instance_transforms.obj", instanceTransforms), "Failed to load the instance points.");
+
+            if (g_LaunchOptions.instanceCount > 0U)
+                ResizeInstancePoints(instanceTransforms, g_LaunchOptions.instanceCount);
+        });
+
+    auto loadMesh = taskGraph.AddTask(
+        "Load Mesh",
+        [&]()
+        {
+            Check(LoadMesh("..\\Assets\\bunny_low.obj", meshVertices, meshIndices), "Failed to load the mesh.");
+
+            SubdivideMesh(meshVertices, meshIndices, g_LaunchOptions.meshSubdivisions);
+        });
+
+    auto createBindlessDescriptors =
+        taskGraph.AddTask("Create Bindless Descriptors", [&]() { g_BindlessDescriptors.Create(pRenderContext); });
+
+    // Every LOD is simplified, uploaded and built on its own branch. Only the first reference to some content uploads
+    // and builds it, the others share its buffers and BLAS.
+    std::array<TaskGraph::TaskHandle, kMeshLODCount> uploadMeshes {};
+    std::array<TaskGraph::TaskHandle, kMeshLODCount> buildBLAS {};
+    std::array<bool, kMeshLODCount>                  ownsGeometry {};
+
+    for (uint32_t lod = 0U; lod < kMeshLODCount; lod++)
+    {
+        uploadMeshes.at(lod) = taskGraph.AddTask(
+            std::format("Upload Mesh (LOD {})", lod),
+            [&, lod]()
+            {
+                std::vector<Vertex>   lodVertices;
+                std::vector<uint32_t> lodIndices;
+
+                if (lod == 0U)
+                {
+                    lodVertices = meshVertices;
+                    lodIndices  = meshIndices;
+                }
+                else
+                    SimplifyMesh(meshVertices, meshIndices, kMeshLODGridResolution.at(lod), lodVertices, lodIndices);
+
+                ownsGeometry.at(lod) = g_GeometryRegistry.Acquire(lodVertices, lodIndices, g_MeshLODs.at(lod));
+
+                if (!ownsGeometry.at(lod))
+                {
+                    spdlog::info("LOD {} has the content of an existing mesh, sharing its buffers and BLAS.", lod);
+                    return;
+                }
+
+                auto& mesh = g_GeometryRegistry.GetMesh(g_MeshLODs.at(lod));
+
+                mesh.vertexCount = (uint32_t)lodVertices.size();
+                mesh.indexCount  = (uint32_t)lodIndices.size();
+                mesh.bounds      = ComputeBoundingSphere(lodVertices);
+
+                CreateMeshBuffer(pRenderContext,
+                                 GetCommandPool(),
+                                 lodVertices.data(),
+                                 sizeof(Vertex) * mesh.vertexCount,
+                                 VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
+                                     VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                 &mesh.vertexBuffer);
+
+                CreateMeshBuffer(pRenderContext,
+                                 GetCommandPool(),
+                                 lodIndices.data(),
+                                 sizeof(uint32_t) * mesh.indexCount,
+                                 VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
+                                     VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                 &mesh.indexBuffer);
+
+                mesh.vertexBufferIndex = g_BindlessDescriptors.RegisterBuffer(pRenderContext, mesh.vertexBuffer);
+                mesh.indexBufferIndex  = g_BindlessDescriptors.RegisterBuffer(pRenderContext, mesh.indexBuffer);
+
+                if (g_LaunchOptions.hostBLASBuilds)
+                {
+                    mesh.hostVertices = std::move(lodVertices);
+                    mesh.hostIndices  = std::move(lodIndices);
+                }
+            },
+            { loadMesh, createBindlessDescriptors });
+
+        buildBLAS.at(lod) = taskGraph.AddTask(
+            std::format("BLAS Build (LOD {})", lod),
+            [&, lod]()
+            {
+                if (ownsGeometry.at(lod))
+                    LoadOrBuildBLAS(pRenderContext, GetCommandPool(), g_GeometryRegistry.GetMesh(g_MeshLODs.at(lod)));
+            },
+            { uploadMeshes.at(lod), queryProperties });
+    }
+
+    // The TLAS instances can reference every LOD once culling selects them.
+    std::vector<TaskGraph::TaskHandle> buildTLASDependencies(buildBLAS.begin(), buildBLAS.end());
+    buildTLASDependencies.push_back(loadPoints);
+
+    auto buildTLAS =
+        taskGraph.AddTask("TLAS Build", [&]() { BuildTLAS(pRenderContext, GetCommandPool(), instanceTransforms); }, buildTLASDependencies);
+
+    // One untextured white material for now, which leaves the barycentric debug output unchanged.
+    auto uploadSceneTables = taskGraph.AddTask(
+        "Upload Scene Tables",
+        [&]()
+        {
+            std::vector<GeometryRecord> geometryRecords;
+
+            // Shared geometry repeats its record, the custom index of an instance stays its LOD.
+            for (auto geometry : g_MeshLODs)
+            {
+                const auto& mesh = g_GeometryRegistry.GetMesh(geometry);
+                geometryRecords.push_back({ mesh.vertexBufferIndex, mesh.indexBufferIndex, 0U, 0U });
+            }
+
+            // The deformed copies from kDeformedGeometryRecord on, LOD 0 itself until CreateOptionalPasses rewrites them.
+            for (uint32_t frameIndex = 0U; frameIndex < kMaxFramesInFlight; frameIndex++)
+                geometryRecords.push_back(geometryRecords.front());
+
+            const std::array<MaterialRecord, 1> materialRecords = { { { glm::vec4(1.0F), kBindlessInvalidIndex, { 0U, 0U, 0U } } } };
+
+            CreateMeshBuffer(pRenderContext,
+                             GetCommandPool(),
+                             geometryRecords.data(),
+                             sizeof(GeometryRecord) * (uint32_t)geometryRecords.size(),
+                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                             &g_GeometryTable);
+
+            CreateMeshBuffer(pRenderContext,
+                             GetCommandPool(),
+                             materialRecords.data(),
+                             sizeof(MaterialRecord) * (uint32_t)materialRecords.size(),
+                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                             &g_MaterialTable);
+
+            g_BindlessDescriptors.SetTables(pRenderContext, g_GeometryTable, g_MaterialTable);
+
+            // Every mesh is acquired by now.
+            g_GeometryRegistry.ReleaseContent();
+
+            g_BenchmarkRecorder.RecordCounter("bindlessBuffers", g_BindlessDescriptors.GetBufferCount());
+            g_BenchmarkRecorder.RecordCounter("uniqueGeometries", g_GeometryRegistry.GetGeometryCount());
+            g_BenchmarkRecorder.RecordCounter("geometryReferences", g_GeometryRegistry.GetReferenceCount());
+        },
+        std::vector<TaskGraph::TaskHandle>(uploadMeshes.begin(), uploadMeshes.end()));
+
+    auto createPipelineLayout =
+        taskGraph.AddTask("Create Pipeline Layout", [&]() { CreatePipelineLayout(pRenderContext); }, { createBindlessDescriptors });
+
+    // The variant selected by the launch options, built with its shader binding tables.
+    auto createRaytracingPipeline = taskGraph.AddTask(
+        "Create Ray Tracing Pipeline",
+        [&]()
+        {
+            g_RaytracingVariants.Initialize(
+                [pRenderContext](const ShaderVariant& variant, RaytracingPipeline& raytracingPipeline)
+                {
+                    if (!CreateRaytracingPipeline(pRenderContext, variant, raytracingPipeline))
+                        return false;
+
+                    CreateShaderBindingTables(pRenderContext, raytracingPipeline);
+                    return true;
+                });
+
+            g_RaytracingVariant.samplesPerPixel = g_LaunchOptions.samplesPerPixel;
+            g_RaytracingVariant.debugView       = static_cast<DebugView>(g_LaunchOptions.debugView);
+            g_RaytracingVariant.maxBounceCount  = g_LaunchOptions.maxBounceCount;
+            g_ActiveRaytracingVariant           = g_RaytracingVariant;
+
+            Check(g_RaytracingVariants.Get(g_RaytracingVariant) != nullptr, "Failed to create ray tracing pipeline.");
+        },
+        { createPipelineLayout, queryProperties });
+
+    auto createRayQueryPipeline =
+        taskGraph.AddTask("Create Ray Query Pipeline", [&]() { CreateRayQueryPipeline(pRenderContext); }, { createPipelineLayout });
+
+    auto createOutputPipeline =
+        taskGraph.AddTask("Create Output Pipeline", [&]() { CreateOutputPipeline(pRenderContext); }, { createPipelineLayout });
+
+    auto createDescriptors = taskGraph.AddTask(
+        "Create Descriptors",
+        [&]() { CreateDescriptors(pRenderContext); },
+        { createPipelineLayout, createAttachments, buildTLAS });
+
+    // End of the critical path, the first frame can be recorded from here on.
+    taskGraph.AddTask(
+        "Resources Ready",
+        [&]()
+        {
+            spdlog::info("Initialized Resources.");
+
+            g_BenchmarkRecorder.RecordTiming("Initialize Resources", MillisecondsSince(initializeTimeBegin));
+
+            g_ResourcesReadyFence.store(true);
+        },
+        { createDescriptors,
+          uploadSceneTables,
+          createRaytracingPipeline,
+          createRayQueryPipeline,
+          createOutputPipeline });
+
+    taskGraph.Execute(workerCount);
+
+    // Task durations overlap, so they don't add up to the total.
+    for (const auto& [taskName, taskMilliseconds] : taskGraph.GetTaskTimings())
+        g_BenchmarkRecorder.RecordTiming(taskName, taskMilliseconds);
 
-    g_ResourcesReadyFence.store(true);
+    // Release the worker command pools.
+    // ------------------------------------------------
+
+    for (auto& vkCommandPool : vkCommandPools)
+        vkDestroyCommandPool(pRenderContext->GetDevice(), vkCommandPool, nullptr);
 }
 
 void FreeResources(RenderContext* pRenderContext)
@@ -1034,97 +2832,186 @@ void FreeResources(RenderContext* pRenderContext)
 
     vkDestroyPipelineLayout(pRenderContext->GetDevice(), g_PipelineLayout, nullptr);
     vkDestroyDescriptorSetLayout(pRenderContext->GetDevice(), g_DescriptorSetLayout, nullptr);
+    vkDestroyPipelineLayout(pRenderContext->GetDevice(), g_OutputPipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(pRenderContext->GetDevice(), g_OutputDescriptorSetLayout, nullptr);
 
     vkDestroyDescriptorPool(pRenderContext->GetDevice(), g_DescriptorPool, nullptr);
 
-    vkDestroyPipeline(pRenderContext->GetDevice(), g_RaytracingPipeline, nullptr);
+    g_DeferredReleases.Flush();
+
+    g_RaytracingVariants.Clear([&](RaytracingPipeline& raytracingPipeline) { ReleaseRaytracingPipeline(pRenderContext, raytracingPipeline); });
+
+    for (auto& [variant, raytracingPipeline] : g_PendingRaytracingVariants)
+        ReleaseRaytracingPipeline(pRenderContext, raytracingPipeline);
+
+    vkDestroyPipeline(pRenderContext->GetDevice(), g_RayQueryPipeline, nullptr);
+    vkDestroyPipeline(pRenderContext->GetDevice(), g_OutputPipeline, nullptr);
+
+    g_Denoiser.Release(pRenderContext);
+    g_SparseReconstruction.Release(pRenderContext);
+
+    if (g_PendingDenoiser.has_value())
+        g_PendingDenoiser->Release(pRenderContext);
+
+    if (g_PendingSparseReconstruction.has_value())
+        g_PendingSparseReconstruction->Release(pRenderContext);
 
-    vkDestroyAccelerationStructureKHR(pRenderContext->GetDevice(), g_BLAS, nullptr);
-    vkDestroyAccelerationStructureKHR(pRenderContext->GetDevice(), g_TLAS, nullptr);
+    vkDestroyAccelerationStructureKHR(pRenderContext->GetDevice(), g_TLAS.handle, nullptr);
 
-    vmaDestroyBuffer(pRenderContext->GetAllocator(), g_BLASBackingMemory.buffer, g_BLASBackingMemory.bufferAllocation);
-    vmaDestroyBuffer(pRenderContext->GetAllocator(), g_TLASBackingMemory.buffer, g_TLASBackingMemory.bufferAllocation);
+    vmaDestroyBuffer(pRenderContext->GetAllocator(), g_TLAS.backingMemory.buffer, g_TLAS.backingMemory.bufferAllocation);
+    vmaDestroyBuffer(pRenderContext->GetAllocator(), g_TLASScratchBuffer.buffer, g_TLASScratchBuffer.bufferAllocation);
 
-    vkDestroyImageView(pRenderContext->GetDevice(), g_ColorAttachment.imageView, nullptr);
-    vkDestroyImageView(pRenderContext->GetDevice(), g_DepthAttachment.imageView, nullptr);
+    for (auto& instanceBuffer : g_InstanceBuffers)
+        vmaDestroyBuffer(pRenderContext->GetAllocator(), instanceBuffer.buffer, instanceBuffer.bufferAllocation);
 
-    vmaDestroyImage(pRenderContext->GetAllocator(), g_ColorAttachment.image, g_ColorAttachment.imageAllocation);
-    vmaDestroyImage(pRenderContext->GetAllocator(), g_DepthAttachment.image, g_DepthAttachment.imageAllocation);
+    vmaDestroyBuffer(pRenderContext->GetAllocator(), g_FrameConstantsBuffer.buffer, g_FrameConstantsBuffer.bufferAllocation);
 
-    vmaDestroyBuffer(pRenderContext->GetAllocator(), g_MeshVertexBuffer.buffer, g_MeshVertexBuffer.bufferAllocation);
-    vmaDestroyBuffer(pRenderContext->GetAllocator(), g_MeshIndexBuffer.buffer, g_MeshIndexBuffer.bufferAllocation);
+    g_TransientImages.Release(pRenderContext);
 
-    vmaDestroyBuffer(pRenderContext->GetAllocator(), g_ShaderBindingsRayGen.buffer, g_ShaderBindingsRayGen.bufferAllocation);
-    vmaDestroyBuffer(pRenderContext->GetAllocator(), g_ShaderBindingsClosestHit.buffer, g_ShaderBindingsClosestHit.bufferAllocation);
-    vmaDestroyBuffer(pRenderContext->GetAllocator(), g_ShaderBindingsMiss.buffer, g_ShaderBindingsMiss.bufferAllocation);
+    g_BindlessDescriptors.Release(pRenderContext);
+
+    vmaDestroyBuffer(pRenderContext->GetAllocator(), g_GeometryTable.buffer, g_GeometryTable.bufferAllocation);
+    vmaDestroyBuffer(pRenderContext->GetAllocator(), g_MaterialTable.buffer, g_MaterialTable.bufferAllocation);
+
+    g_MeshDeformer.Release(pRenderContext);
+
+    if (g_PendingMeshDeformer.has_value())
+        g_PendingMeshDeformer->Release(pRenderContext);
+
+    for (auto geometry : g_MeshLODs)
+        g_GeometryRegistry.Release(pRenderContext, geometry);
 }
 
-bool LoadMesh(const char* filePath, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+void RenderTiles(RenderContext* pRenderContext)
 {
-    tinyobj::ObjReader reader;
+    // One more headless context per capable device other than the primary one (the best scoring, or the --device one).
+    // ------------------------------------------------
+
+    std::vector<std::unique_ptr<RenderContext>> tileContexts;
+    std::vector<RenderContext*>                 renderContexts = { pRenderContext };
+
+    StartupPhase phase(g_BenchmarkRecorder, "Create Tile Device Contexts");
+
+    const std::vector<uint32_t>& capableDeviceIndices = pRenderContext->GetCapableDeviceIndices();
 
-    if (!reader.ParseFromFile(filePath))
+    for (const uint32_t deviceIndex : capableDeviceIndices)
     {
-        if (!reader.Error().empty())
+        if (deviceIndex == pRenderContext->GetDeviceIndex())
+            continue;
+
+        // The back buffers of the tile contexts are never used, keep them small.
+        RenderContextOptions tileContextOptions = g_LaunchOptions.renderContext;
         {
-            spdlog::error("Failed to load mesh: {}", reader.Error());
-            return false;
+            tileContextOptions.device = std::to_string(deviceIndex);
+            tileContextOptions.width  = kTileSize;
+            tileContextOptions.height = kTileSize;
         }
+
+        renderContexts.push_back(tileContexts.emplace_back(std::make_unique<RenderContext>(tileContextOptions)).get());
     }
 
-    auto& attrib = reader.GetAttrib();
-    auto& shapes = reader.GetShapes();
+    // Host copy of the scene, LOD 0 of every instance (nothing is culled offline).
+    // ------------------------------------------------
+
+    phase.Next("Load Tile Scene");
 
-    for (const auto& shape : shapes)
-    {
-        for (const auto& index : shape.mesh.indices)
-        {
-            Vertex v;
+    TileScene           scene;
+    std::vector<Vertex> instancePoints;
+
+    Check(LoadMesh("..\\Assets\\bunny_low.obj", scene.vertices, scene.indices), "Failed to load the mesh.");
+    Check(LoadPoints("..\\Assets\\instance_transforms.obj", instancePoints), "Failed to load the instance points.");
 
-            // Positions
-            v.positionOS.x = attrib.vertices[3U * index.vertex_index + 0U];
-            v.positionOS.y = attrib.vertices[3U * index.vertex_index + 1U];
-            v.positionOS.z = attrib.vertices[3U * index.vertex_index + 2U];
+    SubdivideMesh(scene.vertices, scene.indices, g_LaunchOptions.meshSubdivisions);
 
-            // Normals
-            v.normalOS.x = attrib.normals[3U * index.normal_index + 0U];
-            v.normalOS.y = attrib.normals[3U * index.normal_index + 1U];
-            v.normalOS.z = attrib.normals[3U * index.normal_index + 2U];
+    if (g_LaunchOptions.instanceCount > 0U)
+        ResizeInstancePoints(instancePoints, g_LaunchOptions.instanceCount);
 
-            vertices.push_back(v);
-            indices.push_back((uint32_t)indices.size());
+    for (const auto& point : instancePoints)
+    {
+        const glm::mat4 transform = ComputeInstanceTransform(point);
+
+        VkTransformMatrixKHR& vkTransform = scene.instanceTransforms.emplace_back();
+
+        for (int row = 0; row < 3; ++row)
+        {
+            for (int col = 0; col < 4; ++col)
+            {
+                vkTransform.matrix[row][col] = transform[col][row];
+            }
         }
     }
 
-    spdlog::info("Loaded Mesh: {}", filePath);
+    phase.Next("Replicate Scene");
 
-    return true;
-};
+    TileRenderer tileRenderer;
+    tileRenderer.Initialize(renderContexts, scene);
 
-bool LoadPoints(const char* filePath, std::vector<Vertex>& vertices)
-{
-    tinyobj::ObjReader reader;
+    phase.End();
+
+    // Frames, the tile split adapts to the throughput each device measured on the previous one.
+    // ------------------------------------------------
+
+    g_Camera.Initialize(g_LaunchOptions.renderContext.width, g_LaunchOptions.renderContext.height);
+
+    if (g_LaunchOptions.cameraTime >= 0.0F || g_LaunchOptions.cameraPath)
+        g_Camera.SetScriptedPath(std::max(g_LaunchOptions.cameraTime, 0.0F), g_LaunchOptions.cameraPath ? kCameraScriptedTimeStep : 0.0F);
 
-    if (!reader.ParseFromFile(filePath))
+    std::vector<glm::vec4> image;
+
+    auto frameTimeBegin = std::chrono::high_resolution_clock::now();
+
+    for (uint32_t frameIndex = 0U; frameIndex < g_LaunchOptions.renderContext.frameCount; frameIndex++)
     {
-        if (!reader.Error().empty())
-        {
-            spdlog::error("Failed to load mesh: {}", reader.Error());
-            return false;
-        }
+        tileRenderer.Render(g_Camera.GetState(),
+                            g_LaunchOptions.renderContext.width,
+                            g_LaunchOptions.renderContext.height,
+                            g_LaunchOptions.samplesPerPixel,
+                            image);
+
+        const double frameMilliseconds = MillisecondsSince(frameTimeBegin);
+        frameTimeBegin                 = std::chrono::high_resolution_clock::now();
+
+        if (frameIndex >= g_LaunchOptions.warmupFrames)
+            g_BenchmarkRecorder.RecordFrame(frameMilliseconds, {});
+
+        g_Camera.Update(nullptr, frameMilliseconds / 1000.0);
     }
 
-    auto& attrib = reader.GetAttrib();
+    // Split of the last frame.
+    // ------------------------------------------------
+
+    const auto& deviceStatistics = tileRenderer.GetStatistics();
 
-    for (uint32_t pointIndex = 0U; pointIndex < attrib.vertices.size(); pointIndex += 3U)
+    for (uint32_t deviceIndex = 0U; deviceIndex < deviceStatistics.size(); deviceIndex++)
     {
-        Vertex v;
-        {
-            v.positionOS = glm::vec3(attrib.vertices[pointIndex + 0U], attrib.vertices[pointIndex + 1U], attrib.vertices[pointIndex + 2U]);
-            v.normalOS   = glm::vec3(attrib.normals[pointIndex + 0U], attrib.normals[pointIndex + 1U], attrib.normals[pointIndex + 2U]);
-        }
-        vertices.push_back(v);
+        const auto& statistics = deviceStatistics[deviceIndex];
+
+        spdlog::info("Tile Device {} ({}): {} tiles, {:.2f} ms busy, {:.1f} tiles/s.",
+                     deviceIndex,
+                     statistics.name,
+                     statistics.tileCount,
+                     statistics.busyMilliseconds,
+                     statistics.tilesPerSecond);
+
+        g_BenchmarkRecorder.RecordCounter(std::format("tileDevice{}Tiles", deviceIndex), statistics.tileCount);
     }
 
-    return true;
-};
+    g_BenchmarkRecorder.RecordCounter("tileDevices", deviceStatistics.size());
+    g_BenchmarkRecorder.RecordCounter("tilesStolen", tileRenderer.GetStolenCount());
+
+    if (!g_LaunchOptions.capturePath.empty() && !image.empty())
+    {
+        ImageRGB8 capture;
+        TileRenderer::Resolve(image, g_LaunchOptions.renderContext.width, g_LaunchOptions.renderContext.height, g_LaunchOptions.tonemap, capture);
+
+        WritePPM(g_LaunchOptions.capturePath.c_str(), capture);
+    }
+
+    if (!g_LaunchOptions.resultsPath.empty())
+        g_BenchmarkRecorder.WriteJSON(g_LaunchOptions.resultsPath.c_str(), g_LaunchOptions);
+
+    if (!g_LaunchOptions.tracePath.empty())
+        CPUTracer::Get().WriteChromeTrace(g_LaunchOptions.tracePath.c_str());
+
+    tileRenderer.Release();
+}
@@ -0,0 +1,423 @@
+#include <Common.h>
+#include <Scene.h>
+#include <Profiler.h>
+#include <RenderContext.h>
+#include <RenderGraph.h>
+#include <BindlessDescriptors.h>
+#include <GeometryRegistry.h>
+#include <MeshDeformer.h>
+
+// Mesh Deformer Implementation
+// ------------------------------------------------------------
+
+// Storage buffer bindings of Shaders/DeformVertices.hlsl: the rest vertices, the deformed vertices and the drift.
+const uint32_t kDeformVerticesBindingCount = 3U;
+
+const uint32_t kDeformVerticesGroupSize = 64U;
+
+// Traced for many frames between rebuilds, and refit in between.
+const VkBuildAccelerationStructureFlagsKHR kDeformedBLASFlags =
+    VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
+
+static uint64_t GetBufferDeviceAddress(RenderContext* pRenderContext, const Buffer& buffer)
+{
+    VkBufferDeviceAddressInfo deviceAddressInfo = { VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO };
+    {
+        deviceAddressInfo.buffer = buffer.buffer;
+    }
+    return vkGetBufferDeviceAddress(pRenderContext->GetDevice(), &deviceAddressInfo);
+}
+
+// Triangles of the deformed vertices and the rest pose indices.
+static void GetBuildInfo(RenderContext*                               pRenderContext,
+                         const Mesh&                                  restMesh,
+                         const Buffer&                                deformedVertices,
+                         VkAccelerationStructureGeometryKHR&          blasGeometryInfo,
+                         VkAccelerationStructureBuildGeometryInfoKHR& blasBuildGeometryInfo)
+{
+    blasGeometryInfo = { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR };
+    {
+        blasGeometryInfo.geometryType                                = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
+        blasGeometryInfo.flags                                       = VK_GEOMETRY_OPAQUE_BIT_KHR;
+        blasGeometryInfo.geometry.triangles.sType                    = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
+        blasGeometryInfo.geometry.triangles.vertexFormat             = VK_FORMAT_R32G32B32_SFLOAT;
+        blasGeometryInfo.geometry.triangles.vertexData.deviceAddress = GetBufferDeviceAddress(pRenderContext, deformedVertices);
+        blasGeometryInfo.geometry.triangles.maxVertex                = restMesh.vertexCount;
+        blasGeometryInfo.geometry.triangles.vertexStride             = sizeof(Vertex);
+        blasGeometryInfo.geometry.triangles.indexType                = VK_INDEX_TYPE_UINT32;
+        blasGeometryInfo.geometry.triangles.indexData.deviceAddress  = GetBufferDeviceAddress(pRenderContext, restMesh.indexBuffer);
+    }
+
+    blasBuildGeometryInfo = { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR };
+    {
+        blasBuildGeometryInfo.type          = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+        blasBuildGeometryInfo.flags         = kDeformedBLASFlags;
+        blasBuildGeometryInfo.geometryCount = 1U;
+        blasBuildGeometryInfo.pGeometries   = &blasGeometryInfo;
+    }
+}
+
+void MeshDeformer::Create(RenderContext* pRenderContext, const Mesh& restMesh, BindlessDescriptors& bindlessDescriptors)
+{
+    m_pRenderContext = pRenderContext;
+    m_pRestMesh      = &restMesh;
+
+    VkBufferCreateInfo bufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage                   = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    // The build sizes don't depend on the vertex data.
+    VkAccelerationStructureGeometryKHR          blasGeometryInfo;
+    VkAccelerationStructureBuildGeometryInfoKHR blasBuildGeometryInfo;
+    GetBuildInfo(pRenderContext, restMesh, restMesh.vertexBuffer, blasGeometryInfo, blasBuildGeometryInfo);
+
+    VkAccelerationStructureBuildSizesInfoKHR blasBuildSizesInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR };
+
+    const uint32_t primitiveCount = restMesh.indexCount / 3U;
+
+    vkGetAccelerationStructureBuildSizesKHR(pRenderContext->GetDevice(),
+                                            VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
+                                            &blasBuildGeometryInfo,
+                                            &primitiveCount,
+                                            &blasBuildSizesInfo);
+
+    for (uint32_t frameIndex = 0U; frameIndex < kMaxFramesInFlight; frameIndex++)
+    {
+        auto& vertices = m_Vertices.at(frameIndex);
+        auto& blas     = m_BLAS.at(frameIndex);
+        auto& scratch  = m_Scratch.at(frameIndex);
+
+        // Deformed vertices, in the layout of the rest pose.
+        // ------------------------------------------------
+
+        bufferInfo.size  = sizeof(Vertex) * restMesh.vertexCount;
+        bufferInfo.usage = VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
+                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+
+        Check(vmaCreateBuffer(pRenderContext->GetAllocator(), &bufferInfo, &allocInfo, &vertices.buffer, &vertices.bufferAllocation, nullptr),
+              "Failed to create the deformed vertex buffer.");
+
+        NameVulkanObject(
+            pRenderContext->GetDevice(), VK_OBJECT_TYPE_BUFFER, (uint64_t)vertices.buffer, std::format("Deformed Vertices {}", frameIndex).c_str());
+
+        m_VertexBufferIndices.at(frameIndex) = bindlessDescriptors.RegisterBuffer(pRenderContext, vertices);
+
+        // BLAS backing memory and scratch, sized for both build modes.
+        // ------------------------------------------------
+
+        bufferInfo.size  = blasBuildSizesInfo.accelerationStructureSize;
+        bufferInfo.usage = VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+        Check(vmaCreateBuffer(pRenderContext->GetAllocator(),
+                              &bufferInfo,
+                              &allocInfo,
+                              &blas.backingMemory.buffer,
+                              &blas.backingMemory.bufferAllocation,
+                              nullptr),
+              "Failed to create dedicated buffer memory.");
+
+        bufferInfo.size  = std::max(blasBuildSizesInfo.buildScratchSize, blasBuildSizesInfo.updateScratchSize);
+        bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+        Check(vmaCreateBuffer(pRenderContext->GetAllocator(), &bufferInfo, &allocInfo, &scratch.buffer, &scratch.bufferAllocation, nullptr),
+              "Failed to create dedicated buffer memory.");
+
+        VkAccelerationStructureCreateInfoKHR blasCreateInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR };
+        {
+            blasCreateInfo.buffer = blas.backingMemory.buffer;
+            blasCreateInfo.size   = blasBuildSizesInfo.accelerationStructureSize;
+            blasCreateInfo.type   = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+        }
+        Check(vkCreateAccelerationStructureKHR(pRenderContext->GetDevice(), &blasCreateInfo, nullptr, &blas.handle),
+              "Failed to create acceleration structure");
+
+        VkAccelerationStructureDeviceAddressInfoKHR blasDeviceAddressInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR };
+        {
+            blasDeviceAddressInfo.accelerationStructure = blas.handle;
+        }
+        blas.deviceAddress = vkGetAccelerationStructureDeviceAddressKHR(pRenderContext->GetDevice(), &blasDeviceAddressInfo);
+
+        NameVulkanObject(pRenderContext->GetDevice(),
+                         VK_OBJECT_TYPE_ACCELERATION_STRUCTURE_KHR,
+                         (uint64_t)blas.handle,
+                         std::format("Deformed BLAS {}", frameIndex).c_str());
+    }
+
+    // Drift read back (persistently mapped, one per frame in flight).
+    // ------------------------------------------------
+
+    bufferInfo.size  = sizeof(uint32_t);
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+    allocInfo.usage = VMA_MEMORY_USAGE_GPU_TO_CPU;
+    allocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    for (uint32_t frameIndex = 0U; frameIndex < kMaxFramesInFlight; frameIndex++)
+    {
+        auto& driftBuffer = m_DriftBuffers.at(frameIndex);
+
+        VmaAllocationInfo driftAllocationInfo;
+        Check(vmaCreateBuffer(pRenderContext->GetAllocator(),
+                              &bufferInfo,
+                              &allocInfo,
+                              &driftBuffer.buffer,
+                              &driftBuffer.bufferAllocation,
+                              &driftAllocationInfo),
+              "Failed to create the deformation drift buffer.");
+
+        m_DriftMappings.at(frameIndex) = static_cast<uint32_t*>(driftAllocationInfo.pMappedData);
+    }
+
+    // Pipeline.
+    // ------------------------------------------------
+
+    std::array<VkDescriptorSetLayoutBinding, kDeformVerticesBindingCount> bindingInfos {};
+
+    for (uint32_t bindingIndex = 0U; bindingIndex < kDeformVerticesBindingCount; bindingIndex++)
+        bindingInfos[bindingIndex] = { bindingIndex, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1U, VK_SHADER_STAGE_COMPUTE_BIT, nullptr };
+
+    VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+    {
+        descriptorSetLayoutInfo.bindingCount = kDeformVerticesBindingCount;
+        descriptorSetLayoutInfo.pBindings    = bindingInfos.data();
+    }
+    Check(vkCreateDescriptorSetLayout(pRenderContext->GetDevice(), &descriptorSetLayoutInfo, nullptr, &m_SetLayout),
+          "Failed to create the deform descriptor set layout.");
+
+    m_PipelineLayout = CreateComputePipelineLayout(pRenderContext, m_SetLayout, sizeof(DeformVerticesConstants));
+    m_Pipeline       = CreateComputePipeline(pRenderContext, "DeformVertices.spv", m_PipelineLayout);
+
+    // One set per frame slot, with its deformed vertices and drift buffer.
+    // ------------------------------------------------
+
+    const VkDescriptorPoolSize descriptorPoolSize = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, kMaxFramesInFlight * kDeformVerticesBindingCount };
+
+    VkDescriptorPoolCreateInfo descriptorPoolInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+    {
+        descriptorPoolInfo.maxSets       = kMaxFramesInFlight;
+        descriptorPoolInfo.poolSizeCount = 1U;
+        descriptorPoolInfo.pPoolSizes    = &descriptorPoolSize;
+    }
+    Check(vkCreateDescriptorPool(pRenderContext->GetDevice(), &descriptorPoolInfo, nullptr, &m_DescriptorPool),
+          "Failed to create the deform descriptor pool.");
+
+    for (uint32_t frameIndex = 0U; frameIndex < kMaxFramesInFlight; frameIndex++)
+    {
+        VkDescriptorSetAllocateInfo descriptorSetInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+        {
+            descriptorSetInfo.descriptorPool     = m_DescriptorPool;
+            descriptorSetInfo.descriptorSetCount = 1U;
+            descriptorSetInfo.pSetLayouts        = &m_SetLayout;
+        }
+        Check(vkAllocateDescriptorSets(pRenderContext->GetDevice(), &descriptorSetInfo, &m_Sets.at(frameIndex)),
+              "Failed to allocate a deform descriptor set.");
+
+        // Binding i is the i-th buffer.
+        const std::array<VkDescriptorBufferInfo, kDeformVerticesBindingCount> bufferInfos = {
+            { { restMesh.vertexBuffer.buffer, 0U, VK_WHOLE_SIZE },
+             { m_Vertices.at(frameIndex).buffer, 0U, VK_WHOLE_SIZE },
+             { m_DriftBuffers.at(frameIndex).buffer, 0U, VK_WHOLE_SIZE } }
+        };
+
+        VkWriteDescriptorSet descriptorWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+        {
+            descriptorWrite.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrite.descriptorCount = kDeformVerticesBindingCount;
+            descriptorWrite.dstBinding      = 0U;
+            descriptorWrite.dstSet          = m_Sets.at(frameIndex);
+            descriptorWrite.pBufferInfo     = bufferInfos.data();
+        }
+        vkUpdateDescriptorSets(pRenderContext->GetDevice(), 1U, &descriptorWrite, 0U, nullptr);
+    }
+
+    spdlog::info("Created Mesh Deformer ({} vertices, {} copies).", restMesh.vertexCount, kMaxFramesInFlight);
+}
+
+void MeshDeformer::Release(RenderContext* pRenderContext)
+{
+    vkDestroyDescriptorPool(pRenderContext->GetDevice(), m_DescriptorPool, nullptr);
+    vkDestroyPipeline(pRenderContext->GetDevice(), m_Pipeline, nullptr);
+    vkDestroyPipelineLayout(pRenderContext->GetDevice(), m_PipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(pRenderContext->GetDevice(), m_SetLayout, nullptr);
+
+    for (auto& driftBuffer : m_DriftBuffers)
+        vmaDestroyBuffer(pRenderContext->GetAllocator(), driftBuffer.buffer, driftBuffer.bufferAllocation);
+
+    for (uint32_t frameIndex = 0U; frameIndex < kMaxFramesInFlight; frameIndex++)
+    {
+        auto& blas = m_BLAS.at(frameIndex);
+
+        vkDestroyAccelerationStructureKHR(pRenderContext->GetDevice(), blas.handle, nullptr);
+
+        vmaDestroyBuffer(pRenderContext->GetAllocator(), blas.backingMemory.buffer, blas.backingMemory.bufferAllocation);
+        vmaDestroyBuffer(pRenderContext->GetAllocator(), m_Scratch.at(frameIndex).buffer, m_Scratch.at(frameIndex).bufferAllocation);
+        vmaDestroyBuffer(pRenderContext->GetAllocator(), m_Vertices.at(frameIndex).buffer, m_Vertices.at(frameIndex).bufferAllocation);
+    }
+}
+
+void MeshDeformer::Import(RenderGraph& renderGraph)
+{
+    for (uint32_t frameIndex = 0U; frameIndex < kMaxFramesInFlight; frameIndex++)
+    {
+        m_GraphVertices.at(frameIndex) = renderGraph.ImportBuffer(std::format("Deformed Vertices {}", frameIndex));
+        m_GraphBLAS.at(frameIndex)     = renderGraph.ImportBuffer(std::format("Deformed BLAS {}", frameIndex));
+    }
+}
+
+void MeshDeformer::RecordBuild(VkCommandBuffer vkCommand, uint32_t frameInFlightIndex, uint32_t sourceFrameIndex, bool update)
+{
+    VkAccelerationStructureGeometryKHR          blasGeometryInfo;
+    VkAccelerationStructureBuildGeometryInfoKHR blasBuildGeometryInfo;
+    GetBuildInfo(m_pRenderContext, *m_pRestMesh, m_Vertices.at(frameInFlightIndex), blasGeometryInfo, blasBuildGeometryInfo);
+
+    const VkBuildAccelerationStructureModeKHR buildMode =
+        update ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR : VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+
+    // Updates refit the BLAS of the previous deforming frame into the one of this frame slot.
+    {
+        blasBuildGeometryInfo.mode                      = buildMode;
+        blasBuildGeometryInfo.srcAccelerationStructure  = update ? m_BLAS.at(sourceFrameIndex).handle : VK_NULL_HANDLE;
+        blasBuildGeometryInfo.dstAccelerationStructure  = m_BLAS.at(frameInFlightIndex).handle;
+        blasBuildGeometryInfo.scratchData.deviceAddress = GetBufferDeviceAddress(m_pRenderContext, m_Scratch.at(frameInFlightIndex));
+    }
+
+    VkAccelerationStructureBuildRangeInfoKHR blasBuildRangeInfo;
+    {
+        blasBuildRangeInfo.primitiveCount  = m_pRestMesh->indexCount / 3U;
+        blasBuildRangeInfo.primitiveOffset = 0U;
+        blasBuildRangeInfo.firstVertex     = 0U;
+        blasBuildRangeInfo.transformOffset = 0U;
+    }
+    const VkAccelerationStructureBuildRangeInfoKHR* pBLASBuildRangeInfo = &blasBuildRangeInfo;
+
+    vkCmdBuildAccelerationStructuresKHR(vkCommand, 1U, &blasBuildGeometryInfo, &pBLASBuildRangeInfo);
+}
+
+void MeshDeformer::AddPasses(RenderGraph&               renderGraph,
+                             const DeformationSettings& settings,
+                             float                      time,
+                             uint32_t                   frameInFlightIndex,
+                             GPUProfiler&               profiler)
+{
+    using ResourceState = RenderGraph::ResourceState;
+
+    // Drift measured by the last frame of this slot, if it refers to the current build.
+    // ------------------------------------------------
+
+    if (m_DriftBuildIndices.at(frameInFlightIndex) == m_BuildIndex && m_Built)
+    {
+        vmaInvalidateAllocation(m_pRenderContext->GetAllocator(), m_DriftBuffers.at(frameInFlightIndex).bufferAllocation, 0U, VK_WHOLE_SIZE);
+
+        m_Drift = std::bit_cast<float>(*m_DriftMappings.at(frameInFlightIndex)) / m_pRestMesh->bounds.radius;
+    }
+
+    const bool rebuild = !m_Built || m_RefitsInARow >= settings.maxRefits || m_Drift > settings.rebuildDrift;
+
+    if (rebuild)
+    {
+        m_Built        = true;
+        m_BuildTime    = time;
+        m_RefitsInARow = 0U;
+        m_Drift        = 0.0F;
+
+        m_BuildIndex++;
+        m_TotalRebuildCount++;
+    }
+    else
+    {
+        m_RefitsInARow++;
+        m_TotalRefitCount++;
+    }
+
+    m_DriftBuildIndices.at(frameInFlightIndex) = m_BuildIndex;
+
+    const uint32_t sourceFrameIndex = std::exchange(m_SourceFrameIndex, frameInFlightIndex);
+
+    DeformVerticesConstants constants;
+    {
+        constants.boundsCenterRadius = glm::vec4(m_pRestMesh->bounds.center, m_pRestMesh->bounds.radius);
+        constants.time               = time;
+        constants.buildTime          = m_BuildTime;
+        constants.amplitude          = settings.amplitude;
+        constants.frequency          = settings.frequency;
+        constants.speed              = settings.speed;
+        constants.vertexCount        = m_pRestMesh->vertexCount;
+    }
+
+    // Deform the rest pose, and measure the drift from the build pose.
+    // ------------------------------------------------
+
+    renderGraph.AddPass(
+        "Deform Vertices",
+        { { m_GraphVertices.at(frameInFlightIndex),
+            { VK_IMAGE_LAYOUT_UNDEFINED, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT } } },
+        [this, constants, frameInFlightIndex, &profiler](VkCommandBuffer cmd)
+        {
+            profiler.BeginScope(cmd, "Deform Vertices");
+
+            const Buffer& driftBuffer = m_DriftBuffers.at(frameInFlightIndex);
+
+            vkCmdFillBuffer(cmd, driftBuffer.buffer, 0U, sizeof(uint32_t), 0U);
+
+            VulkanMemoryBarrier(cmd,
+                                VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                                VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                                VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                                VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_Pipeline);
+
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_PipelineLayout, 0, 1, &m_Sets.at(frameInFlightIndex), 0, 0);
+
+            vkCmdPushConstants(cmd, m_PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0U, sizeof(DeformVerticesConstants), &constants);
+
+            vkCmdDispatch(cmd, (constants.vertexCount + kDeformVerticesGroupSize - 1U) / kDeformVerticesGroupSize, 1U, 1U);
+
+            // Read on the host once the fence of this frame slot is waited on.
+            VulkanMemoryBarrier(cmd,
+                                VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                                VK_ACCESS_2_HOST_READ_BIT,
+                                VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                VK_PIPELINE_STAGE_2_HOST_BIT);
+
+            profiler.EndScope(cmd);
+        });
+
+    // Refit (or rebuild) the BLAS of this frame slot. Only the traversals of the frame that last used the slot (whose
+    // fence was waited on) precede it, the previous frame is still traced from its own copy.
+    // ------------------------------------------------
+
+    const ResourceState blasBuild = { VK_IMAGE_LAYOUT_UNDEFINED,
+                                      VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,
+                                      VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR };
+
+    std::vector<RenderGraph::ResourceUsage> buildUsages = {
+        { m_GraphVertices.at(frameInFlightIndex),
+         { VK_IMAGE_LAYOUT_UNDEFINED, VK_ACCESS_2_SHADER_READ_BIT, VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR } },
+        { m_GraphBLAS.at(frameInFlightIndex), blasBuild },
+    };
+
+    // Refits read the BLAS of the previous deforming frame.
+    if (!rebuild && sourceFrameIndex != frameInFlightIndex)
+    {
+        buildUsages.push_back({ m_GraphBLAS.at(sourceFrameIndex),
+                                { VK_IMAGE_LAYOUT_UNDEFINED,
+                                  VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR,
+                                  VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR } });
+    }
+
+    const char* scopeName = rebuild ? "BLAS Rebuild" : "BLAS Refit";
+
+    renderGraph.AddPass(
+        scopeName,
+        std::move(buildUsages),
+        [this, rebuild, frameInFlightIndex, sourceFrameIndex, scopeName, &profiler](VkCommandBuffer cmd)
+        {
+            profiler.BeginScope(cmd, scopeName);
+
+            RecordBuild(cmd, frameInFlightIndex, sourceFrameIndex, !rebuild);
+
+            profiler.EndScope(cmd);
+        });
+}
@@ -0,0 +1,315 @@
+#include <Common.h>
+#include <Profiler.h>
+#include <RenderContext.h>
+
+// GPU Profiler Implementation
+// ------------------------------------------------------------
+
+void GPUProfiler::Create(RenderContext* pRenderContext, uint32_t frameCount)
+{
+    m_VKDevice = pRenderContext->GetDevice();
+
+    VkPhysicalDeviceProperties physicalDeviceProperties;
+    vkGetPhysicalDeviceProperties(pRenderContext->GetDevicePhysical(), &physicalDeviceProperties);
+
+    m_TimestampPeriodNs = static_cast<double>(physicalDeviceProperties.limits.timestampPeriod);
+    m_FrameQueryCount   = 2U * kMaxGPUProfilerScopes;
+
+    m_FrameScopes.resize(frameCount);
+
+    VkQueryPoolCreateInfo queryPoolInfo = { VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+    {
+        queryPoolInfo.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+        queryPoolInfo.queryCount = m_FrameQueryCount * frameCount;
+    }
+    Check(vkCreateQueryPool(m_VKDevice, &queryPoolInfo, nullptr, &m_VKQueryPool), "Failed to create the GPU profiler query pool.");
+
+    queryPoolInfo.queryCount = 2U * kMaxSingleShotQueries;
+
+    Check(vkCreateQueryPool(m_VKDevice, &queryPoolInfo, nullptr, &m_VKSingleShotQueryPool), "Failed to create the GPU profiler query pool.");
+}
+
+void GPUProfiler::Release(RenderContext* pRenderContext)
+{
+    vkDestroyQueryPool(pRenderContext->GetDevice(), m_VKQueryPool, nullptr);
+    vkDestroyQueryPool(pRenderContext->GetDevice(), m_VKSingleShotQueryPool, nullptr);
+}
+
+void GPUProfiler::BeginFrame(VkCommandBuffer cmd, uint32_t frameInFlightIndex)
+{
+    m_FrameInFlightIndex = frameInFlightIndex;
+    m_OpenScopes.clear();
+
+    auto& frameScopes = m_FrameScopes.at(frameInFlightIndex);
+
+    const uint32_t queryBase = frameInFlightIndex * m_FrameQueryCount;
+
+    if (!frameScopes.empty())
+    {
+        std::vector<uint64_t> timestamps(2U * frameScopes.size());
+
+        // The frame fence of this slot was already waited on, so the results are available.
+        auto result = vkGetQueryPoolResults(m_VKDevice,
+                                            m_VKQueryPool,
+                                            queryBase,
+                                            static_cast<uint32_t>(timestamps.size()),
+                                            timestamps.size() * sizeof(uint64_t),
+                                            timestamps.data(),
+                                            sizeof(uint64_t),
+                                            VK_QUERY_RESULT_64_BIT);
+
+        if (result == VK_SUCCESS)
+        {
+            m_LastFrameScopeMilliseconds.clear();
+
+            for (const auto& scope : frameScopes)
+            {
+                const uint64_t ticks = timestamps[scope.queryEnd - queryBase] - timestamps[scope.queryBegin - queryBase];
+                const double   ms    = static_cast<double>(ticks) * m_TimestampPeriodNs * 1e-6;
+
+                m_LastFrameScopeMilliseconds[scope.name] += ms;
+
+                // Exponential moving average to keep the readout stable.
+                auto scopeIt = m_ScopeMilliseconds.find(scope.name);
+
+                if (scopeIt == m_ScopeMilliseconds.end())
+                    m_ScopeMilliseconds[scope.name] = ms;
+                else
+                    scopeIt->second = 0.95 * scopeIt->second + 0.05 * ms;
+            }
+        }
+
+        frameScopes.clear();
+    }
+
+    vkCmdResetQueryPool(cmd, m_VKQueryPool, queryBase, m_FrameQueryCount);
+}
+
+void GPUProfiler::BeginScope(VkCommandBuffer cmd, const char* scopeName)
+{
+    auto& frameScopes = m_FrameScopes.at(m_FrameInFlightIndex);
+
+    if (frameScopes.size() >= kMaxGPUProfilerScopes)
+    {
+        // Keep the scope stack balanced, but don't record anything.
+        m_OpenScopes.push_back(UINT_MAX);
+        return;
+    }
+
+    const uint32_t queryBase = m_FrameInFlightIndex * m_FrameQueryCount;
+    const uint32_t query     = queryBase + 2U * static_cast<uint32_t>(frameScopes.size());
+
+    frameScopes.push_back({ scopeName, query, query + 1U });
+    m_OpenScopes.push_back(static_cast<uint32_t>(frameScopes.size()) - 1U);
+
+    vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_VKQueryPool, query);
+}
+
+void GPUProfiler::EndScope(VkCommandBuffer cmd)
+{
+    Check(!m_OpenScopes.empty(), "GPU profiler scope ended without a matching begin.");
+
+    const uint32_t scopeIndex = m_OpenScopes.back();
+    m_OpenScopes.pop_back();
+
+    if (scopeIndex == UINT_MAX)
+        return;
+
+    vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_VKQueryPool, m_FrameScopes.at(m_FrameInFlightIndex)[scopeIndex].queryEnd);
+}
+
+double GPUProfiler::GetScopeMilliseconds(const std::string& scopeName) const
+{
+    auto scopeIt = m_ScopeMilliseconds.find(scopeName);
+
+    return scopeIt != m_ScopeMilliseconds.end() ? scopeIt->second : 0.0;
+}
+
+uint32_t GPUProfiler::BeginSingleShot(VkCommandBuffer cmd)
+{
+    if (m_VKSingleShotQueryPool == VK_NULL_HANDLE)
+        return UINT_MAX;
+
+    // Single-shot submissions wait for idle, so slots are long free by the time they are reused.
+    const uint32_t querySlot = m_NextSingleShotSlot++ % kMaxSingleShotQueries;
+
+    vkCmdResetQueryPool(cmd, m_VKSingleShotQueryPool, 2U * querySlot, 2U);
+    vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_VKSingleShotQueryPool, 2U * querySlot);
+
+    return querySlot;
+}
+
+void GPUProfiler::EndSingleShot(VkCommandBuffer cmd, uint32_t querySlot)
+{
+    if (querySlot == UINT_MAX)
+        return;
+
+    vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_VKSingleShotQueryPool, 2U * querySlot + 1U);
+}
+
+double GPUProfiler::ResolveSingleShotMilliseconds(uint32_t querySlot)
+{
+    if (querySlot == UINT_MAX)
+        return 0.0;
+
+    std::array<uint64_t, 2> timestamps {};
+
+    auto result = vkGetQueryPoolResults(m_VKDevice,
+                                        m_VKSingleShotQueryPool,
+                                        2U * querySlot,
+                                        2U,
+                                        sizeof(timestamps),
+                                        timestamps.data(),
+                                        sizeof(uint64_t),
+                                        VK_QUERY_RESULT_64_BIT);
+
+    if (result != VK_SUCCESS)
+        return 0.0;
+
+    return static_cast<double>(timestamps[1] - timestamps[0]) * m_TimestampPeriodNs * 1e-6;
+}
+
+// CPU Tracer Implementation
+// ------------------------------------------------------------
+
+struct OpenTraceEvent
+{
+    std::string                                    name;
+    std::chrono::high_resolution_clock::time_point beginTime;
+};
+
+// Events nest per thread, so the open ones live in a thread local stack.
+thread_local std::vector<OpenTraceEvent> t_OpenTraceEvents;
+thread_local uint32_t                    t_TraceThreadId = 0U;
+
+CPUTracer& CPUTracer::Get()
+{
+    static CPUTracer s_Tracer;
+    return s_Tracer;
+}
+
+uint32_t CPUTracer::GetThreadId()
+{
+    // Zero is the GPU track.
+    if (t_TraceThreadId == 0U)
+        t_TraceThreadId = m_NextThreadId++;
+
+    return t_TraceThreadId;
+}
+
+double CPUTracer::MicrosecondsSinceEpoch(std::chrono::high_resolution_clock::time_point timePoint) const
+{
+    return std::chrono::duration<double, std::micro>(timePoint - m_Epoch).count();
+}
+
+void CPUTracer::PushEvent(Event&& event)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    if (m_Events.size() < kMaxCPUTraceEvents)
+        m_Events.push_back(std::move(event));
+}
+
+void CPUTracer::SetThreadName(const char* threadName)
+{
+    const uint32_t threadId = GetThreadId();
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    m_ThreadNames[threadId] = threadName;
+}
+
+void CPUTracer::BeginEvent(const char* eventName)
+{
+    if (!IsEnabled())
+        return;
+
+    t_OpenTraceEvents.push_back({ eventName, std::chrono::high_resolution_clock::now() });
+}
+
+void CPUTracer::EndEvent()
+{
+    // Events opened before the tracer was enabled are not on the stack.
+    if (!IsEnabled() || t_OpenTraceEvents.empty())
+        return;
+
+    const auto endTime = std::chrono::high_resolution_clock::now();
+
+    OpenTraceEvent openEvent = std::move(t_OpenTraceEvents.back());
+    t_OpenTraceEvents.pop_back();
+
+    const double beginUs = MicrosecondsSinceEpoch(openEvent.beginTime);
+
+    PushEvent({ std::move(openEvent.name), beginUs, MicrosecondsSinceEpoch(endTime) - beginUs, GetThreadId() });
+}
+
+const char* CPUTracer::GetCurrentEventName() const
+{
+    return t_OpenTraceEvents.empty() ? nullptr : t_OpenTraceEvents.back().name.c_str();
+}
+
+void CPUTracer::RecordGPUEvent(const char* eventName, std::chrono::high_resolution_clock::time_point submitTime, double gpuMilliseconds)
+{
+    if (!IsEnabled())
+        return;
+
+    PushEvent({ eventName, MicrosecondsSinceEpoch(submitTime), 1000.0 * gpuMilliseconds, kCPUTracerGPUThreadId });
+}
+
+bool CPUTracer::WriteChromeTrace(const char* filePath) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    std::ofstream file(filePath);
+
+    if (!file.is_open())
+    {
+        spdlog::error("Failed to open {} for writing.", filePath);
+        return false;
+    }
+
+    file << "{ \"traceEvents\": [\n";
+    file << std::format("  {{ \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": {}, \"args\": {{ \"name\": \"GPU\" }} }}",
+                        kCPUTracerGPUThreadId);
+
+    for (const auto& [threadId, threadName] : m_ThreadNames)
+    {
+        file << std::format(",\n  {{ \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": {}, \"args\": {{ \"name\": \"{}\" }} }}",
+                            threadId,
+                            EscapeJSON(threadName));
+    }
+
+    // Complete events ("X") carry their own duration, so they need no begin / end pairing.
+    for (const auto& event : m_Events)
+    {
+        file << std::format(",\n  {{ \"name\": \"{}\", \"ph\": \"X\", \"pid\": 0, \"tid\": {}, \"ts\": {:.3f}, \"dur\": {:.3f} }}",
+                            EscapeJSON(event.name),
+                            event.threadId,
+                            event.beginUs,
+                            event.durationUs);
+    }
+
+    file << "\n] }\n";
+
+    spdlog::info("Wrote {} trace events to {}.", m_Events.size(), filePath);
+
+    return true;
+}
+
+void ProfileBeginEvent(const char* eventName)
+{
+#ifdef USE_SUPERLUMINAL
+    PerformanceAPI_BeginEvent(eventName, nullptr, PERFORMANCEAPI_MAKE_COLOR(255, 150, 0));
+#endif
+
+    CPUTracer::Get().BeginEvent(eventName);
+}
+
+void ProfileEndEvent()
+{
+#ifdef USE_SUPERLUMINAL
+    PerformanceAPI_EndEvent();
+#endif
+
+    CPUTracer::Get().EndEvent();
+}
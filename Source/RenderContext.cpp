@@ -1,19 +1,25 @@
 #include <Common.h>
+#include <Profiler.h>
 #include <RenderContext.h>
+#include <ImageIO.h>
 
-RenderContext::RenderContext(uint32_t width, uint32_t height)
+RenderContext::RenderContext(const RenderContextOptions& options) : m_Options(options)
 {
-    Check(glfwInit() != 0, "Failed to initialize GLFW.");
+    if (!m_Options.headless)
+        Check(glfwInit() != 0, "Failed to initialize GLFW.");
 
     // Initialize Vulkan
     // ------------------------------------------------
 
     Check(volkInitialize(), "Failed to initialize volk.");
 
-    // Pass the dynamically loaded function pointer from volk.
-    glfwInitVulkanLoader(vkGetInstanceProcAddr);
+    if (!m_Options.headless)
+    {
+        // Pass the dynamically loaded function pointer from volk.
+        glfwInitVulkanLoader(vkGetInstanceProcAddr);
 
-    Check(glfwVulkanSupported() != 0, "Failed to locate a Vulkan Loader for GLFW.");
+        Check(glfwVulkanSupported() != 0, "Failed to locate a Vulkan Loader for GLFW.");
+    }
 
     VkApplicationInfo vkApplicationInfo  = { VK_STRUCTURE_TYPE_APPLICATION_INFO };
     vkApplicationInfo.pApplicationName   = "Vulkan Viewport";
@@ -28,8 +34,8 @@ RenderContext::RenderContext(uint32_t width, uint32_t height)
     // requiredInstanceLayers.push_back("VK_LAYER_KHRONOS_validation");
 #endif
 
-    uint32_t windowExtensionCount = 0U;
-    auto*    pWindowExtensions    = glfwGetRequiredInstanceExtensions(&windowExtensionCount);
+    uint32_t     windowExtensionCount = 0U;
+    const char** pWindowExtensions    = m_Options.headless ? nullptr : glfwGetRequiredInstanceExtensions(&windowExtensionCount);
 
     std::vector<const char*> requiredInstanceExtensions;
 
@@ -48,107 +54,58 @@ RenderContext::RenderContext(uint32_t width, uint32_t height)
     vkInstanceCreateInfo.ppEnabledExtensionNames = requiredInstanceExtensions.data();
     Check(vkCreateInstance(&vkInstanceCreateInfo, nullptr, &m_VKInstance), "Failed to create the Vulkan Instance.");
 
-    volkLoadInstanceOnly(m_VKInstance);
+    // Device functions resolved through the loader dispatch the call on the handle, so they work for the devices of every
+    // context. Loaded for one device they skip the dispatch, but only that device may use them.
+    if (m_Options.sharedDispatch)
+        volkLoadInstance(m_VKInstance);
+    else
+        volkLoadInstanceOnly(m_VKInstance);
 
-    std::vector<const char*> requiredDeviceExtensions;
+    VulkanDeviceRequirements deviceRequirements;
     {
-        requiredDeviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
-        requiredDeviceExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
-        requiredDeviceExtensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
-        requiredDeviceExtensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
-        requiredDeviceExtensions.push_back(VK_EXT_SHADER_OBJECT_EXTENSION_NAME);
+        // Also required headless, for the present layout of the back buffers.
+        deviceRequirements.requiredExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        deviceRequirements.requiredExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+        deviceRequirements.requiredExtensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+        deviceRequirements.requiredExtensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
 
         // Raytracing
-        requiredDeviceExtensions.push_back(VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME);
-        requiredDeviceExtensions.push_back(VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME);
-        requiredDeviceExtensions.push_back(VK_KHR_RAY_TRACING_PIPELINE_EXTENSION_NAME);
-        requiredDeviceExtensions.push_back(VK_KHR_RAY_QUERY_EXTENSION_NAME);
-        requiredDeviceExtensions.push_back(VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME);
+        deviceRequirements.requiredExtensions.push_back(VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME);
+        deviceRequirements.requiredExtensions.push_back(VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME);
+        deviceRequirements.requiredExtensions.push_back(VK_KHR_RAY_TRACING_PIPELINE_EXTENSION_NAME);
+        deviceRequirements.requiredExtensions.push_back(VK_KHR_RAY_QUERY_EXTENSION_NAME);
+        deviceRequirements.requiredExtensions.push_back(VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME);
+
+        // Used when present, nothing in the frame depends on them.
+        deviceRequirements.optionalExtensions.push_back(VK_EXT_SHADER_OBJECT_EXTENSION_NAME);
+        deviceRequirements.optionalExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+        deviceRequirements.presentation = !m_Options.headless;
+        deviceRequirements.forcedDevice = m_Options.device;
     }
 
-    Check(SelectVulkanPhysicalDevice(m_VKInstance, requiredDeviceExtensions, m_VKDevicePhysical), "Failed to select a Vulkan Physical Device.");
-    Check(GetVulkanQueueIndices(m_VKInstance, m_VKDevicePhysical, m_VKCommandQueueIndex),
+    Check(SelectVulkanPhysicalDevice(
+              m_VKInstance, deviceRequirements, m_VKDevicePhysical, m_DeviceIndex, m_EnabledDeviceExtensions, m_CapableDeviceIndices),
+          "Failed to select a Vulkan Physical Device.");
+    Check(GetVulkanQueueIndices(m_VKInstance, m_VKDevicePhysical, deviceRequirements.presentation, m_VKCommandQueueIndex),
           "Failed to obtain the required Vulkan Queue Indices from the physical "
           "device.");
-    Check(CreateVulkanLogicalDevice(m_VKDevicePhysical, requiredDeviceExtensions, m_VKCommandQueueIndex, m_VKDeviceLogical),
+    Check(CreateVulkanLogicalDevice(m_VKDevicePhysical, m_EnabledDeviceExtensions, m_VKCommandQueueIndex, m_VKDeviceLogical),
           "Failed to create a Vulkan Logical Device");
 
-    volkLoadDevice(m_VKDeviceLogical);
-
-    // Create OS Window + Vulkan Swapchain
-    // ------------------------------------------------
-
-    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-    m_Window = glfwCreateWindow(static_cast<int>(width), static_cast<int>(height), "Vulkan Viewport", nullptr, nullptr);
-    Check(m_Window != nullptr, "Failed to create the OS Window.");
-    Check(glfwCreateWindowSurface(m_VKInstance, m_Window, nullptr, &m_VKSurface), "Failed to create the Vulkan Surface.");
-
-    VkSurfaceCapabilitiesKHR vkSurfaceProperties;
-    Check(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_VKDevicePhysical, m_VKSurface, &vkSurfaceProperties),
-          "Failed to obect the Vulkan Surface Properties");
-
-    VkSwapchainCreateInfoKHR vkSwapchainCreateInfo = { VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR };
-    vkSwapchainCreateInfo.surface                  = m_VKSurface;
-    vkSwapchainCreateInfo.minImageCount            = vkSurfaceProperties.minImageCount + 1;
-    vkSwapchainCreateInfo.imageExtent              = vkSurfaceProperties.currentExtent;
-    vkSwapchainCreateInfo.imageArrayLayers         = vkSurfaceProperties.maxImageArrayLayers;
-    vkSwapchainCreateInfo.imageUsage               = vkSurfaceProperties.supportedUsageFlags;
-    vkSwapchainCreateInfo.preTransform             = vkSurfaceProperties.currentTransform;
-    vkSwapchainCreateInfo.compositeAlpha           = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-    vkSwapchainCreateInfo.imageFormat              = VK_FORMAT_R8G8B8A8_UNORM;
-    vkSwapchainCreateInfo.imageColorSpace          = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
-    vkSwapchainCreateInfo.imageSharingMode         = VK_SHARING_MODE_EXCLUSIVE;
-    vkSwapchainCreateInfo.presentMode              = VK_PRESENT_MODE_FIFO_KHR;
-    vkSwapchainCreateInfo.oldSwapchain             = nullptr;
-    vkSwapchainCreateInfo.clipped                  = static_cast<VkBool32>(true);
-    Check(vkCreateSwapchainKHR(m_VKDeviceLogical, &vkSwapchainCreateInfo, nullptr, &m_VKSwapchain), "Failed to create the Vulkan Swapchain");
-
-    uint32_t vkSwapchainImageCount = 0U;
-    Check(vkGetSwapchainImagesKHR(m_VKDeviceLogical, m_VKSwapchain, &vkSwapchainImageCount, nullptr),
-          "Failed to obtain Vulkan Swapchain image count.");
-
-    m_VKSwapchainImages.resize(vkSwapchainImageCount);
-    m_VKSwapchainImageViews.resize(vkSwapchainImageCount);
-
-    Check(vkGetSwapchainImagesKHR(m_VKDeviceLogical, m_VKSwapchain, &vkSwapchainImageCount, m_VKSwapchainImages.data()),
-          "Failed to obtain the Vulkan Swapchain images.");
-
-#ifdef _DEBUG
-    for (uint32_t swapChainIndex = 0U; swapChainIndex < vkSwapchainImageCount; swapChainIndex++)
-    {
-        auto swapChainName = std::format("Swapchain Image {}", swapChainIndex);
-        NameVulkanObject(m_VKDeviceLogical, VK_OBJECT_TYPE_IMAGE, reinterpret_cast<uint64_t>(m_VKSwapchainImages[swapChainIndex]), swapChainName);
-    }
-#endif
-
-    VkImageSubresourceRange vkSwapchainImageSubresourceRange;
-    {
-        vkSwapchainImageSubresourceRange.levelCount     = 1U;
-        vkSwapchainImageSubresourceRange.layerCount     = 1U;
-        vkSwapchainImageSubresourceRange.baseMipLevel   = 0U;
-        vkSwapchainImageSubresourceRange.baseArrayLayer = 0U;
-        vkSwapchainImageSubresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
-    }
+    VkPhysicalDeviceProperties vkPhysicalDeviceProperties;
+    vkGetPhysicalDeviceProperties(m_VKDevicePhysical, &vkPhysicalDeviceProperties);
 
-    for (uint32_t imageIndex = 0; imageIndex < vkSwapchainImageCount; imageIndex++)
-    {
-        // Create an image view which we can render into.
-        VkImageViewCreateInfo vkImageViewInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+    m_DeviceName = vkPhysicalDeviceProperties.deviceName;
 
-        vkImageViewInfo.viewType         = VK_IMAGE_VIEW_TYPE_2D;
-        vkImageViewInfo.format           = VK_FORMAT_R8G8B8A8_UNORM;
-        vkImageViewInfo.image            = m_VKSwapchainImages[imageIndex];
-        vkImageViewInfo.subresourceRange = vkSwapchainImageSubresourceRange;
-        vkImageViewInfo.components.r     = VK_COMPONENT_SWIZZLE_R;
-        vkImageViewInfo.components.g     = VK_COMPONENT_SWIZZLE_G;
-        vkImageViewInfo.components.b     = VK_COMPONENT_SWIZZLE_B;
-        vkImageViewInfo.components.a     = VK_COMPONENT_SWIZZLE_A;
+    if (!m_Options.sharedDispatch)
+        volkLoadDevice(m_VKDeviceLogical);
 
-        VkImageView vkImageView = VK_NULL_HANDLE;
-        Check(vkCreateImageView(m_VKDeviceLogical, &vkImageViewInfo, nullptr, &vkImageView), "Failed to create a Swapchain Image View.");
+    // Create OS Window + Vulkan Swapchain
+    // ------------------------------------------------
 
-        m_VKSwapchainImageViews[imageIndex] = vkImageView;
-    }
+    if (!m_Options.headless)
+        CreateSwapchain();
 
     VkCommandPoolCreateInfo vkCommandPoolInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
     {
@@ -194,14 +151,28 @@ RenderContext::RenderContext(uint32_t width, uint32_t height)
     vmaVulkanFunctions.vkGetDeviceProcAddr   = vkGetDeviceProcAddr;
 
     VmaAllocatorCreateInfo vmaAllocatorInfo = {};
-    vmaAllocatorInfo.flags                  = VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT | VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
+    vmaAllocatorInfo.flags                  = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
     vmaAllocatorInfo.vulkanApiVersion       = VK_API_VERSION_1_3;
     vmaAllocatorInfo.physicalDevice         = m_VKDevicePhysical;
     vmaAllocatorInfo.device                 = m_VKDeviceLogical;
     vmaAllocatorInfo.instance               = m_VKInstance;
     vmaAllocatorInfo.pVulkanFunctions       = &vmaVulkanFunctions;
+
+    if (IsDeviceExtensionEnabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME))
+        vmaAllocatorInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
     Check(vmaCreateAllocator(&vmaAllocatorInfo, &m_VKMemoryAllocator), "Failed to create Vulkan Memory Allocator.");
 
+    // Create GPU Profiler
+    // ------------------------------------------------
+
+    m_GPUProfiler.Create(this, kMaxFramesInFlight);
+
+    // Create Offscreen Back Buffers
+    // ------------------------------------------------
+
+    if (m_Options.headless)
+        CreateHeadlessBackBuffers();
+
     // Create Descriptor Pool
     // ------------------------------------------------
 
@@ -222,7 +193,8 @@ RenderContext::RenderContext(uint32_t width, uint32_t height)
     // Configure Imgui
     // ------------------------------------------------
 
-    InitializeUserInterface(this);
+    if (!m_Options.headless)
+        InitializeUserInterface(this);
 
     // Done.
     // ------------------------------------------------
@@ -234,15 +206,26 @@ RenderContext::~RenderContext()
 {
     vkDeviceWaitIdle(m_VKDeviceLogical);
 
-    ImGui_ImplVulkan_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
-    ImGui::DestroyContext();
+    if (!m_Options.headless)
+    {
+        ImGui_ImplVulkan_Shutdown();
+        ImGui_ImplGlfw_Shutdown();
+        ImGui::DestroyContext();
+
+        glfwDestroyWindow(m_Window);
+        glfwTerminate();
+    }
+
+    for (auto& vkImageView : m_VKSwapchainImageViews)
+        vkDestroyImageView(m_VKDeviceLogical, vkImageView, nullptr);
 
-    glfwDestroyWindow(m_Window);
-    glfwTerminate();
+    for (uint32_t imageIndex = 0U; imageIndex < m_HeadlessImageAllocations.size(); imageIndex++)
+        vmaDestroyImage(m_VKMemoryAllocator, m_VKSwapchainImages[imageIndex], m_HeadlessImageAllocations[imageIndex]);
 
     vmaDestroyAllocator(m_VKMemoryAllocator);
 
+    m_GPUProfiler.Release(this);
+
     for (uint32_t frameIndex = 0U; frameIndex < kMaxFramesInFlight; frameIndex++)
     {
         vkDestroySemaphore(m_VKDeviceLogical, m_VKImageAvailableSemaphores.at(frameIndex), nullptr);
@@ -250,18 +233,157 @@ RenderContext::~RenderContext()
         vkDestroyFence(m_VKDeviceLogical, m_VKInFlightFences.at(frameIndex), nullptr);
     }
 
-    for (auto& vkImageView : m_VKSwapchainImageViews)
-        vkDestroyImageView(m_VKDeviceLogical, vkImageView, nullptr);
-
     vkDestroyDescriptorPool(m_VKDeviceLogical, m_VKDescriptorPool, nullptr);
     vkDestroyCommandPool(m_VKDeviceLogical, m_VKCommandPool, nullptr);
     vkDestroySwapchainKHR(m_VKDeviceLogical, m_VKSwapchain, nullptr);
     vkDestroyDevice(m_VKDeviceLogical, nullptr);
-    vkDestroySurfaceKHR(m_VKInstance, m_VKSurface, nullptr);
+
+    if (m_VKSurface != VK_NULL_HANDLE)
+        vkDestroySurfaceKHR(m_VKInstance, m_VKSurface, nullptr);
     vkDestroyInstance(m_VKInstance, nullptr);
 }
 
-void RenderContext::Dispatch(const std::function<void(FrameParams)>& commandsFunc, const std::function<void()>& interfaceFunc)
+bool RenderContext::IsDeviceExtensionEnabled(const char* pExtensionName) const
+{
+    return std::any_of(m_EnabledDeviceExtensions.begin(),
+                       m_EnabledDeviceExtensions.end(),
+                       [&](const char* pEnabledExtensionName) { return strcmp(pEnabledExtensionName, pExtensionName) == 0; });
+}
+
+void RenderContext::CreateSwapchain()
+{
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    m_Window = glfwCreateWindow(static_cast<int>(m_Options.width), static_cast<int>(m_Options.height), "Vulkan Viewport", nullptr, nullptr);
+    Check(m_Window != nullptr, "Failed to create the OS Window.");
+    Check(glfwCreateWindowSurface(m_VKInstance, m_Window, nullptr, &m_VKSurface), "Failed to create the Vulkan Surface.");
+
+    VkSurfaceCapabilitiesKHR vkSurfaceProperties;
+    Check(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_VKDevicePhysical, m_VKSurface, &vkSurfaceProperties),
+          "Failed to obect the Vulkan Surface Properties");
+
+    VkSwapchainCreateInfoKHR vkSwapchainCreateInfo = { VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR };
+    vkSwapchainCreateInfo.surface                  = m_VKSurface;
+    vkSwapchainCreateInfo.minImageCount            = vkSurfaceProperties.minImageCount + 1;
+    vkSwapchainCreateInfo.imageExtent              = vkSurfaceProperties.currentExtent;
+    vkSwapchainCreateInfo.imageArrayLayers         = vkSurfaceProperties.maxImageArrayLayers;
+    vkSwapchainCreateInfo.imageUsage               = vkSurfaceProperties.supportedUsageFlags;
+    vkSwapchainCreateInfo.preTransform             = vkSurfaceProperties.currentTransform;
+    vkSwapchainCreateInfo.compositeAlpha           = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+    vkSwapchainCreateInfo.imageFormat              = VK_FORMAT_R8G8B8A8_UNORM;
+    vkSwapchainCreateInfo.imageColorSpace          = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+    vkSwapchainCreateInfo.imageSharingMode         = VK_SHARING_MODE_EXCLUSIVE;
+    vkSwapchainCreateInfo.presentMode              = VK_PRESENT_MODE_FIFO_KHR;
+    vkSwapchainCreateInfo.oldSwapchain             = nullptr;
+    vkSwapchainCreateInfo.clipped                  = static_cast<VkBool32>(true);
+    Check(vkCreateSwapchainKHR(m_VKDeviceLogical, &vkSwapchainCreateInfo, nullptr, &m_VKSwapchain), "Failed to create the Vulkan Swapchain");
+
+    // Storage usage on swapchain images is optional, the output pass falls back to a blit without it.
+    m_BackBufferStorage = (vkSurfaceProperties.supportedUsageFlags & VK_IMAGE_USAGE_STORAGE_BIT) != 0U;
+
+    uint32_t vkSwapchainImageCount = 0U;
+    Check(vkGetSwapchainImagesKHR(m_VKDeviceLogical, m_VKSwapchain, &vkSwapchainImageCount, nullptr),
+          "Failed to obtain Vulkan Swapchain image count.");
+
+    m_VKSwapchainImages.resize(vkSwapchainImageCount);
+    m_VKSwapchainImageViews.resize(vkSwapchainImageCount);
+
+    Check(vkGetSwapchainImagesKHR(m_VKDeviceLogical, m_VKSwapchain, &vkSwapchainImageCount, m_VKSwapchainImages.data()),
+          "Failed to obtain the Vulkan Swapchain images.");
+
+#ifdef _DEBUG
+    for (uint32_t swapChainIndex = 0U; swapChainIndex < vkSwapchainImageCount; swapChainIndex++)
+    {
+        auto swapChainName = std::format("Swapchain Image {}", swapChainIndex);
+        NameVulkanObject(m_VKDeviceLogical, VK_OBJECT_TYPE_IMAGE, reinterpret_cast<uint64_t>(m_VKSwapchainImages[swapChainIndex]), swapChainName);
+    }
+#endif
+
+    VkImageSubresourceRange vkSwapchainImageSubresourceRange;
+    {
+        vkSwapchainImageSubresourceRange.levelCount     = 1U;
+        vkSwapchainImageSubresourceRange.layerCount     = 1U;
+        vkSwapchainImageSubresourceRange.baseMipLevel   = 0U;
+        vkSwapchainImageSubresourceRange.baseArrayLayer = 0U;
+        vkSwapchainImageSubresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+
+    for (uint32_t imageIndex = 0; imageIndex < vkSwapchainImageCount; imageIndex++)
+    {
+        // Create an image view which we can render into.
+        VkImageViewCreateInfo vkImageViewInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+
+        vkImageViewInfo.viewType         = VK_IMAGE_VIEW_TYPE_2D;
+        vkImageViewInfo.format           = VK_FORMAT_R8G8B8A8_UNORM;
+        vkImageViewInfo.image            = m_VKSwapchainImages[imageIndex];
+        vkImageViewInfo.subresourceRange = vkSwapchainImageSubresourceRange;
+        vkImageViewInfo.components.r     = VK_COMPONENT_SWIZZLE_R;
+        vkImageViewInfo.components.g     = VK_COMPONENT_SWIZZLE_G;
+        vkImageViewInfo.components.b     = VK_COMPONENT_SWIZZLE_B;
+        vkImageViewInfo.components.a     = VK_COMPONENT_SWIZZLE_A;
+
+        VkImageView vkImageView = VK_NULL_HANDLE;
+        Check(vkCreateImageView(m_VKDeviceLogical, &vkImageViewInfo, nullptr, &vkImageView), "Failed to create a Swapchain Image View.");
+
+        m_VKSwapchainImageViews[imageIndex] = vkImageView;
+    }
+}
+
+void RenderContext::CreateHeadlessBackBuffers()
+{
+    // Same format and usage the frame recording expects from the swapchain images.
+    VkImageCreateInfo imageInfo = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+    {
+        imageInfo.imageType     = VK_IMAGE_TYPE_2D;
+        imageInfo.arrayLayers   = 1U;
+        imageInfo.format        = VK_FORMAT_R8G8B8A8_UNORM;
+        imageInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.usage         = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                                  VK_IMAGE_USAGE_STORAGE_BIT;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.extent        = { m_Options.width, m_Options.height, 1U };
+        imageInfo.mipLevels     = 1U;
+        imageInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
+    }
+
+    VmaAllocationCreateInfo imageAllocInfo = {};
+    {
+        imageAllocInfo.usage = VMA_MEMORY_USAGE_AUTO;
+    }
+
+    m_VKSwapchainImages.resize(kMaxFramesInFlight);
+    m_VKSwapchainImageViews.resize(kMaxFramesInFlight);
+    m_HeadlessImageAllocations.resize(kMaxFramesInFlight);
+
+    m_BackBufferStorage = true;
+
+    for (uint32_t imageIndex = 0U; imageIndex < kMaxFramesInFlight; imageIndex++)
+    {
+        Check(vmaCreateImage(m_VKMemoryAllocator,
+                             &imageInfo,
+                             &imageAllocInfo,
+                             &m_VKSwapchainImages[imageIndex],
+                             &m_HeadlessImageAllocations[imageIndex],
+                             VK_NULL_HANDLE),
+              "Failed to create an offscreen back buffer.");
+
+        VkImageViewCreateInfo vkImageViewInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+        {
+            vkImageViewInfo.viewType         = VK_IMAGE_VIEW_TYPE_2D;
+            vkImageViewInfo.format           = VK_FORMAT_R8G8B8A8_UNORM;
+            vkImageViewInfo.image            = m_VKSwapchainImages[imageIndex];
+            vkImageViewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0U, 1U, 0U, 1U };
+        }
+        Check(vkCreateImageView(m_VKDeviceLogical, &vkImageViewInfo, nullptr, &m_VKSwapchainImageViews[imageIndex]),
+              "Failed to create an offscreen back buffer view.");
+
+        NameVulkanObject(m_VKDeviceLogical, VK_OBJECT_TYPE_IMAGE, reinterpret_cast<uint64_t>(m_VKSwapchainImages[imageIndex]), "Offscreen Back Buffer");
+    }
+}
+
+void RenderContext::Dispatch(const std::function<void(FrameParams)>& commandsFunc,
+                             const std::function<void()>&            interfaceFunc,
+                             const std::function<void(double)>&      inputFunc)
 {
     uint64_t frameIndex = 0U;
 
@@ -271,7 +393,15 @@ void RenderContext::Dispatch(const std::function<void(FrameParams)>& commandsFun
     // Render-loop
     // ------------------------------------------------
 
-    while (glfwWindowShouldClose(m_Window) == 0)
+    auto IsRunning = [&]()
+    {
+        if (m_Options.frameCount > 0U && frameIndex >= m_Options.frameCount)
+            return false;
+
+        return m_Options.headless || glfwWindowShouldClose(m_Window) == 0;
+    };
+
+    while (IsRunning())
     {
         // Sample the time at the beginning of the frame.
         auto frameTimeBegin = std::chrono::high_resolution_clock::now();
@@ -283,15 +413,21 @@ void RenderContext::Dispatch(const std::function<void(FrameParams)>& commandsFun
         Check(vkWaitForFences(m_VKDeviceLogical, 1U, &m_VKInFlightFences.at(frameInFlightIndex), VK_TRUE, UINT64_MAX),
               "Failed to wait for frame fence");
 
-        // Acquire the next swap chain image available.
-        uint32_t vkCurrentSwapchainImageIndex = 0U;
-        Check(vkAcquireNextImageKHR(m_VKDeviceLogical,
-                                    m_VKSwapchain,
-                                    UINT64_MAX,
-                                    m_VKImageAvailableSemaphores.at(frameInFlightIndex),
-                                    VK_NULL_HANDLE,
-                                    &vkCurrentSwapchainImageIndex),
-              "Failed to acquire swapchain image.");
+        // Acquire the next swap chain image available (offscreen back buffers are owned by a frame slot).
+        uint32_t vkCurrentSwapchainImageIndex = frameInFlightIndex;
+
+        if (!m_Options.headless)
+        {
+            Check(vkAcquireNextImageKHR(m_VKDeviceLogical,
+                                        m_VKSwapchain,
+                                        UINT64_MAX,
+                                        m_VKImageAvailableSemaphores.at(frameInFlightIndex),
+                                        VK_NULL_HANDLE,
+                                        &vkCurrentSwapchainImageIndex),
+                  "Failed to acquire swapchain image.");
+        }
+
+        m_LastBackBufferIndex = vkCurrentSwapchainImageIndex;
 
         // Get the current frame's command buffer.
         auto& vkCurrentCommandBuffer = m_VKCommandBuffers.at(frameInFlightIndex);
@@ -306,11 +442,16 @@ void RenderContext::Dispatch(const std::function<void(FrameParams)>& commandsFun
         }
         Check(vkBeginCommandBuffer(vkCurrentCommandBuffer, &vkCommandBufferBeginInfo), "Failed to open frame command buffer for recording");
 
+        // Resolve the GPU timings of the last use of this frame slot.
+        m_GPUProfiler.BeginFrame(vkCurrentCommandBuffer, frameInFlightIndex);
+
         // Dispatch command recording.
         FrameParams frameParams = { vkCurrentCommandBuffer,
                                     m_VKSwapchainImages[vkCurrentSwapchainImageIndex],
                                     m_VKSwapchainImageViews[vkCurrentSwapchainImageIndex],
-                                    deltaTime.count() };
+                                    vkCurrentSwapchainImageIndex,
+                                    deltaTime.count(),
+                                    frameInFlightIndex };
 
         PROFILE_START("Process Frame");
 
@@ -318,7 +459,8 @@ void RenderContext::Dispatch(const std::function<void(FrameParams)>& commandsFun
 
         PROFILE_END;
 
-        DrawUserInterface(this, vkCurrentSwapchainImageIndex, vkCurrentCommandBuffer, interfaceFunc);
+        if (!m_Options.headless)
+            DrawUserInterface(this, vkCurrentSwapchainImageIndex, vkCurrentCommandBuffer, interfaceFunc);
 
         // Close command recording.
         Check(vkEndCommandBuffer(vkCurrentCommandBuffer), "Failed to close frame command buffer for recording");
@@ -330,11 +472,14 @@ void RenderContext::Dispatch(const std::function<void(FrameParams)>& commandsFun
         {
             VkPipelineStageFlags vkWaitStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 
+            // Nothing to acquire or present headless.
+            const uint32_t semaphoreCount = m_Options.headless ? 0U : 1U;
+
             vkQueueSubmitInfo.commandBufferCount   = 1U;
             vkQueueSubmitInfo.pCommandBuffers      = &vkCurrentCommandBuffer;
-            vkQueueSubmitInfo.waitSemaphoreCount   = 1U;
+            vkQueueSubmitInfo.waitSemaphoreCount   = semaphoreCount;
             vkQueueSubmitInfo.pWaitSemaphores      = &m_VKImageAvailableSemaphores.at(frameInFlightIndex);
-            vkQueueSubmitInfo.signalSemaphoreCount = 1U;
+            vkQueueSubmitInfo.signalSemaphoreCount = semaphoreCount;
             vkQueueSubmitInfo.pSignalSemaphores    = &m_VKRenderCompleteSemaphores.at(frameInFlightIndex);
             vkQueueSubmitInfo.pWaitDstStageMask    = &vkWaitStageMask;
         }
@@ -344,25 +489,107 @@ void RenderContext::Dispatch(const std::function<void(FrameParams)>& commandsFun
         Check(vkQueueSubmit(m_VKCommandQueue, 1U, &vkQueueSubmitInfo, m_VKInFlightFences.at(frameInFlightIndex)),
               "Failed to submit commands to the Vulkan Graphics Queue.");
 
-        VkPresentInfoKHR vkQueuePresentInfo = { VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
+        if (!m_Options.headless)
         {
-            vkQueuePresentInfo.waitSemaphoreCount = 1U;
-            vkQueuePresentInfo.pWaitSemaphores    = &m_VKRenderCompleteSemaphores.at(frameInFlightIndex);
-            vkQueuePresentInfo.swapchainCount     = 1U;
-            vkQueuePresentInfo.pSwapchains        = &m_VKSwapchain;
-            vkQueuePresentInfo.pImageIndices      = &vkCurrentSwapchainImageIndex;
+            VkPresentInfoKHR vkQueuePresentInfo = { VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
+            {
+                vkQueuePresentInfo.waitSemaphoreCount = 1U;
+                vkQueuePresentInfo.pWaitSemaphores    = &m_VKRenderCompleteSemaphores.at(frameInFlightIndex);
+                vkQueuePresentInfo.swapchainCount     = 1U;
+                vkQueuePresentInfo.pSwapchains        = &m_VKSwapchain;
+                vkQueuePresentInfo.pImageIndices      = &vkCurrentSwapchainImageIndex;
+            }
+            Check(vkQueuePresentKHR(m_VKCommandQueue, &vkQueuePresentInfo), "Failed to submit image to the Vulkan Presentation Engine.");
         }
-        Check(vkQueuePresentKHR(m_VKCommandQueue, &vkQueuePresentInfo), "Failed to submit image to the Vulkan Presentation Engine.");
 
         // Advance to the next frame.
         frameIndex++;
 
-        glfwPollEvents();
+        if (!m_Options.headless)
+            glfwPollEvents();
 
         // Sample the time at the end of the frame.
         auto frameTimeEnd = std::chrono::high_resolution_clock::now();
 
         // Update delta time.
         deltaTime = frameTimeEnd - frameTimeBegin;
+
+        // Update the input driven state of the next frame.
+        inputFunc(deltaTime.count());
+    }
+}
+
+bool RenderContext::CaptureLastFrame(ImageRGB8& image)
+{
+    // Presented swapchain images belong to the presentation engine.
+    if (!m_Options.headless || m_VKSwapchainImages.empty())
+        return false;
+
+    vkDeviceWaitIdle(m_VKDeviceLogical);
+
+    Buffer readbackBuffer;
+    {
+        VkBufferCreateInfo bufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+        bufferInfo.size               = 4U * static_cast<VkDeviceSize>(m_Options.width) * m_Options.height;
+        bufferInfo.usage              = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+        VmaAllocationCreateInfo allocInfo = {};
+        allocInfo.usage                   = VMA_MEMORY_USAGE_AUTO;
+        allocInfo.flags                   = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT;
+
+        Check(vmaCreateBuffer(m_VKMemoryAllocator, &bufferInfo, &allocInfo, &readbackBuffer.buffer, &readbackBuffer.bufferAllocation, nullptr),
+              "Failed to create the readback buffer.");
     }
+
+    const VkImage backBuffer = m_VKSwapchainImages.at(m_LastBackBufferIndex);
+
+    VkCommandBuffer cmd = VK_NULL_HANDLE;
+    SingleShotCommandBegin(this, cmd);
+    {
+        VulkanColorImageBarrier(cmd,
+                                backBuffer,
+                                VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                VK_ACCESS_2_MEMORY_WRITE_BIT,
+                                VK_ACCESS_2_TRANSFER_READ_BIT,
+                                VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                                VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+
+        VkBufferImageCopy imageCopy = {};
+        {
+            imageCopy.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0U, 0U, 1U };
+            imageCopy.imageExtent      = { m_Options.width, m_Options.height, 1U };
+        }
+        vkCmdCopyImageToBuffer(cmd, backBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffer.buffer, 1U, &imageCopy);
+
+        VulkanColorImageBarrier(cmd,
+                                backBuffer,
+                                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                                VK_ACCESS_2_TRANSFER_READ_BIT,
+                                VK_ACCESS_2_NONE,
+                                VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                                VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT);
+    }
+    SingleShotCommandEnd(this, cmd);
+
+    image.Resize(m_Options.width, m_Options.height);
+
+    void* pMappedData = nullptr;
+    Check(vmaMapMemory(m_VKMemoryAllocator, readbackBuffer.bufferAllocation, &pMappedData), "Failed to map the readback buffer.");
+    {
+        vmaInvalidateAllocation(m_VKMemoryAllocator, readbackBuffer.bufferAllocation, 0U, VK_WHOLE_SIZE);
+
+        // RGBA -> RGB.
+        const auto* pTexels = static_cast<const uint8_t*>(pMappedData);
+
+        for (size_t texelIndex = 0U; texelIndex < static_cast<size_t>(m_Options.width) * m_Options.height; texelIndex++)
+            memcpy(image.pixels.data() + 3U * texelIndex, pTexels + 4U * texelIndex, 3U);
+
+        vmaUnmapMemory(m_VKMemoryAllocator, readbackBuffer.bufferAllocation);
+    }
+
+    vmaDestroyBuffer(m_VKMemoryAllocator, readbackBuffer.buffer, readbackBuffer.bufferAllocation);
+
+    return true;
 }
@@ -0,0 +1,277 @@
+#include <Common.h>
+#include <TransientImageAllocator.h>
+#include <RenderGraph.h>
+
+// Render Graph Implementation
+// ------------------------------------------------------------
+
+const VkAccessFlags2 kWriteAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT |
+                                        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_HOST_WRITE_BIT |
+                                        VK_ACCESS_2_MEMORY_WRITE_BIT | VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+
+RenderGraph::ResourceHandle RenderGraph::ImportImage(const std::string&   resourceName,
+                                                     VkImage              vkImage,
+                                                     const ResourceState& state,
+                                                     VkImageAspectFlags   vkAspectMask)
+{
+    Resource resource;
+    {
+        resource.name       = resourceName;
+        resource.image      = vkImage;
+        resource.aspectMask = vkAspectMask;
+    }
+    SetState(resource, state);
+
+    m_Resources.push_back(resource);
+
+    return static_cast<ResourceHandle>(m_Resources.size() - 1U);
+}
+
+RenderGraph::ResourceHandle RenderGraph::ImportBuffer(const std::string& resourceName, const ResourceState& state)
+{
+    Resource resource;
+    {
+        resource.name = resourceName;
+    }
+    SetState(resource, state);
+
+    m_Resources.push_back(resource);
+
+    return static_cast<ResourceHandle>(m_Resources.size() - 1U);
+}
+
+std::vector<RenderGraph::ResourceHandle> RenderGraph::ImportTransientImages(const TransientImageAllocator& transientImages)
+{
+    const auto firstResource = static_cast<ResourceHandle>(m_Resources.size());
+
+    std::vector<ResourceHandle> resources;
+
+    for (TransientImageAllocator::ImageHandle image = 0U; image < transientImages.GetImageCount(); image++)
+    {
+        resources.push_back(ImportImage(transientImages.GetImageName(image), transientImages.GetImage(image).image, {}));
+
+        m_Resources.back().transient = true;
+
+        for (const auto alias : transientImages.GetAliases(image))
+            m_Resources.back().aliases.push_back(firstResource + alias);
+    }
+
+    return resources;
+}
+
+void RenderGraph::ResetImage(ResourceHandle resource, VkImage vkImage, const ResourceState& state)
+{
+    m_Resources.at(resource).image = vkImage;
+
+    SetState(m_Resources.at(resource), state);
+}
+
+void RenderGraph::AddPass(const std::string& passName, std::vector<ResourceUsage> usages, std::function<void(VkCommandBuffer)> recordFunc)
+{
+    for (const auto& usage : usages)
+        Check(usage.resource < m_Resources.size(), "Render graph pass uses a resource that was never imported.");
+
+    m_Passes.push_back({ passName, std::move(usages), std::move(recordFunc) });
+}
+
+void RenderGraph::Export(ResourceHandle resource, const ResourceState& state)
+{
+    Check(resource < m_Resources.size(), "Render graph export of a resource that was never imported.");
+
+    m_Exports.emplace_back(resource, state);
+}
+
+void RenderGraph::SetState(Resource& resource, const ResourceState& state)
+{
+    const bool isWrite = (state.access & kWriteAccessMask) != 0U;
+
+    resource.layout        = state.layout;
+    resource.writeStage    = isWrite ? state.stage : VK_PIPELINE_STAGE_2_NONE;
+    resource.writeAccess   = state.access & kWriteAccessMask;
+    resource.visibleStages = VK_PIPELINE_STAGE_2_NONE;
+    resource.visibleAccess = VK_ACCESS_2_NONE;
+    resource.readStages    = isWrite ? VK_PIPELINE_STAGE_2_NONE : state.stage;
+}
+
+void RenderGraph::Discard(Resource& resource)
+{
+    // Whatever used the memory last (this image in an earlier frame, or an alias) has to finish first.
+    for (const auto alias : resource.aliases)
+    {
+        const Resource& aliasResource = m_Resources[alias];
+
+        resource.writeStage  |= aliasResource.writeStage;
+        resource.writeAccess |= aliasResource.writeAccess;
+        resource.readStages  |= aliasResource.readStages;
+    }
+
+    resource.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+}
+
+void RenderGraph::Transition(Resource& resource, const ResourceState& state, BarrierBatch& batch)
+{
+    const bool isWrite      = (state.access & kWriteAccessMask) != 0U;
+    const bool layoutChange = resource.aspectMask != 0x0 && state.layout != resource.layout;
+
+    VkPipelineStageFlags2 srcStage  = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2        srcAccess = VK_ACCESS_2_NONE;
+
+    if (isWrite || layoutChange)
+    {
+        // Write-after-write and write-after-read (a layout transition is a write too).
+        srcStage  = resource.writeStage | resource.readStages;
+        srcAccess = resource.writeAccess;
+    }
+    else if ((state.stage & ~resource.visibleStages) != 0U || (state.access & ~resource.visibleAccess) != 0U)
+    {
+        // Read-after-write, unless an earlier barrier already made the write visible to this reader.
+        srcStage  = resource.writeStage;
+        srcAccess = resource.writeAccess;
+    }
+
+    if (layoutChange)
+    {
+        VkImageMemoryBarrier2 vkImageBarrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
+        {
+            vkImageBarrier.image               = resource.image;
+            vkImageBarrier.oldLayout           = resource.layout;
+            vkImageBarrier.newLayout           = state.layout;
+            vkImageBarrier.srcAccessMask       = srcAccess;
+            vkImageBarrier.dstAccessMask       = state.access;
+            vkImageBarrier.srcStageMask        = srcStage;
+            vkImageBarrier.dstStageMask        = state.stage;
+            vkImageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            vkImageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            vkImageBarrier.subresourceRange    = { resource.aspectMask, 0U, VK_REMAINING_MIP_LEVELS, 0U, VK_REMAINING_ARRAY_LAYERS };
+        }
+        batch.imageBarriers.push_back(vkImageBarrier);
+    }
+    else if (srcStage != VK_PIPELINE_STAGE_2_NONE)
+    {
+        // Over-synchronizes slightly across resources, but keeps every batch at a single memory barrier.
+        batch.memoryBarrier.srcStageMask  |= srcStage;
+        batch.memoryBarrier.srcAccessMask |= srcAccess;
+        batch.memoryBarrier.dstStageMask  |= state.stage;
+        batch.memoryBarrier.dstAccessMask |= state.access;
+    }
+
+    if (isWrite || layoutChange)
+    {
+        // A pure layout transition is visible to the usage that asked for it, a new write isn't visible to anything yet.
+        resource.layout        = state.layout;
+        resource.writeStage    = state.stage;
+        resource.writeAccess   = state.access & kWriteAccessMask;
+        resource.visibleStages = isWrite ? VK_PIPELINE_STAGE_2_NONE : state.stage;
+        resource.visibleAccess = isWrite ? VK_ACCESS_2_NONE : state.access;
+        resource.readStages    = isWrite ? VK_PIPELINE_STAGE_2_NONE : state.stage;
+    }
+    else
+    {
+        resource.readStages |= state.stage;
+
+        if (srcStage != VK_PIPELINE_STAGE_2_NONE)
+        {
+            resource.visibleStages |= state.stage;
+            resource.visibleAccess |= state.access;
+        }
+    }
+}
+
+void RenderGraph::Flush(VkCommandBuffer vkCommand, BarrierBatch& batch)
+{
+    const bool hasMemoryBarrier = batch.memoryBarrier.srcStageMask != VK_PIPELINE_STAGE_2_NONE;
+
+    if (!hasMemoryBarrier && batch.imageBarriers.empty())
+        return;
+
+    VkDependencyInfo vkDependencyInfo = { VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+    {
+        vkDependencyInfo.memoryBarrierCount      = hasMemoryBarrier ? 1U : 0U;
+        vkDependencyInfo.pMemoryBarriers         = &batch.memoryBarrier;
+        vkDependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(batch.imageBarriers.size());
+        vkDependencyInfo.pImageMemoryBarriers    = batch.imageBarriers.data();
+    }
+    vkCmdPipelineBarrier2(vkCommand, &vkDependencyInfo);
+
+    m_Statistics.barrierBatchCount++;
+    m_Statistics.memoryBarrierCount += vkDependencyInfo.memoryBarrierCount;
+    m_Statistics.imageBarrierCount  += vkDependencyInfo.imageMemoryBarrierCount;
+
+    batch = {};
+}
+
+void RenderGraph::Execute(VkCommandBuffer vkCommand)
+{
+    m_Statistics           = {};
+    m_Statistics.passCount = static_cast<uint32_t>(m_Passes.size());
+
+    // Walk back from the exports: a pass survives when the end of the frame, or a later surviving pass, reads
+    // something it writes.
+    // --------------------------------------------
+
+    std::vector<bool> requiredResources(m_Resources.size(), false);
+    std::vector<bool> culledPasses(m_Passes.size(), true);
+
+    for (const auto& exportedResource : m_Exports)
+        requiredResources[exportedResource.first] = true;
+
+    for (size_t passIndex = m_Passes.size(); passIndex-- > 0U;)
+    {
+        const auto& usages = m_Passes[passIndex].usages;
+
+        const bool required = std::any_of(usages.begin(),
+                                          usages.end(),
+                                          [&](const ResourceUsage& usage)
+                                          { return (usage.state.access & kWriteAccessMask) != 0U && requiredResources[usage.resource]; });
+
+        if (!required)
+        {
+            m_Statistics.culledPassCount++;
+            continue;
+        }
+
+        culledPasses[passIndex] = false;
+
+        for (const auto& usage : usages)
+        {
+            if ((usage.state.access & ~kWriteAccessMask) != 0U)
+                requiredResources[usage.resource] = true;
+        }
+    }
+
+    // Record the surviving passes, each behind one batch of barriers.
+    // --------------------------------------------
+
+    BarrierBatch      batch;
+    std::vector<bool> usedResources(m_Resources.size(), false);
+
+    for (size_t passIndex = 0U; passIndex < m_Passes.size(); passIndex++)
+    {
+        if (culledPasses[passIndex])
+            continue;
+
+        for (const auto& usage : m_Passes[passIndex].usages)
+        {
+            Resource& resource = m_Resources[usage.resource];
+
+            if (resource.transient && !usedResources[usage.resource])
+                Discard(resource);
+
+            usedResources[usage.resource] = true;
+
+            Transition(resource, usage.state, batch);
+        }
+
+        Flush(vkCommand, batch);
+
+        m_Passes[passIndex].recordFunc(vkCommand);
+    }
+
+    for (const auto& [resource, state] : m_Exports)
+        Transition(m_Resources[resource], state, batch);
+
+    Flush(vkCommand, batch);
+
+    m_Passes.clear();
+    m_Exports.clear();
+}
@@ -0,0 +1,320 @@
+#include <Common.h>
+#include <Scene.h>
+
+// Scene Implementation
+// ------------------------------------------------------------
+
+bool LoadMesh(const char* filePath, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+{
+    tinyobj::ObjReader reader;
+
+    if (!reader.ParseFromFile(filePath))
+    {
+        if (!reader.Error().empty())
+        {
+            spdlog::error("Failed to load mesh: {}", reader.Error());
+            return false;
+        }
+    }
+
+    auto& attrib = reader.GetAttrib();
+    auto& shapes = reader.GetShapes();
+
+    for (const auto& shape : shapes)
+    {
+        for (const auto& index : shape.mesh.indices)
+        {
+            Vertex v;
+
+            // Positions
+            v.positionOS.x = attrib.vertices[3U * index.vertex_index + 0U];
+            v.positionOS.y = attrib.vertices[3U * index.vertex_index + 1U];
+            v.positionOS.z = attrib.vertices[3U * index.vertex_index + 2U];
+
+            // Normals
+            v.normalOS.x = attrib.normals[3U * index.normal_index + 0U];
+            v.normalOS.y = attrib.normals[3U * index.normal_index + 1U];
+            v.normalOS.z = attrib.normals[3U * index.normal_index + 2U];
+
+            vertices.push_back(v);
+            indices.push_back((uint32_t)indices.size());
+        }
+    }
+
+    spdlog::info("Loaded Mesh: {}", filePath);
+
+    return true;
+};
+
+bool LoadPoints(const char* filePath, std::vector<Vertex>& vertices)
+{
+    tinyobj::ObjReader reader;
+
+    if (!reader.ParseFromFile(filePath))
+    {
+        if (!reader.Error().empty())
+        {
+            spdlog::error("Failed to load mesh: {}", reader.Error());
+            return false;
+        }
+    }
+
+    auto& attrib = reader.GetAttrib();
+
+    for (uint32_t pointIndex = 0U; pointIndex < attrib.vertices.size(); pointIndex += 3U)
+    {
+        Vertex v;
+        {
+            v.positionOS = glm::vec3(attrib.vertices[pointIndex + 0U], attrib.vertices[pointIndex + 1U], attrib.vertices[pointIndex + 2U]);
+            v.normalOS   = glm::vec3(attrib.normals[pointIndex + 0U], attrib.normals[pointIndex + 1U], attrib.normals[pointIndex + 2U]);
+        }
+        vertices.push_back(v);
+    }
+
+    return true;
+};
+
+void ResizeInstancePoints(std::vector<Vertex>& points, uint32_t instanceCount)
+{
+    const auto sourceCount = static_cast<uint32_t>(points.size());
+
+    if (sourceCount == 0U)
+        return;
+
+    // World-space extent of the jitter applied to replicated points.
+    const float kJitterRadius = 4.0F;
+
+    auto Hash = [](uint32_t x)
+    {
+        x ^= x >> 16U;
+        x *= 0x7feb352dU;
+        x ^= x >> 15U;
+        x *= 0x846ca68bU;
+        x ^= x >> 16U;
+        return x;
+    };
+
+    auto Random = [&](uint32_t seed) { return static_cast<float>(Hash(seed)) / 4294967296.0F; };
+
+    points.resize(instanceCount);
+
+    for (uint32_t pointIndex = sourceCount; pointIndex < instanceCount; pointIndex++)
+    {
+        const glm::vec3 jitter(Random(3U * pointIndex + 0U), Random(3U * pointIndex + 1U), Random(3U * pointIndex + 2U));
+
+        points[pointIndex] = points[pointIndex % sourceCount];
+        points[pointIndex].positionOS += (2.0F * jitter - 1.0F) * kJitterRadius;
+    }
+}
+
+void SubdivideMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t levels)
+{
+    auto Midpoint = [](const Vertex& a, const Vertex& b)
+    {
+        Vertex midpoint;
+        {
+            midpoint.positionOS = 0.5F * (a.positionOS + b.positionOS);
+            midpoint.normalOS   = glm::normalize(a.normalOS + b.normalOS);
+        }
+        return midpoint;
+    };
+
+    for (uint32_t level = 0U; level < levels; level++)
+    {
+        std::vector<Vertex> subdividedVertices;
+        subdividedVertices.reserve(4U * indices.size());
+
+        for (uint32_t triangleIndex = 0U; triangleIndex + 2U < indices.size(); triangleIndex += 3U)
+        {
+            const Vertex& v0 = vertices[indices[triangleIndex + 0U]];
+            const Vertex& v1 = vertices[indices[triangleIndex + 1U]];
+            const Vertex& v2 = vertices[indices[triangleIndex + 2U]];
+
+            const Vertex m01 = Midpoint(v0, v1);
+            const Vertex m12 = Midpoint(v1, v2);
+            const Vertex m20 = Midpoint(v2, v0);
+
+            // Keep the winding of the source triangle.
+            for (const Vertex& vertex : { v0, m01, m20, m01, v1, m12, m20, m12, v2, m01, m12, m20 })
+                subdividedVertices.push_back(vertex);
+        }
+
+        vertices = std::move(subdividedVertices);
+
+        indices.resize(vertices.size());
+        std::iota(indices.begin(), indices.end(), 0U);
+    }
+}
+
+glm::mat4 ComputeInstanceTransform(const Vertex& point)
+{
+    glm::vec3 U = glm::normalize(point.normalOS);
+    glm::vec3 F = glm::normalize(glm::vec3(0.0f, 0.0f, -1.0f));
+    glm::vec3 R = glm::normalize(glm::cross(F, U));
+
+    F = glm::normalize(glm::cross(U, R));
+
+    glm::mat4 rotation = glm::mat4(1.0f);
+    rotation[0]        = glm::vec4(R, 0.0f);
+    rotation[1]        = glm::vec4(U, 0.0f);
+    rotation[2]        = glm::vec4(F, 0.0f);
+
+    glm::mat4 translation = glm::translate(glm::mat4(1.0f), point.positionOS);
+
+    return translation * rotation;
+}
+
+void ComputeOrbitCamera(float time, float aspectRatio, glm::mat4& matrixV, glm::mat4& matrixP)
+{
+    const glm::vec3 cameraPosition(kCameraOrbitRadius * std::sin(kCameraOrbitSpeed * time), 0.0F, kCameraOrbitRadius * std::cos(kCameraOrbitSpeed * time));
+
+    matrixV = glm::lookAt(cameraPosition, glm::vec3(0, 1, 0), glm::vec3(0, -1, 0));
+    matrixP = glm::perspective(glm::radians(kCameraFieldOfView), aspectRatio, kCameraNearPlane, kCameraFarPlane);
+}
+
+BoundingSphere ComputeBoundingSphere(const std::vector<Vertex>& vertices)
+{
+    glm::vec3 boundsMin(FLT_MAX);
+    glm::vec3 boundsMax(-FLT_MAX);
+
+    for (const auto& vertex : vertices)
+    {
+        boundsMin = glm::min(boundsMin, vertex.positionOS);
+        boundsMax = glm::max(boundsMax, vertex.positionOS);
+    }
+
+    BoundingSphere sphere;
+    {
+        sphere.center = 0.5F * (boundsMin + boundsMax);
+        sphere.radius = 0.0F;
+    }
+
+    for (const auto& vertex : vertices)
+        sphere.radius = std::max(sphere.radius, glm::length(vertex.positionOS - sphere.center));
+
+    return sphere;
+}
+
+void SimplifyMesh(const std::vector<Vertex>&   vertices,
+                  const std::vector<uint32_t>& indices,
+                  uint32_t                     cellCount,
+                  std::vector<Vertex>&         simplifiedVertices,
+                  std::vector<uint32_t>&       simplifiedIndices)
+{
+    simplifiedVertices.clear();
+    simplifiedIndices.clear();
+
+    glm::vec3 boundsMin(FLT_MAX);
+    glm::vec3 boundsMax(-FLT_MAX);
+
+    for (const auto& vertex : vertices)
+    {
+        boundsMin = glm::min(boundsMin, vertex.positionOS);
+        boundsMax = glm::max(boundsMax, vertex.positionOS);
+    }
+
+    const glm::vec3 extent   = boundsMax - boundsMin;
+    const float     cellSize = std::max(std::max(extent.x, extent.y), extent.z) / static_cast<float>(cellCount);
+
+    auto ComputeCellKey = [&](const glm::vec3& position)
+    {
+        const glm::uvec3 cell = glm::min(glm::uvec3((position - boundsMin) / cellSize), glm::uvec3(cellCount - 1U));
+        return (static_cast<uint64_t>(cell.x) << 42U) | (static_cast<uint64_t>(cell.y) << 21U) | static_cast<uint64_t>(cell.z);
+    };
+
+    // Accumulate the vertices of each occupied cell into one representative vertex.
+    std::unordered_map<uint64_t, uint32_t> cellToVertex;
+    std::vector<uint32_t>                  cellVertexCounts;
+    std::vector<uint32_t>                  vertexRemap(vertices.size());
+
+    for (uint32_t vertexIndex = 0U; vertexIndex < vertices.size(); vertexIndex++)
+    {
+        const auto& vertex = vertices[vertexIndex];
+
+        auto [cellIt, inserted] = cellToVertex.try_emplace(ComputeCellKey(vertex.positionOS), static_cast<uint32_t>(simplifiedVertices.size()));
+
+        if (inserted)
+        {
+            simplifiedVertices.push_back({ glm::vec3(0.0F), glm::vec3(0.0F) });
+            cellVertexCounts.push_back(0U);
+        }
+
+        simplifiedVertices[cellIt->second].positionOS += vertex.positionOS;
+        simplifiedVertices[cellIt->second].normalOS += vertex.normalOS;
+        cellVertexCounts[cellIt->second]++;
+
+        vertexRemap[vertexIndex] = cellIt->second;
+    }
+
+    for (uint32_t vertexIndex = 0U; vertexIndex < simplifiedVertices.size(); vertexIndex++)
+    {
+        auto& vertex = simplifiedVertices[vertexIndex];
+
+        vertex.positionOS /= static_cast<float>(cellVertexCounts[vertexIndex]);
+
+        if (glm::length(vertex.normalOS) > 0.0F)
+            vertex.normalOS = glm::normalize(vertex.normalOS);
+    }
+
+    // Re-index the triangles, dropping the ones that collapsed into a line or a point.
+    for (uint32_t triangleIndex = 0U; triangleIndex + 2U < indices.size(); triangleIndex += 3U)
+    {
+        const uint32_t i0 = vertexRemap[indices[triangleIndex + 0U]];
+        const uint32_t i1 = vertexRemap[indices[triangleIndex + 1U]];
+        const uint32_t i2 = vertexRemap[indices[triangleIndex + 2U]];
+
+        if (i0 == i1 || i1 == i2 || i0 == i2)
+            continue;
+
+        simplifiedIndices.push_back(i0);
+        simplifiedIndices.push_back(i1);
+        simplifiedIndices.push_back(i2);
+    }
+}
+
+void ComputeFrustumPlanes(const glm::mat4& matrixVP, std::array<glm::vec4, 5>& frustumPlanes)
+{
+    // Gribb-Hartmann plane extraction (OpenGL clip space, as produced by glm::perspective).
+    const glm::vec4 row0 = glm::row(matrixVP, 0);
+    const glm::vec4 row1 = glm::row(matrixVP, 1);
+    const glm::vec4 row2 = glm::row(matrixVP, 2);
+    const glm::vec4 row3 = glm::row(matrixVP, 3);
+
+    frustumPlanes[0] = row3 + row0;
+    frustumPlanes[1] = row3 - row0;
+    frustumPlanes[2] = row3 + row1;
+    frustumPlanes[3] = row3 - row1;
+    frustumPlanes[4] = row3 + row2;
+
+    for (auto& plane : frustumPlanes)
+        plane /= glm::length(glm::vec3(plane));
+}
+
+uint32_t SelectInstanceLOD(const InstanceCullingParams& params, const BoundingSphere& worldBounds)
+{
+    const float distance = glm::length(worldBounds.center - params.cameraPosition);
+
+    if (distance - worldBounds.radius > params.maxDistance)
+        return kInstanceCulled;
+
+    const float cullRadius = worldBounds.radius + params.frustumMargin;
+
+    for (const auto& plane : params.frustumPlanes)
+    {
+        if (glm::dot(glm::vec3(plane), worldBounds.center) + plane.w < -cullRadius)
+            return kInstanceCulled;
+    }
+
+    // Camera inside the bounds, always full detail.
+    if (distance <= worldBounds.radius)
+        return 0U;
+
+    const float projectedRadius = params.projectionScale * worldBounds.radius / distance;
+
+    uint32_t lod = 0U;
+
+    while (lod < kMeshLODCount - 1U && projectedRadius < params.lodPixelThresholds.at(lod))
+        lod++;
+
+    return lod;
+}
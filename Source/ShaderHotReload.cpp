@@ -0,0 +1,265 @@
+#include <Common.h>
+#include <Profiler.h>
+#include <RenderContext.h>
+#include <ShaderHotReload.h>
+
+// Shader Hot Reload Implementation
+// ------------------------------------------------------------
+
+static bool IsShaderSource(const std::filesystem::path& filePath)
+{
+    return filePath.extension() == ".hlsl" || filePath.extension() == ".hlsli";
+}
+
+void ShaderHotReload::Start(const std::filesystem::path& shaderDirectory, const std::vector<Shader>& shaders, RebuildFunc rebuildFunc)
+{
+    m_ShaderDirectory = shaderDirectory;
+    m_Shaders         = shaders;
+    m_RebuildFunc     = std::move(rebuildFunc);
+
+#ifdef __linux__
+    // Saves land as a close after writing, or as a rename over the file for editors that write a temporary first.
+    m_NotifyHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (m_NotifyHandle >= 0 && inotify_add_watch(m_NotifyHandle, m_ShaderDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        close(m_NotifyHandle);
+        m_NotifyHandle = -1;
+    }
+#endif
+
+    // The first scan only records the current modification times.
+    if (m_NotifyHandle < 0)
+    {
+        std::error_code errorCode;
+        for (const auto& entry : std::filesystem::directory_iterator(m_ShaderDirectory, errorCode))
+        {
+            if (IsShaderSource(entry.path()))
+                m_WriteTimes[entry.path().filename().string()] = entry.last_write_time(errorCode);
+        }
+    }
+
+    m_Thread = std::jthread([this](std::stop_token stopToken) { Run(stopToken); });
+
+    spdlog::info("Watching {} for shader changes ({}).", m_ShaderDirectory.string(), m_NotifyHandle >= 0 ? "inotify" : "polling");
+}
+
+void ShaderHotReload::Stop()
+{
+    if (m_Thread.joinable())
+    {
+        m_Thread.request_stop();
+        m_Thread.join();
+    }
+
+#ifdef __linux__
+    if (m_NotifyHandle >= 0)
+        close(m_NotifyHandle);
+#endif
+
+    m_NotifyHandle = -1;
+}
+
+std::string ShaderHotReload::GetStatus() const
+{
+    std::lock_guard<std::mutex> lock(m_StatusMutex);
+
+    return m_Status;
+}
+
+void ShaderHotReload::SetStatus(const std::string& status)
+{
+    std::lock_guard<std::mutex> lock(m_StatusMutex);
+
+    m_Status = status;
+}
+
+bool ShaderHotReload::WaitForChanges(const std::stop_token& stopToken, std::set<std::string>& changedFiles)
+{
+#ifdef __linux__
+    if (m_NotifyHandle >= 0)
+    {
+        // The poll timeout bounds how long a stop request waits, and once something changed it is the settle time.
+        while (!stopToken.stop_requested())
+        {
+            pollfd pollInfo = { m_NotifyHandle, POLLIN, 0 };
+
+            const auto timeout = changedFiles.empty() ? kShaderHotReloadPollInterval : kShaderHotReloadSettleTime;
+
+            if (poll(&pollInfo, 1U, static_cast<int>(timeout.count())) <= 0)
+            {
+                if (!changedFiles.empty())
+                    return true;
+
+                continue;
+            }
+
+            alignas(inotify_event) std::array<char, 4096> eventBytes;
+
+            const ssize_t readSize = read(m_NotifyHandle, eventBytes.data(), eventBytes.size());
+
+            for (ssize_t offset = 0; offset < readSize;)
+            {
+                const auto* pEvent = reinterpret_cast<const inotify_event*>(eventBytes.data() + offset);
+
+                if (pEvent->len > 0U && IsShaderSource(pEvent->name))
+                    changedFiles.insert(pEvent->name);
+
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + pEvent->len);
+            }
+        }
+
+        return false;
+    }
+#endif
+
+    auto ScanWriteTimes = [&]()
+    {
+        std::error_code errorCode;
+        for (const auto& entry : std::filesystem::directory_iterator(m_ShaderDirectory, errorCode))
+        {
+            if (!IsShaderSource(entry.path()))
+                continue;
+
+            const std::string fileName  = entry.path().filename().string();
+            const auto        writeTime = entry.last_write_time(errorCode);
+
+            if (auto [writeTimeIt, inserted] = m_WriteTimes.try_emplace(fileName, writeTime); inserted || writeTimeIt->second != writeTime)
+            {
+                writeTimeIt->second = writeTime;
+                changedFiles.insert(fileName);
+            }
+        }
+    };
+
+    while (!stopToken.stop_requested())
+    {
+        std::this_thread::sleep_for(changedFiles.empty() ? kShaderHotReloadPollInterval : kShaderHotReloadSettleTime);
+
+        const size_t changedCount = changedFiles.size();
+
+        ScanWriteTimes();
+
+        // Done once a scan finds nothing new after the first change.
+        if (changedCount > 0U && changedFiles.size() == changedCount)
+            return true;
+    }
+
+    return false;
+}
+
+bool ShaderHotReload::Compile(const Shader& shader) const
+{
+    const char* pCompiler = std::getenv("DXC");
+
+    const std::filesystem::path sourcePath = m_ShaderDirectory / (shader.name + ".hlsl");
+    const std::filesystem::path outputPath = m_ShaderDirectory / "Compiled" / (shader.name + ".spv");
+
+    // Written next to the output first, so a failed compile never leaves a truncated module behind.
+    std::filesystem::path compilePath = outputPath;
+    compilePath += ".tmp";
+
+    // The modules aren't checked in, the directory doesn't exist until the first compile.
+    std::error_code directoryError;
+    std::filesystem::create_directories(outputPath.parent_path(), directoryError);
+
+    const std::string command = std::format(R"("{}" -E Main -T {} -spirv -fspv-target-env=vulkan1.3 -Fo "{}" "{}")",
+                                            pCompiler != nullptr ? pCompiler : kShaderCompilerDefault,
+                                            shader.profile,
+                                            compilePath.string(),
+                                            sourcePath.string());
+
+    if (const int exitCode = std::system(command.c_str()); exitCode != 0)
+    {
+        spdlog::error("Failed to compile {} (exit code {}).", sourcePath.string(), exitCode);
+        return false;
+    }
+
+    std::error_code errorCode;
+    std::filesystem::rename(compilePath, outputPath, errorCode);
+
+    if (errorCode)
+    {
+        spdlog::error("Failed to replace {}: {}", outputPath.string(), errorCode.message());
+        return false;
+    }
+
+    spdlog::info("Compiled {}.", sourcePath.string());
+
+    return true;
+}
+
+void ShaderHotReload::Run(const std::stop_token& stopToken)
+{
+    CPUTracer::Get().SetThreadName("Shader Hot Reload");
+
+    std::set<std::string> changedFiles;
+
+    while (WaitForChanges(stopToken, changedFiles))
+    {
+        const bool includeChanged = std::any_of(changedFiles.begin(),
+                                                changedFiles.end(),
+                                                [](const std::string& fileName) { return fileName.ends_with(".hlsli"); });
+
+        std::vector<std::string> compiledShaders;
+        uint32_t                 failedCount = 0U;
+
+        for (const auto& shader : m_Shaders)
+        {
+            if (!includeChanged && !changedFiles.contains(shader.name + ".hlsl"))
+                continue;
+
+            if (Compile(shader))
+                compiledShaders.push_back(shader.name);
+            else
+                failedCount++;
+        }
+
+        changedFiles.clear();
+
+        // Sources of shaders that aren't watched.
+        if (compiledShaders.empty() && failedCount == 0U)
+            continue;
+
+        if (failedCount > 0U)
+        {
+            SetStatus(std::format("{} shader(s) failed to compile, see the log", failedCount));
+            continue;
+        }
+
+        CPUTracer::Get().BeginEvent("Shader Rebuild");
+
+        const bool rebuilt = m_RebuildFunc(compiledShaders);
+
+        CPUTracer::Get().EndEvent();
+
+        SetStatus(rebuilt ? std::format("Reloaded {} shader(s)", compiledShaders.size()) : "Rebuild failed, see the log");
+    }
+}
+
+// Deferred Release Queue Implementation
+// ------------------------------------------------------------
+
+void DeferredReleaseQueue::Push(std::function<void()> releaseFunc)
+{
+    m_Releases.emplace_back(m_FrameIndex + kMaxFramesInFlight, std::move(releaseFunc));
+}
+
+void DeferredReleaseQueue::Collect()
+{
+    m_FrameIndex++;
+
+    while (!m_Releases.empty() && m_Releases.front().first <= m_FrameIndex)
+    {
+        m_Releases.front().second();
+        m_Releases.pop_front();
+    }
+}
+
+void DeferredReleaseQueue::Flush()
+{
+    for (auto& release : m_Releases)
+        release.second();
+
+    m_Releases.clear();
+}
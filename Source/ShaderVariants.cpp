@@ -0,0 +1,92 @@
+#include <Common.h>
+#include <ShaderVariants.h>
+
+// Shader Variants Implementation
+// ------------------------------------------------------------
+
+static uint64_t HashShaderVariant(const ShaderVariant& variant)
+{
+    return HashBytes(&variant, sizeof(ShaderVariant));
+}
+
+ShaderVariantSpecialization::ShaderVariantSpecialization(const ShaderVariant& variant)
+{
+    static_assert(sizeof(ShaderVariant) == kShaderVariantConstantCount * sizeof(uint32_t), "Specialization constants must be tightly packed.");
+
+    for (uint32_t constantIndex = 0U; constantIndex < kShaderVariantConstantCount; constantIndex++)
+        mapEntries[constantIndex] = { constantIndex, constantIndex * static_cast<uint32_t>(sizeof(uint32_t)), sizeof(uint32_t) };
+
+    info.mapEntryCount = kShaderVariantConstantCount;
+    info.pMapEntries   = mapEntries.data();
+    info.dataSize      = sizeof(ShaderVariant);
+    info.pData         = &variant;
+}
+
+void ShaderVariantCache::Initialize(BuildFunc buildFunc)
+{
+    m_BuildFunc = std::move(buildFunc);
+}
+
+const RaytracingPipeline* ShaderVariantCache::Get(const ShaderVariant& variant)
+{
+    const uint64_t variantHash = HashShaderVariant(variant);
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        if (const auto entry = m_Entries.find(variantHash); entry != m_Entries.end())
+            return &entry->second.raytracingPipeline;
+    }
+
+    // Built outside of the lock, readers of the variant list don't wait on the driver.
+    const auto buildStart = std::chrono::high_resolution_clock::now();
+
+    RaytracingPipeline raytracingPipeline;
+
+    if (!m_BuildFunc(variant, raytracingPipeline))
+        return nullptr;
+
+    m_LastBuildMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - buildStart).count();
+    m_BuildCount++;
+
+    spdlog::info("Built pipeline variant (spp: {}, debug view: {}, ray flags: {:#x}, bounces: {}) in {:.2f} ms.",
+                 variant.samplesPerPixel,
+                 static_cast<uint32_t>(variant.debugView),
+                 variant.rayFlags,
+                 variant.maxBounceCount,
+                 m_LastBuildMilliseconds);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    return &(m_Entries[variantHash] = { variant, raytracingPipeline }).raytracingPipeline;
+}
+
+void ShaderVariantCache::Insert(const ShaderVariant& variant, const RaytracingPipeline& raytracingPipeline)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    m_Entries[HashShaderVariant(variant)] = { variant, raytracingPipeline };
+}
+
+void ShaderVariantCache::Clear(const ReleaseFunc& releaseFunc)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    for (auto& [variantHash, entry] : m_Entries)
+        releaseFunc(entry.raytracingPipeline);
+
+    m_Entries.clear();
+}
+
+std::vector<ShaderVariant> ShaderVariantCache::GetVariants() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    std::vector<ShaderVariant> variants;
+    variants.reserve(m_Entries.size());
+
+    for (const auto& [variantHash, entry] : m_Entries)
+        variants.push_back(entry.variant);
+
+    return variants;
+}
@@ -0,0 +1,196 @@
+#include <Common.h>
+#include <Profiler.h>
+#include <RenderContext.h>
+#include <RenderGraph.h>
+#include <SparseTrace.h>
+
+// Sparse Trace Implementation
+// ------------------------------------------------------------
+
+// Storage image bindings of Shaders/SparseReconstruct.hlsl: the four frame images, the previous and the new history.
+const uint32_t kSparseReconstructBindingCount = 6U;
+
+uint32_t GetSparseTracePhaseCount(SparseTraceMode mode)
+{
+    switch (mode)
+    {
+        case SparseTraceMode::Checkerboard: return 2U;
+        case SparseTraceMode::Interleaved: return 4U;
+        default: return 1U;
+    }
+}
+
+VkExtent2D GetSparseTraceDispatchSize(SparseTraceMode mode, uint32_t width, uint32_t height)
+{
+    // Rounded up, the shaders skip the traced pixels past the edge of odd sized images.
+    switch (mode)
+    {
+        case SparseTraceMode::Checkerboard: return { (width + 1U) / 2U, height };
+        case SparseTraceMode::Interleaved: return { (width + 1U) / 2U, (height + 1U) / 2U };
+        default: return { width, height };
+    }
+}
+
+void SparseReconstruction::Create(RenderContext* pRenderContext,
+                                  const Image&   color,
+                                  const Image&   position,
+                                  const Image&   normal,
+                                  const Image&   motion,
+                                  VkCommandPool  vkCommandPool)
+{
+    m_Width  = pRenderContext->GetRenderWidth();
+    m_Height = pRenderContext->GetRenderHeight();
+
+    // History images, in the general layout from here on.
+    // ------------------------------------------------
+
+    for (uint32_t historyIndex = 0U; historyIndex < m_History.size(); historyIndex++)
+    {
+        Check(CreateStorageImage(pRenderContext,
+                                 m_History[historyIndex].color,
+                                 VK_FORMAT_R16G16B16A16_SFLOAT,
+                                 std::format("Sparse Trace History {}", historyIndex).c_str(),
+                                 vkCommandPool),
+              "Failed to create the sparse trace history.");
+    }
+
+    // Pipeline.
+    // ------------------------------------------------
+
+    m_SetLayout      = CreateStorageImageSetLayout(pRenderContext, kSparseReconstructBindingCount);
+    m_PipelineLayout = CreateComputePipelineLayout(pRenderContext, m_SetLayout, sizeof(SparseReconstructConstants));
+    m_Pipeline       = CreateComputePipeline(pRenderContext, "SparseReconstruct.spv", m_PipelineLayout);
+
+    // One set per history direction, so nothing is rewritten while frames are in flight.
+    // ------------------------------------------------
+
+    const VkDescriptorPoolSize descriptorPoolSize = { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                                                      static_cast<uint32_t>(m_Sets.size()) * kSparseReconstructBindingCount };
+
+    VkDescriptorPoolCreateInfo descriptorPoolInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+    {
+        descriptorPoolInfo.maxSets       = static_cast<uint32_t>(m_Sets.size());
+        descriptorPoolInfo.poolSizeCount = 1U;
+        descriptorPoolInfo.pPoolSizes    = &descriptorPoolSize;
+    }
+    Check(vkCreateDescriptorPool(pRenderContext->GetDevice(), &descriptorPoolInfo, nullptr, &m_DescriptorPool),
+          "Failed to create the sparse trace descriptor pool.");
+
+    for (uint32_t historyIndex = 0U; historyIndex < m_History.size(); historyIndex++)
+    {
+        VkDescriptorSetAllocateInfo descriptorSetInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+        {
+            descriptorSetInfo.descriptorPool     = m_DescriptorPool;
+            descriptorSetInfo.descriptorSetCount = 1U;
+            descriptorSetInfo.pSetLayouts        = &m_SetLayout;
+        }
+        Check(vkAllocateDescriptorSets(pRenderContext->GetDevice(), &descriptorSetInfo, &m_Sets[historyIndex]),
+              "Failed to allocate a sparse trace descriptor set.");
+
+        // Binding i is the i-th view.
+        const std::array<VkDescriptorImageInfo, kSparseReconstructBindingCount> imageInfos = {
+            { { VK_NULL_HANDLE, color.imageView, VK_IMAGE_LAYOUT_GENERAL },
+             { VK_NULL_HANDLE, position.imageView, VK_IMAGE_LAYOUT_GENERAL },
+             { VK_NULL_HANDLE, normal.imageView, VK_IMAGE_LAYOUT_GENERAL },
+             { VK_NULL_HANDLE, motion.imageView, VK_IMAGE_LAYOUT_GENERAL },
+             { VK_NULL_HANDLE, m_History[historyIndex ^ 1U].color.imageView, VK_IMAGE_LAYOUT_GENERAL },
+             { VK_NULL_HANDLE, m_History[historyIndex].color.imageView, VK_IMAGE_LAYOUT_GENERAL } }
+        };
+
+        VkWriteDescriptorSet descriptorWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+        {
+            descriptorWrite.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            descriptorWrite.descriptorCount = kSparseReconstructBindingCount;
+            descriptorWrite.dstBinding      = 0U;
+            descriptorWrite.dstSet          = m_Sets[historyIndex];
+            descriptorWrite.pImageInfo      = imageInfos.data();
+        }
+        vkUpdateDescriptorSets(pRenderContext->GetDevice(), 1U, &descriptorWrite, 0U, nullptr);
+    }
+
+    spdlog::info("Created Sparse Trace Reconstruction.");
+}
+
+void SparseReconstruction::Release(RenderContext* pRenderContext)
+{
+    vkDestroyDescriptorPool(pRenderContext->GetDevice(), m_DescriptorPool, nullptr);
+    vkDestroyPipeline(pRenderContext->GetDevice(), m_Pipeline, nullptr);
+    vkDestroyPipelineLayout(pRenderContext->GetDevice(), m_PipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(pRenderContext->GetDevice(), m_SetLayout, nullptr);
+
+    for (auto& history : m_History)
+    {
+        vkDestroyImageView(pRenderContext->GetDevice(), history.color.imageView, nullptr);
+        vmaDestroyImage(pRenderContext->GetAllocator(), history.color.image, history.color.imageAllocation);
+    }
+}
+
+void SparseReconstruction::Import(RenderGraph& renderGraph)
+{
+    // Left in the general layout by CreateStorageImage, and idle since.
+    const RenderGraph::ResourceState created = { VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_2_NONE, VK_PIPELINE_STAGE_2_NONE };
+
+    for (uint32_t historyIndex = 0U; historyIndex < m_History.size(); historyIndex++)
+    {
+        m_History[historyIndex].graphColor =
+            renderGraph.ImportImage(std::format("Sparse Trace History {}", historyIndex), m_History[historyIndex].color.image, created);
+    }
+}
+
+void SparseReconstruction::AddPass(RenderGraph&          renderGraph,
+                                   const FrameResources& frameResources,
+                                   SparseTraceMode       mode,
+                                   uint32_t              phase,
+                                   GPUProfiler&          profiler)
+{
+    using ResourceState = RenderGraph::ResourceState;
+
+    const ResourceState computeRead  = { VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT };
+    const ResourceState computeWrite = { VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT };
+
+    // The traced pixels are read, the skipped ones written.
+    const ResourceState computeReadWrite = { VK_IMAGE_LAYOUT_GENERAL,
+                                             VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                                             VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT };
+
+    const uint32_t historyIndex = m_HistoryIndex;
+
+    SparseReconstructConstants constants;
+    {
+        constants.sparseMode   = static_cast<uint32_t>(mode);
+        constants.sparsePhase  = phase;
+        constants.historyValid = m_HistoryValid ? 1U : 0U;
+    }
+
+    const uint32_t groupCountX = (m_Width + 7U) / 8U;
+    const uint32_t groupCountY = (m_Height + 7U) / 8U;
+
+    renderGraph.AddPass(
+        "Sparse Reconstruct",
+        {
+            { frameResources.color, computeReadWrite },
+            { frameResources.position, computeReadWrite },
+            { frameResources.normal, computeReadWrite },
+            { frameResources.motion, computeReadWrite },
+            { m_History[historyIndex ^ 1U].graphColor, computeRead },
+            { m_History[historyIndex].graphColor, computeWrite },
+        },
+        [this, constants, historyIndex, groupCountX, groupCountY, &profiler](VkCommandBuffer cmd)
+        {
+            profiler.BeginScope(cmd, "Sparse Reconstruct");
+
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_Pipeline);
+
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_PipelineLayout, 0, 1, &m_Sets[historyIndex], 0, 0);
+
+            vkCmdPushConstants(cmd, m_PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0U, sizeof(SparseReconstructConstants), &constants);
+
+            vkCmdDispatch(cmd, groupCountX, groupCountY, 1U);
+
+            profiler.EndScope(cmd);
+        });
+
+    // The history written this frame is read by the next one.
+    m_HistoryIndex ^= 1U;
+    m_HistoryValid  = true;
+}
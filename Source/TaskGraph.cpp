@@ -0,0 +1,174 @@
+#include <Common.h>
+#include <TaskGraph.h>
+
+// Task Graph Implementation
+// ------------------------------------------------------------
+
+thread_local uint32_t t_WorkerIndex = 0U;
+
+TaskGraph::TaskHandle TaskGraph::AddTask(const std::string& taskName, std::function<void()> taskFunc, const std::vector<TaskHandle>& dependencies)
+{
+    const auto taskHandle = static_cast<TaskHandle>(m_Tasks.size());
+
+    for (const auto dependency : dependencies)
+    {
+        Check(dependency < taskHandle, "Task graph dependencies must be added before their dependents.");
+
+        m_Tasks[dependency].dependents.push_back(taskHandle);
+    }
+
+    m_Tasks.push_back({ taskName, std::move(taskFunc), {}, static_cast<uint32_t>(dependencies.size()) });
+
+    return taskHandle;
+}
+
+uint32_t TaskGraph::GetWorkerIndex()
+{
+    return t_WorkerIndex;
+}
+
+void TaskGraph::Execute(uint32_t workerCount)
+{
+    const auto taskCount = static_cast<uint32_t>(m_Tasks.size());
+
+    if (taskCount == 0U)
+        return;
+
+    workerCount = std::max(workerCount, 1U);
+
+    // Owners push and pop at the back (depth first, warm caches), thieves take the oldest task from the front.
+    struct WorkerQueue
+    {
+        std::mutex             mutex;
+        std::deque<TaskHandle> tasks;
+    };
+
+    std::vector<WorkerQueue>           workerQueues(workerCount);
+    std::vector<std::atomic<uint32_t>> remainingDependencies(taskCount);
+
+    std::atomic<uint32_t> queuedCount    = 0U;
+    std::atomic<uint32_t> completedCount = 0U;
+
+    std::mutex              idleMutex;
+    std::condition_variable idleCondition;
+
+    auto Push = [&](uint32_t workerIndex, TaskHandle taskHandle)
+    {
+        // Counted before it is visible, so a thief can't take it before the count goes up.
+        queuedCount++;
+
+        {
+            std::lock_guard<std::mutex> lock(workerQueues[workerIndex].mutex);
+            workerQueues[workerIndex].tasks.push_back(taskHandle);
+        }
+
+        // Taking the idle lock orders the push against a worker going to sleep, so the wake-up can't be lost.
+        {
+            std::lock_guard<std::mutex> lock(idleMutex);
+        }
+        idleCondition.notify_one();
+    };
+
+    auto Pop = [&](uint32_t workerIndex, TaskHandle& taskHandle)
+    {
+        for (uint32_t offset = 0U; offset < workerCount; offset++)
+        {
+            auto& queue = workerQueues[(workerIndex + offset) % workerCount];
+
+            std::lock_guard<std::mutex> lock(queue.mutex);
+
+            if (queue.tasks.empty())
+                continue;
+
+            if (offset == 0U)
+            {
+                taskHandle = queue.tasks.back();
+                queue.tasks.pop_back();
+            }
+            else
+            {
+                taskHandle = queue.tasks.front();
+                queue.tasks.pop_front();
+            }
+
+            queuedCount--;
+            return true;
+        }
+
+        return false;
+    };
+
+    auto Run = [&](uint32_t workerIndex, TaskHandle taskHandle)
+    {
+        const Task& task = m_Tasks[taskHandle];
+
+        auto taskTimeBegin = std::chrono::high_resolution_clock::now();
+        {
+            PROFILE_SCOPE(task.name.c_str());
+
+            task.func();
+        }
+        const double taskMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - taskTimeBegin).count();
+
+        {
+            std::lock_guard<std::mutex> lock(m_TimingsMutex);
+            m_TaskTimings.emplace_back(task.name, taskMilliseconds);
+        }
+
+        for (const auto dependent : task.dependents)
+        {
+            if (--remainingDependencies[dependent] == 0U)
+                Push(workerIndex, dependent);
+        }
+
+        if (++completedCount == taskCount)
+        {
+            {
+                std::lock_guard<std::mutex> lock(idleMutex);
+            }
+            idleCondition.notify_all();
+        }
+    };
+
+    auto Worker = [&](uint32_t workerIndex)
+    {
+        t_WorkerIndex = workerIndex;
+
+        while (completedCount.load() < taskCount)
+        {
+            TaskHandle taskHandle;
+
+            if (Pop(workerIndex, taskHandle))
+            {
+                Run(workerIndex, taskHandle);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(idleMutex);
+            idleCondition.wait(lock, [&]() { return queuedCount.load() > 0U || completedCount.load() == taskCount; });
+        }
+    };
+
+    // Seed the queues with the roots, spread over the workers.
+    uint32_t rootCount = 0U;
+
+    for (TaskHandle taskHandle = 0U; taskHandle < taskCount; taskHandle++)
+    {
+        remainingDependencies[taskHandle].store(m_Tasks[taskHandle].dependencyCount);
+
+        if (m_Tasks[taskHandle].dependencyCount == 0U)
+            Push(rootCount++ % workerCount, taskHandle);
+    }
+
+    {
+        // The calling thread is worker zero, the rest join on scope exit.
+        std::vector<std::jthread> workers;
+
+        for (uint32_t workerIndex = 1U; workerIndex < workerCount; workerIndex++)
+            workers.emplace_back(Worker, workerIndex);
+
+        Worker(0U);
+    }
+
+    t_WorkerIndex = 0U;
+}
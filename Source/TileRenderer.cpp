@@ -0,0 +1,663 @@
+#include <Common.h>
+#include <Profiler.h>
+#include <RenderContext.h>
+#include <Scene.h>
+#include <Camera.h>
+#include <ImageIO.h>
+#include <TileRenderer.h>
+
+// Tile Scheduler Implementation
+// ------------------------------------------------------------
+
+void TileScheduler::Reset(uint32_t tileCount, const std::vector<double>& deviceWeights)
+{
+    m_Queues.clear();
+    m_StolenCount.store(0U);
+
+    const double weightSum = std::accumulate(deviceWeights.begin(), deviceWeights.end(), 0.0);
+
+    uint32_t firstTile = 0U;
+    double   weightRun = 0.0;
+
+    for (uint32_t deviceIndex = 0U; deviceIndex < deviceWeights.size(); deviceIndex++)
+    {
+        weightRun += deviceWeights[deviceIndex];
+
+        // The last device takes the rounding remainder.
+        const uint32_t lastTile = deviceIndex + 1U == deviceWeights.size()
+                                      ? tileCount
+                                      : std::min(tileCount, static_cast<uint32_t>(std::lround(tileCount * weightRun / weightSum)));
+
+        auto& queue = m_Queues.emplace_back(std::make_unique<DeviceQueue>());
+
+        for (uint32_t tileIndex = firstTile; tileIndex < lastTile; tileIndex++)
+            queue->tiles.push_back(tileIndex);
+
+        firstTile = std::max(firstTile, lastTile);
+    }
+}
+
+void TileScheduler::Pop(uint32_t deviceIndex, uint32_t maxTileCount, std::vector<uint32_t>& tileIndices)
+{
+    tileIndices.clear();
+
+    {
+        auto& queue = *m_Queues[deviceIndex];
+
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        while (!queue.tiles.empty() && tileIndices.size() < maxTileCount)
+        {
+            tileIndices.push_back(queue.tiles.front());
+            queue.tiles.pop_front();
+        }
+    }
+
+    if (!tileIndices.empty())
+        return;
+
+    // Steal half of the longest queue (at most a batch), the owner keeps the tiles it is about to reach.
+    while (true)
+    {
+        DeviceQueue* pVictim   = nullptr;
+        size_t       tileCount = 0U;
+
+        for (auto& queue : m_Queues)
+        {
+            std::lock_guard<std::mutex> lock(queue->mutex);
+
+            if (queue->tiles.size() > tileCount)
+            {
+                pVictim   = queue.get();
+                tileCount = queue->tiles.size();
+            }
+        }
+
+        if (pVictim == nullptr)
+            return;
+
+        std::lock_guard<std::mutex> lock(pVictim->mutex);
+
+        // Drained by its owner (or another thief) in the meantime.
+        if (pVictim->tiles.empty())
+            continue;
+
+        const size_t stealCount = std::min<size_t>(maxTileCount, (pVictim->tiles.size() + 1U) / 2U);
+
+        for (size_t stealIndex = 0U; stealIndex < stealCount; stealIndex++)
+        {
+            tileIndices.push_back(pVictim->tiles.back());
+            pVictim->tiles.pop_back();
+        }
+
+        m_StolenCount += static_cast<uint32_t>(stealCount);
+        return;
+    }
+}
+
+// Tile Renderer Implementation
+// ------------------------------------------------------------
+
+static uint64_t GetDeviceAddress(RenderContext* pRenderContext, const Buffer& buffer)
+{
+    VkBufferDeviceAddressInfo deviceAddressInfo = { VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO };
+    {
+        deviceAddressInfo.buffer = buffer.buffer;
+    }
+    return vkGetBufferDeviceAddress(pRenderContext->GetDevice(), &deviceAddressInfo);
+}
+
+// Host visible and persistently mapped, the tile devices only read their scene once and the output is read back
+// every batch.
+static void* CreateHostBuffer(RenderContext* pRenderContext, VkDeviceSize size, VkBufferUsageFlags usage, bool readback, Buffer& buffer)
+{
+    VkBufferCreateInfo bufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+    bufferInfo.size               = size;
+    bufferInfo.usage              = usage;
+
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage                   = VMA_MEMORY_USAGE_AUTO;
+    allocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT |
+                      (readback ? VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT : VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT);
+
+    VmaAllocationInfo allocationInfo;
+    Check(vmaCreateBuffer(pRenderContext->GetAllocator(), &bufferInfo, &allocInfo, &buffer.buffer, &buffer.bufferAllocation, &allocationInfo),
+          "Failed to create tile renderer buffer memory.");
+
+    return allocationInfo.pMappedData;
+}
+
+static void BuildAccelerationStructure(RenderContext*                            pRenderContext,
+                                       VkAccelerationStructureTypeKHR            type,
+                                       const VkAccelerationStructureGeometryKHR& geometry,
+                                       uint32_t                                  primitiveCount,
+                                       AccelerationStructure&                    accelerationStructure)
+{
+    VkAccelerationStructureBuildGeometryInfoKHR buildGeometryInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR };
+    {
+        buildGeometryInfo.type          = type;
+        buildGeometryInfo.flags         = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
+        buildGeometryInfo.mode          = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+        buildGeometryInfo.geometryCount = 1U;
+        buildGeometryInfo.pGeometries   = &geometry;
+    }
+
+    VkAccelerationStructureBuildSizesInfoKHR buildSizesInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR };
+    vkGetAccelerationStructureBuildSizesKHR(pRenderContext->GetDevice(),
+                                            VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
+                                            &buildGeometryInfo,
+                                            &primitiveCount,
+                                            &buildSizesInfo);
+
+    VkBufferCreateInfo bufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+    bufferInfo.size               = buildSizesInfo.accelerationStructureSize;
+    bufferInfo.usage              = VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage                   = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    Check(vmaCreateBuffer(pRenderContext->GetAllocator(),
+                          &bufferInfo,
+                          &allocInfo,
+                          &accelerationStructure.backingMemory.buffer,
+                          &accelerationStructure.backingMemory.bufferAllocation,
+                          nullptr),
+          "Failed to create acceleration structure memory.");
+
+    bufferInfo.size  = buildSizesInfo.buildScratchSize;
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+    Buffer scratchBuffer;
+    Check(vmaCreateBuffer(pRenderContext->GetAllocator(), &bufferInfo, &allocInfo, &scratchBuffer.buffer, &scratchBuffer.bufferAllocation, nullptr),
+          "Failed to create scratch buffer memory.");
+
+    VkAccelerationStructureCreateInfoKHR createInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR };
+    {
+        createInfo.buffer = accelerationStructure.backingMemory.buffer;
+        createInfo.size   = buildSizesInfo.accelerationStructureSize;
+        createInfo.type   = type;
+    }
+    Check(vkCreateAccelerationStructureKHR(pRenderContext->GetDevice(), &createInfo, nullptr, &accelerationStructure.handle),
+          "Failed to create acceleration structure");
+
+    buildGeometryInfo.dstAccelerationStructure  = accelerationStructure.handle;
+    buildGeometryInfo.scratchData.deviceAddress = GetDeviceAddress(pRenderContext, scratchBuffer);
+
+    VkAccelerationStructureBuildRangeInfoKHR buildRangeInfo = { primitiveCount, 0U, 0U, 0U };
+
+    const VkAccelerationStructureBuildRangeInfoKHR* pBuildRangeInfo = &buildRangeInfo;
+
+    VkCommandBuffer vkCommand = VK_NULL_HANDLE;
+    SingleShotCommandBegin(pRenderContext, vkCommand);
+    {
+        vkCmdBuildAccelerationStructuresKHR(vkCommand, 1U, &buildGeometryInfo, &pBuildRangeInfo);
+    }
+    SingleShotCommandEnd(pRenderContext, vkCommand);
+
+    vmaDestroyBuffer(pRenderContext->GetAllocator(), scratchBuffer.buffer, scratchBuffer.bufferAllocation);
+
+    VkAccelerationStructureDeviceAddressInfoKHR deviceAddressInfo { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR };
+    {
+        deviceAddressInfo.accelerationStructure = accelerationStructure.handle;
+    }
+    accelerationStructure.deviceAddress = vkGetAccelerationStructureDeviceAddressKHR(pRenderContext->GetDevice(), &deviceAddressInfo);
+}
+
+void TileRenderer::Initialize(const std::vector<RenderContext*>& renderContexts, const TileScene& scene)
+{
+    m_Devices.resize(renderContexts.size());
+    m_Statistics.resize(renderContexts.size());
+
+    // Every device builds its copy of the scene at the same time.
+    std::vector<std::jthread> initializeThreads;
+
+    for (uint32_t deviceIndex = 0U; deviceIndex < renderContexts.size(); deviceIndex++)
+    {
+        m_Devices[deviceIndex].pRenderContext = renderContexts[deviceIndex];
+        m_Statistics[deviceIndex].name        = renderContexts[deviceIndex]->GetDeviceName();
+
+        initializeThreads.emplace_back(
+            [this, &scene, deviceIndex]()
+            {
+                CPUTracer::Get().SetThreadName(std::format("Tile Device {}", deviceIndex).c_str());
+
+                InitializeDevice(m_Devices[deviceIndex], scene);
+            });
+    }
+}
+
+void TileRenderer::InitializeDevice(Device& device, const TileScene& scene)
+{
+    PROFILE_SCOPE("Replicate Scene");
+
+    RenderContext* pRenderContext = device.pRenderContext;
+
+    const auto timeBegin = std::chrono::high_resolution_clock::now();
+
+    // Geometry + BLAS.
+    // ------------------------------------------------
+
+    const VkBufferUsageFlags geometryUsage = VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
+                                             VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+
+    memcpy(CreateHostBuffer(pRenderContext, sizeof(Vertex) * scene.vertices.size(), geometryUsage, false, device.vertexBuffer),
+           scene.vertices.data(),
+           sizeof(Vertex) * scene.vertices.size());
+
+    memcpy(CreateHostBuffer(pRenderContext, sizeof(uint32_t) * scene.indices.size(), geometryUsage, false, device.indexBuffer),
+           scene.indices.data(),
+           sizeof(uint32_t) * scene.indices.size());
+
+    VkAccelerationStructureGeometryKHR blasGeometry { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR };
+    {
+        blasGeometry.geometryType                                = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
+        blasGeometry.flags                                       = VK_GEOMETRY_OPAQUE_BIT_KHR;
+        blasGeometry.geometry.triangles.sType                    = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
+        blasGeometry.geometry.triangles.vertexFormat             = VK_FORMAT_R32G32B32_SFLOAT;
+        blasGeometry.geometry.triangles.vertexData.deviceAddress = GetDeviceAddress(pRenderContext, device.vertexBuffer);
+        blasGeometry.geometry.triangles.maxVertex                = static_cast<uint32_t>(scene.vertices.size());
+        blasGeometry.geometry.triangles.vertexStride             = sizeof(Vertex);
+        blasGeometry.geometry.triangles.indexType                = VK_INDEX_TYPE_UINT32;
+        blasGeometry.geometry.triangles.indexData.deviceAddress  = GetDeviceAddress(pRenderContext, device.indexBuffer);
+    }
+
+    BuildAccelerationStructure(pRenderContext,
+                               VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR,
+                               blasGeometry,
+                               static_cast<uint32_t>(scene.indices.size() / 3U),
+                               device.blas);
+
+    // Instances + TLAS.
+    // ------------------------------------------------
+
+    const auto instanceCount = static_cast<uint32_t>(scene.instanceTransforms.size());
+
+    auto* pInstances = static_cast<VkAccelerationStructureInstanceKHR*>(
+        CreateHostBuffer(pRenderContext,
+                         sizeof(VkAccelerationStructureInstanceKHR) * instanceCount,
+                         VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                         false,
+                         device.instanceBuffer));
+
+    for (uint32_t instanceIndex = 0U; instanceIndex < instanceCount; instanceIndex++)
+    {
+        VkAccelerationStructureInstanceKHR& instance = pInstances[instanceIndex]; // NOLINT
+        {
+            instance.transform                              = scene.instanceTransforms[instanceIndex];
+            instance.instanceCustomIndex                    = 0U;
+            instance.mask                                   = 0xFF;
+            instance.instanceShaderBindingTableRecordOffset = 0U;
+            instance.flags                                  = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
+            instance.accelerationStructureReference         = device.blas.deviceAddress;
+        }
+    }
+
+    VkAccelerationStructureGeometryKHR tlasGeometry { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR };
+    {
+        tlasGeometry.geometryType                          = VK_GEOMETRY_TYPE_INSTANCES_KHR;
+        tlasGeometry.flags                                 = VK_GEOMETRY_OPAQUE_BIT_KHR;
+        tlasGeometry.geometry.instances.sType              = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
+        tlasGeometry.geometry.instances.arrayOfPointers    = VK_FALSE;
+        tlasGeometry.geometry.instances.data.deviceAddress = GetDeviceAddress(pRenderContext, device.instanceBuffer);
+    }
+
+    BuildAccelerationStructure(pRenderContext, VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR, tlasGeometry, instanceCount, device.tlas);
+
+    // Pipeline.
+    // ------------------------------------------------
+
+    const std::array<VkDescriptorSetLayoutBinding, 2> descriptorSetBindings = {
+        { { 0U, VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, 1U, VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
+          { 1U, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1U, VK_SHADER_STAGE_COMPUTE_BIT, nullptr } }
+    };
+
+    VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+    {
+        descriptorSetLayoutInfo.bindingCount = static_cast<uint32_t>(descriptorSetBindings.size());
+        descriptorSetLayoutInfo.pBindings    = descriptorSetBindings.data();
+    }
+    Check(vkCreateDescriptorSetLayout(pRenderContext->GetDevice(), &descriptorSetLayoutInfo, nullptr, &device.descriptorSetLayout),
+          "Failed to create the tile trace descriptor set layout.");
+
+    const VkPushConstantRange pushConstantRange = { VK_SHADER_STAGE_COMPUTE_BIT, 0U, sizeof(TileTraceConstants) };
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+    {
+        pipelineLayoutInfo.setLayoutCount         = 1U;
+        pipelineLayoutInfo.pSetLayouts            = &device.descriptorSetLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1U;
+        pipelineLayoutInfo.pPushConstantRanges    = &pushConstantRange;
+    }
+    Check(vkCreatePipelineLayout(pRenderContext->GetDevice(), &pipelineLayoutInfo, nullptr, &device.pipelineLayout),
+          "Failed to create the tile trace pipeline layout.");
+
+    std::vector<char> byteCode;
+    Check(LoadByteCode("TileTrace.spv", byteCode), "Failed to load the tile trace shader byte code.");
+
+    VkShaderModuleCreateInfo shaderModuleInfo = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
+    {
+        shaderModuleInfo.pCode    = reinterpret_cast<uint32_t*>(byteCode.data());
+        shaderModuleInfo.codeSize = byteCode.size();
+    }
+
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+    Check(vkCreateShaderModule(pRenderContext->GetDevice(), &shaderModuleInfo, nullptr, &shaderModule), "Failed to create tile trace shader.");
+
+    VkComputePipelineCreateInfo computePipelineInfo = { VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+    {
+        computePipelineInfo.stage.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        computePipelineInfo.stage.stage  = VK_SHADER_STAGE_COMPUTE_BIT;
+        computePipelineInfo.stage.module = shaderModule;
+        computePipelineInfo.stage.pName  = "Main";
+        computePipelineInfo.layout       = device.pipelineLayout;
+    }
+    Check(vkCreateComputePipelines(pRenderContext->GetDevice(), VK_NULL_HANDLE, 1U, &computePipelineInfo, nullptr, &device.pipeline),
+          "Failed to create tile trace pipeline.");
+
+    vkDestroyShaderModule(pRenderContext->GetDevice(), shaderModule, nullptr);
+
+    // Output + descriptors.
+    // ------------------------------------------------
+
+    const VkDeviceSize outputSize = sizeof(glm::vec4) * kTileSize * kTileSize * kTileBatchSize;
+
+    device.pOutput =
+        static_cast<glm::vec4*>(CreateHostBuffer(pRenderContext, outputSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, true, device.outputBuffer));
+
+    const std::array<VkDescriptorPoolSize, 2> descriptorPoolSizes = {
+        { { VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, 1U }, { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1U } }
+    };
+
+    VkDescriptorPoolCreateInfo descriptorPoolInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+    {
+        descriptorPoolInfo.maxSets       = 1U;
+        descriptorPoolInfo.poolSizeCount = static_cast<uint32_t>(descriptorPoolSizes.size());
+        descriptorPoolInfo.pPoolSizes    = descriptorPoolSizes.data();
+    }
+    Check(vkCreateDescriptorPool(pRenderContext->GetDevice(), &descriptorPoolInfo, nullptr, &device.descriptorPool),
+          "Failed to create the tile trace descriptor pool.");
+
+    VkDescriptorSetAllocateInfo descriptorSetInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    {
+        descriptorSetInfo.descriptorPool     = device.descriptorPool;
+        descriptorSetInfo.descriptorSetCount = 1U;
+        descriptorSetInfo.pSetLayouts        = &device.descriptorSetLayout;
+    }
+    Check(vkAllocateDescriptorSets(pRenderContext->GetDevice(), &descriptorSetInfo, &device.descriptorSet),
+          "Failed to allocate the tile trace descriptor set.");
+
+    VkWriteDescriptorSetAccelerationStructureKHR accelerationStructureWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR };
+    {
+        accelerationStructureWrite.accelerationStructureCount = 1U;
+        accelerationStructureWrite.pAccelerationStructures    = &device.tlas.handle;
+    }
+
+    const VkDescriptorBufferInfo outputBufferInfo = { device.outputBuffer.buffer, 0U, outputSize };
+
+    std::array<VkWriteDescriptorSet, 2> descriptorWrites {};
+    {
+        descriptorWrites[0].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[0].pNext           = &accelerationStructureWrite;
+        descriptorWrites[0].dstSet          = device.descriptorSet;
+        descriptorWrites[0].dstBinding      = 0U;
+        descriptorWrites[0].descriptorCount = 1U;
+        descriptorWrites[0].descriptorType  = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+
+        descriptorWrites[1].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[1].dstSet          = device.descriptorSet;
+        descriptorWrites[1].dstBinding      = 1U;
+        descriptorWrites[1].descriptorCount = 1U;
+        descriptorWrites[1].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[1].pBufferInfo     = &outputBufferInfo;
+    }
+    vkUpdateDescriptorSets(pRenderContext->GetDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0U, nullptr);
+
+    // Submission primitives, reused by every batch.
+    // ------------------------------------------------
+
+    VkCommandBufferAllocateInfo commandBufferInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+    {
+        commandBufferInfo.commandPool        = pRenderContext->GetCommandPool();
+        commandBufferInfo.commandBufferCount = 1U;
+        commandBufferInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    }
+    Check(vkAllocateCommandBuffers(pRenderContext->GetDevice(), &commandBufferInfo, &device.commandBuffer),
+          "Failed to allocate the tile trace command buffer.");
+
+    VkFenceCreateInfo fenceInfo = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+    Check(vkCreateFence(pRenderContext->GetDevice(), &fenceInfo, nullptr, &device.fence), "Failed to create the tile trace fence.");
+
+    spdlog::info("Replicated the scene on {} ({} instances) in {:.2f} ms.",
+                 pRenderContext->GetDeviceName(),
+                 instanceCount,
+                 std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - timeBegin).count());
+}
+
+void TileRenderer::Release()
+{
+    for (auto& device : m_Devices)
+        ReleaseDevice(device);
+
+    m_Devices.clear();
+}
+
+void TileRenderer::ReleaseDevice(Device& device)
+{
+    RenderContext* pRenderContext = device.pRenderContext;
+
+    vkDeviceWaitIdle(pRenderContext->GetDevice());
+
+    vkDestroyFence(pRenderContext->GetDevice(), device.fence, nullptr);
+    vkFreeCommandBuffers(pRenderContext->GetDevice(), pRenderContext->GetCommandPool(), 1U, &device.commandBuffer);
+
+    vkDestroyDescriptorPool(pRenderContext->GetDevice(), device.descriptorPool, nullptr);
+    vkDestroyPipeline(pRenderContext->GetDevice(), device.pipeline, nullptr);
+    vkDestroyPipelineLayout(pRenderContext->GetDevice(), device.pipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(pRenderContext->GetDevice(), device.descriptorSetLayout, nullptr);
+
+    for (auto* pAccelerationStructure : { &device.tlas, &device.blas })
+    {
+        vkDestroyAccelerationStructureKHR(pRenderContext->GetDevice(), pAccelerationStructure->handle, nullptr);
+        vmaDestroyBuffer(pRenderContext->GetAllocator(),
+                         pAccelerationStructure->backingMemory.buffer,
+                         pAccelerationStructure->backingMemory.bufferAllocation);
+    }
+
+    for (auto* pBuffer : { &device.outputBuffer, &device.instanceBuffer, &device.indexBuffer, &device.vertexBuffer })
+        vmaDestroyBuffer(pRenderContext->GetAllocator(), pBuffer->buffer, pBuffer->bufferAllocation);
+}
+
+void TileRenderer::Render(const CameraState& camera, uint32_t width, uint32_t height, uint32_t samplesPerPixel, std::vector<glm::vec4>& image)
+{
+    PROFILE_SCOPE("Render Tiles");
+
+    const uint32_t tileCountX = (width + kTileSize - 1U) / kTileSize;
+    const uint32_t tileCountY = (height + kTileSize - 1U) / kTileSize;
+
+    // Devices without a measurement yet (the first frame) get an even share.
+    std::vector<double> deviceWeights;
+
+    for (const auto& statistics : m_Statistics)
+        deviceWeights.push_back(statistics.tilesPerSecond > 0.0 ? statistics.tilesPerSecond : 1.0);
+
+    m_Scheduler.Reset(tileCountX * tileCountY, deviceWeights);
+
+    image.assign(static_cast<size_t>(width) * height, glm::vec4(0.0F));
+
+    TileTraceConstants frameConstants {};
+    {
+        frameConstants.rayOrigin       = glm::vec4(camera.position, 0.0F);
+        frameConstants.rayCorner       = glm::vec4(camera.rayCorner, 0.0F);
+        frameConstants.rayPixelDeltaX  = glm::vec4(camera.rayPixelDeltaX, 0.0F);
+        frameConstants.rayPixelDeltaY  = glm::vec4(camera.rayPixelDeltaY, 0.0F);
+        frameConstants.imageSize       = glm::uvec2(width, height);
+        frameConstants.samplesPerPixel = samplesPerPixel;
+    }
+
+    {
+        std::vector<std::jthread> deviceThreads;
+
+        for (uint32_t deviceIndex = 0U; deviceIndex < m_Devices.size(); deviceIndex++)
+        {
+            deviceThreads.emplace_back(
+                [this, &frameConstants, &image, deviceIndex]()
+                {
+                    CPUTracer::Get().SetThreadName(std::format("Tile Device {}", deviceIndex).c_str());
+
+                    const auto timeBegin = std::chrono::high_resolution_clock::now();
+
+                    const uint32_t tileCount = RenderDevice(deviceIndex, frameConstants, image);
+
+                    auto& statistics = m_Statistics[deviceIndex];
+
+                    statistics.tileCount        = tileCount;
+                    statistics.busyMilliseconds =
+                        std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - timeBegin).count();
+                });
+        }
+    }
+
+    for (auto& statistics : m_Statistics)
+    {
+        if (statistics.tileCount == 0U || statistics.busyMilliseconds <= 0.0)
+            continue;
+
+        const double tilesPerSecond = 1000.0 * statistics.tileCount / statistics.busyMilliseconds;
+
+        statistics.tilesPerSecond = statistics.tilesPerSecond > 0.0
+                                        ? std::lerp(statistics.tilesPerSecond, tilesPerSecond, kTileThroughputSmoothing)
+                                        : tilesPerSecond;
+    }
+}
+
+uint32_t TileRenderer::RenderDevice(uint32_t deviceIndex, const TileTraceConstants& frameConstants, std::vector<glm::vec4>& image)
+{
+    Device&        device         = m_Devices[deviceIndex];
+    RenderContext* pRenderContext = device.pRenderContext;
+
+    const uint32_t tileCountX = (frameConstants.imageSize.x + kTileSize - 1U) / kTileSize;
+
+    std::vector<uint32_t> tileIndices;
+    uint32_t              tileCount = 0U;
+
+    while (true)
+    {
+        m_Scheduler.Pop(deviceIndex, kTileBatchSize, tileIndices);
+
+        if (tileIndices.empty())
+            return tileCount;
+
+        // Record the batch.
+        // ------------------------------------------------
+
+        VkCommandBufferBeginInfo commandBeginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+        {
+            commandBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        }
+        Check(vkBeginCommandBuffer(device.commandBuffer, &commandBeginInfo), "Failed to begin recording commands");
+
+        vkCmdBindPipeline(device.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, device.pipeline);
+        vkCmdBindDescriptorSets(device.commandBuffer,
+                                VK_PIPELINE_BIND_POINT_COMPUTE,
+                                device.pipelineLayout,
+                                0U,
+                                1U,
+                                &device.descriptorSet,
+                                0U,
+                                nullptr);
+
+        for (uint32_t tileSlot = 0U; tileSlot < tileIndices.size(); tileSlot++)
+        {
+            TileTraceConstants tileConstants = frameConstants;
+            {
+                tileConstants.tileOrigin = glm::uvec2(tileIndices[tileSlot] % tileCountX, tileIndices[tileSlot] / tileCountX) * kTileSize;
+                tileConstants.tileSlot   = tileSlot;
+            }
+
+            vkCmdPushConstants(device.commandBuffer,
+                               device.pipelineLayout,
+                               VK_SHADER_STAGE_COMPUTE_BIT,
+                               0U,
+                               sizeof(TileTraceConstants),
+                               &tileConstants);
+            vkCmdDispatch(device.commandBuffer, kTileSize / 8U, kTileSize / 8U, 1U);
+        }
+
+        VulkanMemoryBarrier(device.commandBuffer,
+                            VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                            VK_ACCESS_2_HOST_READ_BIT,
+                            VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                            VK_PIPELINE_STAGE_2_HOST_BIT);
+
+        Check(vkEndCommandBuffer(device.commandBuffer), "Failed to end recording commands");
+
+        VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+        {
+            submitInfo.commandBufferCount = 1U;
+            submitInfo.pCommandBuffers    = &device.commandBuffer;
+        }
+
+        {
+            std::lock_guard<std::mutex> commandQueueLock(pRenderContext->GetCommandQueueMutex());
+
+            Check(vkQueueSubmit(pRenderContext->GetCommandQueue(), 1U, &submitInfo, device.fence), "Failed to submit the tile batch.");
+        }
+
+        Check(vkWaitForFences(pRenderContext->GetDevice(), 1U, &device.fence, VK_TRUE, UINT64_MAX), "Failed to wait for the tile batch.");
+        Check(vkResetFences(pRenderContext->GetDevice(), 1U, &device.fence), "Failed to reset the tile batch fence.");
+
+        // Compose, tiles never overlap so the devices write the image without a lock.
+        // ------------------------------------------------
+
+        vmaInvalidateAllocation(pRenderContext->GetAllocator(), device.outputBuffer.bufferAllocation, 0U, VK_WHOLE_SIZE);
+
+        for (uint32_t tileSlot = 0U; tileSlot < tileIndices.size(); tileSlot++)
+        {
+            const uint32_t originX = (tileIndices[tileSlot] % tileCountX) * kTileSize;
+            const uint32_t originY = (tileIndices[tileSlot] / tileCountX) * kTileSize;
+
+            const uint32_t rowLength = std::min(kTileSize, frameConstants.imageSize.x - originX);
+            const uint32_t rowCount  = std::min(kTileSize, frameConstants.imageSize.y - originY);
+
+            const glm::vec4* pTile = device.pOutput + static_cast<size_t>(tileSlot) * kTileSize * kTileSize; // NOLINT
+
+            for (uint32_t row = 0U; row < rowCount; row++)
+            {
+                std::copy_n(pTile + static_cast<size_t>(row) * kTileSize, // NOLINT
+                            rowLength,
+                            image.begin() + static_cast<ptrdiff_t>(static_cast<size_t>(originY + row) * frameConstants.imageSize.x + originX));
+            }
+        }
+
+        tileCount += static_cast<uint32_t>(tileIndices.size());
+    }
+}
+
+void TileRenderer::Resolve(const std::vector<glm::vec4>& image, uint32_t width, uint32_t height, bool tonemap, ImageRGB8& output)
+{
+    // Narkowicz's ACES fit and the sRGB encoding, as in Shaders/Tonemap.hlsl (at unit exposure).
+    auto Encode = [tonemap](float x)
+    {
+        if (!tonemap)
+            return x;
+
+        x = std::clamp((x * (2.51F * x + 0.03F)) / (x * (2.43F * x + 0.59F) + 0.14F), 0.0F, 1.0F);
+
+        return x <= 0.0031308F ? 12.92F * x : 1.055F * std::pow(x, 1.0F / 2.4F) - 0.055F;
+    };
+
+    output.Resize(width, height);
+
+    for (uint32_t y = 0U; y < height; y++)
+    {
+        for (uint32_t x = 0U; x < width; x++)
+        {
+            const glm::vec4& color  = image[static_cast<size_t>(y) * width + x];
+            uint8_t*         pPixel = output.GetPixel(x, y);
+
+            pPixel[0] = QuantizeUNORM8(Encode(color.r)); // NOLINT
+            pPixel[1] = QuantizeUNORM8(Encode(color.g)); // NOLINT
+            pPixel[2] = QuantizeUNORM8(Encode(color.b)); // NOLINT
+        }
+    }
+}
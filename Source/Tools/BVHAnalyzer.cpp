@@ -0,0 +1,148 @@
+#include <Common.h>
+#include <Scene.h>
+#include <BVH.h>
+
+// Offline analysis of the scene acceleration structures, using a reference binned-SAH BVH over the same
+// triangles the BLAS is built from and the same instance bounds the TLAS is built from. Needs no GPU.
+//
+// Usage: BVHAnalyzer [mesh.obj] [instance_points.obj]
+// ---------------------------------------------------------
+
+void LogHistogram(const char* label, const std::vector<uint32_t>& histogram)
+{
+    const uint32_t maxCount = histogram.empty() ? 0U : *std::max_element(histogram.begin(), histogram.end());
+
+    spdlog::info("  {}:", label);
+
+    for (uint32_t bucket = 0U; bucket < histogram.size(); bucket++)
+    {
+        if (histogram[bucket] == 0U)
+            continue;
+
+        const auto barLength = static_cast<size_t>(40U * histogram[bucket] / std::max(maxCount, 1U));
+
+        spdlog::info("    {:>4} | {:>6} {}", bucket, histogram[bucket], std::string(barLength, '#'));
+    }
+}
+
+void LogStatistics(const char* label, const BVH& bvh)
+{
+    const BVHStatistics statistics = ComputeBVHStatistics(bvh);
+
+    spdlog::info("{}", label);
+    spdlog::info("  Nodes:                   {} ({} leaves)", statistics.nodeCount, statistics.leafCount);
+    spdlog::info("  SAH Cost:                {:.3f}", statistics.sahCost);
+    spdlog::info("  Sibling Overlap (root):  {:.3f}", statistics.siblingOverlap);
+    spdlog::info("  Sibling Overlap (mean):  {:.1f}%", 100.0F * statistics.averageSiblingOverlap);
+    spdlog::info("  Leaf Depth (mean / max): {:.2f} / {}", statistics.averageDepth, statistics.maxDepth);
+    spdlog::info("  Leaf Size (mean):        {:.2f}", statistics.averageLeafSize);
+
+    LogHistogram("Leaf Depth Histogram", statistics.depthHistogram);
+    LogHistogram("Leaf Size Histogram", statistics.leafSizeHistogram);
+}
+
+int main(int argc, char** argv)
+{
+    const char* meshPath   = argc > 1 ? argv[1] : "..\\Assets\\bunny_low.obj";
+    const char* pointsPath = argc > 2 ? argv[2] : "..\\Assets\\instance_transforms.obj";
+
+    spdlog::set_pattern("%v");
+
+    // Load the scene exactly as the renderer does.
+    // ------------------------------------------------
+
+    std::vector<Vertex>   meshVertices;
+    std::vector<uint32_t> meshIndices;
+    if (!LoadMesh(meshPath, meshVertices, meshIndices))
+        return 1;
+
+    std::vector<Vertex> instancePoints;
+    if (!LoadPoints(pointsPath, instancePoints))
+        return 1;
+
+    // Bottom level (triangles of the mesh).
+    // ------------------------------------------------
+
+    std::vector<AABB> triangleBounds(meshIndices.size() / 3U);
+
+    AABB meshBounds;
+
+    for (uint32_t triangleIndex = 0U; triangleIndex < triangleBounds.size(); triangleIndex++)
+    {
+        for (uint32_t corner = 0U; corner < 3U; corner++)
+            triangleBounds[triangleIndex].Grow(meshVertices[meshIndices[3U * triangleIndex + corner]].positionOS);
+
+        meshBounds.Grow(triangleBounds[triangleIndex]);
+    }
+
+    BVH blas;
+    BuildBVH(triangleBounds, blas);
+
+    LogStatistics(std::format("BLAS ({} triangles)", triangleBounds.size()).c_str(), blas);
+
+    // Top level (instance bounds, as seen by the TLAS build).
+    // ------------------------------------------------
+
+    std::vector<AABB> instanceBounds;
+
+    for (const auto& point : instancePoints)
+        instanceBounds.push_back(TransformAABB(meshBounds, ComputeInstanceTransform(point)));
+
+    BVH tlas;
+    BuildBVH(instanceBounds, tlas, 1U);
+
+    LogStatistics(std::format("TLAS ({} instances)", instanceBounds.size()).c_str(), tlas);
+
+    // Per-instance overlap: every overlapping neighbour is another BLAS a ray through this instance may
+    // have to traverse.
+    // ------------------------------------------------
+
+    std::vector<uint32_t> overlaps;
+    std::vector<uint32_t> neighbourHistogram;
+
+    uint64_t neighbourSum       = 0U;
+    uint32_t neighbourMax       = 0U;
+    uint32_t overlappingCount   = 0U;
+    double   overlapFractionSum = 0.0;
+
+    for (uint32_t instanceIndex = 0U; instanceIndex < instanceBounds.size(); instanceIndex++)
+    {
+        QueryBVHOverlaps(tlas, instanceBounds, instanceBounds[instanceIndex], overlaps);
+
+        // Fraction of this instance volume covered by its neighbours (can exceed 1 when they stack up).
+        double overlapFraction = 0.0;
+
+        for (const auto neighbourIndex : overlaps)
+        {
+            if (neighbourIndex != instanceIndex)
+                overlapFraction += IntersectAABB(instanceBounds[instanceIndex], instanceBounds[neighbourIndex]).Volume();
+        }
+
+        overlapFraction /= std::max(instanceBounds[instanceIndex].Volume(), FLT_MIN);
+
+        const auto neighbourCount = static_cast<uint32_t>(overlaps.size()) - 1U;
+
+        if (neighbourHistogram.size() <= neighbourCount)
+            neighbourHistogram.resize(neighbourCount + 1U, 0U);
+
+        neighbourHistogram[neighbourCount]++;
+
+        neighbourSum += neighbourCount;
+        neighbourMax = std::max(neighbourMax, neighbourCount);
+        overlapFractionSum += overlapFraction;
+
+        if (neighbourCount > 0U)
+            overlappingCount++;
+    }
+
+    const auto instanceCount = static_cast<double>(std::max<size_t>(instanceBounds.size(), 1U));
+
+    spdlog::info("TLAS Instance Overlap");
+    spdlog::info("  Overlapping Instances:   {} / {}", overlappingCount, instanceBounds.size());
+    spdlog::info("  Neighbours (mean / max): {:.2f} / {}", static_cast<double>(neighbourSum) / instanceCount, neighbourMax);
+    spdlog::info("  Covered Volume (mean):   {:.1f}%", 100.0 * overlapFractionSum / instanceCount);
+
+    LogHistogram("Neighbour Count Histogram", neighbourHistogram);
+
+    return 0;
+}
@@ -0,0 +1,311 @@
+#include <Common.h>
+#include <ImageIO.h>
+
+// Runs the headless renderer over sweeps of the scene size and image configuration, and collects the JSON
+// results of every run into a single file to track performance across commits. Each sweep varies one parameter
+// about the baseline configuration, so every run differs from the baseline in exactly one dimension (host BLAS
+// build and deformation runs pair up with the runs of the subdivision sweep instead, and sparse trace runs with a
+// full-rate run along the same camera path, whose capture they are diffed with).
+//
+// Usage: Benchmark [--app path] [--output results.json] [--label name] [--frames N] [--warmup N] [--quick]
+// ---------------------------------------------------------
+
+struct BenchmarkRun
+{
+    std::string name;
+    uint32_t    width         = 1920U;
+    uint32_t    height        = 1080U;
+    uint32_t    instanceCount = 1000U;
+    uint32_t    subdivisions  = 0U;
+    uint32_t    spp           = 1U;
+    bool        hostBLAS      = false;
+    uint32_t    sparseTrace   = 0U;
+    bool        deform        = false;
+    bool        cameraPath    = false; // Moves along the orbit from the fixed time, and captures the last frame.
+};
+
+const std::array<const char*, 3> kSparseTraceNames = { "full", "checkerboard", "interleaved" };
+
+// Fixed camera time, so every run traces the same view.
+const float kBenchmarkCameraTime = 2.0F;
+
+std::vector<BenchmarkRun> BuildSweeps(bool quick)
+{
+    const BenchmarkRun baseline = { "baseline" };
+
+    std::vector<BenchmarkRun> runs = { baseline };
+
+    auto Sweep = [&](const char* parameterName, const std::vector<uint32_t>& values, auto applyValue)
+    {
+        for (const auto value : values)
+        {
+            BenchmarkRun run = baseline;
+            applyValue(run, value);
+
+            run.name = std::format("{}={}", parameterName, value);
+            runs.push_back(run);
+        }
+    };
+
+    Sweep("instances", quick ? std::vector<uint32_t> { 4000U } : std::vector<uint32_t> { 4000U, 16000U, 64000U }, [](BenchmarkRun& run, uint32_t value) { run.instanceCount = value; });
+    Sweep("subdivisions", quick ? std::vector<uint32_t> { 1U } : std::vector<uint32_t> { 1U, 2U }, [](BenchmarkRun& run, uint32_t value) { run.subdivisions = value; });
+    Sweep("spp", quick ? std::vector<uint32_t> { 4U } : std::vector<uint32_t> { 4U, 16U }, [](BenchmarkRun& run, uint32_t value) { run.spp = value; });
+
+    // Resolution sweeps are keyed by height.
+    const std::vector<std::pair<uint32_t, uint32_t>> resolutions = { { 1280U, 720U }, { 2560U, 1440U }, { 3840U, 2160U } };
+
+    for (const auto& [width, height] : resolutions)
+    {
+        if (quick && height != 720U)
+            continue;
+
+        BenchmarkRun run = baseline;
+        {
+            run.name   = std::format("resolution={}x{}", width, height);
+            run.width  = width;
+            run.height = height;
+        }
+        runs.push_back(run);
+    }
+
+    // Host BLAS builds over the mesh sizes, to compare against the device builds of the subdivision sweep.
+    for (const auto subdivisions : quick ? std::vector<uint32_t> { 0U } : std::vector<uint32_t> { 0U, 1U, 2U })
+    {
+        BenchmarkRun run = baseline;
+        {
+            run.name         = std::format("host-blas subdivisions={}", subdivisions);
+            run.subdivisions = subdivisions;
+            run.hostBLAS     = true;
+        }
+        runs.push_back(run);
+    }
+
+    // Deformed full detail mesh over the mesh sizes, its BLAS refit and rebuild timings scale with the triangle count.
+    for (const auto subdivisions : quick ? std::vector<uint32_t> { 0U } : std::vector<uint32_t> { 0U, 1U, 2U })
+    {
+        BenchmarkRun run = baseline;
+        {
+            run.name         = std::format("deform subdivisions={}", subdivisions);
+            run.subdivisions = subdivisions;
+            run.deform       = true;
+        }
+        runs.push_back(run);
+    }
+
+    // Sparse primary visibility against full-rate tracing, with a moving camera so the reconstruction is measured on
+    // reprojected history rather than a still image. The full-rate run comes first, it is the reference capture.
+    for (uint32_t sparseTrace = 0U; sparseTrace < kSparseTraceNames.size(); sparseTrace++)
+    {
+        BenchmarkRun run = baseline;
+        {
+            run.name        = std::format("sparse-trace={}", kSparseTraceNames[sparseTrace]);
+            run.sparseTrace = sparseTrace;
+            run.cameraPath  = true;
+        }
+        runs.push_back(run);
+    }
+
+    return runs;
+}
+
+bool ReadTextFile(const std::filesystem::path& filePath, std::string& text)
+{
+    std::ifstream file(filePath);
+
+    if (!file.is_open())
+        return false;
+
+    std::stringstream stream;
+    stream << file.rdbuf();
+
+    text = stream.str();
+    return true;
+}
+
+// Per-channel error of a capture against the reference, PSNR capped at 100 dB for identical images.
+bool CompareCaptures(const std::filesystem::path& referencePath, const std::filesystem::path& capturePath, double& meanAbsoluteError, double& psnr)
+{
+    ImageRGB8 reference;
+    ImageRGB8 capture;
+
+    if (!ReadPPM(referencePath.string().c_str(), reference) || !ReadPPM(capturePath.string().c_str(), capture))
+        return false;
+
+    if (reference.width != capture.width || reference.height != capture.height || reference.pixels.empty())
+        return false;
+
+    double absoluteErrorSum = 0.0;
+    double squaredErrorSum  = 0.0;
+
+    for (size_t i = 0U; i < reference.pixels.size(); i++)
+    {
+        const double error = static_cast<double>(reference.pixels[i]) - static_cast<double>(capture.pixels[i]);
+
+        absoluteErrorSum += std::abs(error);
+        squaredErrorSum  += error * error;
+    }
+
+    const double channelCount = static_cast<double>(reference.pixels.size());
+
+    meanAbsoluteError = absoluteErrorSum / channelCount;
+
+    const double meanSquaredError = squaredErrorSum / channelCount;
+
+    psnr = meanSquaredError > 0.0 ? std::min(10.0 * std::log10(255.0 * 255.0 / meanSquaredError), 100.0) : 100.0;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    std::string appPath    = (std::filesystem::path(argv[0]).parent_path() / "Vulkan-Raytracing-Shader-Objects").string();
+    std::string outputPath = "benchmark.json";
+    std::string label;
+    uint32_t    frameCount  = 256U;
+    uint32_t    warmupCount = 16U;
+    bool        quick       = false;
+
+    spdlog::set_pattern("%v");
+
+    for (int argIndex = 1; argIndex < argc; argIndex++)
+    {
+        const std::string arg = argv[argIndex];
+
+        if (arg == "--quick")
+            quick = true;
+        else if (argIndex + 1 >= argc)
+        {
+            spdlog::error("Missing value for argument {}.", arg);
+            return 1;
+        }
+        else if (arg == "--app")
+            appPath = argv[++argIndex];
+        else if (arg == "--output")
+            outputPath = argv[++argIndex];
+        else if (arg == "--label")
+            label = argv[++argIndex];
+        else if (arg == "--frames")
+            frameCount = static_cast<uint32_t>(std::strtoul(argv[++argIndex], nullptr, 10));
+        else if (arg == "--warmup")
+            warmupCount = static_cast<uint32_t>(std::strtoul(argv[++argIndex], nullptr, 10));
+        else
+        {
+            spdlog::error("Unknown argument {}.", arg);
+            return 1;
+        }
+    }
+
+    const std::filesystem::path runDirectory = std::filesystem::temp_directory_path() / "VulkanRaytracingBenchmark";
+    std::filesystem::create_directories(runDirectory);
+
+    // Run every configuration in its own process, so startup phases are measured cold each time.
+    // ------------------------------------------------
+
+    const std::vector<BenchmarkRun> runs = BuildSweeps(quick);
+
+    struct RunResults
+    {
+        std::string name;
+        std::string results;
+        std::string imageError; // Sparse trace runs, against the full-rate capture.
+    };
+
+    std::vector<RunResults> results;
+
+    std::filesystem::path fullRateCapturePath;
+
+    uint32_t failedRunCount = 0U;
+
+    for (uint32_t runIndex = 0U; runIndex < runs.size(); runIndex++)
+    {
+        const BenchmarkRun& run = runs[runIndex];
+
+        const std::filesystem::path resultsPath = runDirectory / std::format("run{}.json", runIndex);
+        const std::filesystem::path capturePath = runDirectory / std::format("run{}.ppm", runIndex);
+        std::filesystem::remove(resultsPath);
+        std::filesystem::remove(capturePath);
+
+        const std::string captureArguments = run.cameraPath ? std::format(" --camera-path --capture \"{}\"", capturePath.string()) : "";
+
+        const std::string command = std::format("\"{}\" --headless --width {} --height {} --instances {} --subdivisions {} --spp {} "
+                                                "--sparse-trace {} --frames {} --warmup {} --camera-time {} --no-cache{}{}{} --results \"{}\"",
+                                                appPath,
+                                                run.width,
+                                                run.height,
+                                                run.instanceCount,
+                                                run.subdivisions,
+                                                run.spp,
+                                                run.sparseTrace,
+                                                warmupCount + frameCount,
+                                                warmupCount,
+                                                kBenchmarkCameraTime,
+                                                run.hostBLAS ? " --host-blas" : "",
+                                                run.deform ? " --deform" : "",
+                                                captureArguments,
+                                                resultsPath.string());
+
+        spdlog::info("[{}/{}] {}", runIndex + 1U, runs.size(), run.name);
+
+        std::string runResults;
+
+        if (std::system(command.c_str()) != 0 || !ReadTextFile(resultsPath, runResults))
+        {
+            spdlog::error("  Run failed: {}", command);
+            failedRunCount++;
+            continue;
+        }
+
+        std::string imageError;
+
+        if (run.cameraPath && run.sparseTrace == 0U)
+            fullRateCapturePath = capturePath;
+        else if (run.cameraPath && !fullRateCapturePath.empty())
+        {
+            double meanAbsoluteError = 0.0;
+            double psnr              = 0.0;
+
+            if (CompareCaptures(fullRateCapturePath, capturePath, meanAbsoluteError, psnr))
+            {
+                spdlog::info("  Against full-rate tracing: mean error {:.3f}, PSNR {:.2f} dB", meanAbsoluteError, psnr);
+
+                imageError = std::format("{{ \"meanAbsolute\": {:.4f}, \"psnr\": {:.4f} }}", meanAbsoluteError, psnr);
+            }
+            else
+                spdlog::warn("  Failed to compare the capture against the full-rate one.");
+        }
+
+        results.push_back({ run.name, runResults, imageError });
+    }
+
+    // Combine the per-run results.
+    // ------------------------------------------------
+
+    std::ofstream file(outputPath);
+
+    if (!file.is_open())
+    {
+        spdlog::error("Failed to open {} for writing.", outputPath);
+        return 1;
+    }
+
+    file << "{\n";
+    file << std::format("  \"label\": \"{}\",\n", label);
+    file << "  \"runs\": [";
+
+    for (size_t resultIndex = 0U; resultIndex < results.size(); resultIndex++)
+    {
+        const auto& [runName, runResults, imageError] = results[resultIndex];
+
+        file << std::format("{}\n    {{ \"name\": \"{}\", \"results\": {}", resultIndex > 0U ? "," : "", runName, runResults);
+
+        if (!imageError.empty())
+            file << std::format(", \"imageError\": {}", imageError);
+
+        file << " }";
+    }
+
+    file << "\n  ]\n}\n";
+
+    spdlog::info("Wrote {} of {} runs to {}.", results.size(), runs.size(), outputPath);
+
+    return failedRunCount > 0U ? 1 : 0;
+}
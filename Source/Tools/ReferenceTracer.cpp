@@ -0,0 +1,626 @@
+#include <Common.h>
+#include <Scene.h>
+#include <BVH.h>
+#include <ImageIO.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define REFERENCE_TRACER_SSE
+#include <emmintrin.h>
+#endif
+
+// CPU reference of the primary trace (RayGen.hlsl, ClosestHit.hlsl and Miss.hlsl): barycentric color on hit and
+// (0, 0, 0.2) on miss, seen from the orbit camera. Traces 2x2 pixel packets (SSE, with a scalar fallback) through
+// a two-level BVH mirroring the BLAS / TLAS, on all hardware threads.
+//
+// Usage: ReferenceTracer [--width N] [--height N] [--time seconds] [--threads N] [--iterations N]
+//                        [--mesh mesh.obj] [--points instance_points.obj] [--output reference.ppm]
+//                        [--diff gpu.ppm] [--diff-output diff.ppm] [--tolerance N] [--max-mismatch percent]
+// ---------------------------------------------------------
+
+const uint32_t kPacketSize = 4U;
+const uint32_t kTileSize   = 16U;
+
+// Traversal stack size, far deeper than the reference BVH builder produces for the demo assets.
+const uint32_t kTraversalStackSize = 256U;
+
+// Matches the RayDesc of RayGen.hlsl.
+const float kRayTMin = 0.001F;
+const float kRayTMax = 10000.0F;
+
+const glm::vec3 kMissColor = { 0.0F, 0.0F, 0.2F };
+
+struct TracerOptions
+{
+    uint32_t    width       = 1920U;
+    uint32_t    height      = 1080U;
+    float       time        = 0.0F;
+    uint32_t    threadCount = std::max(1U, std::thread::hardware_concurrency());
+    uint32_t    iterations  = 1U;
+    std::string meshPath    = "..\\Assets\\bunny_low.obj";
+    std::string pointsPath  = "..\\Assets\\instance_transforms.obj";
+    std::string outputPath  = "Reference.ppm";
+    std::string diffPath;
+    std::string diffOutputPath;
+
+    // Per-channel difference (8-bit units) above which a pixel counts as a mismatch. The GPU uses a watertight
+    // triangle test so silhouette pixels can legitimately differ.
+    uint32_t tolerance = 2U;
+
+    // Percentage of mismatching pixels above which the diff fails.
+    float maxMismatch = 0.5F;
+};
+
+// Two-level scene.
+// ---------------------------------------------------------
+
+struct Triangle
+{
+    glm::vec3 v0;
+    glm::vec3 edge1;
+    glm::vec3 edge2;
+};
+
+struct TracerScene
+{
+    BVH                   blas;
+    std::vector<Triangle> triangles;
+
+    BVH                    tlas;
+    std::vector<glm::mat4> worldToObject;
+};
+
+// Rays and hits of a 2x2 pixel packet, in SoA layout.
+// ---------------------------------------------------------
+
+struct alignas(16) RayPacket
+{
+    float origin[3][kPacketSize];
+    float direction[3][kPacketSize];
+    float inverseDirection[3][kPacketSize];
+};
+
+struct alignas(16) PacketHit
+{
+    float    t[kPacketSize];
+    float    u[kPacketSize];
+    float    v[kPacketSize];
+    uint32_t instance[kPacketSize];
+};
+
+// Lane-parallel primitives.
+// ---------------------------------------------------------
+
+// Returns the active lanes whose ray overlaps the bounds within [tMin, tHit).
+uint32_t IntersectBounds(const AABB& bounds, const RayPacket& rays, const PacketHit& hit, uint32_t activeMask)
+{
+#ifdef REFERENCE_TRACER_SSE
+    __m128 tEnter = _mm_set1_ps(kRayTMin);
+    __m128 tExit  = _mm_load_ps(hit.t);
+
+    for (uint32_t axis = 0U; axis < 3U; axis++)
+    {
+        const __m128 origin           = _mm_load_ps(rays.origin[axis]);
+        const __m128 inverseDirection = _mm_load_ps(rays.inverseDirection[axis]);
+
+        const __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bounds.min[axis]), origin), inverseDirection);
+        const __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bounds.max[axis]), origin), inverseDirection);
+
+        tEnter = _mm_max_ps(tEnter, _mm_min_ps(t0, t1));
+        tExit  = _mm_min_ps(tExit, _mm_max_ps(t0, t1));
+    }
+
+    return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(tEnter, tExit))) & activeMask;
+#else
+    uint32_t hitMask = 0U;
+
+    for (uint32_t lane = 0U; lane < kPacketSize; lane++)
+    {
+        float tEnter = kRayTMin;
+        float tExit  = hit.t[lane];
+
+        for (uint32_t axis = 0U; axis < 3U; axis++)
+        {
+            const float t0 = (bounds.min[axis] - rays.origin[axis][lane]) * rays.inverseDirection[axis][lane];
+            const float t1 = (bounds.max[axis] - rays.origin[axis][lane]) * rays.inverseDirection[axis][lane];
+
+            tEnter = std::max(tEnter, std::min(t0, t1));
+            tExit  = std::min(tExit, std::max(t0, t1));
+        }
+
+        if (tEnter <= tExit)
+            hitMask |= 1U << lane;
+    }
+
+    return hitMask & activeMask;
+#endif
+}
+
+// Moller-Trumbore, returns the active lanes for which the triangle is the new closest hit (hit is updated).
+uint32_t IntersectTriangle(const Triangle& triangle, const RayPacket& rays, PacketHit& hit, uint32_t activeMask)
+{
+#ifdef REFERENCE_TRACER_SSE
+    const __m128 e1x = _mm_set1_ps(triangle.edge1.x), e1y = _mm_set1_ps(triangle.edge1.y), e1z = _mm_set1_ps(triangle.edge1.z);
+    const __m128 e2x = _mm_set1_ps(triangle.edge2.x), e2y = _mm_set1_ps(triangle.edge2.y), e2z = _mm_set1_ps(triangle.edge2.z);
+
+    const __m128 dx = _mm_load_ps(rays.direction[0]), dy = _mm_load_ps(rays.direction[1]), dz = _mm_load_ps(rays.direction[2]);
+
+    // p = cross(d, e2)
+    const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+    const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+    const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+
+    const __m128 determinant        = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+    const __m128 inverseDeterminant = _mm_div_ps(_mm_set1_ps(1.0F), determinant);
+
+    // s = o - v0
+    const __m128 sx = _mm_sub_ps(_mm_load_ps(rays.origin[0]), _mm_set1_ps(triangle.v0.x));
+    const __m128 sy = _mm_sub_ps(_mm_load_ps(rays.origin[1]), _mm_set1_ps(triangle.v0.y));
+    const __m128 sz = _mm_sub_ps(_mm_load_ps(rays.origin[2]), _mm_set1_ps(triangle.v0.z));
+
+    const __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inverseDeterminant);
+
+    // q = cross(s, e1)
+    const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+    const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+    const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+
+    const __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inverseDeterminant);
+    const __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inverseDeterminant);
+
+    const __m128 zero = _mm_setzero_ps();
+
+    // Comparisons against NaN (parallel rays) fail, which rejects them.
+    __m128 valid = _mm_cmpneq_ps(determinant, zero);
+    valid        = _mm_and_ps(valid, _mm_cmpge_ps(u, zero));
+    valid        = _mm_and_ps(valid, _mm_cmpge_ps(v, zero));
+    valid        = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0F)));
+    valid        = _mm_and_ps(valid, _mm_cmpgt_ps(t, _mm_set1_ps(kRayTMin)));
+    valid        = _mm_and_ps(valid, _mm_cmplt_ps(t, _mm_load_ps(hit.t)));
+
+    const uint32_t hitMask = static_cast<uint32_t>(_mm_movemask_ps(valid)) & activeMask;
+
+    if (hitMask == 0U)
+        return 0U;
+
+    const __m128 laneMask = _mm_castsi128_ps(_mm_set_epi32((hitMask & 8U) ? -1 : 0, (hitMask & 4U) ? -1 : 0, (hitMask & 2U) ? -1 : 0, (hitMask & 1U) ? -1 : 0));
+
+    auto Select = [&](const __m128 newValue, float* pValue)
+    {
+        _mm_store_ps(pValue, _mm_or_ps(_mm_and_ps(laneMask, newValue), _mm_andnot_ps(laneMask, _mm_load_ps(pValue))));
+    };
+
+    Select(t, hit.t);
+    Select(u, hit.u);
+    Select(v, hit.v);
+
+    return hitMask;
+#else
+    uint32_t hitMask = 0U;
+
+    for (uint32_t lane = 0U; lane < kPacketSize; lane++)
+    {
+        if ((activeMask & (1U << lane)) == 0U)
+            continue;
+
+        const glm::vec3 origin(rays.origin[0][lane], rays.origin[1][lane], rays.origin[2][lane]);
+        const glm::vec3 direction(rays.direction[0][lane], rays.direction[1][lane], rays.direction[2][lane]);
+
+        const glm::vec3 p           = glm::cross(direction, triangle.edge2);
+        const float     determinant = glm::dot(triangle.edge1, p);
+
+        if (determinant == 0.0F)
+            continue;
+
+        const float     inverseDeterminant = 1.0F / determinant;
+        const glm::vec3 s                  = origin - triangle.v0;
+        const float     u                  = glm::dot(s, p) * inverseDeterminant;
+        const glm::vec3 q                  = glm::cross(s, triangle.edge1);
+        const float     v                  = glm::dot(direction, q) * inverseDeterminant;
+        const float     t                  = glm::dot(triangle.edge2, q) * inverseDeterminant;
+
+        if (u < 0.0F || v < 0.0F || u + v > 1.0F || t <= kRayTMin || t >= hit.t[lane])
+            continue;
+
+        hit.t[lane] = t;
+        hit.u[lane] = u;
+        hit.v[lane] = v;
+
+        hitMask |= 1U << lane;
+    }
+
+    return hitMask;
+#endif
+}
+
+// Packet traversal.
+// ---------------------------------------------------------
+
+template <typename LeafFunc> void TraverseBVH(const BVH& bvh, const RayPacket& rays, PacketHit& hit, uint32_t activeMask, LeafFunc&& leafFunc)
+{
+    std::array<uint32_t, kTraversalStackSize> nodeStack;
+
+    uint32_t stackSize = 0U;
+
+    nodeStack[stackSize++] = 0U;
+
+    while (stackSize > 0U)
+    {
+        const BVHNode& node = bvh.nodes[nodeStack[--stackSize]];
+
+        // Re-tested on pop since closer hits may have been found after the push.
+        const uint32_t nodeMask = IntersectBounds(node.bounds, rays, hit, activeMask);
+
+        if (nodeMask == 0U)
+            continue;
+
+        if (node.IsLeaf())
+        {
+            for (uint32_t i = node.leftFirst; i < node.leftFirst + node.primitiveCount; i++)
+                leafFunc(bvh.primitiveIndices[i], nodeMask);
+
+            continue;
+        }
+
+        // Visit the child nearest along the direction of the first active ray first.
+        const uint32_t  lane = static_cast<uint32_t>(std::countr_zero(nodeMask));
+        const glm::vec3 direction(rays.direction[0][lane], rays.direction[1][lane], rays.direction[2][lane]);
+
+        const glm::vec3 childOffset = bvh.nodes[node.leftFirst + 1U].bounds.Centroid() - bvh.nodes[node.leftFirst].bounds.Centroid();
+
+        const bool leftFirst = glm::dot(childOffset, direction) > 0.0F;
+
+        Check(stackSize + 2U <= kTraversalStackSize, "Reference tracer traversal stack overflow.");
+
+        nodeStack[stackSize++] = leftFirst ? node.leftFirst + 1U : node.leftFirst;
+        nodeStack[stackSize++] = leftFirst ? node.leftFirst : node.leftFirst + 1U;
+    }
+}
+
+void TracePacket(const TracerScene& scene, const RayPacket& worldRays, PacketHit& hit, uint32_t activeMask)
+{
+    for (uint32_t lane = 0U; lane < kPacketSize; lane++)
+    {
+        hit.t[lane]        = kRayTMax;
+        hit.u[lane]        = 0.0F;
+        hit.v[lane]        = 0.0F;
+        hit.instance[lane] = UINT_MAX;
+    }
+
+    TraverseBVH(scene.tlas,
+                worldRays,
+                hit,
+                activeMask,
+                [&](uint32_t instanceIndex, uint32_t instanceMask)
+                {
+                    // Object space rays. Directions are not renormalized, so hit distances stay in world space
+                    // (as RayTCurrent() does).
+                    const glm::mat4& worldToObject = scene.worldToObject[instanceIndex];
+
+                    RayPacket objectRays;
+
+                    for (uint32_t lane = 0U; lane < kPacketSize; lane++)
+                    {
+                        const glm::vec3 origin(worldToObject * glm::vec4(worldRays.origin[0][lane], worldRays.origin[1][lane], worldRays.origin[2][lane], 1.0F));
+                        const glm::vec3 direction(
+                            worldToObject * glm::vec4(worldRays.direction[0][lane], worldRays.direction[1][lane], worldRays.direction[2][lane], 0.0F));
+
+                        for (uint32_t axis = 0U; axis < 3U; axis++)
+                        {
+                            objectRays.origin[axis][lane]           = origin[axis];
+                            objectRays.direction[axis][lane]        = direction[axis];
+                            objectRays.inverseDirection[axis][lane] = 1.0F / direction[axis];
+                        }
+                    }
+
+                    TraverseBVH(scene.blas,
+                                objectRays,
+                                hit,
+                                instanceMask,
+                                [&](uint32_t triangleIndex, uint32_t triangleMask)
+                                {
+                                    uint32_t hitMask = IntersectTriangle(scene.triangles[triangleIndex], objectRays, hit, triangleMask);
+
+                                    for (; hitMask != 0U; hitMask &= hitMask - 1U)
+                                        hit.instance[std::countr_zero(hitMask)] = instanceIndex;
+                                });
+                });
+}
+
+// Rendering.
+// ---------------------------------------------------------
+
+void RenderImage(const TracerScene& scene, const TracerOptions& options, const glm::mat4& inverseMatrixV, const glm::mat4& inverseMatrixP, ImageRGB8& image)
+{
+    const uint32_t tileCountX = (options.width + kTileSize - 1U) / kTileSize;
+    const uint32_t tileCountY = (options.height + kTileSize - 1U) / kTileSize;
+    const uint32_t tileCount  = tileCountX * tileCountY;
+
+    const glm::vec3 rayOrigin(inverseMatrixV * glm::vec4(0, 0, 0, 1));
+
+    std::atomic<uint32_t> nextTile = 0U;
+
+    auto Worker = [&]()
+    {
+        for (uint32_t tileIndex = nextTile++; tileIndex < tileCount; tileIndex = nextTile++)
+        {
+            const uint32_t tileX = (tileIndex % tileCountX) * kTileSize;
+            const uint32_t tileY = (tileIndex / tileCountX) * kTileSize;
+
+            for (uint32_t quadY = tileY; quadY < std::min(tileY + kTileSize, options.height); quadY += 2U)
+            {
+                for (uint32_t quadX = tileX; quadX < std::min(tileX + kTileSize, options.width); quadX += 2U)
+                {
+                    RayPacket rays;
+                    PacketHit hit;
+
+                    uint32_t activeMask = 0U;
+
+                    // Same ray setup as RayGen.hlsl.
+                    for (uint32_t lane = 0U; lane < kPacketSize; lane++)
+                    {
+                        const uint32_t x = std::min(quadX + (lane & 1U), options.width - 1U);
+                        const uint32_t y = std::min(quadY + (lane >> 1U), options.height - 1U);
+
+                        if (x == quadX + (lane & 1U) && y == quadY + (lane >> 1U))
+                            activeMask |= 1U << lane;
+
+                        const glm::vec2 uv     = (glm::vec2(x, y) + 0.5F) / glm::vec2(options.width, options.height);
+                        const glm::vec2 d      = uv * 2.0F - 1.0F;
+                        const glm::vec4 target = inverseMatrixP * glm::vec4(d.x, d.y, 1.0F, 1.0F);
+
+                        const glm::vec3 direction(inverseMatrixV * glm::vec4(glm::normalize(glm::vec3(target)), 0.0F));
+
+                        for (uint32_t axis = 0U; axis < 3U; axis++)
+                        {
+                            rays.origin[axis][lane]           = rayOrigin[axis];
+                            rays.direction[axis][lane]        = direction[axis];
+                            rays.inverseDirection[axis][lane] = 1.0F / direction[axis];
+                        }
+                    }
+
+                    TracePacket(scene, rays, hit, activeMask);
+
+                    // Same shading as ClosestHit.hlsl / Miss.hlsl.
+                    for (uint32_t lane = 0U; lane < kPacketSize; lane++)
+                    {
+                        if ((activeMask & (1U << lane)) == 0U)
+                            continue;
+
+                        const glm::vec3 color =
+                            hit.instance[lane] != UINT_MAX ? glm::vec3(1.0F - hit.u[lane] - hit.v[lane], hit.u[lane], hit.v[lane]) : kMissColor;
+
+                        uint8_t* pPixel = image.GetPixel(quadX + (lane & 1U), quadY + (lane >> 1U));
+
+                        for (uint32_t channel = 0U; channel < 3U; channel++)
+                            pPixel[channel] = QuantizeUNORM8(color[channel]);
+                    }
+                }
+            }
+        }
+    };
+
+    std::vector<std::jthread> workers;
+
+    for (uint32_t workerIndex = 1U; workerIndex < options.threadCount; workerIndex++)
+        workers.emplace_back(Worker);
+
+    Worker();
+}
+
+// Compares against a GPU capture, returns false if too many pixels mismatch.
+bool DiffImages(const ImageRGB8& reference, const TracerOptions& options)
+{
+    ImageRGB8 capture;
+    if (!ReadPPM(options.diffPath.c_str(), capture))
+        return false;
+
+    if (capture.width != reference.width || capture.height != reference.height)
+    {
+        spdlog::error("Image size mismatch: reference {}x{}, capture {}x{}.", reference.width, reference.height, capture.width, capture.height);
+        return false;
+    }
+
+    ImageRGB8 diffImage;
+    diffImage.Resize(reference.width, reference.height);
+
+    uint64_t mismatchCount = 0U;
+    uint64_t errorSum      = 0U;
+    uint32_t errorMax      = 0U;
+
+    for (size_t i = 0U; i < reference.pixels.size(); i += 3U)
+    {
+        uint32_t pixelError = 0U;
+
+        for (uint32_t channel = 0U; channel < 3U; channel++)
+            pixelError = std::max(pixelError, static_cast<uint32_t>(std::abs(reference.pixels[i + channel] - capture.pixels[i + channel])));
+
+        errorSum += pixelError;
+        errorMax = std::max(errorMax, pixelError);
+
+        if (pixelError > options.tolerance)
+        {
+            mismatchCount++;
+            diffImage.pixels[i] = 255U;
+        }
+    }
+
+    const double pixelCount      = static_cast<double>(reference.width) * reference.height;
+    const double mismatchPercent = 100.0 * static_cast<double>(mismatchCount) / pixelCount;
+
+    spdlog::info("Diff: mean error {:.3f}, max error {}, {} mismatching pixels ({:.3f}%)",
+                 static_cast<double>(errorSum) / pixelCount,
+                 errorMax,
+                 mismatchCount,
+                 mismatchPercent);
+
+    if (!options.diffOutputPath.empty())
+        WritePPM(options.diffOutputPath.c_str(), diffImage);
+
+    return mismatchPercent <= options.maxMismatch;
+}
+
+bool ParseOptions(int argc, char** argv, TracerOptions& options)
+{
+    for (int argIndex = 1; argIndex < argc; argIndex++)
+    {
+        const std::string_view arg = argv[argIndex];
+
+        if (argIndex + 1 >= argc)
+        {
+            spdlog::error("Missing value for {}.", arg);
+            return false;
+        }
+
+        const char* value = argv[++argIndex];
+
+        if (arg == "--width")
+            options.width = static_cast<uint32_t>(std::stoul(value));
+        else if (arg == "--height")
+            options.height = static_cast<uint32_t>(std::stoul(value));
+        else if (arg == "--time")
+            options.time = std::stof(value);
+        else if (arg == "--threads")
+            options.threadCount = std::max(1U, static_cast<uint32_t>(std::stoul(value)));
+        else if (arg == "--iterations")
+            options.iterations = std::max(1U, static_cast<uint32_t>(std::stoul(value)));
+        else if (arg == "--mesh")
+            options.meshPath = value;
+        else if (arg == "--points")
+            options.pointsPath = value;
+        else if (arg == "--output")
+            options.outputPath = value;
+        else if (arg == "--diff")
+            options.diffPath = value;
+        else if (arg == "--diff-output")
+            options.diffOutputPath = value;
+        else if (arg == "--tolerance")
+            options.tolerance = static_cast<uint32_t>(std::stoul(value));
+        else if (arg == "--max-mismatch")
+            options.maxMismatch = std::stof(value);
+        else
+        {
+            spdlog::error("Unknown option {}.", arg);
+            return false;
+        }
+    }
+
+    return options.width > 0U && options.height > 0U;
+}
+
+int main(int argc, char** argv)
+{
+    spdlog::set_pattern("%v");
+
+    TracerOptions options;
+    if (!ParseOptions(argc, argv, options))
+        return 1;
+
+    // Load the scene exactly as the renderer does (LOD 0, every instance).
+    // ------------------------------------------------
+
+    std::vector<Vertex>   meshVertices;
+    std::vector<uint32_t> meshIndices;
+    if (!LoadMesh(options.meshPath.c_str(), meshVertices, meshIndices))
+        return 1;
+
+    std::vector<Vertex> instancePoints;
+    if (!LoadPoints(options.pointsPath.c_str(), instancePoints))
+        return 1;
+
+    TracerScene scene;
+
+    std::vector<AABB> triangleBounds;
+
+    AABB meshBounds;
+
+    for (uint32_t triangleIndex = 0U; triangleIndex < meshIndices.size() / 3U; triangleIndex++)
+    {
+        const glm::vec3& p0 = meshVertices[meshIndices[3U * triangleIndex + 0U]].positionOS;
+        const glm::vec3& p1 = meshVertices[meshIndices[3U * triangleIndex + 1U]].positionOS;
+        const glm::vec3& p2 = meshVertices[meshIndices[3U * triangleIndex + 2U]].positionOS;
+
+        scene.triangles.push_back({ p0, p1 - p0, p2 - p0 });
+
+        AABB bounds;
+        {
+            bounds.Grow(p0);
+            bounds.Grow(p1);
+            bounds.Grow(p2);
+        }
+        triangleBounds.push_back(bounds);
+
+        meshBounds.Grow(bounds);
+    }
+
+    BuildBVH(triangleBounds, scene.blas);
+
+    std::vector<AABB> instanceBounds;
+
+    for (const auto& point : instancePoints)
+    {
+        const glm::mat4 objectToWorld = ComputeInstanceTransform(point);
+
+        scene.worldToObject.push_back(glm::inverse(objectToWorld));
+        instanceBounds.push_back(TransformAABB(meshBounds, objectToWorld));
+    }
+
+    BuildBVH(instanceBounds, scene.tlas, 1U);
+
+    if (scene.blas.nodes.empty() || scene.tlas.nodes.empty())
+    {
+        spdlog::error("Nothing to trace.");
+        return 1;
+    }
+
+    // Same camera as RecordCommands.
+    // ------------------------------------------------
+
+    glm::mat4 matrixV, matrixP;
+    ComputeOrbitCamera(options.time, options.width / (float)options.height, matrixV, matrixP);
+
+    const glm::mat4 inverseMatrixV = glm::inverse(matrixV);
+    const glm::mat4 inverseMatrixP = glm::inverse(matrixP);
+
+    // Trace.
+    // ------------------------------------------------
+
+    ImageRGB8 image;
+    image.Resize(options.width, options.height);
+
+#ifdef REFERENCE_TRACER_SSE
+    const char* kernelName = "SSE";
+#else
+    const char* kernelName = "Scalar";
+#endif
+
+    double bestSeconds = DBL_MAX;
+
+    for (uint32_t iteration = 0U; iteration < options.iterations; iteration++)
+    {
+        const auto startTime = std::chrono::high_resolution_clock::now();
+
+        RenderImage(scene, options, inverseMatrixV, inverseMatrixP, image);
+
+        const std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - startTime;
+
+        bestSeconds = std::min(bestSeconds, elapsed.count());
+    }
+
+    const double rayCount = static_cast<double>(options.width) * options.height;
+
+    spdlog::info("Traced {}x{} ({} kernel, {} threads) in {:.2f} ms: {:.2f} Mrays/s",
+                 options.width,
+                 options.height,
+                 kernelName,
+                 options.threadCount,
+                 1000.0 * bestSeconds,
+                 rayCount / bestSeconds * 1e-6);
+
+    if (!options.outputPath.empty() && !WritePPM(options.outputPath.c_str(), image))
+        return 1;
+
+    if (!options.diffPath.empty() && !DiffImages(image, options))
+        return 1;
+
+    return 0;
+}
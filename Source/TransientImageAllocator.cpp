@@ -0,0 +1,169 @@
+#include <Common.h>
+#include <RenderContext.h>
+#include <TransientImageAllocator.h>
+
+// Transient Image Allocator Implementation
+// ------------------------------------------------------------
+
+TransientImageAllocator::ImageHandle TransientImageAllocator::AddImage(const std::string& imageName,
+                                                                       VkFormat           imageFormat,
+                                                                       VkImageUsageFlags  imageUsage,
+                                                                       uint32_t           firstPass,
+                                                                       uint32_t           lastPass)
+{
+    Check(m_Allocation == VK_NULL_HANDLE, "Transient images must be added before they are allocated.");
+    Check(firstPass <= lastPass, "Transient image lifetime ends before it begins.");
+
+    m_Images.push_back({ imageName, imageFormat, imageUsage, firstPass, lastPass });
+
+    return static_cast<ImageHandle>(m_Images.size() - 1U);
+}
+
+void TransientImageAllocator::Allocate(RenderContext* pRenderContext)
+{
+    Check(m_Allocation == VK_NULL_HANDLE, "Transient images are already allocated.");
+
+    // Create the images to learn their memory requirements.
+    // ------------------------------------------------
+
+    uint32_t     memoryTypeBits  = ~0U;
+    VkDeviceSize memoryAlignment = 1U;
+
+    for (auto& transientImage : m_Images)
+    {
+        VkImageCreateInfo imageInfo = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+        {
+            imageInfo.imageType     = VK_IMAGE_TYPE_2D;
+            imageInfo.arrayLayers   = 1U;
+            imageInfo.format        = transientImage.format;
+            imageInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.usage         = transientImage.usage;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            imageInfo.extent        = { pRenderContext->GetRenderWidth(), pRenderContext->GetRenderHeight(), 1 };
+            imageInfo.mipLevels     = 1U;
+            imageInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+            imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.flags         = 0x0;
+        }
+        Check(vkCreateImage(pRenderContext->GetDevice(), &imageInfo, nullptr, &transientImage.image.image), "Failed to create a transient image.");
+
+        vkGetImageMemoryRequirements(pRenderContext->GetDevice(), transientImage.image.image, &transientImage.memoryRequirements);
+
+        memoryTypeBits  &= transientImage.memoryRequirements.memoryTypeBits;
+        memoryAlignment  = std::max(memoryAlignment, transientImage.memoryRequirements.alignment);
+        m_UnaliasedSize += transientImage.memoryRequirements.size;
+    }
+
+    Check(memoryTypeBits != 0U, "Transient images have no memory type in common.");
+
+    // Largest first, each at the lowest offset clear of the placed images it is alive together with.
+    // ------------------------------------------------
+
+    std::vector<ImageHandle> placementOrder(m_Images.size());
+    std::iota(placementOrder.begin(), placementOrder.end(), 0U);
+
+    std::stable_sort(placementOrder.begin(),
+                     placementOrder.end(),
+                     [&](ImageHandle a, ImageHandle b) { return m_Images[a].memoryRequirements.size > m_Images[b].memoryRequirements.size; });
+
+    for (size_t placementIndex = 0U; placementIndex < placementOrder.size(); placementIndex++)
+    {
+        auto& transientImage = m_Images[placementOrder[placementIndex]];
+
+        std::vector<const TransientImage*> conflicts;
+
+        for (size_t placedIndex = 0U; placedIndex < placementIndex; placedIndex++)
+        {
+            const auto& placedImage = m_Images[placementOrder[placedIndex]];
+
+            if (placedImage.firstPass <= transientImage.lastPass && transientImage.firstPass <= placedImage.lastPass)
+                conflicts.push_back(&placedImage);
+        }
+
+        std::sort(conflicts.begin(), conflicts.end(), [](const TransientImage* a, const TransientImage* b) { return a->offset < b->offset; });
+
+        // The candidate only moves up, so the first gap it fits in before the next conflict is the lowest one.
+        const VkDeviceSize alignment = transientImage.memoryRequirements.alignment;
+
+        VkDeviceSize offset = 0U;
+
+        for (const auto* pConflict : conflicts)
+        {
+            if (offset + transientImage.memoryRequirements.size <= pConflict->offset)
+                break;
+
+            const VkDeviceSize conflictEnd = pConflict->offset + pConflict->memoryRequirements.size;
+
+            offset = std::max(offset, (conflictEnd + alignment - 1U) / alignment * alignment);
+        }
+
+        transientImage.offset = offset;
+        m_AllocationSize      = std::max(m_AllocationSize, offset + transientImage.memoryRequirements.size);
+    }
+
+    for (ImageHandle imageA = 0U; imageA < m_Images.size(); imageA++)
+    {
+        for (ImageHandle imageB = imageA + 1U; imageB < m_Images.size(); imageB++)
+        {
+            const auto& a = m_Images[imageA];
+            const auto& b = m_Images[imageB];
+
+            if (a.offset < b.offset + b.memoryRequirements.size && b.offset < a.offset + a.memoryRequirements.size)
+            {
+                m_Images[imageA].aliases.push_back(imageB);
+                m_Images[imageB].aliases.push_back(imageA);
+            }
+        }
+    }
+
+    // Allocate, bind and create the views.
+    // ------------------------------------------------
+
+    const VkMemoryRequirements memoryRequirements = { m_AllocationSize, memoryAlignment, memoryTypeBits };
+
+    VmaAllocationCreateInfo allocInfo = {};
+    {
+        allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    }
+    Check(vmaAllocateMemory(pRenderContext->GetAllocator(), &memoryRequirements, &allocInfo, &m_Allocation, nullptr),
+          "Failed to allocate the transient image memory.");
+
+    for (auto& transientImage : m_Images)
+    {
+        Check(vmaBindImageMemory2(pRenderContext->GetAllocator(), m_Allocation, transientImage.offset, transientImage.image.image, nullptr),
+              "Failed to bind a transient image.");
+
+        VkImageViewCreateInfo imageViewInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+        {
+            imageViewInfo.image            = transientImage.image.image;
+            imageViewInfo.viewType         = VK_IMAGE_VIEW_TYPE_2D;
+            imageViewInfo.format           = transientImage.format;
+            imageViewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0U, 1U, 0U, 1U };
+        }
+        Check(vkCreateImageView(pRenderContext->GetDevice(), &imageViewInfo, nullptr, &transientImage.image.imageView),
+              "Failed to create a transient image view.");
+
+        DebugLabelImageResource(pRenderContext, transientImage.image, transientImage.name.c_str());
+    }
+
+    spdlog::info("Placed {} transient images in {:.1f} MB ({:.1f} MB as separate allocations).",
+                 m_Images.size(),
+                 static_cast<double>(m_AllocationSize) / (1024.0 * 1024.0),
+                 static_cast<double>(m_UnaliasedSize) / (1024.0 * 1024.0));
+}
+
+void TransientImageAllocator::Release(RenderContext* pRenderContext)
+{
+    for (auto& transientImage : m_Images)
+    {
+        vkDestroyImageView(pRenderContext->GetDevice(), transientImage.image.imageView, nullptr);
+        vkDestroyImage(pRenderContext->GetDevice(), transientImage.image.image, nullptr);
+
+        transientImage.image = {};
+    }
+
+    if (m_Allocation != VK_NULL_HANDLE)
+        vmaFreeMemory(pRenderContext->GetAllocator(), m_Allocation);
+
+    m_Allocation = VK_NULL_HANDLE;
+}